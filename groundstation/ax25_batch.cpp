@@ -0,0 +1,165 @@
+//============================================================================
+// Name        : ax25_batch.cpp
+// Description : Batch decoding of recorded passes
+//============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "batch_decoder.h"
+#include "tlm_archive.h"
+
+static void usage(const char *prog){
+	fprintf(stderr, "Usage: %s [-j threads] [-r bitrate] [-s kbits] [-n] [-z] [-a] [-d seconds] [-o out.csv] [-A dir] capture...\n", prog);
+	fprintf(stderr, "  -j  decoding threads (default: one per core)\n");
+	fprintf(stderr, "  -r  bitrate of the captures in bit/s (default: 1200)\n");
+	fprintf(stderr, "  -s  work unit per thread in kbit (default: 65536)\n");
+	fprintf(stderr, "  -n  captures are not bit stuffed (frame.txt)\n");
+	fprintf(stderr, "  -z  zero padded Info fields whose FCS only covers the text before the first NUL (frame.txt)\n");
+	fprintf(stderr, "  -a  also output frames with a wrong FCS\n");
+	fprintf(stderr, "  -d  drop copies of a frame received within this many seconds (several stations)\n");
+	fprintf(stderr, "  -o  output file (default: stdout)\n");
+	fprintf(stderr, "  -A  append the frames to the archives in dir (<schema>.tlm, raw.tlm)\n");
+}
+
+/* Appends every frame to the archive of its schema, the others to raw.tlm */
+static int archive_frames(const char *dir, const std::vector<decoded_frame> &frames){
+	const tlm_schema *const *s;
+	std::vector<tlm_archive_writer> w;
+	std::string path;
+	size_t i, k, n;
+	int ret = 0;
+
+	for (n=0; tlm_schemas[n]; n++);
+	w.resize(n + 1);
+
+	for (k=0; k<=n; k++){
+		path = std::string(dir) + "/" + (k < n ? tlm_schemas[k]->name : "raw") + ".tlm";
+		if (tlm_archive_create(&w[k], path.c_str(), k < n ? tlm_schemas[k] : NULL, TLM_BLOCK_ROWS) != 0){
+			fprintf(stderr, "ERROR, can't open archive %s\n", path.c_str());
+			while (k-- > 0) tlm_archive_close(&w[k]);
+			return -1;
+		}
+	}
+
+	for (i=0; i<frames.size(); i++){
+		const decoded_frame &f = frames[i];
+
+		for (k=0, s=tlm_schemas; *s && *s != f.schema; s++, k++);
+		if (tlm_archive_append(&w[k], f.time, f.values, f.frame, f.frame_len) != 0) ret = -1;
+	}
+
+	for (k=0; k<=n; k++)
+		if (tlm_archive_close(&w[k]) != 0) ret = -1;
+
+	if (ret != 0) fprintf(stderr, "ERROR, can't write the archives in %s\n", dir);
+	return ret;
+}
+
+static void print_time(FILE *out, double t){
+	time_t sec = (time_t)t;
+	struct tm tm;
+	char buf[32];
+
+	gmtime_r(&sec, &tm);
+	strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+	fprintf(out, "%s.%03dZ", buf, (int)((t - (double)sec)*1000));
+}
+
+static void print_header(FILE *out){
+	const tlm_schema *const *s;
+	size_t i;
+
+	fprintf(out, "time,file,bit,source,destination,control,pid,info_len,fcs_ok");
+	for (s=tlm_schemas; *s; s++)
+		for (i=0; i<(*s)->nfields; i++) fprintf(out, ",%s.%s", (*s)->name, (*s)->fields[i].name);
+	fputc('\n', out);
+}
+
+static void print_frame(FILE *out, const std::vector<capture_file> &caps, const decoded_frame &f){
+	const tlm_schema *const *s;
+	size_t i;
+
+	print_time(out, f.time);
+	fprintf(out, ",%s,%llu,%s,%s,0x%02X,0x%02X,%u,%d", caps[f.file].path.c_str(),
+			(unsigned long long)f.bit_pos, f.source, f.destination, f.control, f.pid,
+			f.info_len, f.fcs_ok);
+
+	// one column per field of every schema, empty when not this frame's schema
+	for (s=tlm_schemas; *s; s++)
+		for (i=0; i<(*s)->nfields; i++){
+			if (*s == f.schema) fprintf(out, ",%.10g", f.values[i]);
+			else fputc(',', out);
+		}
+
+	fputc('\n', out);
+}
+
+int main(int argc, char **argv){
+	std::vector<capture_file> caps;
+	std::vector<decoded_frame> frames;
+	batch_options opt;
+	batch_stats stats;
+	FILE *out = stdout;
+	const char *archive_dir = NULL;
+	int c, i;
+
+	batch_default_options(&opt);
+
+	while ((c = getopt(argc, argv, "j:r:s:nzad:o:A:h")) != -1){
+		switch (c){
+		case 'j': opt.threads = atoi(optarg); break;
+		case 'r': opt.bitrate = atof(optarg); break;
+		case 's': opt.shard_bits = (uint64_t)atol(optarg) << 10; break;
+		case 'n': opt.destuff = 0; break;
+		case 'z': opt.nul_padded = 1; break;
+		case 'a': opt.keep_bad = 1; break;
+		case 'd': opt.dedup_window = atof(optarg); break;
+		case 'A': archive_dir = optarg; break;
+		case 'o':
+			if ((out = fopen(optarg, "w")) == NULL){
+				fprintf(stderr, "ERROR, can't open %s\n", optarg);
+				return 1;
+			}
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (optind >= argc || opt.bitrate <= 0 || opt.shard_bits == 0){
+		usage(argv[0]);
+		return 1;
+	}
+
+	for (i=optind; i<argc; i++){
+		capture_file cap;
+
+		if (capture_open(argv[i], &cap) != 0){
+			fprintf(stderr, "ERROR, can't open %s\n", argv[i]);
+			return 1;
+		}
+		caps.push_back(cap);
+	}
+
+	frames = batch_decode(caps, opt, &stats);
+
+	print_header(out);
+	for (size_t k=0; k<frames.size(); k++) print_frame(out, caps, frames[k]);
+
+	if (out != stdout) fclose(out);
+
+	if (archive_dir && archive_frames(archive_dir, frames) != 0) return 1;
+
+	fprintf(stderr, "%u files, %llu shards, %.1f MB, %llu frames (%llu FCS errors, %llu duplicates) in %.3f s: %.1f MB/s, %.0f frames/s\n",
+			(unsigned)caps.size(), (unsigned long long)stats.shards, stats.bytes/1e6,
+			(unsigned long long)stats.frames, (unsigned long long)stats.fcs_errors,
+			(unsigned long long)stats.duplicates, stats.seconds,
+			stats.bytes/1e6/stats.seconds, stats.frames/stats.seconds);
+
+	return 0;
+}
@@ -0,0 +1,216 @@
+//============================================================================
+// Name        : ax25_bits.cpp
+// Description : Int-per-bit AX.25 field builders (one int per transmitted bit)
+//============================================================================
+
+#include <ctype.h>
+
+#include "ax25_bits.h"
+
+void flipbits (int *a, int nelems){
+	int temp, i;
+
+	for (i=0; i<nelems/2; i++){
+		temp = a[nelems-1-i];
+		a[nelems-1-i] = a[i];
+		a[i] = temp;
+	}
+
+	/*
+	for(i=0; i<nelems; i++){
+		cout << a[i];
+	}
+	cout<<endl;
+	*/
+}
+
+int *decimal2bin(int decimalNumber, int *binary){
+
+	int c, k;
+	//int i;
+	for (c = 15; c >= 0; c--){
+		k = decimalNumber >> c;
+
+	    if (k & 1){
+	    	/*printf("1"); */
+	    	binary[c] = 1;
+	    }
+	    else{
+	    	/*printf("0"); */
+	    	binary[c] = 0;
+	    }
+	}
+	//cout<<endl;
+
+	flipbits(binary, 16);
+
+	//cout<<"binary: ";
+	//  for(i=0; i<16; i++) cout<<binary[i];
+	//cout<<endl;
+
+	return binary;
+
+	//return binaryNumber;
+}
+
+void initInfo(int *a){
+	int i;
+
+	for(i=0; i<(256*8); i++) a[i] = 0;
+
+	//for(i=0; i<256; i++) cout << a[i];
+	//cout << endl;
+}
+
+void initAddress(int *l, int tam){
+	int AddMin = 48;
+	int i, tam_temp = AddMin - tam;
+	int temp[tam_temp];
+
+
+	for(i=tam; i<AddMin; i++){
+		if ( (i-1)%8 == 0 ) temp[i-tam] = 1;
+		else temp[i-tam] = 0;
+	}
+
+	flipbits(temp, tam_temp);
+
+	for(i=tam; i<AddMin; i++) l[i] = temp[i-tam];
+
+
+	/*
+	cout<<"Valor de l:  ";
+	for (i = 0; i<AddMin; i++)
+		cout << l[i];
+	cout<<endl;
+	*/
+}
+
+/* Transforma caracteres em bits invertidos */
+void fullAddressDest(int *l, char *c, int tam_c, int tam_c_bits, int *SSID_dest){
+
+	int i, k=0;
+	char temp; // lembrar do caracter NULL em c[7]
+
+	/* ASCII em vetor de bits :DDDD */
+		//printf("Valor de cd: ");
+		for(i=0; i<tam_c; i++){
+
+			l[0] = 0; //printf("0");
+			k++;
+			temp = c[i];
+			while (c[i]) {
+				if (c[i] & 1) {l[k] = 1; //printf("1");
+				}
+				else {l[k] = 0; //printf("0");
+				}
+				c[i] >>= 1;
+				k++;
+			}
+			/* Digitos contem 6 bits.
+			 * Se for, adiciona um bit para deixa-lo com formato padrao de 7 bits
+			 */
+			if (isdigit(temp)) {l[k] = 0; k++; //printf("0");
+			}
+		}
+		//printf("\n");
+
+		/*
+		cout<<"Valor de cd: ";
+			for (i = 0; i<tam_c_bits; i++) cout<<l[i];
+		cout<<endl;
+		*/
+
+		initAddress(l,tam_c_bits);
+
+		// preenche o SSID
+		for (i = 48; i<56; i++)	l[i] = SSID_dest[i-48];
+}
+
+/* Transforma caracteres em bits invertidos */
+void fullAddressSource(int *m, char *c, int tam_c, int tam_c_bits, int *SSID_source){
+
+	int i, k=0;
+	char temp; // lembrar do caracter NULL em c[7]
+
+	/* ASCII em vetor de bits :DDDD */
+		//printf("Valor de cs: ");
+		for(i=0; i<tam_c; i++){
+
+			m[0] = 0; //printf("0");
+			k++;
+			temp = c[i];
+			while (c[i]) {
+				if (c[i] & 1) {m[k] = 1; //printf("1");
+				}
+				else { m[k] = 0; //printf("0");
+				}
+			c[i] >>= 1;
+			k++;
+			}
+			/* Digitos contem 6 bits.
+			 * Se for, adiciona um bit para deixa-lo com formato padrao de 7 bits
+			 */
+			if (isdigit(temp)) {m[k] = 0; k++; //printf("0");
+			}
+		}
+		//printf("\n");
+
+		initAddress(m,tam_c_bits);
+
+		// preenche o SSID
+		for (i = 48; i<56; i++)	m[i] = SSID_source[i-48];
+}
+
+void fullInfo(int *infoFIELD, unsigned char *inform, int tam_c, int tam_c_bits){
+
+	int i, k=0;
+	char temp;
+
+	/* Inicializa o campo Info com zeros */
+		initInfo(infoFIELD);
+
+	/* ASCII em vetor de bits :DDDD */
+		//printf("Valor de i: ");
+		for(i=0; i<tam_c; i++){
+
+			//infoFIELD[0] = 0; printf("0");
+			//k++;
+			temp = inform[i];
+			while (inform[i]) {
+				if (inform[i] & 1) {
+					infoFIELD[k] = 1; //printf("1");
+				}
+				else {
+					infoFIELD[k] = 0; //printf("0");
+				}
+				inform[i] >>= 1;
+				k++;
+			}
+			k++; //printf("0");
+			if (isdigit(temp)) {
+				infoFIELD[k] = 0; k++; //printf("0");
+			}
+		}
+		//printf("\n");
+}
+
+void bytes2bits(const uint8_t *bytes, size_t nbytes, int *bits){
+	size_t i;
+	int j;
+
+	for(i=0; i<nbytes; i++)
+		for(j=0; j<8; j++)
+			*bits++ = (bytes[i] >> j) & 1;
+}
+
+void bits2bytes(const int *bits, size_t nbytes, uint8_t *bytes){
+	size_t i;
+	int j;
+
+	for(i=0; i<nbytes; i++){
+		bytes[i] = 0;
+		for(j=0; j<8; j++)
+			if (*bits++) bytes[i] |= 1 << j;
+	}
+}
@@ -0,0 +1,29 @@
+//============================================================================
+// Name        : ax25_bits.h
+// Description : Int-per-bit AX.25 field builders (one int per transmitted bit)
+//============================================================================
+
+#ifndef AX25_BITS_H_
+#define AX25_BITS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+void flipbits (int *a, int nelems);
+
+/* Writes the 16 bits of decimalNumber MSB first into binary and returns it */
+int *decimal2bin(int decimalNumber, int *binary);
+
+void initInfo(int *a);
+void initAddress(int *l, int tam);
+
+/* Transforma caracteres em bits invertidos */
+void fullAddressDest(int *l, char *c, int tam_c, int tam_c_bits, int *SSID_dest);
+void fullAddressSource(int *m, char *c, int tam_c, int tam_c_bits, int *SSID_source);
+void fullInfo(int *infoFIELD, unsigned char *inform, int tam_c, int tam_c_bits);
+
+/* Conversion between packed octets (sent LSB first) and one int per bit */
+void bytes2bits(const uint8_t *bytes, size_t nbytes, int *bits);
+void bits2bytes(const int *bits, size_t nbytes, uint8_t *bytes);
+
+#endif /* AX25_BITS_H_ */
@@ -0,0 +1,71 @@
+//============================================================================
+// Name        : ax25_decoder.cpp
+// Description : AX.25 frame parser for the octets delivered by the HDLC deframer
+//============================================================================
+
+#include <string.h>
+
+#include "ax25_decoder.h"
+#include "crc.h"
+
+static void decode_callsign(const uint8_t *addr, char *callsign){
+	int i;
+
+	for(i=0; i<AX25_CALLSIGN_LEN; i++) callsign[i] = (char)(addr[i] >> 1);
+
+	while (i > 0 && callsign[i-1] == ' ') i--;
+	callsign[i] = '\0';
+}
+
+int ax25_decode_frame(const uint8_t *frame, size_t len, ax25_frame *out, int flags){
+	const uint8_t *p = frame, *end;
+	size_t text_len;
+
+	if (len < 2*AX25_ADDR_LEN + 1 + AX25_FCS_LEN) return -1;
+	end = frame + len - AX25_FCS_LEN;
+
+	// address field: the last octet has the extension bit set
+	out->naddrs = 0;
+	do {
+		if (p + AX25_ADDR_LEN > end || out->naddrs == AX25_MAX_ADDRS) return -1;
+
+		if (out->naddrs == 0){
+			decode_callsign(p, out->destination);
+			out->ssid_dest = p[AX25_CALLSIGN_LEN];
+		}
+		else if (out->naddrs == 1){
+			decode_callsign(p, out->source);
+			out->ssid_source = p[AX25_CALLSIGN_LEN];
+		}
+		out->naddrs++;
+		p += AX25_ADDR_LEN;
+	} while (!(p[-1] & 1));
+
+	if (out->naddrs < 2 || p >= end) return -1;
+
+	out->control = *p++;
+
+	// I frames (bit 0 = 0) and UI frames (0x03, P/F ignored) carry a PID
+	out->has_pid = !(out->control & 0x01) || (out->control & 0xEF) == 0x03;
+	out->pid = 0;
+	if (out->has_pid){
+		if (p >= end) return -1;
+		out->pid = *p++;
+	}
+
+	out->info = p;
+	out->info_len = (size_t)(end - p);
+
+	out->fcs = (unsigned int)ax25_reverse8(end[0]) << 8 | ax25_reverse8(end[1]);
+	out->fcs_ok = crctablefast(out->info, (unsigned int)out->info_len) == out->fcs;
+	out->fcs_prefix = 0;
+
+	if (!out->fcs_ok && (flags & AX25_NUL_PADDED) && out->info_len > 0 && out->info[out->info_len-1] == 0){
+		const uint8_t *nul = (const uint8_t *)memchr(out->info, 0, out->info_len);
+
+		text_len = (size_t)(nul - out->info);
+		out->fcs_ok = out->fcs_prefix = crctablefast(out->info, (unsigned int)text_len) == out->fcs;
+	}
+
+	return 0;
+}
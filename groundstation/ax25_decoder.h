@@ -0,0 +1,50 @@
+//============================================================================
+// Name        : ax25_decoder.h
+// Description : AX.25 frame parser for the octets delivered by the HDLC deframer
+//============================================================================
+
+#ifndef AX25_DECODER_H_
+#define AX25_DECODER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ax25_encoder.h"
+
+#define AX25_MAX_ADDRS		10		// destination + source + 8 digipeaters (560 bits)
+
+/* ax25_decode_frame() flags */
+#define AX25_NUL_PADDED		0x01	// zero padded Info field of main() (frame.txt), see below
+
+typedef struct {
+	char destination[AX25_CALLSIGN_LEN + 1];	// trailing spaces removed
+	uint8_t ssid_dest;
+	char source[AX25_CALLSIGN_LEN + 1];
+	uint8_t ssid_source;
+	int naddrs;
+
+	uint8_t control;
+	int has_pid;
+	uint8_t pid;
+
+	const uint8_t *info;		// points into the frame given to ax25_decode_frame()
+	size_t info_len;
+
+	unsigned int fcs;			// received FCS
+	int fcs_ok;
+	int fcs_prefix;				// fcs_ok only over the text before the first NUL (AX25_NUL_PADDED)
+} ax25_frame;
+
+/*
+* Parses the octets between the flags (FCS included).
+* Returns 0 on success or -1 if the address field is malformed.
+*
+* The FCS is checked over the whole Info field. With AX25_NUL_PADDED it is
+* also checked, failing that, over the text before the first NUL of a zero
+* padded field (main() fills a fixed 256 octet field but only protects the
+* string): a match sets fcs_prefix too. Other frames ending in 0 are not
+* given that second chance, so a tail corrupted after a NUL is rejected.
+*/
+int ax25_decode_frame(const uint8_t *frame, size_t len, ax25_frame *out, int flags = 0);
+
+#endif /* AX25_DECODER_H_ */
@@ -0,0 +1,59 @@
+//============================================================================
+// Name        : ax25_encoder.cpp
+// Description : Packed-byte AX.25 frame encoder
+//============================================================================
+
+#include <string.h>
+
+#include "ax25_encoder.h"
+#include "crc.h"
+
+void ax25_encode_address(uint8_t *out, const char *callsign, uint8_t ssid){
+	int i;
+
+	for(i=0; i<AX25_CALLSIGN_LEN && callsign[i]; i++)
+		out[i] = (uint8_t)(callsign[i] << 1);
+
+	for(; i<AX25_CALLSIGN_LEN; i++)
+		out[i] = ' ' << 1;	// pad with spaces
+
+	out[AX25_CALLSIGN_LEN] = ssid;
+}
+
+void ax25_encode_fcs(uint8_t *out, unsigned int crc){
+	// the octets are sent LSB first but the FCS goes out MSB first
+	out[0] = ax25_reverse8((uint8_t)(crc >> 8));
+	out[1] = ax25_reverse8((uint8_t)crc);
+}
+
+size_t ax25_encode_frame(uint8_t *out, size_t out_size, const ax25_header *hdr,
+						 const uint8_t *info, size_t info_len, size_t field_len){
+	size_t len;
+	uint8_t *p = out;
+
+	if (field_len < info_len) field_len = info_len;
+	len = 1 + AX25_HEADER_LEN + field_len + AX25_FCS_LEN + 1;
+
+	if (field_len > AX25_INFO_MAX || out_size < len) return 0;
+
+	*p++ = AX25_FLAG;
+
+	ax25_encode_address(p, hdr->destination, hdr->ssid_dest);
+	p += AX25_ADDR_LEN;
+	ax25_encode_address(p, hdr->source, hdr->ssid_source);
+	p += AX25_ADDR_LEN;
+
+	*p++ = hdr->control;
+	*p++ = hdr->pid;
+
+	memcpy(p, info, info_len);
+	memset(p + info_len, 0, field_len - info_len);
+	p += field_len;
+
+	ax25_encode_fcs(p, crctablefast(info, (unsigned int)info_len));
+	p += AX25_FCS_LEN;
+
+	*p = AX25_FLAG;
+
+	return len;
+}
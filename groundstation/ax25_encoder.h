@@ -0,0 +1,70 @@
+//============================================================================
+// Name        : ax25_encoder.h
+// Description : Packed-byte AX.25 frame encoder
+//============================================================================
+
+#ifndef AX25_ENCODER_H_
+#define AX25_ENCODER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+* | Flag | Destination | Source | Control | PID | Info.    | FCS  | Flag |
+* | 0x7E | 7 Bytes     | 7 Bytes| 1 Byte  | 1 B | N Bytes  | 2 B  | 0x7E |
+*
+* The frame is written one octet per byte in transmission order. Each octet
+* is sent LSB first, so bit j of out[k] is the on-air bit 8*k+j (the same
+* order used by the int-per-bit arrays and by frame.txt).
+*
+* The FCS is the CRC-CCITT of the Info field only and is sent MSB first,
+* as expected by checkCRC() in ax_25.cpp.
+*/
+
+#define AX25_FLAG			0x7E
+#define AX25_PID_NO_L3		0xF0	// No layer 3 protocol implemented
+#define AX25_CALLSIGN_LEN	6
+#define AX25_ADDR_LEN		7		// callsign + SSID octet
+#define AX25_HEADER_LEN		(2*AX25_ADDR_LEN + 2)	// addresses + control + PID
+#define AX25_INFO_MAX		256
+#define AX25_FCS_LEN		2
+#define AX25_FRAME_MAX		(1 + AX25_HEADER_LEN + AX25_INFO_MAX + AX25_FCS_LEN + 1)
+
+typedef struct {
+	const char *destination;	// up to 6 characters, padded with spaces
+	uint8_t ssid_dest;			// SSID octet, see ax25_ssid()
+	const char *source;
+	uint8_t ssid_source;
+	uint8_t control;
+	uint8_t pid;
+} ax25_header;
+
+/* SSID octet: | C | R | R | SSID (4 bits) | last address | */
+static inline uint8_t ax25_ssid(int c_bit, int ssid, int last){
+	return (uint8_t)(((c_bit & 1) << 7) | 0x60 | ((ssid & 0x0F) << 1) | (last & 1));
+}
+
+static inline uint8_t ax25_reverse8(uint8_t b){
+	b = (uint8_t)((b & 0xF0) >> 4 | (b & 0x0F) << 4);
+	b = (uint8_t)((b & 0xCC) >> 2 | (b & 0x33) << 2);
+	b = (uint8_t)((b & 0xAA) >> 1 | (b & 0x55) << 1);
+	return b;
+}
+
+/* Writes the 7 address octets (callsign shifted left by one bit + SSID) */
+void ax25_encode_address(uint8_t *out, const char *callsign, uint8_t ssid);
+
+/* FCS octets in transmission order */
+void ax25_encode_fcs(uint8_t *out, unsigned int crc);
+
+/*
+* Builds a full frame (both flags included) into out.
+* The Info field is zero padded up to field_len octets when field_len > info_len
+* (main() uses a fixed 256 octet field); the FCS only covers the info_len octets.
+* Returns the number of bytes written or 0 if out_size is too small
+* or the Info field is above AX25_INFO_MAX.
+*/
+size_t ax25_encode_frame(uint8_t *out, size_t out_size, const ax25_header *hdr,
+						 const uint8_t *info, size_t info_len, size_t field_len = 0);
+
+#endif /* AX25_ENCODER_H_ */
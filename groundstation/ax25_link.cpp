@@ -0,0 +1,606 @@
+//============================================================================
+// Name        : ax25_link.cpp
+// Description : AX.25 v2.2 connected mode (LAPB) data link state machine
+//============================================================================
+
+#include <string.h>
+
+#include "ax25_link.h"
+
+#define T1_MIN_MS		100
+#define T1_MAX_MS		(120*1000)
+
+static unsigned int seq_sub(const ax25_link *l, unsigned int a, unsigned int b){
+	return (a + l->modulo - b) % l->modulo;
+}
+
+static unsigned int seq_inc(const ax25_link *l, unsigned int a){
+	return (a + 1) % l->modulo;
+}
+
+void ax25_link_default_config(ax25_link_config *cfg){
+	cfg->local = "";
+	cfg->local_ssid = 0;
+	cfg->remote = "";
+	cfg->remote_ssid = 0;
+	cfg->modulo = 8;
+	cfg->window = 4;
+	cfg->n1 = AX25_INFO_MAX;
+	cfg->n2 = 10;
+	cfg->t1_ms = 10000;
+	cfg->t3_ms = 300000;
+	cfg->srej = 1;
+}
+
+int ax25_link_init(ax25_link *l, const ax25_link_config *cfg, ax25_link_send_cb send,
+				   ax25_link_data_cb data, ax25_link_event_cb event, void *user){
+	if (cfg->modulo != 8 && cfg->modulo != 128) return -1;
+	if (cfg->window < 1 || cfg->window > cfg->modulo - 1) return -1;
+	// selective reject keeps frames ahead of V(R): the windows can't overlap
+	if (cfg->srej && cfg->window > cfg->modulo/2) return -1;
+	if (cfg->n1 < 1 || cfg->n1 > AX25_INFO_MAX || cfg->n2 < 1 || cfg->t1_ms == 0) return -1;
+	if (send == NULL) return -1;
+
+	l->cfg = *cfg;
+	l->send = send;
+	l->data = data;
+	l->event = event;
+	l->user = user;
+
+	ax25_encode_address(l->local_addr, cfg->local, ax25_ssid(0, cfg->local_ssid, 0));
+	ax25_encode_address(l->remote_addr, cfg->remote, ax25_ssid(0, cfg->remote_ssid, 0));
+
+	l->state = AX25_LINK_DISCONNECTED;
+	l->modulo = (unsigned int)cfg->modulo;
+	l->vs = l->vt = l->va = l->vr = 0;
+	l->rc = 0;
+	l->peer_busy = l->reject_sent = l->ack_pending = 0;
+	l->t1_expiry = l->t1_start = l->t3_expiry = 0;
+	l->srt = cfg->t1_ms/2;
+	l->t1v = cfg->t1_ms;
+
+	l->queue.clear();
+	l->sent.assign(128, std::vector<uint8_t>());
+	l->rx.assign(128, std::vector<uint8_t>());
+	l->rx_have.assign(128, 0);
+	l->srej_asked.assign(128, 0);
+
+	memset(&l->stats, 0, sizeof(l->stats));
+	return 0;
+}
+
+/* ------------------------------- transmission ------------------------------- */
+
+static void send_frame(ax25_link *l, int command, const uint8_t *ctrl, size_t ctrl_len,
+					   const uint8_t *info, size_t info_len, int with_pid){
+	uint8_t f[AX25_LINK_FRAME_MAX];
+	uint8_t *p = f;
+
+	// command: C bit set in the destination, response: in the source
+	ax25_encode_address(p, l->cfg.remote, ax25_ssid(command, l->cfg.remote_ssid, 0));
+	p += AX25_ADDR_LEN;
+	ax25_encode_address(p, l->cfg.local, ax25_ssid(!command, l->cfg.local_ssid, 1));
+	p += AX25_ADDR_LEN;
+
+	memcpy(p, ctrl, ctrl_len);
+	p += ctrl_len;
+
+	if (with_pid) *p++ = AX25_PID_NO_L3;
+	if (info_len) memcpy(p, info, info_len);
+	p += info_len;
+
+	l->send(f, (size_t)(p - f), l->user);
+}
+
+static void send_u(ax25_link *l, uint8_t type, int command, int pf){
+	uint8_t c = (uint8_t)(type | (pf ? AX25_CTRL_PF : 0));
+
+	send_frame(l, command, &c, 1, NULL, 0, 0);
+}
+
+static void send_s(ax25_link *l, uint8_t type, int command, int pf, unsigned int nr){
+	uint8_t c[2];
+
+	if (l->modulo == 8){
+		c[0] = (uint8_t)(nr << 5 | (pf ? AX25_CTRL_PF : 0) | type);
+		send_frame(l, command, c, 1, NULL, 0, 0);
+	}
+	else {
+		c[0] = type;
+		c[1] = (uint8_t)(nr << 1 | (pf ? 1 : 0));
+		send_frame(l, command, c, 2, NULL, 0, 0);
+	}
+	if (type == AX25_CTRL_RR || type == AX25_CTRL_RNR || type == AX25_CTRL_REJ) l->ack_pending = 0;
+}
+
+static void send_i(ax25_link *l, unsigned int ns, int p){
+	const std::vector<uint8_t> &d = l->sent[ns];
+	uint8_t c[2];
+
+	if (l->modulo == 8){
+		c[0] = (uint8_t)(l->vr << 5 | (p ? AX25_CTRL_PF : 0) | ns << 1);
+		send_frame(l, 1, c, 1, d.data(), d.size(), 1);
+	}
+	else {
+		c[0] = (uint8_t)(ns << 1);
+		c[1] = (uint8_t)(l->vr << 1 | (p ? 1 : 0));
+		send_frame(l, 1, c, 2, d.data(), d.size(), 1);
+	}
+	l->ack_pending = 0;		// N(R) goes with the frame
+}
+
+/* --------------------------------- timers --------------------------------- */
+
+static void start_t1(ax25_link *l, uint64_t now){
+	l->t1_start = now;
+	l->t1_expiry = now + l->t1v;
+}
+
+static void start_t3(ax25_link *l, uint64_t now){
+	l->t3_expiry = l->cfg.t3_ms ? now + l->cfg.t3_ms : 0;
+}
+
+/* T1 = 2*SRT, SRT updated with the time the last frame took to be acknowledged */
+static void select_t1(ax25_link *l, uint64_t now){
+	if (l->rc == 0 && l->t1_expiry){
+		uint64_t rtt = now - l->t1_start;
+
+		l->srt = (uint32_t)((7*(uint64_t)l->srt + rtt)/8);
+	}
+	l->t1v = 2*l->srt;
+	if (l->t1v < T1_MIN_MS) l->t1v = T1_MIN_MS;
+	if (l->t1v > T1_MAX_MS) l->t1v = T1_MAX_MS;
+}
+
+/* -------------------------------- procedures -------------------------------- */
+
+static void notify(ax25_link *l, ax25_link_event ev){
+	if (l->event) l->event(ev, l->user);
+}
+
+static void clear_window(ax25_link *l){
+	unsigned int i;
+
+	l->vs = l->vt = l->va = l->vr = 0;
+	l->rc = 0;
+	l->peer_busy = l->reject_sent = l->ack_pending = 0;
+	for (i=0; i<128; i++){
+		l->sent[i].clear();
+		l->rx[i].clear();
+		l->rx_have[i] = 0;
+		l->srej_asked[i] = 0;
+	}
+}
+
+/* After a link reset the unacknowledged frames go out again, before the queue */
+static void requeue_unacked(ax25_link *l){
+	unsigned int s;
+
+	for (s=l->vt; s!=l->va; ){
+		s = (s + l->modulo - 1) % l->modulo;
+		l->queue.push_front(std::vector<uint8_t>());
+		l->queue.front().swap(l->sent[s]);
+	}
+}
+
+static void set_disconnected(ax25_link *l, ax25_link_event ev){
+	l->state = AX25_LINK_DISCONNECTED;
+	l->t1_expiry = l->t3_expiry = 0;
+	l->queue.clear();
+	clear_window(l);
+	notify(l, ev);
+}
+
+static void establish(ax25_link *l, uint64_t now){
+	requeue_unacked(l);
+	l->modulo = (unsigned int)l->cfg.modulo;
+	clear_window(l);
+	send_u(l, l->modulo == 128 ? AX25_CTRL_SABME : AX25_CTRL_SABM, 1, 1);
+	l->state = AX25_LINK_AWAITING_CONNECTION;
+	l->t3_expiry = 0;
+	start_t1(l, now);
+}
+
+static void transmit_enquiry(ax25_link *l, uint64_t now){
+	send_s(l, AX25_CTRL_RR, 1, 1, l->vr);
+	start_t1(l, now);
+}
+
+/* N(R) is valid if V(A) <= N(R) <= highest N(S) sent + 1 */
+static int nr_valid(const ax25_link *l, unsigned int nr){
+	return seq_sub(l, nr, l->va) <= seq_sub(l, l->vt, l->va);
+}
+
+/* Frees the frames acknowledged by N(R) */
+static void acknowledge(ax25_link *l, unsigned int nr){
+	if (seq_sub(l, nr, l->va) > seq_sub(l, l->vs, l->va)) l->vs = nr;
+
+	while (l->va != nr){
+		l->sent[l->va].clear();
+		l->va = seq_inc(l, l->va);
+	}
+}
+
+/* N(R) of a frame received in the connected state */
+static void check_acknowledged(ax25_link *l, unsigned int nr, uint64_t now){
+	if (l->state == AX25_LINK_TIMER_RECOVERY){
+		acknowledge(l, nr);
+		return;
+	}
+
+	if (nr == l->vt){
+		acknowledge(l, nr);
+		select_t1(l, now);
+		l->t1_expiry = 0;
+		start_t3(l, now);
+	}
+	else if (nr != l->va){
+		acknowledge(l, nr);
+		start_t1(l, now);
+	}
+}
+
+static void nr_error(ax25_link *l, uint64_t now){
+	notify(l, AX25_LINK_EV_RESET);
+	establish(l, now);
+}
+
+static void deliver(ax25_link *l, const uint8_t *info, size_t len){
+	l->stats.i_received++;
+	if (l->data) l->data(info, len, l->user);
+}
+
+/* --------------------------------- receive --------------------------------- */
+
+static void receive_u(ax25_link *l, uint8_t c, int command, uint64_t now){
+	uint8_t type = (uint8_t)(c & ~AX25_CTRL_PF);
+	int pf = (c & AX25_CTRL_PF) != 0;
+	int was_connected = l->state == AX25_LINK_CONNECTED || l->state == AX25_LINK_TIMER_RECOVERY;
+
+	switch (type){
+	case AX25_CTRL_SABM:
+	case AX25_CTRL_SABME:
+		if (!command) break;
+		if (l->state == AX25_LINK_AWAITING_RELEASE){
+			send_u(l, AX25_CTRL_DM, 0, pf);
+			break;
+		}
+		requeue_unacked(l);
+		l->modulo = type == AX25_CTRL_SABME ? 128 : 8;
+		clear_window(l);
+		send_u(l, AX25_CTRL_UA, 0, pf);
+		l->state = AX25_LINK_CONNECTED;
+		l->t1_expiry = 0;
+		start_t3(l, now);
+		notify(l, was_connected ? AX25_LINK_EV_RESET : AX25_LINK_EV_CONNECTED);
+		break;
+
+	case AX25_CTRL_DISC:
+		if (!command) break;
+		if (l->state == AX25_LINK_DISCONNECTED || l->state == AX25_LINK_AWAITING_CONNECTION){
+			send_u(l, AX25_CTRL_DM, 0, pf);
+			break;
+		}
+		send_u(l, AX25_CTRL_UA, 0, pf);
+		set_disconnected(l, AX25_LINK_EV_DISCONNECTED);
+		break;
+
+	case AX25_CTRL_UA:
+		if (!pf) break;
+		if (l->state == AX25_LINK_AWAITING_CONNECTION){
+			l->state = AX25_LINK_CONNECTED;
+			l->rc = 0;
+			l->t1_expiry = 0;
+			start_t3(l, now);
+			notify(l, AX25_LINK_EV_CONNECTED);
+		}
+		else if (l->state == AX25_LINK_AWAITING_RELEASE)
+			set_disconnected(l, AX25_LINK_EV_DISCONNECTED);
+		break;
+
+	case AX25_CTRL_DM:
+		if (l->state == AX25_LINK_AWAITING_CONNECTION){
+			if (pf) set_disconnected(l, AX25_LINK_EV_REFUSED);
+		}
+		else if (l->state != AX25_LINK_DISCONNECTED)
+			set_disconnected(l, AX25_LINK_EV_DISCONNECTED);
+		break;
+
+	case AX25_CTRL_FRMR:
+		if (was_connected) nr_error(l, now);
+		break;
+
+	default:		// XID, TEST: not supported
+		break;
+	}
+}
+
+static void receive_s(ax25_link *l, uint8_t type, int command, int pf, unsigned int nr, uint64_t now){
+	if (command && pf){		// enquiry
+		send_s(l, AX25_CTRL_RR, 0, 1, l->vr);
+	}
+
+	if (type == AX25_CTRL_SREJ){
+		// N(R) is the missing frame, it doesn't acknowledge anything
+		if (seq_sub(l, nr, l->va) < seq_sub(l, l->vt, l->va)){
+			send_i(l, nr, 0);
+			l->stats.i_resent++;
+			if (!l->t1_expiry) start_t1(l, now);
+		}
+		return;
+	}
+
+	if (!nr_valid(l, nr)){
+		nr_error(l, now);
+		return;
+	}
+
+	l->peer_busy = type == AX25_CTRL_RNR;
+
+	if (l->state == AX25_LINK_TIMER_RECOVERY && !command && pf){
+		// answer to our enquiry: resume, resending what is still unacknowledged
+		l->t1_expiry = 0;
+		l->rc = 0;
+		select_t1(l, now);
+		acknowledge(l, nr);
+		l->vs = nr;
+		l->state = AX25_LINK_CONNECTED;
+		if (l->va == l->vt) start_t3(l, now);
+		return;
+	}
+
+	check_acknowledged(l, nr, now);
+
+	if (type == AX25_CTRL_REJ && l->state == AX25_LINK_CONNECTED){
+		l->vs = nr;		// go back N
+		l->t1_expiry = 0;
+	}
+}
+
+static void receive_i(ax25_link *l, unsigned int ns, int p, unsigned int nr,
+					  const uint8_t *info, size_t info_len, uint64_t now){
+	if (!nr_valid(l, nr)){
+		nr_error(l, now);
+		return;
+	}
+	check_acknowledged(l, nr, now);
+
+	if (info_len > l->cfg.n1){
+		l->stats.i_discarded++;
+	}
+	else if (ns == l->vr){
+		deliver(l, info, info_len);
+		l->srej_asked[ns] = 0;
+		l->vr = seq_inc(l, l->vr);
+		l->reject_sent = 0;
+
+		// frames already received after a selective reject
+		while (l->rx_have[l->vr]){
+			deliver(l, l->rx[l->vr].data(), l->rx[l->vr].size());
+			l->rx_have[l->vr] = 0;
+			l->srej_asked[l->vr] = 0;
+			l->vr = seq_inc(l, l->vr);
+		}
+		l->ack_pending = 1;
+	}
+	else if (seq_sub(l, ns, l->vr) < (unsigned int)l->cfg.window){
+		// ahead of V(R): some frames were lost
+		if (l->cfg.srej){
+			unsigned int s;
+
+			if (!l->rx_have[ns]){
+				l->rx[ns].assign(info, info + info_len);
+				l->rx_have[ns] = 1;
+			}
+			else l->stats.i_discarded++;
+
+			for (s=l->vr; s!=ns; s=seq_inc(l, s))
+				if (!l->rx_have[s] && !l->srej_asked[s]){
+					send_s(l, AX25_CTRL_SREJ, 0, 0, s);
+					l->srej_asked[s] = 1;
+					l->stats.srej_sent++;
+				}
+		}
+		else {
+			l->stats.i_discarded++;
+			if (!l->reject_sent){
+				send_s(l, AX25_CTRL_REJ, 0, 0, l->vr);
+				l->reject_sent = 1;
+				l->stats.rej_sent++;
+			}
+		}
+	}
+	else {
+		// duplicate: tell the peer where we are
+		l->stats.i_discarded++;
+		l->ack_pending = 1;
+	}
+
+	if (p) send_s(l, AX25_CTRL_RR, 0, 1, l->vr);
+}
+
+int ax25_link_receive(ax25_link *l, const uint8_t *frame, size_t len, uint64_t now){
+	const uint8_t *p = frame, *end = frame + len;
+	int command, connected;
+	unsigned int ns = 0, nr, pf;
+	uint8_t c;
+
+	if (len < 2*AX25_ADDR_LEN + 1) return -1;
+
+	// destination must be us and source the peer (SSID without the C and last bits)
+	if (memcmp(p, l->local_addr, AX25_CALLSIGN_LEN) != 0 ||
+		((p[6] ^ l->local_addr[6]) & 0x1E) != 0) return -1;
+	if (memcmp(p + AX25_ADDR_LEN, l->remote_addr, AX25_CALLSIGN_LEN) != 0 ||
+		((p[13] ^ l->remote_addr[6]) & 0x1E) != 0) return -1;
+
+	command = (p[6] & 0x80) != 0 && (p[13] & 0x80) == 0;
+
+	// skip digipeaters
+	for (p+=AX25_ADDR_LEN; !(p[AX25_CALLSIGN_LEN] & 1); p+=AX25_ADDR_LEN)
+		if (p + 2*AX25_ADDR_LEN >= end) return -1;
+	p += AX25_ADDR_LEN;
+
+	c = *p;
+
+	if ((c & 3) == 3){
+		if ((c & ~AX25_CTRL_PF) == AX25_CTRL_UI) return -1;
+		receive_u(l, c, command, now);
+		return 0;
+	}
+
+	connected = l->state == AX25_LINK_CONNECTED || l->state == AX25_LINK_TIMER_RECOVERY;
+
+	if (l->modulo == 8){
+		nr = c >> 5;
+		pf = (c & AX25_CTRL_PF) != 0;
+		ns = (c >> 1) & 7;
+		p++;
+	}
+	else {
+		if (p + 2 > end) return 0;
+		nr = p[1] >> 1;
+		pf = p[1] & 1;
+		ns = c >> 1;
+		p += 2;
+	}
+
+	if (!connected){
+		if (l->state == AX25_LINK_DISCONNECTED && command && pf) send_u(l, AX25_CTRL_DM, 0, 1);
+		return 0;
+	}
+
+	if ((c & 1) == 0){
+		if (p >= end) return 0;		// no PID
+		receive_i(l, ns, pf, nr, p + 1, (size_t)(end - p - 1), now);
+	}
+	else
+		receive_s(l, (uint8_t)(c & 0x0F), command, pf, nr, now);
+
+	return 0;
+}
+
+/* ------------------------------- user commands ------------------------------- */
+
+void ax25_link_connect(ax25_link *l, uint64_t now){
+	if (l->state != AX25_LINK_DISCONNECTED) return;
+	l->t1v = l->cfg.t1_ms;
+	establish(l, now);
+}
+
+void ax25_link_disconnect(ax25_link *l, uint64_t now){
+	if (l->state == AX25_LINK_DISCONNECTED) return;
+
+	l->queue.clear();
+	clear_window(l);
+	send_u(l, AX25_CTRL_DISC, 1, 1);
+	l->state = AX25_LINK_AWAITING_RELEASE;
+	l->t3_expiry = 0;
+	start_t1(l, now);
+}
+
+int ax25_link_write(ax25_link *l, const uint8_t *data, size_t len){
+	size_t n;
+
+	if (l->state == AX25_LINK_DISCONNECTED || l->state == AX25_LINK_AWAITING_RELEASE) return -1;
+
+	for (; len > 0; data+=n, len-=n){
+		n = len < l->cfg.n1 ? len : l->cfg.n1;
+		l->queue.push_back(std::vector<uint8_t>(data, data + n));
+	}
+	return 0;
+}
+
+void ax25_link_poll(ax25_link *l, uint64_t now){
+	if (l->t1_expiry && now >= l->t1_expiry){
+		l->t1_expiry = 0;
+		l->stats.t1_expired++;
+
+		// back off: T1 doubles with every retry
+		l->t1v = l->t1v*2 > T1_MAX_MS ? T1_MAX_MS : l->t1v*2;
+
+		switch (l->state){
+		case AX25_LINK_AWAITING_CONNECTION:
+			if (l->rc == l->cfg.n2){
+				set_disconnected(l, AX25_LINK_EV_FAILED);
+				break;
+			}
+			l->rc++;
+			send_u(l, l->modulo == 128 ? AX25_CTRL_SABME : AX25_CTRL_SABM, 1, 1);
+			start_t1(l, now);
+			break;
+
+		case AX25_LINK_AWAITING_RELEASE:
+			if (l->rc == l->cfg.n2){
+				set_disconnected(l, AX25_LINK_EV_DISCONNECTED);
+				break;
+			}
+			l->rc++;
+			send_u(l, AX25_CTRL_DISC, 1, 1);
+			start_t1(l, now);
+			break;
+
+		case AX25_LINK_CONNECTED:
+			l->rc = 1;
+			l->state = AX25_LINK_TIMER_RECOVERY;
+			transmit_enquiry(l, now);
+			break;
+
+		case AX25_LINK_TIMER_RECOVERY:
+			if (l->rc == l->cfg.n2){
+				send_u(l, AX25_CTRL_DM, 0, 0);
+				set_disconnected(l, AX25_LINK_EV_FAILED);
+				break;
+			}
+			l->rc++;
+			transmit_enquiry(l, now);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	if (l->t3_expiry && now >= l->t3_expiry){
+		l->t3_expiry = 0;
+		if (l->state == AX25_LINK_CONNECTED){
+			l->rc = 1;
+			l->state = AX25_LINK_TIMER_RECOVERY;
+			transmit_enquiry(l, now);
+		}
+	}
+
+	if (l->state == AX25_LINK_CONNECTED){
+		if (l->peer_busy){
+			// poll until the peer is ready again
+			if (!l->t1_expiry && ax25_link_pending(l)) start_t1(l, now);
+		}
+		else {
+			while (seq_sub(l, l->vs, l->va) < (unsigned int)l->cfg.window){
+				if (l->vs != l->vt) l->stats.i_resent++;
+				else if (!l->queue.empty()){
+					l->sent[l->vt].swap(l->queue.front());
+					l->queue.pop_front();
+					l->vt = seq_inc(l, l->vt);
+					l->stats.i_sent++;
+				}
+				else break;
+
+				send_i(l, l->vs, 0);
+				l->vs = seq_inc(l, l->vs);
+				if (!l->t1_expiry) start_t1(l, now);
+				l->t3_expiry = 0;
+			}
+		}
+	}
+
+	if (l->ack_pending && (l->state == AX25_LINK_CONNECTED || l->state == AX25_LINK_TIMER_RECOVERY))
+		send_s(l, AX25_CTRL_RR, 0, 0, l->vr);
+}
+
+uint64_t ax25_link_next_timer(const ax25_link *l){
+	uint64_t t = UINT64_MAX;
+
+	if (l->t1_expiry) t = l->t1_expiry;
+	if (l->t3_expiry && l->t3_expiry < t) t = l->t3_expiry;
+	return t;
+}
@@ -0,0 +1,159 @@
+//============================================================================
+// Name        : ax25_link.h
+// Description : AX.25 v2.2 connected mode (LAPB) data link state machine
+//============================================================================
+
+#ifndef AX25_LINK_H_
+#define AX25_LINK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <deque>
+#include <vector>
+
+#include "ax25_encoder.h"
+
+/*
+* One end of a connected mode link. The link doesn't own a clock or a radio:
+* every call gets the current time in ms, frames to transmit are handed to
+* the send callback and the frames received (FCS already checked) are given
+* to ax25_link_receive().
+*
+* Frames are | Destination | Source | Control (1 or 2 octets) | PID | Info |,
+* without flags and FCS, which are added by the transmitter.
+*
+* Control field (modulo 8, one octet; modulo 128 I and S frames take two,
+* N(S)/N(R) shifted left by one and P/F in bit 0 of the second octet):
+*
+* I: | N(R) | P | N(S) | 0 |    S: | N(R) | P/F | S S | 0 1 |    U: | M M M | P/F | M M | 1 1 |
+*/
+
+#define AX25_CTRL_I			0x00
+#define AX25_CTRL_RR		0x01
+#define AX25_CTRL_RNR		0x05
+#define AX25_CTRL_REJ		0x09
+#define AX25_CTRL_SREJ		0x0D
+#define AX25_CTRL_SABME		0x6F
+#define AX25_CTRL_SABM		0x2F
+#define AX25_CTRL_DISC		0x43
+#define AX25_CTRL_DM		0x0F
+#define AX25_CTRL_UA		0x63
+#define AX25_CTRL_FRMR		0x87
+#define AX25_CTRL_UI		0x03
+#define AX25_CTRL_PF		0x10	// P/F bit of modulo 8 and U frames
+
+#define AX25_LINK_FRAME_MAX	(2*AX25_ADDR_LEN + 2 + 1 + AX25_INFO_MAX)
+
+typedef enum {
+	AX25_LINK_DISCONNECTED = 0,
+	AX25_LINK_AWAITING_CONNECTION,
+	AX25_LINK_AWAITING_RELEASE,
+	AX25_LINK_CONNECTED,
+	AX25_LINK_TIMER_RECOVERY
+} ax25_link_state;
+
+typedef enum {
+	AX25_LINK_EV_CONNECTED = 0,		// link up (our SABM answered or the peer's accepted)
+	AX25_LINK_EV_DISCONNECTED,		// DISC/DM exchanged
+	AX25_LINK_EV_REFUSED,			// the peer answered our SABM with DM
+	AX25_LINK_EV_FAILED,			// no answer after N2 retries
+	AX25_LINK_EV_RESET				// link reset: the unacknowledged frames are sent again
+									// and may reach the peer twice
+} ax25_link_event;
+
+typedef struct {
+	const char *local;				// our callsign
+	uint8_t local_ssid;				// 0..15
+	const char *remote;
+	uint8_t remote_ssid;
+
+	int modulo;						// 8 or 128 (SABME)
+	int window;						// k, outstanding I frames: 1..modulo-1 (modulo/2 with SREJ)
+	size_t n1;						// max Info octets per I frame
+	int n2;							// retries
+	uint32_t t1_ms;					// initial acknowledgement timer
+	uint32_t t3_ms;					// idle link poll timer
+	int srej;						// ask for the missing frames only (selective reject)
+} ax25_link_config;
+
+typedef void (*ax25_link_send_cb)(const uint8_t *frame, size_t len, void *user);
+typedef void (*ax25_link_data_cb)(const uint8_t *info, size_t len, void *user);
+typedef void (*ax25_link_event_cb)(ax25_link_event ev, void *user);
+
+typedef struct {
+	uint64_t i_sent;				// new I frames
+	uint64_t i_resent;
+	uint64_t i_received;			// delivered in sequence
+	uint64_t i_discarded;			// duplicates and out of window
+	uint64_t rej_sent;
+	uint64_t srej_sent;
+	uint64_t t1_expired;
+} ax25_link_stats;
+
+typedef struct {
+	ax25_link_config cfg;
+	ax25_link_send_cb send;
+	ax25_link_data_cb data;
+	ax25_link_event_cb event;
+	void *user;
+
+	uint8_t local_addr[AX25_ADDR_LEN];
+	uint8_t remote_addr[AX25_ADDR_LEN];
+
+	ax25_link_state state;
+	unsigned int modulo;
+	unsigned int vs;				// next N(S) to (re)send
+	unsigned int vt;				// next new N(S); frames va..vt-1 are kept
+	unsigned int va;				// oldest unacknowledged
+	unsigned int vr;				// next expected N(S)
+	int rc;							// retry count
+	int peer_busy;
+	int reject_sent;
+	int ack_pending;
+
+	uint64_t t1_expiry;				// 0: stopped
+	uint64_t t1_start;
+	uint64_t t3_expiry;
+	uint32_t srt;					// smoothed round trip time
+	uint32_t t1v;					// current T1 value
+
+	std::deque<std::vector<uint8_t> > queue;	// data not sent yet, one I frame each
+	std::vector<std::vector<uint8_t> > sent;	// by N(S), until acknowledged
+	std::vector<std::vector<uint8_t> > rx;		// by N(S), received out of sequence (SREJ)
+	std::vector<uint8_t> rx_have;
+	std::vector<uint8_t> srej_asked;
+
+	ax25_link_stats stats;
+} ax25_link;
+
+void ax25_link_default_config(ax25_link_config *cfg);
+
+/* Returns 0 on success or -1 if the configuration is invalid */
+int ax25_link_init(ax25_link *l, const ax25_link_config *cfg, ax25_link_send_cb send,
+				   ax25_link_data_cb data, ax25_link_event_cb event, void *user);
+
+/* Sends SABM (modulo 8) or SABME (modulo 128) */
+void ax25_link_connect(ax25_link *l, uint64_t now);
+void ax25_link_disconnect(ax25_link *l, uint64_t now);
+
+/* Queues data, split in I frames of at most N1 octets. Returns -1 if not connected. */
+int ax25_link_write(ax25_link *l, const uint8_t *data, size_t len);
+
+/*
+* Processes a received frame. Returns 0 if the frame belongs to the link,
+* -1 otherwise (other addresses, UI frames), so the caller can handle it.
+*/
+int ax25_link_receive(ax25_link *l, const uint8_t *frame, size_t len, uint64_t now);
+
+/* Runs the timers and sends what the window allows. Call after every receive and when a timer is due. */
+void ax25_link_poll(ax25_link *l, uint64_t now);
+
+/* Time of the next timer, UINT64_MAX if none is running */
+uint64_t ax25_link_next_timer(const ax25_link *l);
+
+/* Queued or unacknowledged data */
+static inline size_t ax25_link_pending(const ax25_link *l){
+	return l->queue.size() + (l->vt + l->modulo - l->va) % l->modulo;
+}
+
+#endif /* AX25_LINK_H_ */
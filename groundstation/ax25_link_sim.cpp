@@ -0,0 +1,251 @@
+//============================================================================
+// Name        : ax25_link_sim.cpp
+// Description : File transfer over two AX.25 links and a simulated lossy channel
+//============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <deque>
+
+#include "ax25_link.h"
+#include "crc_template.h"
+
+/*
+* The ground station (GS) connects to the satellite (SAT) and downlinks a file
+* of random bytes over I frames. Each direction is a half of a full duplex
+* channel: frames are serialized at the bitrate (flags, FCS and 1/5 of stuffing
+* included), delayed, dropped or hit by bit errors. A frame with bit errors is
+* dropped by the FCS check, as by the HDLC deframer.
+*
+* Exit status is 0 when the file arrives intact.
+*/
+
+typedef struct {
+	uint64_t time;
+	std::vector<uint8_t> frame;		// FCS included
+} in_flight;
+
+typedef struct {
+	double busy_until;				// ms
+	std::deque<in_flight> frames;	// in arrival order
+	uint64_t sent, lost, corrupted;
+} channel;
+
+typedef struct sim sim;
+
+typedef struct {
+	sim *s;
+	int id;							// 0 = GS, 1 = SAT
+	ax25_link link;
+	int connected, disconnected;
+	std::vector<uint8_t> received;
+} endpoint;
+
+struct sim {
+	uint64_t now;
+	double bitrate;
+	uint32_t delay_ms;
+	double loss;
+	double ber;
+	uint64_t rng;
+	channel ch[2];					// ch[i]: frames sent by endpoint i
+	endpoint ep[2];
+};
+
+static double rnd(sim *s){
+	s->rng ^= s->rng << 13;
+	s->rng ^= s->rng >> 7;
+	s->rng ^= s->rng << 17;
+	return (double)(s->rng >> 11)/9007199254740992.0;
+}
+
+static void send_cb(const uint8_t *frame, size_t len, void *user){
+	endpoint *e = (endpoint *)user;
+	sim *s = e->s;
+	channel *ch = &s->ch[e->id];
+	in_flight f;
+	double start, bits;
+	size_t i;
+
+	f.frame.assign(frame, frame + len);
+	f.frame.resize(len + AX25_FCS_LEN);
+	ax25_encode_fcs(&f.frame[len], crc_ccitt::compute(frame, len));
+
+	bits = (double)(len + AX25_FCS_LEN + 2)*8*1.2;
+	start = ch->busy_until > (double)s->now ? ch->busy_until : (double)s->now;
+	ch->busy_until = start + bits*1000/s->bitrate;
+	f.time = (uint64_t)ceil(ch->busy_until) + s->delay_ms;
+	ch->sent++;
+
+	if (rnd(s) < s->loss){
+		ch->lost++;
+		return;
+	}
+	if (s->ber > 0){
+		int hit = 0;
+
+		for (i=0; i<f.frame.size()*8; i++)
+			if (rnd(s) < s->ber){
+				f.frame[i/8] ^= (uint8_t)(1 << (i%8));
+				hit = 1;
+			}
+		ch->corrupted += hit;
+	}
+
+	ch->frames.push_back(f);
+}
+
+static void data_cb(const uint8_t *info, size_t len, void *user){
+	endpoint *e = (endpoint *)user;
+
+	e->received.insert(e->received.end(), info, info + len);
+}
+
+static void event_cb(ax25_link_event ev, void *user){
+	endpoint *e = (endpoint *)user;
+	static const char *names[] = {"connected", "disconnected", "refused", "failed", "reset"};
+
+	printf("%10.3f s  %s: %s\n", e->s->now/1000.0, e->id ? "SAT" : "GS ", names[ev]);
+	if (ev == AX25_LINK_EV_CONNECTED) e->connected = 1;
+	else if (ev != AX25_LINK_EV_RESET) e->disconnected = 1;
+}
+
+static void usage(const char *prog){
+	fprintf(stderr, "Usage: %s [-m 8|128] [-k window] [-n N1] [-x] [-s bytes] [-r bitrate] [-d delay_ms]\n"
+					"       [-l loss] [-b ber] [-t t1_ms] [-S seed]\n", prog);
+	fprintf(stderr, "  -x  go back N (REJ) instead of selective reject\n");
+}
+
+int main(int argc, char **argv){
+	static sim s;
+	ax25_link_config cfg;
+	std::vector<uint8_t> file;
+	size_t size = 64*1024;
+	uint64_t limit;
+	int c, i;
+
+	ax25_link_default_config(&cfg);
+	s.bitrate = 9600;
+	s.delay_ms = 20;
+	s.loss = 0.05;
+	s.ber = 0;
+	s.rng = 88172645463325252ULL;
+
+	while ((c = getopt(argc, argv, "m:k:n:xs:r:d:l:b:t:S:h")) != -1){
+		switch (c){
+		case 'm': cfg.modulo = atoi(optarg); break;
+		case 'k': cfg.window = atoi(optarg); break;
+		case 'n': cfg.n1 = (size_t)atol(optarg); break;
+		case 'x': cfg.srej = 0; break;
+		case 's': size = (size_t)atol(optarg); break;
+		case 'r': s.bitrate = atof(optarg); break;
+		case 'd': s.delay_ms = (uint32_t)atoi(optarg); break;
+		case 'l': s.loss = atof(optarg); break;
+		case 'b': s.ber = atof(optarg); break;
+		case 't': cfg.t1_ms = (uint32_t)atoi(optarg); break;
+		case 'S': s.rng = strtoull(optarg, NULL, 0) | 1; break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+	if (s.bitrate <= 0){
+		usage(argv[0]);
+		return 1;
+	}
+
+	for (i=0; i<2; i++){
+		ax25_link_config c2 = cfg;
+
+		c2.local = i ? "FSAT" : "PY0EFS";
+		c2.remote = i ? "PY0EFS" : "FSAT";
+		s.ep[i].s = &s;
+		s.ep[i].id = i;
+		s.ep[i].connected = s.ep[i].disconnected = 0;
+		if (ax25_link_init(&s.ep[i].link, &c2, send_cb, data_cb, event_cb, &s.ep[i]) != 0){
+			fprintf(stderr, "ERROR, invalid link configuration (window above modulo/2 with SREJ?)\n");
+			return 1;
+		}
+	}
+
+	file.resize(size);
+	for (size_t k=0; k<size; k++) file[k] = (uint8_t)(rnd(&s)*256);
+
+	// the file shouldn't take more than 100x its air time
+	limit = (uint64_t)(size*8*100/s.bitrate*1000) + 600000;
+
+	s.now = 0;
+	ax25_link_connect(&s.ep[0].link, s.now);
+
+	int written = 0, closing = 0;
+
+	while (s.now < limit){
+		uint64_t next = UINT64_MAX;
+
+		for (i=0; i<2; i++){
+			if (!s.ch[i].frames.empty() && s.ch[i].frames.front().time < next) next = s.ch[i].frames.front().time;
+			if (ax25_link_next_timer(&s.ep[i].link) < next) next = ax25_link_next_timer(&s.ep[i].link);
+		}
+		if (next == UINT64_MAX) break;
+		if (next > s.now) s.now = next;
+
+		for (i=0; i<2; i++){
+			channel *ch = &s.ch[i];
+			endpoint *to = &s.ep[1 - i];
+
+			while (!ch->frames.empty() && ch->frames.front().time <= s.now){
+				in_flight f;
+				uint8_t fcs[AX25_FCS_LEN];
+				size_t len;
+
+				f.frame.swap(ch->frames.front().frame);
+				ch->frames.pop_front();
+				len = f.frame.size() - AX25_FCS_LEN;
+
+				ax25_encode_fcs(fcs, crc_ccitt::compute(f.frame.data(), len));
+				if (memcmp(fcs, &f.frame[len], AX25_FCS_LEN) == 0)
+					ax25_link_receive(&to->link, f.frame.data(), len, s.now);
+				ax25_link_poll(&to->link, s.now);
+			}
+		}
+
+		// the satellite sends the file once the link is up, then the ground station hangs up
+		if (!written && s.ep[1].connected){
+			ax25_link_write(&s.ep[1].link, file.data(), file.size());
+			written = 1;
+		}
+		if (!closing && s.ep[0].received.size() >= file.size() && ax25_link_pending(&s.ep[1].link) == 0){
+			ax25_link_disconnect(&s.ep[0].link, s.now);
+			closing = 1;
+		}
+
+		for (i=0; i<2; i++) ax25_link_poll(&s.ep[i].link, s.now);
+
+		if (s.ep[0].disconnected && s.ep[1].disconnected) break;
+		if (s.ep[0].disconnected && !closing) break;
+	}
+
+	const ax25_link_stats *st = &s.ep[1].link.stats;
+	const ax25_link_stats *gr = &s.ep[0].link.stats;
+	int ok = s.ep[0].received == file;
+
+	printf("\nmodulo %d, window %d, N1 %u, %s, %.0f bit/s, delay %u ms, loss %.3f, BER %g\n",
+		   cfg.modulo, cfg.window, (unsigned)cfg.n1, cfg.srej ? "SREJ" : "REJ", s.bitrate,
+		   (unsigned)s.delay_ms, s.loss, s.ber);
+	printf("SAT -> GS: %llu frames, %llu lost, %llu corrupted\n", (unsigned long long)s.ch[1].sent,
+		   (unsigned long long)s.ch[1].lost, (unsigned long long)s.ch[1].corrupted);
+	printf("GS -> SAT: %llu frames, %llu lost, %llu corrupted\n", (unsigned long long)s.ch[0].sent,
+		   (unsigned long long)s.ch[0].lost, (unsigned long long)s.ch[0].corrupted);
+	printf("I frames: %llu new, %llu resent, %llu T1 expiries; GS: %llu REJ, %llu SREJ, %llu discarded\n",
+		   (unsigned long long)st->i_sent, (unsigned long long)st->i_resent, (unsigned long long)st->t1_expired,
+		   (unsigned long long)gr->rej_sent, (unsigned long long)gr->srej_sent, (unsigned long long)gr->i_discarded);
+	printf("%u of %u bytes in %.3f s: %.0f bit/s of data (%.0f%% of the channel)\n",
+		   (unsigned)s.ep[0].received.size(), (unsigned)file.size(), s.now/1000.0,
+		   file.size()*8/(s.now/1000.0), file.size()*8/(s.now/1000.0)/s.bitrate*100);
+	printf("%s\n", ok ? "OK" : "MISMATCH");
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+//============================================================================
+// Name        : ax25_rt.cpp
+// Description : Real-time decoding of the receiver bit stream
+//============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rt_pipeline.h"
+#include "tlm_archive.h"
+
+typedef struct {
+	FILE *out;
+	std::vector<tlm_archive_writer> archives;	// one per schema, then raw
+} store_ctx;
+
+static void usage(const char *prog){
+	fprintf(stderr, "Usage: %s [-r bitrate] [-t] [-n] [-a] [-R] [-v] [-d seconds] [-o out.csv] [-A dir] [input]\n", prog);
+	fprintf(stderr, "  -r  bitrate in bit/s (default: 1200)\n");
+	fprintf(stderr, "  -t  input is '0'/'1' characters (default: packed bits, LSB first)\n");
+	fprintf(stderr, "  -n  input is not bit stuffed\n");
+	fprintf(stderr, "  -a  also output frames with a wrong FCS\n");
+	fprintf(stderr, "  -R  read a file at the bitrate (replay of a capture)\n");
+	fprintf(stderr, "  -v  pipeline counters on stderr every second\n");
+	fprintf(stderr, "  -d  drop copies of a frame received within this many seconds\n");
+	fprintf(stderr, "  -o  output file (default: stdout)\n");
+	fprintf(stderr, "  -A  append the frames to the archives in dir (<schema>.tlm, raw.tlm)\n");
+	fprintf(stderr, "  input: file or pipe of the demodulated bits (default: stdin)\n");
+}
+
+static void print_time(FILE *out, double t){
+	time_t sec = (time_t)t;
+	struct tm tm;
+	char buf[32];
+
+	gmtime_r(&sec, &tm);
+	strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+	fprintf(out, "%s.%03dZ", buf, (int)((t - (double)sec)*1000));
+}
+
+static void print_header(FILE *out){
+	const tlm_schema *const *s;
+	size_t i;
+
+	fprintf(out, "time,bit,source,destination,control,pid,info_len,fcs_ok");
+	for (s=tlm_schemas; *s; s++)
+		for (i=0; i<(*s)->nfields; i++) fprintf(out, ",%s.%s", (*s)->name, (*s)->fields[i].name);
+	fputc('\n', out);
+}
+
+/* Store stage: CSV line and archive row, on the store thread */
+static void store_frame(const decoded_frame *f, void *user){
+	store_ctx *ctx = (store_ctx *)user;
+	const tlm_schema *const *s;
+	size_t i, k;
+
+	print_time(ctx->out, f->time);
+	fprintf(ctx->out, ",%llu,%s,%s,0x%02X,0x%02X,%u,%d", (unsigned long long)f->bit_pos,
+			f->source, f->destination, f->control, f->pid, f->info_len, f->fcs_ok);
+	for (s=tlm_schemas; *s; s++)
+		for (i=0; i<(*s)->nfields; i++){
+			if (*s == f->schema) fprintf(ctx->out, ",%.10g", f->values[i]);
+			else fputc(',', ctx->out);
+		}
+	fputc('\n', ctx->out);
+	fflush(ctx->out);
+
+	if (!ctx->archives.empty()){
+		for (k=0, s=tlm_schemas; *s && *s != f->schema; s++, k++);
+		if (tlm_archive_append(&ctx->archives[k], f->time, f->values, f->frame, f->frame_len) != 0)
+			fprintf(stderr, "ERROR, can't append to the %s archive\n", *s ? (*s)->name : "raw");
+	}
+}
+
+static int open_archives(const char *dir, store_ctx *ctx){
+	std::string path;
+	size_t k, n;
+
+	for (n=0; tlm_schemas[n]; n++);
+	ctx->archives.resize(n + 1);
+
+	for (k=0; k<=n; k++){
+		path = std::string(dir) + "/" + (k < n ? tlm_schemas[k]->name : "raw") + ".tlm";
+		if (tlm_archive_create(&ctx->archives[k], path.c_str(), k < n ? tlm_schemas[k] : NULL, TLM_BLOCK_ROWS) != 0){
+			fprintf(stderr, "ERROR, can't open archive %s\n", path.c_str());
+			while (k-- > 0) tlm_archive_close(&ctx->archives[k]);
+			ctx->archives.clear();
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static void print_stats(const rt_stats &st){
+	fprintf(stderr, "in %llu B (dropped %llu, max queued %llu) | deframe %llu frames (full %llu) | "
+			"crc %llu ok, %llu errors (full %llu) | decode %llu, %llu duplicates (backlog %llu, max %llu) | stored %llu\n",
+			(unsigned long long)st.bytes_in, (unsigned long long)st.bytes_dropped,
+			(unsigned long long)st.deframe.high_water, (unsigned long long)st.deframe.out,
+			(unsigned long long)st.deframe.full, (unsigned long long)st.crc.out,
+			(unsigned long long)st.fcs_errors, (unsigned long long)st.crc.full,
+			(unsigned long long)st.decode.in, (unsigned long long)st.duplicates, (unsigned long long)st.backlog,
+			(unsigned long long)st.backlog_max, (unsigned long long)st.store.out);
+}
+
+int main(int argc, char **argv){
+	rt_options opt;
+	rt_pipeline *p;
+	rt_stats st;
+	store_ctx ctx;
+	const char *archive_dir = NULL;
+	uint8_t buf[4096];
+	int c, fd = 0, replay = 0, verbose = 0, ret = 0, from_file;
+	uint64_t total = 0;
+	struct stat st_in;
+	ssize_t n;
+	size_t k, chunk;
+
+	rt_default_options(&opt);
+	ctx.out = stdout;
+
+	while ((c = getopt(argc, argv, "r:tnaRvd:o:A:h")) != -1){
+		switch (c){
+		case 'r': opt.bitrate = atof(optarg); break;
+		case 't': opt.text = 1; break;
+		case 'n': opt.destuff = 0; break;
+		case 'a': opt.keep_bad = 1; break;
+		case 'R': replay = 1; break;
+		case 'v': verbose = 1; break;
+		case 'd': opt.dedup_window = atof(optarg); break;
+		case 'A': archive_dir = optarg; break;
+		case 'o':
+			if ((ctx.out = fopen(optarg, "w")) == NULL){
+				fprintf(stderr, "ERROR, can't open %s\n", optarg);
+				return 1;
+			}
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (optind < argc && (fd = open(argv[optind], O_RDONLY)) < 0){
+		fprintf(stderr, "ERROR, can't open %s\n", argv[optind]);
+		return 1;
+	}
+	// a regular file is read faster than real time: wait for room instead of dropping
+	from_file = fstat(fd, &st_in) == 0 && S_ISREG(st_in.st_mode);
+
+	if (opt.bitrate <= 0){
+		usage(argv[0]);
+		return 1;
+	}
+	if (archive_dir && open_archives(archive_dir, &ctx) != 0) return 1;
+
+	opt.store = store_frame;
+	opt.user = &ctx;
+	if ((p = rt_pipeline_start(&opt)) == NULL){
+		fprintf(stderr, "ERROR, can't start the pipeline\n");
+		return 1;
+	}
+
+	print_header(ctx.out);
+
+	auto t0 = std::chrono::steady_clock::now(), last = t0;
+
+	// replay: 100 ms of bits per read
+	chunk = replay ? std::min(sizeof(buf), (size_t)(opt.bitrate/(opt.text ? 1 : 8)/10) + 1) : sizeof(buf);
+
+	while ((n = read(fd, buf, chunk)) > 0){
+		if (from_file && !replay) rt_pipeline_push_wait(p, buf, (size_t)n);
+		else rt_pipeline_push(p, buf, (size_t)n);
+		total += (uint64_t)n;
+
+		// replay: hold the reads to the bitrate, as a receiver would deliver them
+		if (replay)
+			std::this_thread::sleep_until(t0 + std::chrono::duration<double>(total*(opt.text ? 1 : 8)/opt.bitrate));
+
+		if (verbose && std::chrono::steady_clock::now() - last > std::chrono::seconds(1)){
+			last = std::chrono::steady_clock::now();
+			rt_pipeline_stats(p, &st);
+			print_stats(st);
+		}
+	}
+	if (n < 0){
+		perror("read");
+		ret = 1;
+	}
+
+	rt_pipeline_stop(p, &st);
+	print_stats(st);
+
+	for (k=0; k<ctx.archives.size(); k++)
+		if (tlm_archive_close(&ctx.archives[k]) != 0) ret = 1;
+	if (ctx.out != stdout) fclose(ctx.out);
+	if (fd != 0) close(fd);
+
+	return st.bytes_dropped ? 2 : ret;
+}
@@ -0,0 +1,201 @@
+//============================================================================
+// Name        : ax25_uplink.cpp
+// Description : Telecommands of a pass packed into AX.25 UI frames
+//============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+#include "uplink_cmd.h"
+#include "hdlc.h"
+
+/*
+* Command file, one command per line ('#' starts a comment):
+*
+*   time  to  data  [expires]
+*
+*   2026-10-17T12:03:00  0x10  01A0FF
+*   2026-10-17T12:04:30  0x11  02      2026-10-17T12:05:00
+*
+* time and expires are seconds since the epoch or YYYY-MM-DDTHH:MM:SS (UTC),
+* to is the TO byte of the dataframe and data its DATA in hex (1 to 50 bytes).
+*/
+
+static void usage(const char *prog){
+	fprintf(stderr, "Usage: %s -a aos -l los [-D callsign] [-S callsign] [-F from] [-m octets] [-o out.bin] [-v] commands.txt\n", prog);
+	fprintf(stderr, "  -a  -l  pass window [aos, los): seconds since the epoch or YYYY-MM-DDTHH:MM:SS (UTC)\n");
+	fprintf(stderr, "  -D  destination callsign (default: FSAT)\n");
+	fprintf(stderr, "  -S  source callsign (default: PY0EFS)\n");
+	fprintf(stderr, "  -F  FROM byte of the dataframes (default: 0)\n");
+	fprintf(stderr, "  -m  dataframe octets per frame, %d..%d (default: %d)\n", DF_FRAME_MAX, AX25_INFO_MAX, AX25_INFO_MAX);
+	fprintf(stderr, "  -o  also write the frames bit stuffed, packed LSB first (ax25_batch input)\n");
+	fprintf(stderr, "  -v  counts and encoding time on stderr\n");
+}
+
+static int parse_time(const char *s, double *t){
+	struct tm tm;
+	char *end;
+
+	*t = strtod(s, &end);
+	if (end != s && *end == '\0') return 0;
+
+	memset(&tm, 0, sizeof(tm));
+	end = strptime(s, "%Y-%m-%dT%H:%M:%S", &tm);
+	if (!end || (*end && strcmp(end, "Z") != 0)) return -1;
+	*t = (double)timegm(&tm);
+	return 0;
+}
+
+static void print_time(FILE *out, double t){
+	time_t sec = (time_t)t;
+	struct tm tm;
+	char buf[32];
+
+	gmtime_r(&sec, &tm);
+	strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+	fprintf(out, "%s.%03dZ", buf, (int)((t - (double)sec)*1000));
+}
+
+static int parse_hex(const char *s, uint8_t *out, size_t max){
+	size_t n = strlen(s), i;
+	unsigned int b;
+
+	if (n == 0 || n % 2 || n/2 > max) return -1;
+	for (i=0; i<n/2; i++){
+		if (sscanf(s + 2*i, "%2x", &b) != 1) return -1;
+		out[i] = (uint8_t)b;
+	}
+	return (int)(n/2);
+}
+
+static int load_commands(uplink_queue *q, const char *path){
+	FILE *fp = fopen(path, "r");
+	char line[512], t_str[64], to_str[16], hex[2*DF_DATA_MAX + 8], exp_str[64];
+	uint8_t data[DF_DATA_MAX];
+	double t, expires;
+	int lineno = 0, n, len;
+	char *p;
+
+	if (!fp){
+		fprintf(stderr, "ERROR, can't open %s\n", path);
+		return -1;
+	}
+
+	while (fgets(line, sizeof(line), fp)){
+		lineno++;
+		if ((p = strchr(line, '#'))) *p = '\0';
+
+		n = sscanf(line, "%63s %15s %107s %63s", t_str, to_str, hex, exp_str);
+		if (n <= 0) continue;
+
+		expires = INFINITY;
+		if (n < 3 || parse_time(t_str, &t) != 0 || (n == 4 && parse_time(exp_str, &expires) != 0) ||
+			(len = parse_hex(hex, data, sizeof(data))) < 0 ||
+			uplink_add(q, t, expires, (uint8_t)strtoul(to_str, NULL, 0), data, (size_t)len) < 0){
+			fprintf(stderr, "ERROR, %s:%d: bad command\n", path, lineno);
+			fclose(fp);
+			return -1;
+		}
+	}
+
+	fclose(fp);
+	return 0;
+}
+
+/* Appends the frame bit stuffed between flags to the packed stream */
+static void pack_frame(const uplink_frame *f, std::vector<uint8_t> &out, uint64_t *bit){
+	uint8_t bits[2*AX25_FRAME_MAX*8];
+	size_t n, k;
+
+	n = hdlc_stuff_frame(f->frame + 1, f->len - 2, bits, sizeof(bits));
+	out.resize((*bit + n + 7)/8, 0);
+	for (k=0; k<n; k++, (*bit)++) out[*bit >> 3] |= (uint8_t)(bits[k] << (*bit & 7));
+}
+
+int main(int argc, char **argv){
+	const char *dest = "FSAT", *source = "PY0EFS", *out_path = NULL;
+	const char *aos_str = NULL, *los_str = NULL;
+	std::vector<uplink_frame> frames;
+	std::vector<uint8_t> packed;
+	uplink_queue q;
+	uplink_stats st;
+	double aos, los;
+	unsigned long from = 0;
+	size_t info_max = AX25_INFO_MAX, k, i;
+	uint64_t bit = 0;
+	int c, verbose = 0;
+
+	while ((c = getopt(argc, argv, "a:l:D:S:F:m:o:vh")) != -1){
+		switch (c){
+		case 'a': aos_str = optarg; break;
+		case 'l': los_str = optarg; break;
+		case 'D': dest = optarg; break;
+		case 'S': source = optarg; break;
+		case 'F': from = strtoul(optarg, NULL, 0); break;
+		case 'm': info_max = (size_t)atol(optarg); break;
+		case 'o': out_path = optarg; break;
+		case 'v': verbose = 1; break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (optind != argc - 1 || !aos_str || !los_str || from > 0xFF ||
+		info_max < DF_FRAME_MAX || info_max > AX25_INFO_MAX){
+		usage(argv[0]);
+		return 1;
+	}
+	if (parse_time(aos_str, &aos) != 0 || parse_time(los_str, &los) != 0 || los <= aos){
+		fprintf(stderr, "ERROR, bad pass window\n");
+		return 1;
+	}
+
+	uplink_init(&q, dest, source, (uint8_t)from);
+	q.info_max = info_max;
+	if (load_commands(&q, argv[optind]) != 0) return 1;
+
+	auto t0 = std::chrono::steady_clock::now();
+	uplink_schedule(&q, aos, los, frames, &st);
+	double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+	printf("time,commands,ids,len,frame\n");
+	for (k=0; k<frames.size(); k++){
+		const uplink_frame *f = &frames[k];
+
+		print_time(stdout, f->time);
+		printf(",%u,", (unsigned)f->ncmds);
+		for (i=0; i<f->ncmds; i++) printf("%s%u", i ? " " : "", (unsigned)f->ids[i]);
+		printf(",%u,", (unsigned)f->len);
+		for (i=0; i<f->len; i++) printf("%02X", f->frame[i]);
+		putchar('\n');
+
+		if (out_path) pack_frame(f, packed, &bit);
+	}
+
+	if (out_path){
+		FILE *fp = fopen(out_path, "wb");
+
+		if (!fp || fwrite(packed.data(), 1, packed.size(), fp) != packed.size()){
+			fprintf(stderr, "ERROR, can't write %s\n", out_path);
+			if (fp) fclose(fp);
+			return 1;
+		}
+		fclose(fp);
+	}
+
+	if (verbose)
+		fprintf(stderr, "%llu commands in %llu frames (%.1f per frame), %llu expired, %u left for later passes, "
+				"%.2f us per frame\n",
+				(unsigned long long)st.commands, (unsigned long long)st.frames,
+				st.frames ? (double)st.commands/st.frames : 0.0, (unsigned long long)st.expired,
+				(unsigned)uplink_pending(&q), st.frames ? s*1e6/st.frames : 0.0);
+
+	return 0;
+}
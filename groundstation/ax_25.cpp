@@ -18,6 +18,15 @@
 #include <math.h>
 //#include "crctester.c"
 
+#include "crc.h"
+#include "ax25_bits.h"
+#include "ax25_encoder.h"
+#include "hdlc.h"
+#include "capture_reader.h"
+#include "tlm_schema.h"
+#include "frame_arena.h"
+#include "frame_view.h"
+
 using namespace std;
 
 //#define FLAG 01111110
@@ -42,205 +51,11 @@ const unsigned char str[] = {"TEST"};
 */
 
 
-// internal global values:
-
-unsigned int crcmask;
-unsigned int crchighbit;
-unsigned int crcinit_direct;
-unsigned int crcinit_nondirect;
-unsigned int crctab[256];
-
-int bit, crc;
-
-
-/* ----------------------- CRC parameters (default values are for CRC-CCITT): ----------------------- */
-
-const int order = 16;
-const unsigned int polynom = 0x1021;
-const int direct = 1;
-const unsigned int crcinit = 0xffff;
-const unsigned int crcxor = 0x0000;
-const int refin = 0;
-const int refout = 0;
-
-/* ---------------------------------------------------------------------------------------------- */
-
 int ready = 1;
 
 
 /* ----------------------------- subroutines ---------------------------------- */
 
-void flipbits (int *a, int nelems){
-	int temp, i;
-
-	for (i=0; i<nelems/2; i++){
-		temp = a[nelems-1-i];
-		a[nelems-1-i] = a[i];
-		a[i] = temp;
-	}
-
-	/*
-	for(i=0; i<nelems; i++){
-		cout << a[i];
-	}
-	cout<<endl;
-	*/
-}
-
-unsigned int reflect (unsigned int crc, int bitnum) {
-
-	// reflects the lower 'bitnum' bits of 'crc'
-
-	unsigned int i, j=1, crcout=0;
-
-	for (i=(unsigned int)1<<(bitnum-1); i; i>>=1) {
-		if (crc & i) crcout|=j;
-		j<<= 1;
-	}
-	return (crcout);
-}
-
-void generate_crc_table() {
-
-	// make CRC lookup table used by table algorithms
-
-	int i, j;
-	unsigned int bit, crc;
-
-	for (i=0; i<256; i++) {
-
-		crc=(unsigned int)i;
-		if (refin) crc=reflect(crc, 8);
-		crc<<= order-8;
-
-		for (j=0; j<8; j++) {
-
-			bit = crc & crchighbit;
-			crc<<= 1;
-			if (bit) crc^= polynom;
-		}
-
-		if (refin) crc = reflect(crc, order);
-		crc&= crcmask;
-		crctab[i]= crc;
-	}
-}
-
-unsigned int crctablefast (unsigned char* p, unsigned int len) {
-
-	// fast lookup table algorithm without augmented zero bytes, e.g. used in pkzip.
-	// only usable with polynom orders of 8, 16, 24 or 32.
-
-	unsigned int crc = crcinit_direct;
-
-	if (refin) crc = reflect(crc, order);
-
-	if (!refin) while (len--) crc = (crc << 8) ^ crctab[ ((crc >> (order-8)) & 0xff) ^ *p++];
-	else while (len--) crc = (crc >> 8) ^ crctab[ (crc & 0xff) ^ *p++];
-
-	if (refout^refin) crc = reflect(crc, order);
-	crc^= crcxor;
-	crc&= crcmask;
-
-	return(crc);
-}
-
-int crcParameters(){
-
-	int i;
-	// at first, compute constant bit masks for whole CRC and CRC high bit
-
-			crcmask = ((((unsigned int)1<<(order-1))-1)<<1)|1;
-			crchighbit = (unsigned int)1<<(order-1);
-
-
-			// check parameters
-
-			if (order < 1 || order > 32) {
-				printf("ERROR, invalid order, it must be between 1..32.\n");
-				return(0);
-			}
-
-			if (polynom != (polynom & crcmask)) {
-				printf("ERROR, invalid polynom.\n");
-				return(0);
-			}
-
-			if (crcinit != (crcinit & crcmask)) {
-				printf("ERROR, invalid crcinit.\n");
-				return(0);
-			}
-
-			if (crcxor != (crcxor & crcmask)) {
-				printf("ERROR, invalid crcxor.\n");
-				return(0);
-			}
-
-
-		// generate lookup table
-
-		generate_crc_table();
-
-		if (!direct) {
-
-				crcinit_nondirect = crcinit;
-				crc = crcinit;
-				for (i=0; i<order; i++) {
-
-					bit = crc & crchighbit;
-					crc<<= 1;
-					if (bit) crc^= polynom;
-				}
-				crc&= crcmask;
-				crcinit_direct = crc;
-			}
-
-			else {
-
-				crcinit_direct = crcinit;
-				crc = crcinit;
-				for (i=0; i<order; i++) {
-
-					bit = crc & 1;
-					if (bit) crc^= polynom;
-					crc >>= 1;
-					if (bit) crc|= crchighbit;
-				}
-				crcinit_nondirect = crc;
-			}
-
-		return(0);
-}
-
-int *decimal2bin(int decimalNumber){
-
-	static int c, k, binary[16];
-	//int i;
-	for (c = 15; c >= 0; c--){
-		k = decimalNumber >> c;
-
-	    if (k & 1){
-	    	/*printf("1"); */
-	    	binary[c] = 1;
-	    }
-	    else{
-	    	/*printf("0"); */
-	    	binary[c] = 0;
-	    }
-	}
-	//cout<<endl;
-
-	flipbits(binary, 16);
-
-	//cout<<"binary: ";
-	//  for(i=0; i<16; i++) cout<<binary[i];
-	//cout<<endl;
-
-	return binary;
-
-	//return binaryNumber;
-}
-
 void controlField(int *a, int nelems);
 void Iframes (int *a, int nelems);
 void Sframes (int *a, int nelems);
@@ -248,147 +63,6 @@ void Uframes (int *a, int nelems);
 void findFlag (int *a, int nelems);
 void findAddress(int *a, int nelems);
 
-void initInfo(int *a){
-	int i;
-
-	for(i=0; i<(256*8); i++) a[i] = 0;
-
-	//for(i=0; i<256; i++) cout << a[i];
-	//cout << endl;
-}
-
-void initAddress(int *l, int tam){
-	int AddMin = 48;
-	int i, tam_temp = AddMin - tam;
-	int temp[tam_temp];
-
-
-	for(i=tam; i<AddMin; i++){
-		if ( (i-1)%8 == 0 ) temp[i-tam] = 1;
-		else temp[i-tam] = 0;
-	}
-
-	flipbits(temp, tam_temp);
-
-	for(i=tam; i<AddMin; i++) l[i] = temp[i-tam];
-
-
-	/*
-	cout<<"Valor de l:  ";
-	for (i = 0; i<AddMin; i++)
-		cout << l[i];
-	cout<<endl;
-	*/
-}
-
-/* Transforma caracteres em bits invertidos */
-void fullAddressDest(int *l, char *c, int tam_c, int tam_c_bits, int *SSID_dest){
-
-	int i, k=0;
-	char temp; // lembrar do caracter NULL em c[7]
-
-	/* ASCII em vetor de bits :DDDD */
-		//printf("Valor de cd: ");
-		for(i=0; i<tam_c; i++){
-
-			l[0] = 0; //printf("0");
-			k++;
-			temp = c[i];
-			while (c[i]) {
-				if (c[i] & 1) {l[k] = 1; //printf("1");
-				}
-				else {l[k] = 0; //printf("0");
-				}
-				c[i] >>= 1;
-				k++;
-			}
-			/* Digitos contem 6 bits.
-			 * Se for, adiciona um bit para deixa-lo com formato padrao de 7 bits
-			 */
-			if (isdigit(temp)) {l[k] = 0; k++; //printf("0");
-			}
-		}
-		//printf("\n");
-
-		/*
-		cout<<"Valor de cd: ";
-			for (i = 0; i<tam_c_bits; i++) cout<<l[i];
-		cout<<endl;
-		*/
-
-		initAddress(l,tam_c_bits);
-
-		// preenche o SSID
-		for (i = 48; i<56; i++)	l[i] = SSID_dest[i-48];
-}
-
-/* Transforma caracteres em bits invertidos */
-void fullAddressSource(int *m, char *c, int tam_c, int tam_c_bits, int *SSID_source){
-
-	int i, k=0;
-	char temp; // lembrar do caracter NULL em c[7]
-
-	/* ASCII em vetor de bits :DDDD */
-		//printf("Valor de cs: ");
-		for(i=0; i<tam_c; i++){
-
-			m[0] = 0; //printf("0");
-			k++;
-			temp = c[i];
-			while (c[i]) {
-				if (c[i] & 1) {m[k] = 1; //printf("1");
-				}
-				else { m[k] = 0; //printf("0");
-				}
-			c[i] >>= 1;
-			k++;
-			}
-			/* Digitos contem 6 bits.
-			 * Se for, adiciona um bit para deixa-lo com formato padrao de 7 bits
-			 */
-			if (isdigit(temp)) {m[k] = 0; k++; //printf("0");
-			}
-		}
-		//printf("\n");
-
-		initAddress(m,tam_c_bits);
-
-		// preenche o SSID
-		for (i = 48; i<56; i++)	m[i] = SSID_source[i-48];
-}
-
-void fullInfo(int *infoFIELD, unsigned char *inform, int tam_c, int tam_c_bits){
-
-	int i, k=0;
-	char temp;
-
-	/* Inicializa o campo Info com zeros */
-		initInfo(infoFIELD);
-
-	/* ASCII em vetor de bits :DDDD */
-		//printf("Valor de i: ");
-		for(i=0; i<tam_c; i++){
-
-			//infoFIELD[0] = 0; printf("0");
-			//k++;
-			temp = inform[i];
-			while (inform[i]) {
-				if (inform[i] & 1) {
-					infoFIELD[k] = 1; //printf("1");
-				}
-				else {
-					infoFIELD[k] = 0; //printf("0");
-				}
-				inform[i] >>= 1;
-				k++;
-			}
-			k++; //printf("0");
-			if (isdigit(temp)) {
-				infoFIELD[k] = 0; k++; //printf("0");
-			}
-		}
-		//printf("\n");
-}
 
 void printDest(int *fr){
 	int i, j, cont, temp = 0;
@@ -424,9 +98,10 @@ void printSource(int *fr){
 	cout<< "Source: " <<sourceChar <<endl;
 }
 
-unsigned char *printInfo(int *fr){
+/* O texto fica na arena: valido ate o proximo frame_arena_reset() */
+unsigned char *printInfo(frame_arena *arena, int *fr){
 	int i, j, cont, temp = 0;
-	unsigned char infoChar[256] = "\0";
+	unsigned char *infoChar = frame_arena_new<unsigned char>(arena, 256 + 1);
 
 	cont = 0;
 		for(j = 0; j<256; j++){ // verificar jaja
@@ -444,462 +119,9 @@ unsigned char *printInfo(int *fr){
 		return infoChar;
 }
 
-void egua(int *fr, int indice){
-		int cont=0, temp = 0;
-		int j,i;
-		float egua = 0;
-
-		indice = 0;
-
-
-		for(j = 0; j<2; j++){ // dois octetos
-			for(i=indice+cont; i<indice+8+cont; i++){ // 136 eh o indice que comeca a INFO
-				temp = temp + fr[i]*pow(2,i-cont-indice); // converte de binario para inteiro
-			}
-			egua = temp;
-			//cont = i-indice;
-			temp = 0;
-		}
-
-		// vou chamar uma funcao para 3 pares de octetos do ADC0 ADC1 ADC2
-
-//		ADC_1_2_3_I (fr, indice);
-
-
-
-						//egua = egua*cte;
-
-
-}
-
-void ADC_4_5_6_I(int *fr, int ind){
-
-	int cont=0, temp = 0;
-	int i,j,k;
-	double I_ADC = 0, V_ADC = 0;
-	int ind2 = ind;
-
-
-	for (k=0; k<3; k++){ // tres pares de octetos
-		ind = ind + 8;
-		for(j = 0; j<2; j++){ // dois octetos para cada ADC
-			for(i=ind; i<ind+8; i++, cont++){ // 136 eh o indice que comeca a INFO
-				temp = temp + fr[i]*pow(2,cont); // converte de binario para inteiro
-			}
-			//ind = ind - 16;
-			V_ADC = V_ADC+ temp;
-			//cont = i-ind;
-			temp = 0;
-			ind = 2*k*8 + ind2;
-		}
-		cont = 0;
-		ind = 16*pow(2,k);
-
-		I_ADC = V_ADC*6.1035/(50*25*16.5);
-		cout<< "I_ADC_" <<k<<": "<<I_ADC<<endl;
-
-		V_ADC = 0;
-	}
-}
-
-
-void ADC_1_2_3_V(int *fr, int ind){
-
-	int cont=0, temp = 0;
-	int i,j,k;
-	double V_panel = 0, V_ADC = 0;
-	int ind2 = ind;
-	//indice = 0;
-
-
-	for (k=0; k<3; k++){ // tres pares de octetos
-		ind = ind + 8;
-		for(j = 0; j<2; j++){ // dois octetos para cada ADC
-			for(i=ind; i<ind+8; i++, cont++){ // 136 eh o indice que comeca a INFO
-				temp = temp + fr[i]*pow(2,cont); // converte de binario para inteiro
-			}
-			//ind = ind - 16;
-			V_ADC = V_ADC+ temp;
-			//cont = i-ind;
-			temp = 0;
-			ind = 2*k*8 + ind2;
-		}
-		cont = 0;
-		ind = 16*pow(2,k);
-
-		V_panel = V_ADC*6.1035*193.1/pow(10,6);
-		cout<< "V_panel_" <<k<<": "<<V_panel<<endl;
-
-		V_ADC = 0;
-	}
-}
-
-/****** ADC Voltage Total Data *******/
-void ADC_total_V(int *fr, int ind){
-	int cont=0, temp=0;
-	int i,j;
-	double V_ADC_total = 0, V_ADC = 0;
-	int ind2 = ind;
-
-
-	ind = ind + 8;
-	for(j = 0; j<2; j++){ // dois octetos para cada ADC
-		for(i=ind; i<ind+8; i++, cont++){ // 136 eh o indice que comeca a INFO
-			temp = temp + fr[i]*pow(2,cont); // converte de binario para inteiro
-		}
-
-		V_ADC = V_ADC+temp;
-		temp = 0;
-		ind = ind2;
-	}
-
-	V_ADC_total = V_ADC*6.1035*4/pow(10,4);
-	cout<< "V_ADC_total: "<<V_ADC_total<<endl;
-}
-
-/****** MSP430 Temperature Sensor ******/
-void MSP_TS (int *fr, int ind){
-	int cont=0, temp=0;
-	int i,j;
-	double TemperSens = 0, V_MSP = 0;
-	int ind2 = ind;
-
-
-	ind = ind + 8;
-	for(j = 0; j<2; j++){ // dois octetos para cada ADC
-		for(i=ind; i<ind+8; i++, cont++){ // 136 eh o indice que comeca a INFO
-			temp = temp + fr[i]*pow(2,cont); // converte de binario para inteiro
-		}
-
-		V_MSP = V_MSP+temp;
-		temp = 0;
-		ind = ind2;
-	}
-
-	TemperSens = (V_MSP*6.1035*pow(10,-4) - 0.986)/0.00355;
-	cout<< "Temperature Sensor: "<<TemperSens<<" Celsius"<<endl;
-}
-
-
-/******** Average Current **********/
-void AVC (int *fr, int ind){
-	int cont=0, flag = 0;;
-	int i;
-	double AVC_I = 0, V_AVC = 0;
-	int V_AVC_int[16],V_AVC_MSB[8],V_AVC_LSB[8];
-
-	for(i=ind; i<ind+16; i++) V_AVC_int[i-ind] = fr[i];
-
-	for(i=0; i<8; i++)	V_AVC_MSB[i] = V_AVC_int[i];
-
-	for(i=8; i<16; i++)	V_AVC_LSB[i-8] = V_AVC_int[i];
-
-	flipbits(V_AVC_MSB, 8);
-	flipbits(V_AVC_LSB, 8);
-
-	// Colocado na forma original
-	for(i=0; i<8; i++) 	V_AVC_int[i] = V_AVC_MSB[i];
-	for(i=8; i<16; i++)	V_AVC_int[i] = V_AVC_LSB[i-8];
-
-
-	//for(i=0; i<16; i++) cout<<V_AVC_int[i];
-	//cout<<endl;
-
-	/* Two's Complement */
-	if (V_AVC_int[0] == 1){
-		i = 15;
-		while(i>=0){
-			if(V_AVC_int[i] == 1 or flag){
-				flag = 1;
-				i--;
-				V_AVC_int[i] = !V_AVC_int[i];
-				i++;
-			}
-			i--;
-		}
-	}
-	V_AVC_int[0] = 0;
-
-
-	//for(i=0; i<16; i++) cout<<V_AVC_int[i];
-	//cout<<endl;
-
-
-	flipbits(V_AVC_int, 16); // flip the vector for calculation below
-
-	for(i=0; i<15; i++, cont++){ // the last bit is the parity bit
-		V_AVC = V_AVC + V_AVC_int[i]*pow(2,cont); // converte de binario para inteiro
-	}
-
-	// cout<< "Average Current: "<<V_AVC<<" Ampere"<<endl;
-
-	AVC_I = V_AVC*1.5625*pow(10,-6)/0.015;
-	cout<< "Average Current: "<<AVC_I<<" Ampere"<<endl;
-}
-
-/******** Temperature Register Value *********/
-void TEMP_REG (int *fr, int ind){
-	int cont=0, flag=0;
-	int i,j;
-	double TR = 0, V_TR = 0;
-	int V_TR_int[16],V_TR_MSB[8],V_TR_LSB[8];
-
-
-	for(i=ind; i<ind+16; i++) V_TR_int[i-ind] = fr[i];
-
-	for(i=0; i<8; i++)	V_TR_MSB[i] = V_TR_int[i];
-
-	for(i=8; i<16; i++)	V_TR_LSB[i-8] = V_TR_int[i];
-
-	flipbits(V_TR_MSB, 8);
-	flipbits(V_TR_LSB, 8);
-
-
-		// Colocado na forma original
-	for(i=0; i<8; i++) 	V_TR_int[i] = V_TR_MSB[i];
-	for(i=8; i<16; i++)	V_TR_int[i] = V_TR_LSB[i-8];
-
-	//for(i=0; i<16; i++) cout<<V_TR_int[i];
-	//cout<<endl;
-
-
-	/* Two's Complement */
-	if (V_TR_int[0] == 1){
-		i = 15;
-		while(i>=0){
-			if(V_TR_int[i] == 1 or flag){
-				flag = 1;
-				i--;
-				V_TR_int[i] = !V_TR_int[i];
-				i++;
-			}
-			i--;
-		}
-	}
-	V_TR_int[0] = 0;
-
-	//for(i=0; i<16; i++) cout<<V_TR_int[i];
-	//cout<<endl;
-
-		// desloca cinco posicoes para a direita
-	for(j=0;j<5;j++){
-		for(i=15;i>0;i--) V_TR_int[i] = V_TR_int[i-1];
-
-		V_TR_int[0] = 0;
-	}
-
-	//for(i=0; i<16; i++) cout<<V_TR_int[i];
-	//cout<<endl;
-
-	flipbits(V_TR_int, 16); // flip the vector for calculation below
-
-	for(i=0; i<15; i++, cont++){
-		V_TR = V_TR + V_TR_int[i]*pow(2,cont); // converte de binario para inteiro
-	}
-
-
-	TR = V_TR*0.125;
-	cout<< "Temperature Register: "<<TR<<" Celsius"<<endl;
-}
-
-
-/********* Voltage Register Value **********/
-void VOLT_REG(int *fr, int ind){
-
-	int cont=0, flag = 0;
-	int i,j;
-	double V_REG = 0, V_bat;
-	int V_REG_int[16],V_REG_MSB[8],V_REG_LSB[8];
-
-
-	for(i=ind; i<ind+16; i++) V_REG_int[i-ind] = fr[i];
-
-	for(i=0; i<8; i++)	V_REG_MSB[i] = V_REG_int[i];
-
-	for(i=8; i<16; i++)	V_REG_LSB[i-8] = V_REG_int[i];
-
-	flipbits(V_REG_MSB, 8);
-	flipbits(V_REG_LSB, 8);
-
-	// Colocado na forma original
-	for(i=0; i<8; i++) 	V_REG_int[i] = V_REG_MSB[i];
-	for(i=8; i<16; i++)	V_REG_int[i] = V_REG_LSB[i-8];
-
-	//for(i=0; i<16; i++) cout<<V_REG_int[i];
-	//cout<<endl;
-
-	/* Two's Complement */
-	if (V_REG_int[0] == 1){
-		i = 15;
-		while(i>=0){
-			if(V_REG_int[i] == 1 or flag){
-				flag = 1;
-				i--;
-				V_REG_int[i] = !V_REG_int[i];
-				i++;
-			}
-			i--;
-		}
-	}
-	V_REG_int[0] = 0;
-
-	//for(i=0; i<16; i++) cout<<V_REG_int[i];
-	//cout<<endl;
-
-
-	// desloca cinco posicoes para a direita. Olhar na documentacao
-	for(j=0;j<5;j++){
-		for(i=15;i>0;i--) V_REG_int[i] = V_REG_int[i-1];
-
-		V_REG_int[0] = 0;
-	}
-
-	//for(i=0; i<16; i++) cout<<V_REG_int[i];
-	//cout<<endl;
-
-	flipbits(V_REG_int, 16); // flip the vector for calculation below
-
-	for(i=0; i<15; i++, cont++)	V_REG = V_REG + V_REG_int[i]*pow(2,cont); // converte de binario para inteiro
-
-
-	V_bat = V_REG*4.883*pow(10,-3);
-	cout<< "Voltage Register: "<<V_bat<< " V"<<endl;
-}
-
-void CURRENT_REG (int *fr, int ind){
-	int cont=0, flag = 0;;
-	int i;
-	double V_CR = 0, I_bat = 0;
-	int V_CR_int[16],V_CR_MSB[8],V_CR_LSB[8];
-
-	for(i=ind; i<ind+16; i++) V_CR_int[i-ind] = fr[i];
-
-	for(i=0; i<8; i++)	V_CR_MSB[i] = V_CR_int[i];
-
-	for(i=8; i<16; i++)	V_CR_LSB[i-8] = V_CR_int[i];
-
-	flipbits(V_CR_MSB, 8);
-	flipbits(V_CR_LSB, 8);
-
-	for(i=0; i<8; i++) 	V_CR_int[i] = V_CR_MSB[i];
-	for(i=8; i<16; i++)	V_CR_int[i] = V_CR_LSB[i-8];
-
-	//for(i=0; i<16; i++) cout<<V_CR_int[i];
-	//cout<<endl;
-
-
-	/* Two's Complement */
-	if (V_CR_int[0] == 1){
-		i = 15;
-		while(i>=0){
-			if(V_CR_int[i] == 1 or flag){
-				flag = 1;
-				i--;
-				V_CR_int[i] = !V_CR_int[i];
-				i++;
-			}
-			i--;
-		}
-	}
-	V_CR_int[0] = 0;
-
-	//for(i=0; i<16; i++) cout<<V_CR_int[i];
-	//cout<<endl;
-
-	flipbits(V_CR_int, 16); // flip the vector for calculation below
-
-	for(i=0; i<15; i++, cont++){ // the last bit is the parity bit
-		V_CR = V_CR + V_CR_int[i]*pow(2,cont); // converte de binario para inteiro
-	}
-
-	I_bat = V_CR*1.5625*pow(10,-6)/0.015;
-	cout<< "Current Register: "<<I_bat<<" Ampere"<<endl;
-}
-
-void ACCUM_CURRENT (int *fr, int ind){
-	int cont=0, temp=0;
-	int i,j;
-	double Q_bat = 0, V_ACR = 0;
-	int ind2 = ind;
-
-
-	ind = ind + 8;
-	for(j = 0; j<2; j++){ // dois octetos para cada Register
-		for(i=ind; i<ind+8; i++, cont++){ // 136 eh o indice que comeca a INFO
-			temp = temp + fr[i]*pow(2,cont); // converte de binario para inteiro
-		}
-
-		V_ACR = V_ACR+temp;
-		temp = 0;
-		ind = ind2;
-	}
-
-	Q_bat = V_ACR*6.25*pow(10,-6)/0.015;
-	cout<< "Accumulated Current: "<<Q_bat<<" Ampere hour"<<endl;
-}
-
-
-/****** Voltage Regulator Status *******/
-void VR_STATUS (int *fr, int ind){
-	int cont=0;
-	int i;
-	double V_status = 0;
-
-
-	for(i=ind; i<ind+8; i++, cont++){ // ind eh o indice que comeca o Voltage Regulator Status
-		V_status = V_status + fr[i]*pow(2,cont); // convercao de binario para inteiro
-	}
-
-
-	cout<< "Voltage Regulator Status: "<<V_status<<endl;
-}
-
-
-
-void RTD(int *fr, int ind){
-
-	int cont=0, temp = 0;
-	int i,j,k;
-	double T_RTD, V_RTD, V_ADC_RTD = 0;
-	int ind2;
-	int fr_cp[21*8];
-
-	// copia para outro vetor, pois eh mais facil tratar um vetor comecando com indice "0"
-	for(i=ind; i<ind+21*8; i++)
-		fr_cp[i-ind] = fr[i];
-
-	ind = 0;
-	ind2 = ind + 8;
-
-	for (k=0; k<4; k++){ // tres pares de octetos
-		ind = ind + 16;
-		for(j = 0; j<3; j++){ // tres octetos para cada RTD
-			for(i=ind; i<ind+8; i++, cont++){ // ind eh o indice que comeca a INFO
-				temp = temp + fr_cp[i]*pow(2,cont); // converte de binario para inteiro
-			}
-			//ind = ind - 16;
-			V_ADC_RTD = V_ADC_RTD + temp;
-			//cont = i-ind;
-			temp = 0;
-			ind = 2*k*8 + ind2*(k+1) - (j*8);
-		}
-		cont = 0;
-		ind = 16*pow(2,k) + 8;
-
-		V_RTD = V_ADC_RTD/(2.048*pow(2,24));
-
-		T_RTD = (1000*33 - 898*V_RTD - 1000*V_RTD)/(3.85*V_RTD - 3.85*33);
-		cout<<"V_ADC_RTD_" <<k+1<<": "<<V_ADC_RTD<<endl;
-
-		//cout<<"TEMPERATURE_RTD_" <<k+1<<": "<<T_RTD<<" Celsius"<<endl;
-
-		V_ADC_RTD = 0;
-	}
-}
-
-static unsigned char * checkCRC(int fr[]){
+static unsigned char * checkCRC(frame_arena *arena, int fr[]){
 	int i, j, cont, temp = 0;
-	unsigned char CRC_Char[16] = "\0";
+	unsigned char *CRC_Char = frame_arena_new<unsigned char>(arena, 2);
 
 	//unsigned char ar[16] = {0,1,0,1,0,1,0,0, 0,1,0,0,0,1,0,1};
 
@@ -924,212 +146,83 @@ static unsigned char * checkCRC(int fr[]){
 		return CRC_Char;
 }
 
+/* Chamada pelo deframer para cada frame recebido (sem as flags) */
+static void frameReceived(const uint8_t *frame, size_t len, uint64_t bit_pos, void *user){
+	const frame_view *v = frame_decode_view((frame_arena *)user, frame, len, bit_pos, 0, 1, AX25_NUL_PADDED);
+
+	printf("Frame received: %u octets at bit %u\n", (unsigned)len, (unsigned)bit_pos);
+	if (v) printf("%s -> %s, %u octets of Info, FCS %s\n", v->ax25.source, v->ax25.destination,
+				  (unsigned)v->ax25.info_len, v->ax25.fcs_ok ? "ok" : "wrong");
+}
+
 int main() {
 
 	//int a [] = {0,1,1,1,1,1,1,0,  1,0,0,1,  0,1,1,1,1,1,1,0};
-	static int dest_bits[56], source_bits[56];
-
-
-	int adc1[] = {1,1,1,1,0,0,0,0, 1,1,1,1,1,1,1,1,
-				  0,0,0,0,0,0,0,1, 0,1,1,0,0,0,0,0,
-				  0,0,0,0,0,0,0,1, 0,0,0,0,0,0,0,0,
-				  0,0,0,0,0,0,0,0, 1,0,0,0,0,0,0,0,
-				  1,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,
-				  1,0,0,0,0,0,0,0, 1,0,0,0,0,0,0,0};
-
-	int rtd[] = {1,1,1,1,0,0,0,0, 1,1,1,1,1,1,1,1, 0,0,0,0,0,0,0,1,
-				 0,1,1,0,0,0,0,0, 0,0,0,0,0,0,0,1, 0,0,0,0,0,0,0,0,
-				 0,0,0,0,0,0,0,0, 1,0,0,0,0,0,0,0, 1,0,0,0,0,0,0,0,
-				 0,0,0,0,0,0,0,0, 1,0,0,0,0,0,0,0, 1,0,0,0,0,0,0,0};
-
-
-	//ADC_4_5_6_I(adc1, 16);
-	//ADC_1_2_3_V(adc1, 0);
-	//ADC_total_V(adc1, 0);
-	//MSP_TS(adc1, 0);
-	//AVC(adc1, 16);
-	//TEMP_REG(adc1, 16);
-	//VOLT_REG(adc1, 0);
-	//CURRENT_REG(adc1,16);
-	//VR_STATUS(adc1, 8);
-	RTD(rtd, 0);
-
-
-	int flag[8] = {0,1,1,1,1,1,1,0}; // Default value to FLAG
-	int control[8] = {0,0,1,1,1,1,1,0}; // initial value to Control Field
-	int pid[8] = {1,1,1,1,0,0,0,0}; // No layer 3 protocol implemented
-	static int frame[2208]; // (256 de INFO + 20 do resto)*8
-	int infoRecepTam = 0;
 
-	static int infoField[256*8]; // The I field defaults to a length of 256 octets --- INFO ---
+
+	/* Exemplo de telemetria do EPS (Info field de 39 octetos, ver tlm_schema.cpp) */
+	static const uint8_t epsExample[] = {
+		0x0F,0xFF, 0x80,0x06, 0x80,0x00,	// ADC1-3 V
+		0x00,0x01, 0x01,0x00, 0x01,0x01,	// ADC4-6 I
+		0x0B,0xB8,							// ADC total V
+		0x0A,0x3C,							// MSP430 temperature sensor
+		0xFF,0x38,							// AVC
+		0x03,0x20,							// TEMP_REG
+		0x84,0x00,							// VOLT_REG
+		0x00,0xC8,							// CURRENT_REG
+		0x12,0x34,							// ACCUM_CURRENT
+		0x05,								// VR_STATUS
+		0x0F,0xFF,0x80, 0x06,0x80,0x00, 0x00,0x01,0x01, 0x00,0x01,0x01	// RTD1-4
+	};
+	double epsValues[TLM_MAX_FIELDS];
+
+	tlm_decode(&eps_schema, epsExample, epsValues);
+	tlm_print(stdout, &eps_schema, epsValues);
+
+
+	static uint8_t frame[AX25_FRAME_MAX]; // (256 de INFO + 20 do resto)
+	size_t frameLen;
+	int infoRecepTam = 0;
 
 	static unsigned char info[] = {"TEST"}; // example
 	static unsigned char *infoCRC;
 	unsigned char *infoRecep;
 	static unsigned char *testCRC = NULL;
-	//info[4] = 0x8c;
-	//info[5] = 0xca;
-	//info[6] = 00000000;
-
-	int contBits = 0;
 
 
 	/* ---------------------------------------------------- */
 	FILE *fp;
 
-	int tam_dest, tam_dest_bits, tam_source, tam_source_bits, tam_info, tam_info_bits;
-	static unsigned int CRC;
+	int tam_info;
 	int i,j;
-	static int *binCRC;
 
 	/* ------------------------ Example --------------------------------- */
 
-	char destination[] = "1B0"; // Example of DESTINATION address
-	int SSID_dest[8] = {0,1,1,0, 0,0,0,0}; // SSID DESTINATION
-	int C_bit_dest = 0; // indica que tem mais enderecos
-    	SSID_dest[0] = C_bit_dest; // set the bit "C" from DESTINATION
-
-	char source[] = "01B"; // Example of SOURCE address
-	int SSID_source[8] = {1,1,1,0, 0,0,0,1}; // SSID SOURCE
-	int C_bit_source = 1; // indica que eh o ultimo octeto do campo Address
-		SSID_source[0] = C_bit_source; // set the bit "C" from SOURCE
-
-
-	tam_dest = (sizeof(destination)/sizeof(destination[0]))-1; // number of characters without the NULL
-	tam_dest_bits = tam_dest*8; // length of DESTINATION in 8 bits
-
-	tam_source = (sizeof(source)/sizeof(source[0]))-1; // number of characters without the NULL
-	tam_source_bits = tam_source*8; // length of SOURCE in 8 bits
-
-
-
-	/*******************************************\ Functions /*********************************************/
-
-	/* Invert the SSID DESTINATION */
-	flipbits(SSID_dest, 8);
-
-	/* Invert the SSID SOURCE */
-	flipbits(SSID_source, 8);
-
-	/* Invert the CONTROL octet  */
-	flipbits(control, 8);
-
-	/* Invert the PID */
-	flipbits(pid, 8);
-
+	ax25_header header;
 
-	/****************************************************\ Field DESTINATION /****************************************************/
+	header.destination = "1B0"; // Example of DESTINATION address
+	header.ssid_dest = ax25_ssid(0, 0, 0); // C = 0, indica que tem mais enderecos
 
-	/* Preenche o endereco de destino (invertido) em bits e seu SSID em dest_bits*/
-	fullAddressDest(dest_bits, destination, tam_dest, tam_dest_bits, SSID_dest);
+	header.source = "01B"; // Example of SOURCE address
+	header.ssid_source = ax25_ssid(1, 0, 1); // C = 1, eh o ultimo octeto do campo Address
 
-	/*
-	cout<<"Valor de dest_bits:  ";
-	for (i = 0; i<56; i++) cout<<dest_bits[i];
-	cout<<endl;
-	*/
-
-	/****************************************************************************************************************************/
-
-
-
-	/*****************************************************\ Field SOURCE /******************************************************/
-
-	/* Preenche o endereco de origem (invertido) em bits e o seu SSID em source_bits*/
-	fullAddressSource(source_bits, source, tam_source, tam_source_bits, SSID_source);
-
-	/*
-	cout<<"Valor de source_bits:  ";
-		for (i = 0; i<56; i++) cout << source_bits[i];
-	cout<<endl;
-	*/
-
-	/**************************************************************************************************************************/
-
-
-
-	/*****************************************************\ Field INFO /****************************************************/
-
-	/* Faz o calculo do tamanho da informacao em bits */
-	tam_info = (sizeof(info)/sizeof(info[0]))-1;
-	tam_info_bits = tam_info*8;
-
-	/* Preenche a informacao no campo Info */
-	fullInfo(infoField, info, tam_info, tam_info_bits); // converte cada caracter ASCII --> 8bit
-
-/*	printf("info field: ");
-	for(i=0; i<(50); i++) printf("%d", infoField[i]);
-	printf("\n"); */
-
-	/*********************************************************************************************************************/
-
-
-	/*******************************************************\ Field FCS /******************************************************/
-
-		/* CRC calculation based on CRC-CCITT */
-		crcParameters();
-		CRC = crctablefast(info, strlen((const char*)info));
-
-		printf("crc table fast: 0x%x\n", CRC);
-
-		/* Converte o CRC de decimal para binario em um vetor de 16 bits */
-		binCRC = decimal2bin(CRC);
-
-		/*
-		cout<<"binary: ";
-		for(i=0; i<16; i++){
-			cout<<*binCRC;
-			binCRC = binCRC+1;
-		}
-		binCRC = binCRC-16;
-		cout<<endl;
-		*/
-
-		/***********************************************************************************************************************/
+	header.control = 0x3E; // initial value to Control Field
+	header.pid = AX25_PID_NO_L3;
 
+	tam_info = (sizeof(info)/sizeof(info[0]))-1; // number of characters without the NULL
 
 
 	/**************************************************\ Make the Frame /*************************************************/
-	/* Preenche a flag incial*/
-	for (i=0; i<8; i++)	frame[i] = flag[i];
 
-	/* Preenche o destino e SSID */
-	for (j=8; j<64; j++) frame[j] = dest_bits[j-8];
+	/* The I field defaults to a length of 256 octets */
+	frameLen = ax25_encode_frame(frame, sizeof(frame), &header, info, tam_info, AX25_INFO_MAX);
 
-	/* Preenche a origem e SSID */
-	for (j=64; j<120; j++) frame[j] = source_bits[j-64];
-
-	/* Preenche o Control Field */
-	for(j=120; j<128; j++) frame[j] = control[j-120];
-
-	/* Preenche o PID */
-	for(j=128; j<136; j++) frame[j] = pid[j-128];
-
-	/* Preenche a informacao */
-	for(j=136; j<2184; j++) frame[j] = infoField[j-136];
-
-	/* Preenche o FCS */
-	for(j=2184; j<2200; j++) {
-		frame[j] = *binCRC;
-		binCRC = binCRC+1;
-	}
-
-	/* Preenche a flag final */
-	for (j=2200; j<2208; j++)	frame[j] = flag[j-2200];
-
-
-	/* Imprime o frame */
-	cout<< "Vf:  ";
-	for(i=392; i<408; i++) cout<<frame[i];
-	cout<<endl;
+	printf("crc table fast: 0x%x\n", crctablefast(info, tam_info));
 
 	/*********************************************************************************************************************/
 
 
 
-
-
-
 	/**************************************************\ Write to File /*************************************************/
 
 	if((fp = fopen("frame.txt","w")) == NULL){
@@ -1137,48 +230,36 @@ int main() {
 		exit(1);
 	}
 
-	i=0;
-	do{
-		fprintf(fp, "%d",frame[i]);
-		//putc(frame[i],fp);
-		i++;
-	}while(i<2208);
+	/* Um caractere "0"/"1" por bit, LSB de cada octeto primeiro */
+	for(i=0; i<(int)frameLen; i++)
+		for(j=0; j<8; j++)
+			putc('0' + ((frame[i] >> j) & 1), fp);
 
 	fclose(fp);
 
 	/*********************************************************************************************************************/
 
 
-
 	/**************************************************\ Read from File /*************************************************/
 
-	if((fp = fopen("frame.txt","r")) == NULL){
+	static capture_map capture;
+	static hdlc_deframer deframer;
+
+	/* Mapeia o arquivo: o deframer le os "0"s e "1"s direto das paginas mapeadas */
+	if(capture_map_open(&capture, "frame.txt", 1) != 0){
 		printf("O arquivo nao pode ser aberto.\n");
 		exit(1);
 	}
 
-	char ch;
-	int frameRecep[2208];
-
-	ch = getc(fp); /* Le "0"s e "1"s em ASCII */
-	i=0;
+	/* Estado de decodificacao de cada frame na arena desta thread */
+	frame_arena *arena = frame_arena_local();
 
-	while(ch!=EOF){
-		//printf("%c",ch); /* show on screen o que esta no aquivo em ASCII*/
+	hdlc_deframer_init(&deframer, frameReceived, arena);
+	deframer.destuff = 0; // frame.txt eh escrito sem bit stuffing
 
-		if (ch == '0')	frameRecep[i] = 0; /* Preenche "0"s e "1"s em vetor de inteiros */
-		else if (ch == '1') frameRecep[i] = 1;
+	capture_feed(&capture, &deframer, 0, capture.size);
 
-		i++;
-		ch = getc(fp); /* Le "0"s e "1"s em ASCII */
-	}
-
-	fclose(fp);
-//	printf("\n");
-
-	/* mostra na tela o vetor de bits recebidos do arquivo */
-	//for(i=0;i<2208;i++)	printf("%d",frameRecep[i]); /* show on screen */
-	//printf("\n");
+	capture_map_close(&capture);
 
 	/***********************************************************************************************************************/
 
@@ -1210,16 +291,17 @@ int main() {
 	printSource(fr);
 
 	// recebe a INFO decodificada ja em ASCII e mostra da tela
-	infoRecep = printInfo(fr);
+	infoRecep = printInfo(arena, fr);
 	//cout<<strlen((char*)infoRecep)<<endl;
 
 	// recebe o FSC decodificado em ASCII
-	infoCRC = checkCRC(fr);
+	infoCRC = checkCRC(arena, fr);
 	//cout<<strlen((const char*)infoRecep)<<endl;
 
-	testCRC = infoRecep; // apontam para o mesmo endereco
-
 	for(i=0; infoRecep[i]; i++, infoRecepTam++); // outra forma de contar o tamanho do vetor
+
+	testCRC = frame_arena_new<unsigned char>(arena, infoRecepTam + 3); // INFO + CRC + NULL
+
 	//cout<<"tam: "<<infoRecepTam<<endl;
 
 	//for(i=0; i<infoRecepTam; i++) testCRC[i] = infoRecep[i];
@@ -1249,6 +331,8 @@ int main() {
 
 	//initInfo(a);
 
+	frame_arena_reset(arena); // libera infoRecep, infoCRC e testCRC
+
 	return 0;
 }
 
@@ -0,0 +1,328 @@
+//============================================================================
+// Name        : batch_decoder.cpp
+// Description : Multi-threaded decoder for recorded passes (capture files)
+//============================================================================
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <queue>
+#include <thread>
+
+#include "batch_decoder.h"
+#include "ax25_decoder.h"
+#include "hdlc.h"
+#include "capture_reader.h"
+#include "dedup_index.h"
+#include "frame_view.h"
+
+/* A stuffed frame plus both flags, so a frame starting in a shard always ends in the read window */
+#define SHARD_OVERLAP_BITS	(16 + HDLC_MAX_FRAME*8 + HDLC_MAX_FRAME*8/5)
+/* Bits read before a shard so a flag split by the boundary is still seen */
+#define SHARD_LOOKBACK_BITS	16
+
+/*
+* Shards are cut at byte offsets times the bits per byte. A text capture may
+* hold other characters than '0'/'1' (line breaks), which the deframer skips
+* without counting them: there the frame starts are mapped back to byte
+* offsets for the ownership test, and the bit index from the start of the file
+* is only known once the bits of the shards before are counted.
+*/
+typedef struct {
+	uint32_t file;
+	uint64_t begin, end;		// owned frame starts, in bits (text: bytes)
+} shard;
+
+typedef struct view_node {
+	const frame_view *view;
+	struct view_node *next;
+} view_node;
+
+typedef struct {
+	const batch_options *opt;
+	const capture_file *cap;
+	uint32_t file;
+	uint64_t begin, end;
+	const uint8_t *data;		// text: the capture, to map the deframer bits to bytes
+	uint64_t cur;				// text: byte of the cursor
+	uint64_t cur_bits;			// text: bits before cur, from the first byte pushed
+	uint64_t lead;				// text: bits before begin, from the first byte pushed
+	frame_arena *arena;			// views of the frames of the shard, in order
+	view_node *first, *last;
+	size_t nframes;
+	uint64_t fcs_errors;
+} shard_ctx;
+
+void batch_default_options(batch_options *opt){
+	opt->threads = 0;
+	opt->bitrate = 1200;		// 1,2 ksps 2-GFSK (ttc/beacon/inc/cc11xx_floripasat_reg_config.h)
+	opt->destuff = 1;
+	opt->keep_bad = 0;
+	opt->nul_padded = 0;
+	opt->shard_bits = (uint64_t)64 << 20;
+	opt->dedup_window = 0;
+}
+
+/* YYYYMMDD followed by one separator and HHMMSS */
+static int parse_name_time(const char *name, double *t){
+	size_t n = strlen(name), i, j;
+
+	for (i=0; i+15<=n; i++){
+		for (j=0; j<15; j++){
+			if (j == 8){
+				if (name[i+j] != '_' && name[i+j] != 'T' && name[i+j] != '-') break;
+			}
+			else if (!isdigit((unsigned char)name[i+j])) break;
+		}
+		if (j == 15){
+			struct tm tm;
+			memset(&tm, 0, sizeof(tm));
+			sscanf(name + i, "%4d%2d%2d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday);
+			sscanf(name + i + 9, "%2d%2d%2d", &tm.tm_hour, &tm.tm_min, &tm.tm_sec);
+			tm.tm_year -= 1900;
+			tm.tm_mon -= 1;
+			*t = (double)timegm(&tm);
+			return 0;
+		}
+	}
+	return -1;
+}
+
+int capture_open(const char *path, capture_file *cap){
+	struct stat st;
+	const char *base = strrchr(path, '/');
+
+	if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) return -1;
+
+	cap->path = path;
+	cap->size = (uint64_t)st.st_size;
+	cap->text = capture_is_text(path);
+
+	if (parse_name_time(base ? base + 1 : path, &cap->start_time) != 0)
+		cap->start_time = (double)st.st_mtime;
+
+	return 0;
+}
+
+/* Moves the text cursor to the byte of the bit 'bit' (counted from the first byte pushed) */
+static uint64_t text_byte(shard_ctx *ctx, uint64_t bit, uint64_t stop){
+	while (ctx->cur < stop && (ctx->cur_bits < bit || !capture_is_bit(ctx->data[ctx->cur]))){
+		ctx->cur_bits += capture_is_bit(ctx->data[ctx->cur]);
+		ctx->cur++;
+	}
+	return ctx->cur;
+}
+
+static void frame_cb(const uint8_t *frame, size_t len, uint64_t bit_pos, void *user){
+	shard_ctx *ctx = (shard_ctx *)user;
+	const frame_view *v;
+	view_node *node;
+
+	if (ctx->data){
+		// byte offset for the ownership test, then the bit from begin (the file offset is added once all shards are done)
+		if (bit_pos < ctx->lead || text_byte(ctx, bit_pos, ctx->end) >= ctx->end) return;
+		bit_pos -= ctx->lead;
+	}
+	else if (bit_pos < ctx->begin || bit_pos >= ctx->end) return;		// owned by another shard
+
+	// fields are decoded after the merge when duplicates are dropped
+	v = frame_decode_view(ctx->arena, frame, len, bit_pos,
+						  ctx->cap->start_time + (double)bit_pos/ctx->opt->bitrate, ctx->opt->dedup_window <= 0,
+						  ctx->opt->nul_padded ? AX25_NUL_PADDED : 0);
+	if (!v) return;
+
+	if (!v->ax25.fcs_ok){
+		ctx->fcs_errors++;
+		if (!ctx->opt->keep_bad) return;
+	}
+
+	if ((node = frame_arena_new<view_node>(ctx->arena)) == NULL) return;
+	node->view = v;
+	node->next = NULL;
+	if (ctx->last) ctx->last->next = node;
+	else ctx->first = node;
+	ctx->last = node;
+	ctx->nframes++;
+}
+
+static void copy_view(const frame_view *v, uint32_t file, decoded_frame *rec){
+	rec->time = v->time;
+	rec->file = file;
+	rec->bit_pos = v->bit_pos;
+	memcpy(rec->destination, v->ax25.destination, sizeof(rec->destination));
+	memcpy(rec->source, v->ax25.source, sizeof(rec->source));
+	rec->control = v->ax25.control;
+	rec->pid = v->ax25.pid;
+	rec->info_len = (uint16_t)v->ax25.info_len;
+	rec->fcs_ok = v->ax25.fcs_ok;
+	rec->schema = v->schema;
+	if (v->values) memcpy(rec->values, v->values, v->schema->nfields*sizeof(double));
+	rec->frame_len = (uint16_t)v->frame_len;
+	memcpy(rec->frame, v->frame, v->frame_len);
+}
+
+/*
+* Text captures: the frames get bit_pos and time from the first bit of the
+* shard, and *bits is the number of bits in the shard.
+*/
+static uint64_t decode_shard(const batch_options &opt, const capture_file &cap, const capture_map &map,
+							 const shard &s, std::vector<decoded_frame> *out, uint64_t *fcs_errors, uint64_t *bits){
+	const unsigned int bits_per_byte = capture_bits_per_byte(&map);
+	uint64_t from = s.begin > SHARD_LOOKBACK_BITS ? s.begin - SHARD_LOOKBACK_BITS : 0;
+	uint64_t to = s.end + SHARD_OVERLAP_BITS;
+	uint64_t off = from/bits_per_byte, stop = (to + bits_per_byte - 1)/bits_per_byte;
+	hdlc_deframer d;
+	shard_ctx ctx;
+
+	if (stop > map.size) stop = map.size;
+
+	ctx.opt = &opt;
+	ctx.cap = &cap;
+	ctx.file = s.file;
+	ctx.begin = s.begin;
+	ctx.end = s.end;
+	ctx.data = map.text ? map.data : NULL;
+	ctx.cur = off;
+	ctx.cur_bits = 0;
+	ctx.lead = 0;
+	ctx.arena = frame_arena_local();
+	ctx.first = ctx.last = NULL;
+	ctx.nframes = 0;
+	ctx.fcs_errors = 0;
+
+	hdlc_deframer_init(&d, frame_cb, &ctx);
+	d.destuff = opt.destuff;
+	d.bit_pos = off*bits_per_byte;
+
+	if (ctx.data){
+		// the deframer counts the bits from off, the cursor starts at begin
+		d.bit_pos = 0;
+		text_byte(&ctx, UINT64_MAX, std::min(s.begin, stop));
+		ctx.lead = ctx.cur_bits;
+	}
+
+	if (off < stop) capture_feed(&map, &d, off, stop - off);
+
+	*bits = 0;
+	if (ctx.data){
+		text_byte(&ctx, UINT64_MAX, std::min(s.end, stop));
+		*bits = ctx.cur_bits - ctx.lead;
+	}
+
+	// one allocation for the shard, then the arena is reused by the next shard of this thread
+	out->resize(ctx.nframes);
+	view_node *node = ctx.first;
+	for (size_t i=0; i<ctx.nframes; i++, node=node->next) copy_view(node->view, s.file, &(*out)[i]);
+	frame_arena_reset(ctx.arena);
+
+	*fcs_errors = ctx.fcs_errors;
+	return (std::min(s.end, (uint64_t)map.size*bits_per_byte) - s.begin)/bits_per_byte;
+}
+
+std::vector<decoded_frame> batch_decode(const std::vector<capture_file> &captures,
+										const batch_options &opt, batch_stats *stats){
+	std::vector<shard> shards;
+	std::vector<capture_map> maps(captures.size());
+	std::vector<std::vector<decoded_frame> > results;
+	std::vector<uint64_t> shard_bits;
+	std::vector<std::thread> pool;
+	std::vector<decoded_frame> merged;
+	std::atomic<size_t> next(0);
+	std::atomic<uint64_t> bytes(0), fcs_errors(0);
+	unsigned int nthreads = opt.threads > 0 ? (unsigned int)opt.threads : std::thread::hardware_concurrency();
+	uint32_t i;
+
+	auto t0 = std::chrono::steady_clock::now();
+
+	for (i=0; i<captures.size(); i++){
+		uint64_t bits, b;
+
+		// one mapping per capture, shared by the shards
+		if (capture_map_open(&maps[i], captures[i].path.c_str(), captures[i].text) != 0) continue;
+		bits = maps[i].size*capture_bits_per_byte(&maps[i]);
+
+		for (b=0; b<bits; b+=opt.shard_bits){
+			shard s = {i, b, std::min(bits, b + opt.shard_bits)};
+			shards.push_back(s);
+		}
+	}
+	results.resize(shards.size());
+	shard_bits.resize(shards.size());
+
+	if (nthreads == 0) nthreads = 1;
+	if (nthreads > shards.size()) nthreads = (unsigned int)std::max<size_t>(shards.size(), 1);
+
+	for (i=0; i<nthreads; i++)
+		pool.push_back(std::thread([&]{
+			size_t k;
+			uint64_t errors;
+
+			while ((k = next++) < shards.size()){
+				bytes += decode_shard(opt, captures[shards[k].file], maps[shards[k].file], shards[k],
+									  &results[k], &errors, &shard_bits[k]);
+				fcs_errors += errors;
+			}
+		}));
+
+	for (auto &t : pool) t.join();
+	for (i=0; i<maps.size(); i++) capture_map_close(&maps[i]);
+
+	// text captures: bits from the start of the file (the shards of a file are in order)
+	uint64_t base = 0;
+	for (size_t k=0; k<shards.size(); k++){
+		if (!captures[shards[k].file].text) continue;
+		if (k == 0 || shards[k].file != shards[k-1].file) base = 0;
+		for (auto &f : results[k]){
+			f.bit_pos += base;
+			f.time += (double)base/opt.bitrate;
+		}
+		base += shard_bits[k];
+	}
+
+	// every shard is already in time order: k-way merge
+	typedef std::pair<double, std::pair<size_t, size_t> > head;
+	std::priority_queue<head, std::vector<head>, std::greater<head> > heap;
+	size_t total = 0;
+	dedup_index dedup;
+
+	if (opt.dedup_window > 0) dedup_init(&dedup, DEDUP_CAPACITY, opt.dedup_window);
+
+	for (size_t k=0; k<results.size(); k++){
+		total += results[k].size();
+		if (!results[k].empty()) heap.push(head(results[k][0].time, std::make_pair(k, (size_t)0)));
+	}
+	merged.reserve(total);
+
+	while (!heap.empty()){
+		size_t k = heap.top().second.first, j = heap.top().second.second;
+
+		heap.pop();
+		if (++j < results[k].size()) heap.push(head(results[k][j].time, std::make_pair(k, j)));
+
+		const decoded_frame &f = results[k][j-1];
+
+		if (opt.dedup_window > 0){
+			// a bad frame has no key (kept from every station) and no schema, as without dedup
+			if (f.fcs_ok && dedup_check(&dedup, dedup_key(f.frame, f.frame_len), f.time)) continue;
+			merged.push_back(f);
+			if (f.schema) tlm_decode(f.schema, f.frame + f.frame_len - AX25_FCS_LEN - f.info_len, merged.back().values);
+		}
+		else merged.push_back(f);
+	}
+
+	if (stats){
+		stats->bytes = bytes;
+		stats->frames = merged.size();
+		stats->fcs_errors = fcs_errors;
+		stats->duplicates = opt.dedup_window > 0 ? dedup.duplicates : 0;
+		stats->shards = shards.size();
+		stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	}
+
+	return merged;
+}
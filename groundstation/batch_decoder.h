@@ -0,0 +1,85 @@
+//============================================================================
+// Name        : batch_decoder.h
+// Description : Multi-threaded decoder for recorded passes (capture files)
+//============================================================================
+
+#ifndef BATCH_DECODER_H_
+#define BATCH_DECODER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "ax25_encoder.h"
+#include "hdlc.h"
+#include "tlm_schema.h"
+
+/*
+* A capture is either text, one '0'/'1' character per bit (.txt, as frame.txt),
+* or packed binary (any other extension), each byte LSB first.
+*
+* The time of a frame is start_time + bit offset / bitrate, where start_time
+* comes from a YYYYMMDD[_T-]HHMMSS stamp in the file name (UTC) or else from
+* the modification time of the file.
+*/
+
+typedef struct {
+	std::string path;
+	double start_time;			// seconds since the epoch
+	int text;					// 1 for '0'/'1' captures
+	uint64_t size;				// bytes
+} capture_file;
+
+typedef struct {
+	double time;
+	uint32_t file;				// index in the capture list
+	uint64_t bit_pos;			// first bit after the opening flag
+
+	char destination[AX25_CALLSIGN_LEN + 1];
+	char source[AX25_CALLSIGN_LEN + 1];
+	uint8_t control;
+	uint8_t pid;
+	uint16_t info_len;
+	int fcs_ok;
+
+	const tlm_schema *schema;	// NULL if the Info field isn't telemetry or the FCS is wrong
+	double values[TLM_MAX_FIELDS];
+
+	uint16_t frame_len;			// frame as received, without flags
+	uint8_t frame[HDLC_MAX_FRAME];
+} decoded_frame;
+
+typedef struct {
+	int threads;				// 0 = std::thread::hardware_concurrency()
+	double bitrate;				// bits/s of the captures
+	int destuff;				// 0 for captures written without bit stuffing
+	int keep_bad;				// also return frames with a wrong FCS (no schema, with or without dedup)
+	int nul_padded;				// frames of main() (frame.txt): FCS over the text before the first NUL accepted
+	uint64_t shard_bits;		// bits per work unit
+	double dedup_window;		// s, drop copies of a frame received within it (0 = keep all)
+} batch_options;
+
+typedef struct {
+	uint64_t bytes;
+	uint64_t frames;
+	uint64_t fcs_errors;
+	uint64_t duplicates;
+	uint64_t shards;
+	double seconds;
+} batch_stats;
+
+void batch_default_options(batch_options *opt);
+
+/* Fills size/text/start_time. Returns -1 if the file can't be opened. */
+int capture_open(const char *path, capture_file *cap);
+
+/*
+* Decodes every capture and returns the frames in time order. With a dedup
+* window the captures can be of several stations: copies of a frame are
+* dropped (dedup_index.h) while merging, before their fields are decoded.
+*/
+std::vector<decoded_frame> batch_decode(const std::vector<capture_file> &captures,
+										const batch_options &opt, batch_stats *stats);
+
+#endif /* BATCH_DECODER_H_ */
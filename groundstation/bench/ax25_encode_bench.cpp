@@ -0,0 +1,112 @@
+//============================================================================
+// Name        : ax25_encode_bench.cpp
+// Description : Frames/second of the packed encoder against the int-per-bit builder
+//============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include "../crc.h"
+#include "../ax25_bits.h"
+#include "../ax25_encoder.h"
+
+#define LEGACY_FRAME_BITS	2208	// (256 de INFO + 20 do resto)*8
+
+static const char destination[] = "1B0";
+static const char source[] = "01B";
+static const unsigned char info[] = "TEST";
+
+/* Same steps as the original main(): one int per bit, 2208 ints per frame */
+static void legacy_build(int *frame){
+	int flag[8] = {0,1,1,1,1,1,1,0};
+	int control[8] = {0,0,1,1,1,1,1,0};
+	int pid[8] = {1,1,1,1,0,0,0,0};
+	int SSID_dest[8] = {0,1,1,0, 0,0,0,0};
+	int SSID_source[8] = {1,1,1,0, 0,0,0,1};
+	static int dest_bits[56], source_bits[56], infoField[256*8], crcBits[16];
+	char dest[sizeof(destination)], src[sizeof(source)];
+	unsigned char inf[sizeof(info)];
+	int *binCRC;
+	int j;
+
+	// the builders consume their input strings
+	memcpy(dest, destination, sizeof(dest));
+	memcpy(src, source, sizeof(src));
+	memcpy(inf, info, sizeof(inf));
+
+	flipbits(SSID_dest, 8);
+	flipbits(SSID_source, 8);
+	flipbits(control, 8);
+	flipbits(pid, 8);
+
+	fullAddressDest(dest_bits, dest, 3, 24, SSID_dest);
+	fullAddressSource(source_bits, src, 3, 24, SSID_source);
+
+	// CRC before fullInfo(), which shifts inf down to zeros
+	binCRC = decimal2bin(crctablefast(inf, sizeof(inf)-1), crcBits);
+	fullInfo(infoField, inf, sizeof(inf)-1, (sizeof(inf)-1)*8);
+
+	for (j=0; j<8; j++) frame[j] = flag[j];
+	for (j=8; j<64; j++) frame[j] = dest_bits[j-8];
+	for (j=64; j<120; j++) frame[j] = source_bits[j-64];
+	for (j=120; j<128; j++) frame[j] = control[j-120];
+	for (j=128; j<136; j++) frame[j] = pid[j-128];
+	for (j=136; j<2184; j++) frame[j] = infoField[j-136];
+	for (j=2184; j<2200; j++) frame[j] = binCRC[j-2184];
+	for (j=2200; j<2208; j++) frame[j] = flag[j-2200];
+}
+
+static size_t packed_build(uint8_t *frame){
+	ax25_header header;
+
+	header.destination = destination;
+	header.ssid_dest = ax25_ssid(0, 0, 0);
+	header.source = source;
+	header.ssid_source = ax25_ssid(1, 0, 1);
+	header.control = 0x3E;
+	header.pid = AX25_PID_NO_L3;
+
+	return ax25_encode_frame(frame, AX25_FRAME_MAX, &header, info, sizeof(info)-1, AX25_INFO_MAX);
+}
+
+int main(int argc, char **argv){
+	long n = (argc > 1) ? atol(argv[1]) : 200000;
+	static int legacy[LEGACY_FRAME_BITS], unpacked[LEGACY_FRAME_BITS];
+	static uint8_t packed[AX25_FRAME_MAX];
+	volatile int sink = 0;
+	size_t len;
+	long i;
+
+	legacy_build(legacy);
+	len = packed_build(packed);
+	bytes2bits(packed, len, unpacked);
+
+	if (len*8 != LEGACY_FRAME_BITS || memcmp(legacy, unpacked, sizeof(legacy)) != 0){
+		printf("ERROR, packed frame differs from the int-per-bit frame.\n");
+		return 1;
+	}
+	printf("frames are bit-identical (%u bits)\n", (unsigned)(len*8));
+
+	auto t0 = std::chrono::steady_clock::now();
+	for (i=0; i<n; i++){
+		legacy_build(legacy);
+		sink += legacy[2190];
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	for (i=0; i<n; i++){
+		packed_build(packed);
+		sink += packed[273];
+	}
+	auto t2 = std::chrono::steady_clock::now();
+
+	double s_legacy = std::chrono::duration<double>(t1 - t0).count();
+	double s_packed = std::chrono::duration<double>(t2 - t1).count();
+
+	printf("int-per-bit: %12.0f frames/s (%u bytes per frame)\n", n/s_legacy, (unsigned)sizeof(legacy));
+	printf("packed     : %12.0f frames/s (%u bytes per frame)\n", n/s_packed, (unsigned)len);
+	printf("speedup    : %12.1fx\n", s_legacy/s_packed);
+
+	return 0;
+}
@@ -0,0 +1,279 @@
+//============================================================================
+// Name        : batch_check.cpp
+// Description : Batch decoder checked against the frames sent, for every shard size
+//============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include "../ax25_decoder.h"
+#include "../ax25_encoder.h"
+#include "../batch_decoder.h"
+#include "../hdlc.h"
+
+/*
+* Builds a pass of FRAMES frames (EPS sized Info fields of random octets,
+* random idle flags in between, bit stuffed) and writes it as three captures:
+*  - packed binary;
+*  - text, one '0'/'1' per bit;
+*  - text with a line break every 80 bits (skipped by the deframer).
+* Each is decoded with shard sizes from 509 bits up to the whole file and 1 or 4
+* threads. Every frame sent must come out once, with the bit index (counted
+* from the start of the file, line breaks not included) and the time it was
+* sent at.
+*
+* Then:
+*  - a pass with every BAD_EVERY-th frame corrupted, received by two stations
+*    and decoded with -a -d: the good frames come out once with the fields of
+*    the single station decode, the bad ones from both stations, without
+*    fields, as without -d;
+*  - the zero padded frames of main(): accepted with AX25_NUL_PADDED only,
+*    flagged fcs_prefix, and a corrupted tail after the NUL is rejected
+*    without it.
+*
+* batch_check
+*/
+
+#define FRAMES		400
+#define INFO_LEN	39			// EPS telemetry
+#define BAD_EVERY	7
+#define LINE_BITS	80
+
+typedef struct {
+	uint64_t bit;				// first bit after the opening flag
+	int bad;
+} sent_frame;
+
+static uint64_t rng = 0x9E3779B97F4A7C15ULL;
+
+static uint32_t next_rand(){
+	rng ^= rng << 13;
+	rng ^= rng >> 7;
+	rng ^= rng << 17;
+	return (uint32_t)(rng >> 32);
+}
+
+static void put_bit(std::vector<uint8_t> &out, uint64_t *nbits, int b){
+	if ((*nbits & 7) == 0) out.push_back(0);
+	out.back() |= (uint8_t)((b & 1) << (*nbits & 7));
+	(*nbits)++;
+}
+
+static void put_flag(std::vector<uint8_t> &out, uint64_t *nbits){
+	int k;
+
+	for (k=0; k<8; k++) put_bit(out, nbits, (AX25_FLAG >> k) & 1);
+}
+
+/* One pass, packed LSB first; with bad, every BAD_EVERY-th frame has an Info octet changed after its FCS */
+static void make_pass(std::vector<uint8_t> &out, std::vector<sent_frame> &sent, int bad){
+	static uint8_t frame[AX25_FRAME_MAX], bits[AX25_FRAME_MAX*8*6/5 + 16];
+	uint8_t info[INFO_LEN];
+	ax25_header hdr;
+	uint64_t nbits = 0;
+	size_t len, n, k;
+	int i, j;
+
+	hdr.destination = "PY0EFS";
+	hdr.ssid_dest = ax25_ssid(0, 0, 0);
+	hdr.source = "FSAT";
+	hdr.ssid_source = ax25_ssid(1, 0, 1);
+	hdr.control = 0x03;
+	hdr.pid = AX25_PID_NO_L3;
+
+	for (i=0; i<FRAMES; i++){
+		for (j=1 + next_rand()%24; j>0; j--) put_flag(out, &nbits);
+
+		for (k=0; k<INFO_LEN; k++) info[k] = (uint8_t)next_rand();
+		len = ax25_encode_frame(frame, sizeof(frame), &hdr, info, INFO_LEN);
+
+		sent_frame s = {nbits + 8, bad && i % BAD_EVERY == BAD_EVERY - 1};
+		if (s.bad) frame[1 + AX25_HEADER_LEN + 5] ^= 0x10;
+
+		n = hdlc_stuff_frame(frame + 1, len - 2, bits, sizeof(bits));
+		for (k=0; k<n; k++) put_bit(out, &nbits, bits[k]);
+		sent.push_back(s);
+	}
+	put_flag(out, &nbits);
+	put_flag(out, &nbits);
+}
+
+static int write_file(const std::string &path, const std::vector<uint8_t> &data){
+	FILE *fp = fopen(path.c_str(), "wb");
+
+	if (!fp) return -1;
+	fwrite(data.data(), 1, data.size(), fp);
+	return fclose(fp);
+}
+
+static int check(const std::string &path, const std::vector<sent_frame> &sent, uint64_t shard_bits, int threads){
+	std::vector<capture_file> caps(1);
+	batch_options opt;
+	size_t i;
+
+	batch_default_options(&opt);
+	opt.shard_bits = shard_bits;
+	opt.threads = threads;
+	if (capture_open(path.c_str(), &caps[0]) != 0) return 0;
+
+	std::vector<decoded_frame> frames = batch_decode(caps, opt, NULL);
+
+	if (frames.size() != sent.size()){
+		printf("ERROR, %s, shards of %llu, %d thread(s): %u frames, %u sent\n", path.c_str(),
+			   (unsigned long long)shard_bits, threads, (unsigned)frames.size(), (unsigned)sent.size());
+		return 0;
+	}
+	for (i=0; i<frames.size(); i++){
+		double dt = frames[i].time - caps[0].start_time - (double)sent[i].bit/opt.bitrate;
+
+		if (frames[i].bit_pos != sent[i].bit || dt > 1e-6 || dt < -1e-6){
+			printf("ERROR, %s, shards of %llu, %d thread(s): frame %u at bit %llu (%.6f s), sent at %llu\n",
+				   path.c_str(), (unsigned long long)shard_bits, threads, (unsigned)i,
+				   (unsigned long long)frames[i].bit_pos, frames[i].time - caps[0].start_time,
+				   (unsigned long long)sent[i].bit);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* Two stations, -a -d: the good frames once with the fields of one station alone, the bad ones twice without fields */
+static int check_dedup_keep_bad(const std::string &dir){
+	std::vector<uint8_t> bin;
+	std::vector<sent_frame> sent;
+	std::vector<capture_file> one(1), two(2);
+	std::string paths[2] = {dir + "/st1_20261017_000000.bin", dir + "/st2_20261017_000000.bin"};
+	batch_options opt;
+	batch_stats stats;
+	size_t i, j, nbad = 0;
+	int ok = 1;
+
+	make_pass(bin, sent, 1);
+	for (i=0; i<sent.size(); i++) nbad += sent[i].bad;
+	if (write_file(paths[0], bin) || write_file(paths[1], bin) ||
+		capture_open(paths[0].c_str(), &one[0]) || capture_open(paths[0].c_str(), &two[0]) ||
+		capture_open(paths[1].c_str(), &two[1])){
+		perror(dir.c_str());
+		return 0;
+	}
+
+	batch_default_options(&opt);
+	opt.keep_bad = 1;
+	std::vector<decoded_frame> ref = batch_decode(one, opt, NULL);
+
+	opt.dedup_window = 1;
+	std::vector<decoded_frame> merged = batch_decode(two, opt, &stats);
+
+	unlink(paths[0].c_str());
+	unlink(paths[1].c_str());
+
+	if (ref.size() != sent.size() || merged.size() != sent.size() + nbad || stats.duplicates != sent.size() - nbad){
+		printf("ERROR, -a -d: %u frames from one station, %u from two (%llu duplicates), %u sent, %u bad\n",
+			   (unsigned)ref.size(), (unsigned)merged.size(), (unsigned long long)stats.duplicates,
+			   (unsigned)sent.size(), (unsigned)nbad);
+		return 0;
+	}
+
+	for (i=0, j=0; i<merged.size() && ok; i++){
+		const decoded_frame &f = merged[i];
+
+		while (j < ref.size() && ref[j].bit_pos < f.bit_pos) j++;
+		if (j == ref.size() || ref[j].bit_pos != f.bit_pos || ref[j].fcs_ok != f.fcs_ok) ok = 0;
+		else if (!f.fcs_ok) ok = !f.schema && !ref[j].schema;
+		else ok = f.schema && f.schema == ref[j].schema &&
+				  memcmp(f.values, ref[j].values, f.schema->nfields*sizeof(double)) == 0;
+
+		if (!ok) printf("ERROR, -a -d: frame %u at bit %llu (FCS %s) differs from the single station decode\n",
+						(unsigned)i, (unsigned long long)f.bit_pos, f.fcs_ok ? "ok" : "wrong");
+	}
+	return ok;
+}
+
+/* Frames of main(): "TEST" in a zero padded 256 octet field, the FCS over the text only */
+static int check_nul_padded(){
+	static const uint8_t text[] = "TEST";
+	static uint8_t frame[AX25_FRAME_MAX];
+	ax25_header hdr;
+	ax25_frame f, g, h;
+	size_t len;
+
+	hdr.destination = "1B0";
+	hdr.ssid_dest = ax25_ssid(0, 0, 0);
+	hdr.source = "01B";
+	hdr.ssid_source = ax25_ssid(1, 0, 1);
+	hdr.control = 0x3E;
+	hdr.pid = AX25_PID_NO_L3;
+
+	len = ax25_encode_frame(frame, sizeof(frame), &hdr, text, 4, AX25_INFO_MAX);
+	if (ax25_decode_frame(frame + 1, len - 2, &f) != 0 || f.fcs_ok ||
+		ax25_decode_frame(frame + 1, len - 2, &g, AX25_NUL_PADDED) != 0 || !g.fcs_ok || !g.fcs_prefix){
+		printf("ERROR, zero padded frame: FCS %d without AX25_NUL_PADDED, %d (prefix %d) with it\n",
+			   f.fcs_ok, g.fcs_ok, g.fcs_prefix);
+		return 0;
+	}
+
+	// tail corrupted after the NUL, still ending in 0
+	frame[1 + AX25_HEADER_LEN + 100] = 0x55;
+	if (ax25_decode_frame(frame + 1, len - 2, &f) != 0 || f.fcs_ok || f.fcs_prefix){
+		printf("ERROR, zero padded frame with a corrupted tail accepted without AX25_NUL_PADDED\n");
+		return 0;
+	}
+
+	// a frame whose FCS covers the whole field is not a prefix match
+	len = ax25_encode_frame(frame, sizeof(frame), &hdr, text, 5);
+	if (ax25_decode_frame(frame + 1, len - 2, &h, AX25_NUL_PADDED) != 0 || !h.fcs_ok || h.fcs_prefix){
+		printf("ERROR, frame ending in NUL: FCS %d, prefix %d\n", h.fcs_ok, h.fcs_prefix);
+		return 0;
+	}
+	return 1;
+}
+
+int main(){
+	static const uint64_t shard_sizes[] = {509, 1 << 10, 1 << 16, 1 << 18, (uint64_t)64 << 20};
+	char dir[] = "/tmp/batch_checkXXXXXX";
+	std::vector<uint8_t> bin, text, lines;
+	std::vector<sent_frame> sent;
+	std::string paths[3];
+	size_t i, k;
+	int t, ok = 1;
+
+	make_pass(bin, sent, 0);
+
+	for (i=0; i<bin.size()*8; i++){
+		uint8_t c = '0' + ((bin[i >> 3] >> (i & 7)) & 1);
+
+		text.push_back(c);
+		lines.push_back(c);
+		if (i % LINE_BITS == LINE_BITS - 1) lines.push_back('\n');
+	}
+
+	if (!mkdtemp(dir)){
+		perror(dir);
+		return 1;
+	}
+	paths[0] = std::string(dir) + "/pass.bin";
+	paths[1] = std::string(dir) + "/pass.txt";
+	paths[2] = std::string(dir) + "/pass_lines.txt";
+	if (write_file(paths[0], bin) || write_file(paths[1], text) || write_file(paths[2], lines)){
+		perror(dir);
+		return 1;
+	}
+
+	printf("%u frames, %u bytes\n", (unsigned)sent.size(), (unsigned)bin.size());
+	for (k=0; k<3; k++)
+		for (i=0; i<sizeof(shard_sizes)/sizeof(shard_sizes[0]); i++)
+			for (t=1; t<=4; t+=3) ok &= check(paths[k], sent, shard_sizes[i], t);
+
+	for (k=0; k<3; k++) unlink(paths[k].c_str());
+
+	ok &= check_dedup_keep_bad(dir);
+	ok &= check_nul_padded();
+	rmdir(dir);
+
+	printf(ok ? "OK\n" : "FAIL\n");
+	return ok ? 0 : 1;
+}
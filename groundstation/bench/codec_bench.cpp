@@ -0,0 +1,290 @@
+//============================================================================
+// Name        : codec_bench.cpp
+// Description : Per stage throughput of the codec and regression check against a baseline
+//============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../crc.h"
+#include "../crc_engine.h"
+#include "../hdlc.h"
+#include "../ax25_encoder.h"
+#include "../ax25_decoder.h"
+#include "../tlm_schema.h"
+#include "../uplink_cmd.h"
+
+/*
+* For each Info length, builds frames with random payloads and times every
+* stage of the ground-station codec on its own:
+*
+*   encode      ax25_encode_frame()
+*   uplink      df_encode() + ax25_encode_frame(), one telecommand per frame
+*               (only up to DF_DATA_MAX)
+*   stuff       hdlc_stuff_frame() (bit stuffing, one bit per byte)
+*   deframe     hdlc_push_bytes() over a packed stream of all the frames
+*   crc_table   crctablefast() over the Info field (the FCS check of the decoder)
+*   crc_engine  crc16_compute() (slicing-by-8 or PCLMULQDQ)
+*   parse       ax25_decode_frame() (addresses, control, PID and FCS)
+*   fields:xxx  tlm_decode() of schema xxx (only at the payload length of the schema)
+*
+* Each stage runs over all the frames -r times and keeps the fastest pass.
+* Results are written as CSV (stage,info_len,frames,ns_per_frame,mbyte_s).
+* With -b, ns_per_frame is compared with a previous run and the program
+* exits with 2 if a stage got slower than the tolerance.
+*/
+
+typedef struct {
+	std::string stage;
+	size_t info_len;
+	size_t frames;
+	double ns_per_frame;
+	double mbyte_s;
+} bench_result;
+
+static void usage(const char *prog){
+	fprintf(stderr, "Usage: %s [-n frames] [-r passes] [-s sizes] [-o out.csv] [-b baseline.csv] [-t percent]\n", prog);
+	fprintf(stderr, "  -n  frames per Info length (default: 2000)\n");
+	fprintf(stderr, "  -r  timed passes per stage, the fastest is kept (default: 5)\n");
+	fprintf(stderr, "  -s  comma separated Info lengths, 1..256 (default: 1,2,4,8,16,32,39,41,64,128,192,256)\n");
+	fprintf(stderr, "  -o  output file (default: stdout)\n");
+	fprintf(stderr, "  -b  baseline CSV of a previous run\n");
+	fprintf(stderr, "  -t  allowed slowdown against the baseline in %% (default: 15)\n");
+}
+
+/* Fastest of 'passes' runs of fn(), in seconds */
+template <typename F>
+static double best_of(int passes, F fn){
+	double best = 1e30;
+	int r;
+
+	for (r=0; r<passes; r++){
+		auto t0 = std::chrono::steady_clock::now();
+		fn();
+		auto t1 = std::chrono::steady_clock::now();
+		double s = std::chrono::duration<double>(t1 - t0).count();
+		if (s < best) best = s;
+	}
+	return best;
+}
+
+static void add_result(std::vector<bench_result> &results, const char *stage, size_t info_len,
+					   size_t frames, size_t bytes, double s){
+	bench_result r;
+
+	r.stage = stage;
+	r.info_len = info_len;
+	r.frames = frames;
+	r.ns_per_frame = s*1e9/frames;
+	r.mbyte_s = bytes/s/1e6;
+	results.push_back(r);
+}
+
+static void count_frame(const uint8_t *, size_t, uint64_t, void *user){
+	(*(size_t *)user)++;
+}
+
+/* All the stages for one Info length. Returns -1 if a stage doesn't round trip. */
+static int bench_size(size_t info_len, size_t nframes, int passes, std::mt19937 &rng,
+					  const crc16_engine *engine, std::vector<bench_result> &results){
+	ax25_header hdr = {"PY0EFS", ax25_ssid(0, 0, 0), "FSAT", ax25_ssid(1, 0, 1), 0x03, AX25_PID_NO_L3};
+	std::vector<uint8_t> info(nframes*info_len), frames(nframes*AX25_FRAME_MAX), stream;
+	std::vector<size_t> lens(nframes);
+	std::vector<uint8_t> bits(2*AX25_FRAME_MAX*8);
+	volatile unsigned int sink = 0;
+	size_t i, k, n, total = 0, bit = 0, deframed;
+	hdlc_deframer d;
+	ax25_frame f;
+	double s;
+
+	for (i=0; i<info.size(); i++) info[i] = (uint8_t)rng();
+
+	s = best_of(passes, [&]{
+		for (i=0; i<nframes; i++)
+			lens[i] = ax25_encode_frame(&frames[i*AX25_FRAME_MAX], AX25_FRAME_MAX, &hdr,
+										&info[i*info_len], info_len);
+	});
+	for (i=0; i<nframes; i++) total += lens[i];
+	add_result(results, "encode", info_len, nframes, total, s);
+
+	if (info_len <= DF_DATA_MAX){
+		uint8_t df[DF_FRAME_MAX], up[AX25_FRAME_MAX];
+		df_view v;
+
+		s = best_of(passes, [&]{
+			for (i=0; i<nframes; i++){
+				n = df_encode(df, sizeof(df), 0x00, 0x10, &info[i*info_len], info_len);
+				sink += (unsigned int)ax25_encode_frame(up, sizeof(up), &hdr, df, n);
+			}
+		});
+		if (ax25_decode_frame(up + 1, AX25_HEADER_LEN + n + AX25_FCS_LEN, &f) != 0 || !f.fcs_ok ||
+			df_parse(f.info, f.info_len, &v) != n || v.len != info_len){
+			fprintf(stderr, "ERROR, telecommand doesn't parse back (data %u)\n", (unsigned)info_len);
+			return -1;
+		}
+		add_result(results, "uplink", info_len, nframes, nframes*(n + AX25_HEADER_LEN + AX25_FCS_LEN + 2), s);
+	}
+
+	s = best_of(passes, [&]{
+		for (i=0; i<nframes; i++)
+			sink += (unsigned int)hdlc_stuff_frame(&frames[i*AX25_FRAME_MAX] + 1, lens[i] - 2, bits.data(), bits.size());
+	});
+	add_result(results, "stuff", info_len, nframes, total, s);
+
+	// packed stream (LSB first) of all the stuffed frames
+	stream.assign((nframes*2*AX25_FRAME_MAX*8)/8 + 1, 0);
+	for (i=0; i<nframes; i++){
+		n = hdlc_stuff_frame(&frames[i*AX25_FRAME_MAX] + 1, lens[i] - 2, bits.data(), bits.size());
+		for (k=0; k<n; k++, bit++) stream[bit >> 3] |= (uint8_t)(bits[k] << (bit & 7));
+	}
+	stream.resize((bit + 7)/8);
+
+	s = best_of(passes, [&]{
+		deframed = 0;
+		hdlc_deframer_init(&d, count_frame, &deframed);
+		hdlc_push_bytes(&d, stream.data(), stream.size());
+	});
+	if (deframed != nframes){
+		fprintf(stderr, "ERROR, %u of %u frames deframed (info %u)\n", (unsigned)deframed, (unsigned)nframes, (unsigned)info_len);
+		return -1;
+	}
+	add_result(results, "deframe", info_len, nframes, stream.size(), s);
+
+	s = best_of(passes, [&]{
+		for (i=0; i<nframes; i++) sink += crctablefast(&info[i*info_len], (unsigned int)info_len);
+	});
+	add_result(results, "crc_table", info_len, nframes, info.size(), s);
+
+	s = best_of(passes, [&]{
+		for (i=0; i<nframes; i++) sink += crc16_compute(engine, &info[i*info_len], info_len);
+	});
+	add_result(results, "crc_engine", info_len, nframes, info.size(), s);
+
+	s = best_of(passes, [&]{
+		for (i=0; i<nframes; i++){
+			if (ax25_decode_frame(&frames[i*AX25_FRAME_MAX] + 1, lens[i] - 2, &f) != 0 || !f.fcs_ok) sink = 0;
+			else sink += (unsigned int)f.info_len;
+		}
+	});
+	if (ax25_decode_frame(&frames[1], lens[0] - 2, &f) != 0 || !f.fcs_ok || f.info_len != info_len){
+		fprintf(stderr, "ERROR, frame doesn't parse back (info %u)\n", (unsigned)info_len);
+		return -1;
+	}
+	add_result(results, "parse", info_len, nframes, total, s);
+
+	for (k=0; tlm_schemas[k]; k++){
+		const tlm_schema *schema = tlm_schemas[k];
+		double values[TLM_MAX_FIELDS];
+		std::string stage = std::string("fields:") + schema->name;
+
+		if (schema->payload_len != info_len) continue;
+
+		s = best_of(passes, [&]{
+			for (i=0; i<nframes; i++){
+				tlm_decode(schema, &info[i*info_len], values);
+				sink += (unsigned int)values[0];
+			}
+		});
+		add_result(results, stage.c_str(), info_len, nframes, info.size(), s);
+	}
+
+	return 0;
+}
+
+static int load_baseline(const char *path, std::map<std::string, double> &base){
+	FILE *fp = fopen(path, "r");
+	char line[256], stage[64];
+	unsigned int info_len;
+	double ns;
+
+	if (!fp) return -1;
+
+	while (fgets(line, sizeof(line), fp))
+		if (sscanf(line, "%63[^,],%u,%*u,%lf", stage, &info_len, &ns) == 3)
+			base[std::string(stage) + "/" + std::to_string(info_len)] = ns;
+
+	fclose(fp);
+	return 0;
+}
+
+int main(int argc, char **argv){
+	const char *out_path = NULL, *base_path = NULL, *sizes = "1,2,4,8,16,32,39,41,64,128,192,256";
+	size_t nframes = 2000;
+	int passes = 5, opt, regressions = 0;
+	double tolerance = 15;
+	std::vector<bench_result> results;
+	std::mt19937 rng(1);
+	crc16_engine engine;
+	const char *p;
+	FILE *out = stdout;
+	size_t i;
+
+	while ((opt = getopt(argc, argv, "n:r:s:o:b:t:h")) != -1){
+		switch (opt){
+		case 'n': nframes = (size_t)atol(optarg); break;
+		case 'r': passes = atoi(optarg); break;
+		case 's': sizes = optarg; break;
+		case 'o': out_path = optarg; break;
+		case 'b': base_path = optarg; break;
+		case 't': tolerance = atof(optarg); break;
+		default: usage(argv[0]); return 1;
+		}
+	}
+	if (nframes < 1 || passes < 1){
+		usage(argv[0]);
+		return 1;
+	}
+
+	crc16_engine_init(&engine, 0x1021, 0xFFFF, 0x0000);
+
+	for (p=sizes; *p; ){
+		long len = strtol(p, (char **)&p, 10);
+
+		if (len < 1 || len > AX25_INFO_MAX || (*p && *p != ',')){
+			fprintf(stderr, "ERROR, bad Info length list: %s\n", sizes);
+			return 1;
+		}
+		if (*p) p++;
+		if (bench_size((size_t)len, nframes, passes, rng, &engine, results) != 0) return 1;
+	}
+
+	if (out_path && !(out = fopen(out_path, "w"))){
+		fprintf(stderr, "ERROR, can't open %s\n", out_path);
+		return 1;
+	}
+	fprintf(out, "stage,info_len,frames,ns_per_frame,mbyte_s\n");
+	for (i=0; i<results.size(); i++)
+		fprintf(out, "%s,%u,%u,%.1f,%.2f\n", results[i].stage.c_str(), (unsigned)results[i].info_len,
+				(unsigned)results[i].frames, results[i].ns_per_frame, results[i].mbyte_s);
+	if (out != stdout) fclose(out);
+
+	if (base_path){
+		std::map<std::string, double> base;
+
+		if (load_baseline(base_path, base) != 0){
+			fprintf(stderr, "ERROR, can't read baseline %s\n", base_path);
+			return 1;
+		}
+		for (i=0; i<results.size(); i++){
+			auto it = base.find(results[i].stage + "/" + std::to_string(results[i].info_len));
+
+			if (it == base.end() || it->second <= 0) continue;
+			if (results[i].ns_per_frame > it->second*(1 + tolerance/100)){
+				fprintf(stderr, "REGRESSION %-12s info %3u: %9.1f ns/frame, baseline %9.1f (%+.0f%%)\n",
+						results[i].stage.c_str(), (unsigned)results[i].info_len, results[i].ns_per_frame,
+						it->second, (results[i].ns_per_frame/it->second - 1)*100);
+				regressions++;
+			}
+		}
+		fprintf(stderr, "%d regression(s) above %.0f%% against %s\n", regressions, tolerance, base_path);
+	}
+
+	return regressions ? 2 : 0;
+}
@@ -0,0 +1,71 @@
+//============================================================================
+// Name        : crc_bench.cpp
+// Description : GB/s of the CRC-CCITT kernels against crctablefast()
+//============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+#include "../crc.h"
+#include "../crc_engine.h"
+
+static crc16_engine engine;
+
+static uint16_t run_legacy(unsigned char *p, size_t len){
+	return (uint16_t)crctablefast(p, (unsigned int)len);
+}
+
+static uint16_t run_slice8(unsigned char *p, size_t len){
+	return crc16_update_slice8(&engine, engine.init, p, len) ^ engine.xorout;
+}
+
+static uint16_t run_clmul(unsigned char *p, size_t len){
+	return crc16_update_clmul(&engine, engine.init, p, len) ^ engine.xorout;
+}
+
+static double bench(const char *name, uint16_t (*fn)(unsigned char *, size_t),
+					std::vector<unsigned char> &buf, size_t block, int reps, uint16_t *crc){
+	size_t off;
+	int r;
+
+	auto t0 = std::chrono::steady_clock::now();
+	for (r=0; r<reps; r++)
+		for (off=0; off+block<=buf.size(); off+=block)
+			*crc ^= fn(&buf[off], block);
+	auto t1 = std::chrono::steady_clock::now();
+
+	double s = std::chrono::duration<double>(t1 - t0).count();
+	double gbps = (double)(buf.size()/block*block)*reps/s/1e9;
+
+	printf("%-10s block %7u B: %7.3f GB/s\n", name, (unsigned)block, gbps);
+	return gbps;
+}
+
+int main(int argc, char **argv){
+	size_t size = (argc > 1) ? (size_t)atol(argv[1]) << 20 : 64u << 20;	// MiB
+	static const size_t blocks[] = {64, 276, 4096, 1 << 20};
+	std::vector<unsigned char> buf(size);
+	uint16_t a, b, c;
+	size_t i;
+
+	for (i=0; i<size; i++) buf[i] = (unsigned char)rand();
+
+	crc16_engine_init(&engine, 0x1021, 0xFFFF, 0x0000);
+
+	printf("pclmulqdq: %s\n", crc16_has_clmul() ? "yes" : "no (clmul runs the slicing-by-8 kernel)");
+
+	for (i=0; i<sizeof(blocks)/sizeof(blocks[0]); i++){
+		a = b = c = 0;
+		bench("table", run_legacy, buf, blocks[i], 1, &a);
+		bench("slice-by-8", run_slice8, buf, blocks[i], 1, &b);
+		bench("clmul", run_clmul, buf, blocks[i], 1, &c);
+		if (a != b || a != c){
+			printf("ERROR, CRC mismatch (0x%04x 0x%04x 0x%04x)\n", a, b, c);
+			return 1;
+		}
+	}
+
+	return 0;
+}
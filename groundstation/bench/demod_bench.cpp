@@ -0,0 +1,135 @@
+//============================================================================
+// Name        : demod_bench.cpp
+// Description : 2-GFSK demodulator speed (x real time) and frames recovered
+//============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "../fsk_demod.h"
+#include "../hdlc.h"
+#include "../ax25_encoder.h"
+#include "../ax25_decoder.h"
+
+/*
+* Modulates AX.25 frames as the beacon does (NRZI, 2-GFSK BT 0,5, 1,2 ksps,
+* 4 kHz deviation) with white noise at the given Eb/N0 and a carrier offset,
+* then times fsk_demod + hdlc_deframer over the IQ samples.
+*
+* demod_bench [frames] [sample rate] [Eb/N0 dB] [offset Hz] [tones|discriminator] [out.cf32]
+*/
+
+static int frames_ok;
+
+static void frame_cb(const uint8_t *frame, size_t len, uint64_t, void *){
+	ax25_frame f;
+
+	if (ax25_decode_frame(frame, len, &f) == 0 && f.fcs_ok) frames_ok++;
+}
+
+int main(int argc, char **argv){
+	int nframes = argc > 1 ? atoi(argv[1]) : 200;
+	double fs = argc > 2 ? atof(argv[2]) : 48000;
+	double ebn0 = pow(10, (argc > 3 ? atof(argv[3]) : 20)/10);
+	double offset = argc > 4 ? atof(argv[4]) : 0;
+	const double rb = 1200, dev = 4000, bt = 0.5;
+	std::vector<uint8_t> bits;
+	std::vector<float> iq, ci(FSK_BLOCK), cq(FSK_BLOCK), soft(FSK_BLOCK);
+	std::vector<uint8_t> hard(FSK_BLOCK);
+	std::mt19937 rng(1);
+	std::normal_distribution<float> noise(0, (float)sqrt(fs/(2*rb*ebn0)));
+	fsk_config cfg;
+	fsk_demod d;
+	hdlc_deframer deframer;
+	ax25_header hdr = {"PY0EFS", ax25_ssid(0, 0, 0), "FSAT", ax25_ssid(1, 0, 1), 0x03, AX25_PID_NO_L3};
+	uint8_t frame[AX25_FRAME_MAX], stuffed[4*AX25_FRAME_MAX*8], info[39];
+	size_t len, n, k, j;
+	int i;
+
+	// bit stream: flags between frames, NRZI (a '0' changes the tone)
+	for (i=0; i<16; i++) bits.push_back(i % 8 == 0 || i % 8 == 7 ? 0 : 1);
+	for (i=0; i<nframes; i++){
+		for (k=0; k<sizeof(info); k++) info[k] = (uint8_t)rng();
+		len = ax25_encode_frame(frame, sizeof(frame), &hdr, info, sizeof(info));
+		n = hdlc_stuff_frame(frame + 1, len - 2, stuffed, sizeof(stuffed));
+		bits.insert(bits.end(), stuffed, stuffed + n);
+	}
+	for (i=0; i<16; i++) bits.push_back(i % 8 == 0 || i % 8 == 7 ? 0 : 1);
+
+	// NRZ levels through the gaussian filter (frequency pulse tabulated over 5 symbols), integrated phase
+	{
+		double sps = fs/rb, sigma = sqrt(log(2.0))/(2*M_PI*bt), phase = 0;
+		size_t total = (size_t)(bits.size()*sps), span = (size_t)ceil(5*sps);
+		std::vector<float> level(bits.size()), pulse(span + 1);
+		long s0;
+		int nrz = 1;
+
+		for (k=0; k<=span; k++){
+			double t = (double)k/sps - 2.5;		// symbols from the centre
+			pulse[k] = (float)(0.5*(erf((t + 0.5)/(sqrt(2.0)*sigma)) - erf((t - 0.5)/(sqrt(2.0)*sigma))));
+		}
+		for (k=0; k<bits.size(); k++){
+			if (!bits[k]) nrz = -nrz;
+			level[k] = (float)nrz;
+		}
+
+		iq.resize(2*total);
+		for (k=0; k<total; k++){
+			double f = 0;
+
+			s0 = (long)(k/sps);
+			for (long m=s0-2; m<=s0+2; m++){
+				long idx = lround((double)k - (m + 0.5)*sps + 2.5*sps);
+
+				if (m >= 0 && m < (long)bits.size() && idx >= 0 && idx <= (long)span) f += level[m]*pulse[idx];
+			}
+			phase += 2*M_PI*(dev*f + offset)/fs;
+			iq[2*k] = (float)cos(phase) + noise(rng);
+			iq[2*k+1] = (float)sin(phase) + noise(rng);
+		}
+	}
+
+	if (argc > 6){
+		FILE *fp = fopen(argv[6], "wb");
+		if (fp){
+			fwrite(iq.data(), sizeof(float), iq.size(), fp);
+			fclose(fp);
+		}
+	}
+
+	fsk_default_config(&cfg);
+	cfg.sample_rate = fs;
+	cfg.freq_offset = offset;
+	if (argc > 5 && argv[5][0] == 'd') cfg.detector = FSK_DET_DISCRIMINATOR;
+	if (fsk_demod_init(&d, &cfg) != 0){
+		fprintf(stderr, "ERROR, sample rate too low\n");
+		return 1;
+	}
+	hdlc_deframer_init(&deframer, frame_cb, NULL);
+
+	auto t0 = std::chrono::steady_clock::now();
+	for (k=0; k<iq.size()/2; k+=n){
+		size_t nsym;
+
+		n = std::min<size_t>(FSK_BLOCK, iq.size()/2 - k);
+		iq_convert(&iq[2*k], n, IQ_CF32, ci.data(), cq.data());
+		nsym = fsk_demod_process(&d, ci.data(), cq.data(), n, soft.data());
+		for (j=0; j<nsym; j++) hard[j] = soft[j] > 0;
+		hdlc_push_bits(&deframer, hard.data(), nsym);
+	}
+	double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	double air = (double)iq.size()/2/fs;
+
+	printf("%s, fs %.0f Hz (D %u, %.1f samples/symbol, %u taps), Eb/N0 %.1f dB, offset %.0f Hz\n",
+		   cfg.detector == FSK_DET_TONES ? "tones" : "discriminator", fs, d.decim, d.sps,
+		   (unsigned)d.chan_taps.size(), 10*log10(ebn0), offset);
+	printf("%d/%d frames, %.1f s of signal in %.3f s: %.1fx real time, %.1f Msamples/s\n",
+		   frames_ok, nframes, air, s, air/s, iq.size()/2/s/1e6);
+
+	return 0;
+}
@@ -0,0 +1,149 @@
+//============================================================================
+// Name        : fec_bench.cpp
+// Description : FEC round trip: OBDH encoder, noisy channel, ground decoder
+//============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "../fec.h"
+#include "../ax25_encoder.h"
+#include "../../obdh/obdh_v1/util/fec.h"
+
+/*
+* AX.25 frames (flags excluded) go through fec_encode() of the OBDH firmware
+* and a stream of soft bits at the given Eb/N0 per information bit (antipodal
+* symbols, white noise, int8 like iq_demod -S), with a burst of flipped bits
+* in each block. The receiver looks for the ASM and runs fec_decode().
+* The same frames sent without coding, at the same Eb/N0, are the reference.
+*
+* fec_bench [frames] [Eb/N0 dB] [depth] [burst bits] [info bytes]
+*/
+
+#define FEC_ASM_THRESHOLD	0.7f
+
+static void push_soft(std::vector<int8_t> &soft, const uint8_t *bytes, size_t nbits, double sigma,
+					  std::mt19937 &rng){
+	std::normal_distribution<double> noise(0, sigma);
+	size_t k;
+
+	for (k=0; k<nbits; k++){
+		double v = (((bytes[k/8] >> (7 - k%8)) & 1) ? 1 : -1) + noise(rng);
+
+		v *= 64;
+		soft.push_back((int8_t)(v > 127 ? 127 : v < -127 ? -127 : v));
+	}
+}
+
+int main(int argc, char **argv){
+	int nframes = argc > 1 ? atoi(argv[1]) : 200;
+	double ebn0 = pow(10, (argc > 2 ? atof(argv[2]) : 4)/10);
+	int depth = argc > 3 ? atoi(argv[3]) : 2;
+	size_t burst = argc > 4 ? (size_t)atol(argv[4]) : 0;
+	size_t info_len = argc > 5 ? (size_t)atol(argv[5]) : 200;
+	ax25_header hdr = {"PY0EFS", ax25_ssid(0, 0, 0), "FSAT", ax25_ssid(1, 0, 1), 0x03, AX25_PID_NO_L3};
+	uint8_t frame[AX25_FRAME_MAX], info[AX25_INFO_MAX], decoded[AX25_FRAME_MAX];
+	std::vector<uint8_t> block, coded;
+	std::vector<int8_t> soft, plain;
+	std::vector<std::vector<uint8_t> > sent;
+	std::vector<size_t> starts;
+	std::mt19937 rng(1);
+	fec_decoder d;
+	size_t len, k;
+	int i, plain_ok = 0, fec_ok = 0, failed = 0, corrected = 0, worst = 0, synced = 0, false_sync = 0;
+	long bit_errors = 0;
+
+	if (info_len > AX25_INFO_MAX){
+		fprintf(stderr, "ERROR, at most %d info bytes\n", AX25_INFO_MAX);
+		return 1;
+	}
+	len = AX25_HEADER_LEN + info_len + AX25_FCS_LEN;
+	if (fec_decoder_init(&d, len, depth) != 0){
+		fprintf(stderr, "ERROR, %u bytes can't be coded with depth %d\n", (unsigned)len, depth);
+		return 1;
+	}
+
+	block.resize(FEC_RS_BLOCK_LENGTH(len, depth));
+	coded.resize(FEC_BLOCK_LENGTH(len, depth));
+
+	size_t coded_bits = FEC_ASM_BITS + fec_coded_bits(len, depth);
+	double rate = 8.0*len/coded_bits;
+	double sigma = sqrt(1/(2*rate*ebn0)), sigma_plain = sqrt(1/(2*ebn0));
+
+	// stream: idle bits, then ASM and the block
+	for (i=0; i<nframes; i++){
+		std::uniform_int_distribution<size_t> where(0, coded_bits - FEC_ASM_BITS - burst);
+		size_t at, start;
+
+		for (k=0; k<info_len; k++) info[k] = (uint8_t)rng();
+		ax25_encode_frame(frame, sizeof(frame), &hdr, info, info_len);
+		sent.push_back(std::vector<uint8_t>(frame + 1, frame + 1 + len));
+
+		memcpy(block.data(), frame + 1, len);
+		fec_encode(block.data(), (uint16_t)len, (uint8_t)depth, coded.data());
+
+		for (k=0; k<64; k++) soft.push_back((int8_t)(rng() & 1 ? 64 : -64));
+		start = soft.size();
+		starts.push_back(start);
+		push_soft(soft, coded.data(), coded_bits, sigma, rng);
+		at = start + FEC_ASM_BITS + where(rng);
+		for (k=0; k<burst; k++) soft[at + k] = (int8_t)-soft[at + k];
+
+		push_soft(plain, frame + 1, 8*len, sigma_plain, rng);
+	}
+
+	auto t0 = std::chrono::steady_clock::now();
+	{
+		size_t pos = 0, next, nbits = fec_coded_bits(len, depth);
+
+		while ((next = fec_find_asm(soft.data() + pos, soft.size() - pos, FEC_ASM_THRESHOLD)) < soft.size() - pos){
+			std::vector<size_t>::iterator it;
+			fec_result r;
+
+			pos += next;
+			it = std::lower_bound(starts.begin(), starts.end(), pos - FEC_ASM_BITS);
+			if (it == starts.end() || *it != pos - FEC_ASM_BITS){
+				false_sync++;
+				continue;
+			}
+			if (pos + nbits > soft.size()) break;
+			synced++;
+
+			r = fec_decode(&d, soft.data() + pos, decoded);
+			pos += nbits;
+			bit_errors += r.bit_errors;
+			if (r.corrected < 0){
+				failed++;
+				continue;
+			}
+			corrected += r.corrected;
+			worst = std::max(worst, r.worst);
+			if (memcmp(decoded, sent[it - starts.begin()].data(), len) == 0) fec_ok++;
+		}
+	}
+	double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+	for (i=0; i<nframes; i++){
+		for (k=0; k<8*len; k++){
+			if ((plain[i*8*len + k] > 0) != ((sent[i][k/8] >> (7 - k%8)) & 1)) break;
+		}
+		if (k == 8*len) plain_ok++;
+	}
+
+	printf("%d frames of %u bytes, Eb/N0 %.1f dB, depth %d (%u coded bits, rate %.3f), bursts of %u bits\n",
+		   nframes, (unsigned)len, 10*log10(ebn0), depth, (unsigned)coded_bits, rate, (unsigned)burst);
+	printf("uncoded: %d/%d frames\n", plain_ok, nframes);
+	printf("ASM:     %d/%d found, %d false\n", synced, nframes, false_sync);
+	printf("FEC:     %d/%d frames, %d not correctable, %d bytes corrected by RS (worst codeword %d), "
+		   "%.2f%% channel bit errors\n", fec_ok, nframes, failed, corrected, worst,
+		   synced ? 100.0*bit_errors/((double)synced*fec_coded_bits(len, depth)) : 0.0);
+	printf("decoder: %.3f s, %.2f Mbit/s of coded bits\n", s, (double)soft.size()/s/1e6);
+
+	return 0;
+}
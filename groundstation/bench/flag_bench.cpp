@@ -0,0 +1,225 @@
+//============================================================================
+// Name        : flag_bench.cpp
+// Description : Flag/abort scanners checked against the naive scanner, then timed
+//============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "../hdlc.h"
+#include "../ax25_encoder.h"
+
+/*
+* Checks, before timing:
+*  - every 16 bit pattern at the bit offsets around a word boundary and the
+*    AVX2 lane boundaries of a 384 bit buffer (zero elsewhere);
+*  - every 24 bit buffer;
+*  - random buffers of random length and density of ones;
+*  - hdlc_push_bytes() (flag skip while hunting) against hdlc_push_bits() on
+*    frames in noise, pushed in random pieces.
+* Then the GB/s of the scanners over random bits and the deframer over noise.
+*
+* flag_bench [MiB]
+*/
+
+typedef size_t (*scan_fn)(const uint8_t *, uint64_t, hdlc_sync *, size_t);
+
+static const scan_fn scanners[] = {hdlc_scan_word, hdlc_scan_avx2, hdlc_scan};
+static const char *const names[] = {"word", "avx2", "dispatch"};
+#define NSCANNERS	(sizeof(scanners)/sizeof(scanners[0]))
+
+static std::vector<hdlc_sync> ref, got;
+
+static int same(const uint8_t *data, uint64_t nbits){
+	size_t n, m, k;
+
+	ref.resize(HDLC_SCAN_MAX(nbits));
+	got.resize(HDLC_SCAN_MAX(nbits));
+	n = hdlc_scan_naive(data, nbits, ref.data(), ref.size());
+
+	for (k=0; k<NSCANNERS; k++){
+		m = scanners[k](data, nbits, got.data(), got.size());
+		if (m != n || memcmp(ref.data(), got.data(), n*sizeof(hdlc_sync)) != 0){
+			printf("ERROR, %s scanner: %u events, naive %u (%u bits)\n", names[k], (unsigned)m, (unsigned)n, (unsigned)nbits);
+			return 0;
+		}
+		// a short output buffer gets the first events
+		if (n > 1 && (m = scanners[k](data, nbits, got.data(), n/2)) != n/2){
+			printf("ERROR, %s scanner ignores max\n", names[k]);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static int check_patterns(void){
+	static const unsigned int ranges[][2] = {{40, 72}, {104, 136}, {296, 328}, {360, 369}};
+	uint8_t buf[48];
+	unsigned int r, off, b;
+	uint32_t v;
+
+	for (r=0; r<sizeof(ranges)/sizeof(ranges[0]); r++)
+		for (off=ranges[r][0]; off<ranges[r][1]; off++)
+			for (v=0; v<65536; v++){
+				memset(buf, 0, sizeof(buf));
+				for (b=0; b<16; b++)
+					if ((v >> b) & 1) buf[(off + b) >> 3] |= (uint8_t)(1 << ((off + b) & 7));
+				if (!same(buf, sizeof(buf)*8)) return 0;
+			}
+	return 1;
+}
+
+static int check_24bit(void){
+	uint8_t buf[3];
+	uint32_t v;
+
+	for (v=0; v<(1u << 24); v++){
+		buf[0] = (uint8_t)v;
+		buf[1] = (uint8_t)(v >> 8);
+		buf[2] = (uint8_t)(v >> 16);
+		if (!same(buf, 24)) return 0;
+	}
+	return 1;
+}
+
+static int check_random(std::mt19937 &rng, int iterations){
+	std::vector<uint8_t> buf(1024);
+	uint64_t nbits;
+	double p;
+	int i;
+	size_t k;
+
+	for (i=0; i<iterations; i++){
+		nbits = rng() % (buf.size()*8 + 1);
+		p = (i % 8)/8.0 + 0.05;		// from sparse ones to long runs
+		for (k=0; k<buf.size(); k++){
+			uint8_t b = 0;
+			for (int j=0; j<8; j++) if ((double)rng()/rng.max() < p) b |= (uint8_t)(1 << j);
+			buf[k] = b;
+		}
+		if (!same(buf.data(), nbits)) return 0;
+	}
+	return 1;
+}
+
+typedef struct {
+	std::vector<uint64_t> log;		// bit_pos, len and a checksum of each frame
+} frame_log;
+
+static void log_frame(const uint8_t *frame, size_t len, uint64_t bit_pos, void *user){
+	frame_log *l = (frame_log *)user;
+	uint64_t h = 1469598103934665603ULL;
+	size_t i;
+
+	for (i=0; i<len; i++) h = (h ^ frame[i])*1099511628211ULL;
+	l->log.push_back(bit_pos);
+	l->log.push_back(len);
+	l->log.push_back(h);
+}
+
+/* hdlc_push_bytes() in random pieces against one bit at a time */
+static int check_deframer(std::mt19937 &rng, int iterations){
+	ax25_header hdr = {"PY0EFS", ax25_ssid(0, 0, 0), "FSAT", ax25_ssid(1, 0, 1), 0x03, AX25_PID_NO_L3};
+	uint8_t frame[AX25_FRAME_MAX], stuffed[2*AX25_FRAME_MAX*8], info[64];
+	std::vector<uint8_t> bits, packed;
+	hdlc_deframer a, b;
+	frame_log la, lb;
+	size_t len, n, k, off, piece;
+	int i, f, destuff;
+
+	for (i=0; i<iterations; i++){
+		bits.clear();
+		destuff = i % 4 != 0;
+		for (f=0; f<20; f++){
+			// noise, sometimes with long runs of ones (aborts) and fake flags
+			n = rng() % 600;
+			for (k=0; k<n; k++) bits.push_back(f % 3 == 0 ? (rng() % 10 != 0) : rng() & 1);
+			for (k=0; k<sizeof(info); k++) info[k] = (uint8_t)rng();
+			len = ax25_encode_frame(frame, sizeof(frame), &hdr, info, 1 + rng() % sizeof(info));
+			n = hdlc_stuff_frame(frame + 1, len - 2, stuffed, sizeof(stuffed));
+			if (rng() % 5 == 0) n -= rng() % n;		// cut frame
+			bits.insert(bits.end(), stuffed, stuffed + n);
+		}
+
+		packed.assign((bits.size() + 7)/8, 0);
+		for (k=0; k<bits.size(); k++) packed[k >> 3] |= (uint8_t)(bits[k] << (k & 7));
+		bits.resize(packed.size()*8, 0);
+
+		la.log.clear();
+		lb.log.clear();
+		hdlc_deframer_init(&a, log_frame, &la);
+		hdlc_deframer_init(&b, log_frame, &lb);
+		a.destuff = b.destuff = destuff;
+
+		for (off=0; off<packed.size(); off+=piece){
+			piece = 1 + rng() % (rng() % 4 ? 512 : 40);
+			if (piece > packed.size() - off) piece = packed.size() - off;
+			hdlc_push_bytes(&a, &packed[off], piece);
+		}
+		hdlc_push_bits(&b, bits.data(), bits.size());
+
+		if (la.log != lb.log || a.bit_pos != b.bit_pos || a.frames != b.frames ||
+			a.aborts != b.aborts || a.bad_len != b.bad_len || a.ones != b.ones){
+			printf("ERROR, hdlc_push_bytes() differs from hdlc_push_bits() (%u vs %u frames)\n",
+				   (unsigned)a.frames, (unsigned)b.frames);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static void count_frame(const uint8_t *, size_t, uint64_t, void *user){
+	(*(uint64_t *)user)++;
+}
+
+int main(int argc, char **argv){
+	size_t size = (argc > 1) ? (size_t)atol(argv[1]) << 20 : 64u << 20;	// MiB
+	std::vector<uint8_t> buf(size);
+	std::vector<hdlc_sync> events(HDLC_SCAN_MAX((uint64_t)size*8));
+	std::mt19937 rng(1);
+	hdlc_deframer d;
+	uint64_t frames = 0;
+	size_t i, k, n;
+
+	printf("avx2: %s\n", hdlc_has_avx2() ? "yes" : "no (avx2 runs the word scanner)");
+
+	if (!check_patterns() || !check_24bit() || !check_random(rng, 20000) || !check_deframer(rng, 300)) return 1;
+	printf("scanners and deframer match the naive versions\n");
+
+	for (i=0; i<size; i++) buf[i] = (uint8_t)rng();
+
+	auto t0 = std::chrono::steady_clock::now();
+	n = hdlc_scan_naive(buf.data(), (uint64_t)size*8, events.data(), events.size());
+	double s_naive = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	printf("%-9s %8.3f GB/s, %u events\n", "naive", size/s_naive/1e9, (unsigned)n);
+
+	for (k=0; k<NSCANNERS; k++){
+		t0 = std::chrono::steady_clock::now();
+		n = scanners[k](buf.data(), (uint64_t)size*8, events.data(), events.size());
+		double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		printf("%-9s %8.3f GB/s, %u events, %.1fx naive\n", names[k], size/s/1e9, (unsigned)n, s_naive/s);
+	}
+
+	// deframer on noise: one bit at a time against the flag skip
+	std::vector<uint8_t> bits(size < (8u << 20) ? size*8 : (64u << 20));
+	for (i=0; i<bits.size(); i++) bits[i] = (buf[i >> 3] >> (i & 7)) & 1;
+
+	hdlc_deframer_init(&d, count_frame, &frames);
+	t0 = std::chrono::steady_clock::now();
+	hdlc_push_bits(&d, bits.data(), bits.size());
+	double s_bits = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+	hdlc_deframer_init(&d, count_frame, &frames);
+	t0 = std::chrono::steady_clock::now();
+	hdlc_push_bytes(&d, buf.data(), bits.size()/8);
+	double s_bytes = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+	printf("deframer on noise: bit by bit %.1f Mbit/s, with flag skip %.1f Mbit/s (%.1fx)\n",
+		   bits.size()/s_bits/1e6, bits.size()/s_bytes/1e6, s_bits/s_bytes);
+
+	return 0;
+}
@@ -0,0 +1,92 @@
+//============================================================================
+// Name        : capture_reader.cpp
+// Description : Memory mapped reader of raw capture files
+//============================================================================
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+#include "capture_reader.h"
+
+static uintptr_t page_size(){
+	static const uintptr_t ps = (uintptr_t)sysconf(_SC_PAGESIZE);
+	return ps;
+}
+
+/* madvise on the pages covering [p, p+len) */
+static void advise(const uint8_t *p, size_t len, int advice){
+	uintptr_t begin = (uintptr_t)p & ~(page_size() - 1);
+
+	if (len) madvise((void *)begin, (uintptr_t)p + len - begin, advice);
+}
+
+int capture_is_text(const char *path){
+	size_t n = strlen(path);
+
+	return n >= 4 && strcmp(path + n - 4, ".txt") == 0;
+}
+
+int capture_map_open(capture_map *m, const char *path, int text){
+	struct stat st;
+	void *p;
+	int fd;
+
+	m->data = NULL;
+	m->size = 0;
+	m->text = text < 0 ? capture_is_text(path) : text;
+
+	if ((fd = open(path, O_RDONLY)) < 0) return -1;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)){
+		close(fd);
+		return -1;
+	}
+
+	if (st.st_size > 0){
+		p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p == MAP_FAILED){
+			close(fd);
+			return -1;
+		}
+		m->data = (const uint8_t *)p;
+		m->size = (uint64_t)st.st_size;
+		madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+	}
+
+	close(fd);		// the mapping keeps the file
+	return 0;
+}
+
+void capture_map_close(capture_map *m){
+	if (m->data) munmap((void *)m->data, (size_t)m->size);
+	m->data = NULL;
+	m->size = 0;
+}
+
+uint64_t capture_feed(const capture_map *m, hdlc_deframer *d, uint64_t off, uint64_t len){
+	uint64_t end, done;
+	size_t n;
+
+	if (off >= m->size) return 0;
+	end = len > m->size - off ? m->size : off + len;
+
+	advise(m->data + off, (size_t)std::min<uint64_t>(CAPTURE_WINDOW, end - off), MADV_WILLNEED);
+
+	for (done=off; done<end; done+=n){
+		n = (size_t)std::min<uint64_t>(CAPTURE_WINDOW, end - done);
+
+		if (done + n < end)
+			advise(m->data + done + n, (size_t)std::min<uint64_t>(CAPTURE_WINDOW, end - done - n), MADV_WILLNEED);
+
+		if (m->text) hdlc_push_bits(d, m->data + done, n);
+		else hdlc_push_bytes(d, m->data + done, n);
+
+		// read once: let the kernel drop the window (the file is untouched)
+		advise(m->data + done, n, MADV_DONTNEED);
+	}
+
+	return end - off;
+}
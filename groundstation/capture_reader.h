@@ -0,0 +1,53 @@
+//============================================================================
+// Name        : capture_reader.h
+// Description : Memory mapped reader of raw capture files
+//============================================================================
+
+#ifndef CAPTURE_READER_H_
+#define CAPTURE_READER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hdlc.h"
+
+/*
+* The capture is mapped read-only and the deframer reads the mapped pages in
+* place, no copy. Two formats:
+*  - text: one '0'/'1' character per bit (frame.txt), other characters skipped
+*  - packed binary: 8 bits per byte, LSB first
+*/
+
+#define CAPTURE_WINDOW		((size_t)4 << 20)	// readahead and release unit
+
+typedef struct {
+	const uint8_t *data;		// NULL for an empty file
+	uint64_t size;				// bytes
+	int text;
+} capture_map;
+
+/* 1 if the file name ends in .txt */
+int capture_is_text(const char *path);
+
+/* text: 1, 0 or -1 to choose by the file name. Returns 0 on success, -1 on error. */
+int capture_map_open(capture_map *m, const char *path, int text);
+void capture_map_close(capture_map *m);
+
+static inline unsigned int capture_bits_per_byte(const capture_map *m){
+	return m->text ? 1 : 8;
+}
+
+/* Bytes of a text capture that hdlc_push_bits() takes as a bit */
+static inline int capture_is_bit(uint8_t b){
+	return b == '0' || b == '1' || b <= 1;
+}
+
+/*
+* Pushes bytes [off, off+len) of the capture to the deframer, one window at a
+* time: the next window is requested ahead (MADV_WILLNEED) and the pages
+* already read are released, so a multi-GB capture isn't kept resident.
+* Returns the bytes pushed.
+*/
+uint64_t capture_feed(const capture_map *m, hdlc_deframer *d, uint64_t off, uint64_t len);
+
+#endif /* CAPTURE_READER_H_ */
@@ -0,0 +1,16 @@
+//============================================================================
+// Name        : crc.h
+// Description : CRC-CCITT of the AX.25 FCS
+//============================================================================
+
+#ifndef CRC_H_
+#define CRC_H_
+
+#include "crc_template.h"
+
+/* CRC of p[0..len-1] (order 16, polynom 0x1021, init 0xFFFF, not reflected) */
+static inline unsigned int crctablefast (const unsigned char* p, unsigned int len){
+	return crc_ccitt::compute(p, len);
+}
+
+#endif /* CRC_H_ */
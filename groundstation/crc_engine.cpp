@@ -0,0 +1,148 @@
+//============================================================================
+// Name        : crc_engine.cpp
+// Description : Reentrant CRC-16 engine (slicing-by-8 and carry-less multiply)
+//============================================================================
+
+#include <string.h>
+
+#include "crc_engine.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CRC_HAVE_X86_CLMUL 1
+#include <immintrin.h>
+#else
+#define CRC_HAVE_X86_CLMUL 0
+#endif
+
+/* x^n mod P */
+static uint16_t xpow_mod(unsigned int n, uint16_t polynom){
+	uint32_t r = 1;
+
+	while (n--){
+		r <<= 1;
+		if (r & 0x10000) r ^= 0x10000 | polynom;
+	}
+	return (uint16_t)r;
+}
+
+void crc16_engine_init(crc16_engine *e, uint16_t polynom, uint16_t init, uint16_t xorout){
+	int i, j, k;
+
+	e->polynom = polynom;
+	e->init = init;
+	e->xorout = xorout;
+
+	for (i=0; i<256; i++){
+		uint16_t crc = (uint16_t)(i << 8);
+
+		for (j=0; j<8; j++)
+			crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ polynom) : (uint16_t)(crc << 1);
+		e->table[0][i] = crc;
+	}
+
+	for (k=1; k<8; k++)
+		for (i=0; i<256; i++){
+			uint16_t crc = e->table[k-1][i];
+			e->table[k][i] = (uint16_t)((crc << 8) ^ e->table[0][crc >> 8]);
+		}
+
+	for (i=0; i<4; i++){
+		e->fold[i][0] = xpow_mod(128*(i+1), polynom);
+		e->fold[i][1] = xpow_mod(128*(i+1) + 64, polynom);
+	}
+
+	e->update = crc16_has_clmul() ? crc16_update_clmul : crc16_update_slice8;
+}
+
+uint16_t crc16_compute(const crc16_engine *e, const uint8_t *p, size_t len){
+	return (uint16_t)(e->update(e, e->init, p, len) ^ e->xorout);
+}
+
+uint16_t crc16_update_slice8(const crc16_engine *e, uint16_t crc, const uint8_t *p, size_t len){
+	const uint16_t (*t)[256] = e->table;
+
+	while (len >= 8){
+		crc = t[7][p[0] ^ (crc >> 8)] ^ t[6][p[1] ^ (crc & 0xFF)] ^
+			  t[5][p[2]] ^ t[4][p[3]] ^ t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+		p += 8;
+		len -= 8;
+	}
+
+	while (len--) crc = (uint16_t)((crc << 8) ^ t[0][(crc >> 8) ^ *p++]);
+
+	return crc;
+}
+
+#if CRC_HAVE_X86_CLMUL
+
+int crc16_has_clmul(void){
+	return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+}
+
+/*
+* Folding: the message is kept as 128 bit blocks whose polynomial is congruent
+* (mod P) to everything read so far. A block 16*n bytes ahead is folded in by
+* multiplying its halves by x^(128n+64) and x^(128n) mod P; the 128 bits left
+* at the end and the tail go through the slicing-by-8 tables.
+*/
+__attribute__((target("pclmul,ssse3")))
+static inline __m128i fold(__m128i x, __m128i k){
+	return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x11), _mm_clmulepi64_si128(x, k, 0x00));
+}
+
+__attribute__((target("pclmul,ssse3")))
+uint16_t crc16_update_clmul(const crc16_engine *e, uint16_t crc, const uint8_t *p, size_t len){
+	const __m128i bswap = _mm_set_epi8(0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15);
+	__m128i x0, x1, x2, x3, k;
+	uint8_t last[16];
+
+	if (len < 64) return crc16_update_slice8(e, crc, p, len);
+
+	// the register is the same as xor-ing it into the first two octets
+	x0 = _mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)p), bswap),
+					   _mm_set_epi64x((long long)((uint64_t)crc << 48), 0));
+	x1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 16)), bswap);
+	x2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 32)), bswap);
+	x3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 48)), bswap);
+	p += 64;
+	len -= 64;
+
+	k = _mm_set_epi64x((long long)e->fold[3][1], (long long)e->fold[3][0]);
+	while (len >= 64){
+		x0 = _mm_xor_si128(fold(x0, k), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)p), bswap));
+		x1 = _mm_xor_si128(fold(x1, k), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 16)), bswap));
+		x2 = _mm_xor_si128(fold(x2, k), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 32)), bswap));
+		x3 = _mm_xor_si128(fold(x3, k), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 48)), bswap));
+		p += 64;
+		len -= 64;
+	}
+
+	x0 = fold(x0, _mm_set_epi64x((long long)e->fold[2][1], (long long)e->fold[2][0]));
+	x1 = fold(x1, _mm_set_epi64x((long long)e->fold[1][1], (long long)e->fold[1][0]));
+	x2 = fold(x2, _mm_set_epi64x((long long)e->fold[0][1], (long long)e->fold[0][0]));
+	x0 = _mm_xor_si128(_mm_xor_si128(x0, x1), _mm_xor_si128(x2, x3));
+
+	k = _mm_set_epi64x((long long)e->fold[0][1], (long long)e->fold[0][0]);
+	while (len >= 16){
+		x0 = _mm_xor_si128(fold(x0, k), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)p), bswap));
+		p += 16;
+		len -= 16;
+	}
+
+	_mm_storeu_si128((__m128i *)last, _mm_shuffle_epi8(x0, bswap));
+	crc = crc16_update_slice8(e, 0, last, sizeof(last));
+
+	return crc16_update_slice8(e, crc, p, len);
+}
+
+#else
+
+int crc16_has_clmul(void){
+	return 0;
+}
+
+uint16_t crc16_update_clmul(const crc16_engine *e, uint16_t crc, const uint8_t *p, size_t len){
+	return crc16_update_slice8(e, crc, p, len);
+}
+
+#endif
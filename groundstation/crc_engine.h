@@ -0,0 +1,45 @@
+//============================================================================
+// Name        : crc_engine.h
+// Description : Reentrant CRC-16 engine (slicing-by-8 and carry-less multiply)
+//============================================================================
+
+#ifndef CRC_ENGINE_H_
+#define CRC_ENGINE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+* Non reflected 16 bit CRCs (refin = refout = 0), e.g. the CRC-CCITT of the
+* AX.25 FCS: crc16_engine_init(&e, 0x1021, 0xFFFF, 0x0000).
+*
+* All the state lives in the crc16_engine, which is only read after
+* crc16_engine_init(), so one engine can be shared by any number of threads.
+*/
+
+typedef struct crc16_engine crc16_engine;
+
+typedef uint16_t (*crc16_update_fn)(const crc16_engine *e, uint16_t crc, const uint8_t *p, size_t len);
+
+struct crc16_engine {
+	uint16_t polynom;
+	uint16_t init;
+	uint16_t xorout;
+	uint16_t table[8][256];		// table[k][b]: byte b followed by k zero bytes
+	uint64_t fold[4][2];		// x^(128*(i+1)) and x^(128*(i+1)+64) mod P
+	crc16_update_fn update;		// fastest kernel supported by this CPU
+};
+
+void crc16_engine_init(crc16_engine *e, uint16_t polynom, uint16_t init, uint16_t xorout);
+
+/* Complete CRC (init and xorout applied) with the dispatched kernel */
+uint16_t crc16_compute(const crc16_engine *e, const uint8_t *p, size_t len);
+
+/* Raw register update (no init/xorout), for data split in several blocks */
+uint16_t crc16_update_slice8(const crc16_engine *e, uint16_t crc, const uint8_t *p, size_t len);
+uint16_t crc16_update_clmul(const crc16_engine *e, uint16_t crc, const uint8_t *p, size_t len);
+
+/* 1 if crc16_update_clmul() can run on this CPU */
+int crc16_has_clmul(void);
+
+#endif /* CRC_ENGINE_H_ */
@@ -0,0 +1,116 @@
+//============================================================================
+// Name        : crc_template.h
+// Description : Parameterised CRC with lookup tables generated at compile time
+//============================================================================
+
+#ifndef CRC_TEMPLATE_H_
+#define CRC_TEMPLATE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+/*
+* Same parameters as the "crctester" model used before in crc.cpp:
+*   Order   - 8, 16, 24 or 32 (table algorithm)
+*   Polynom - polynomial without the leading term, not reflected
+*   Init    - direct initial value
+*   XorOut  - final xor
+*   RefIn, RefOut - reflected input octets / output
+*
+* The tables are constexpr, so there is no init call and nothing mutable:
+* any number of threads can use a model at the same time.
+*/
+
+template <typename T>
+struct crc_table {
+	T v[256];
+};
+
+template <int Order, uint32_t Polynom, uint32_t Init, uint32_t XorOut, bool RefIn, bool RefOut>
+struct crc_model {
+	static_assert(Order >= 8 && Order <= 32 && Order % 8 == 0, "table CRC needs an order of 8, 16, 24 or 32");
+
+	typedef typename std::conditional<(Order <= 8), uint8_t,
+			typename std::conditional<(Order <= 16), uint16_t, uint32_t>::type>::type value_type;
+
+	static constexpr uint32_t mask = (((uint32_t)1 << (Order-1)) - 1) << 1 | 1;
+	static constexpr uint32_t highbit = (uint32_t)1 << (Order-1);
+
+	static_assert((Polynom & mask) == Polynom, "invalid polynom");
+	static_assert((Init & mask) == Init, "invalid init");
+	static_assert((XorOut & mask) == XorOut, "invalid xorout");
+
+	/* reflects the lower 'bitnum' bits of 'crc' */
+	static constexpr uint32_t reflect(uint32_t crc, int bitnum){
+		uint32_t out = 0;
+
+		for (int i=0; i<bitnum; i++)
+			if (crc & ((uint32_t)1 << i)) out |= (uint32_t)1 << (bitnum-1-i);
+		return out;
+	}
+
+	static constexpr crc_table<value_type> make_table(){
+		crc_table<value_type> t = {};
+
+		for (int i=0; i<256; i++){
+			uint32_t crc = (uint32_t)i;
+
+			if (RefIn) crc = reflect(crc, 8);
+			crc <<= Order-8;
+
+			for (int j=0; j<8; j++)
+				crc = (crc & highbit) ? (crc << 1) ^ Polynom : crc << 1;
+
+			if (RefIn) crc = reflect(crc, Order);
+			t.v[i] = (value_type)(crc & mask);
+		}
+		return t;
+	}
+
+	static constexpr crc_table<value_type> table = make_table();
+
+	/* Register before the first octet */
+	static constexpr uint32_t start(){
+		return RefIn ? reflect(Init, Order) : Init;
+	}
+
+	/* Raw register update, for data split in several blocks */
+	static constexpr uint32_t update(uint32_t crc, const uint8_t *p, size_t len){
+		if (RefIn)
+			while (len--) crc = (crc >> 8) ^ table.v[(crc & 0xFF) ^ *p++];
+		else
+			while (len--) crc = ((crc << 8) ^ table.v[((crc >> (Order-8)) & 0xFF) ^ *p++]) & mask;
+		return crc;
+	}
+
+	static constexpr value_type finish(uint32_t crc){
+		if (RefOut != RefIn) crc = reflect(crc, Order);
+		return (value_type)((crc ^ XorOut) & mask);
+	}
+
+	static constexpr value_type compute(const uint8_t *p, size_t len){
+		return finish(update(start(), p, len));
+	}
+
+	/* Compile time check value of "123456789" */
+	static constexpr value_type check(){
+		const uint8_t s[] = {'1','2','3','4','5','6','7','8','9'};
+		return compute(s, sizeof(s));
+	}
+};
+
+template <int Order, uint32_t Polynom, uint32_t Init, uint32_t XorOut, bool RefIn, bool RefOut>
+constexpr crc_table<typename crc_model<Order, Polynom, Init, XorOut, RefIn, RefOut>::value_type>
+	crc_model<Order, Polynom, Init, XorOut, RefIn, RefOut>::table;
+
+/* AX.25 FCS of this groundstation (see ax25_encoder.h) */
+typedef crc_model<16, 0x1021, 0xFFFF, 0x0000, false, false> crc_ccitt;
+
+/* CRC8() of the OBDH uG frame (obdh/obdh_v1/util/crc.c): 0x8C is 0x31 reflected */
+typedef crc_model<8, 0x31, 0x00, 0x00, true, true> crc8_ug;
+
+static_assert(crc_ccitt::check() == 0x29B1, "CRC-CCITT check value");
+static_assert(crc8_ug::check() == 0xA1, "CRC-8 (0x8C) check value");
+
+#endif /* CRC_TEMPLATE_H_ */
@@ -0,0 +1,102 @@
+//============================================================================
+// Name        : dedup_index.cpp
+// Description : Bounded index of the frames already received, to drop duplicates
+//============================================================================
+
+#include <string.h>
+#include <algorithm>
+
+#include "dedup_index.h"
+
+#define MIX_K1	0x9E3779B97F4A7C15ULL
+#define MIX_K2	0xBF58476D1CE4E5B9ULL
+#define MIX_K3	0x94D049BB133111EBULL
+
+static inline uint64_t mix64(uint64_t x){
+	x ^= x >> 30;
+	x *= MIX_K2;
+	x ^= x >> 27;
+	x *= MIX_K3;
+	return x ^ (x >> 31);
+}
+
+void dedup_init(dedup_index *d, size_t capacity, double window){
+	size_t n = 16;
+
+	while (n < capacity) n <<= 1;
+	d->table[0].assign(n, 0);
+	d->table[1].assign(n, 0);
+	d->mask = n - 1;
+	d->used = 0;
+	d->cur = 0;
+	d->window = window;
+	d->gen_start = 0;
+	d->frames = 0;
+	d->duplicates = 0;
+	d->early_rotations = 0;
+}
+
+/* 8 octets at a time, then the tail and the length */
+uint64_t dedup_key(const uint8_t *frame, size_t len){
+	uint64_t h = MIX_K1 ^ len, w;
+	size_t i;
+
+	for (i=0; i+8<=len; i+=8){
+		memcpy(&w, frame + i, 8);
+		h = mix64(h ^ w) + MIX_K1;
+	}
+	if (i < len){
+		w = 0;
+		memcpy(&w, frame + i, len - i);
+		h = mix64(h ^ w) + MIX_K1;
+	}
+	h = mix64(h);
+
+	return h ? h : 1;
+}
+
+static int find(const std::vector<uint64_t> &t, size_t mask, uint64_t key){
+	size_t i;
+
+	for (i=key & mask; t[i]; i=(i + 1) & mask)
+		if (t[i] == key) return 1;
+	return 0;
+}
+
+static void rotate(dedup_index *d, double time){
+	d->cur ^= 1;
+	std::fill(d->table[d->cur].begin(), d->table[d->cur].end(), 0);
+	d->used = 0;
+	d->gen_start = time;
+}
+
+int dedup_check(dedup_index *d, uint64_t key, double time){
+	size_t i;
+
+	d->frames++;
+
+	if (d->used == 0) d->gen_start = time;
+	else if (time - d->gen_start >= 2*d->window){	// both tables are out of the window
+		rotate(d, time);
+		rotate(d, time);
+	}
+	else if (time - d->gen_start >= d->window) rotate(d, time);
+
+	if (find(d->table[d->cur], d->mask, key) || find(d->table[d->cur ^ 1], d->mask, key)){
+		d->duplicates++;
+		return 1;
+	}
+
+	// at most half full, so the probes stay short
+	if (d->used >= (d->mask + 1)/2){
+		d->early_rotations++;
+		rotate(d, time);
+	}
+
+	std::vector<uint64_t> &t = d->table[d->cur];
+	for (i=key & d->mask; t[i]; i=(i + 1) & d->mask);
+	t[i] = key;
+	d->used++;
+
+	return 0;
+}
@@ -0,0 +1,53 @@
+//============================================================================
+// Name        : dedup_index.h
+// Description : Bounded index of the frames already received, to drop duplicates
+//============================================================================
+
+#ifndef DEDUP_INDEX_H_
+#define DEDUP_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/*
+* The key of a frame is a 64 bit hash of its octets: addresses (source),
+* control, PID, Info and FCS. The satellite puts its own time in the telemetry
+* (OBDH sysclock of the uG frame), so copies of one frame heard by several
+* stations share the key while two frames sent at different times don't.
+* Frames without a time stamp (the "FloripaSat" beacon) are collapsed to one
+* per window.
+*
+* The index keeps only the keys, in two open addressing tables (linear
+* probing) used as generations: keys go to the current one, lookups see both,
+* and when the current table is 'window' seconds old (or half full) it becomes
+* the previous one and the old previous one is cleared. A copy is caught if it
+* arrives within 'window' seconds of the first one, and memory is fixed at
+* 2*capacity*8 octets. Frames must be given in time order.
+*/
+
+typedef struct {
+	std::vector<uint64_t> table[2];		// 0 is an empty slot
+	size_t mask;
+	size_t used;						// keys in the current table
+	int cur;
+	double window;
+	double gen_start;					// time of the first key of the current table
+
+	uint64_t frames;					// statistics
+	uint64_t duplicates;
+	uint64_t early_rotations;			// current table filled before the window ended
+} dedup_index;
+
+#define DEDUP_CAPACITY		((size_t)1 << 16)	// keys per table, 1 MiB for both
+
+/* capacity is rounded up to a power of two */
+void dedup_init(dedup_index *d, size_t capacity, double window);
+
+/* Key of the octets between the flags (FCS included), never 0 */
+uint64_t dedup_key(const uint8_t *frame, size_t len);
+
+/* 1 if the key was seen in the window, else adds it and returns 0 */
+int dedup_check(dedup_index *d, uint64_t key, double time);
+
+#endif /* DEDUP_INDEX_H_ */
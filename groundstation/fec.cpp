@@ -0,0 +1,386 @@
+//============================================================================
+// Name        : fec.cpp
+// Description : FEC decoder of the downlink blocks: Viterbi K=7 r=1/2 and RS(255,223)
+//============================================================================
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "fec.h"
+
+// same code as obdh/obdh_v1/util/fec.c
+#define GF_POLY		0x187		// x^8+x^7+x^2+x+1
+#define RS_FCR		112
+#define RS_PRIM		11
+#define RS_IPRIM	116			// 11*116 = 1 mod 255
+#define A0			FEC_RS_N	// log of zero
+
+#define CONV_POLY_A	0x4F		// 171 octal, newest bit in bit 0
+#define CONV_POLY_B	0x6D		// 133 octal
+
+#define BM_MAX		(4*127)		// branch metric of two symbols, both wrong
+
+typedef struct {
+	uint8_t exp[256];
+	uint8_t log[256];
+	uint8_t symbols[128];		// G1 (bit 1) and G2 (bit 0) of a shift register value
+} fec_tables;
+
+static int parity(unsigned int x){
+	x ^= x >> 4;
+	x ^= x >> 2;
+	x ^= x >> 1;
+	return x & 1;
+}
+
+static const fec_tables &tables(){
+	static fec_tables t;
+	static bool ready = false;
+
+	if (!ready){
+		unsigned int sr = 1, i;
+
+		for (i=0; i<FEC_RS_N; i++){
+			t.log[sr] = (uint8_t)i;
+			t.exp[i] = (uint8_t)sr;
+			sr <<= 1;
+			if (sr & 0x100) sr ^= GF_POLY;
+		}
+		t.log[0] = A0;
+		t.exp[A0] = 0;
+		for (i=0; i<128; i++) t.symbols[i] = (uint8_t)(parity(i & CONV_POLY_A) << 1 | parity(i & CONV_POLY_B));
+		ready = true;
+	}
+	return t;
+}
+
+static inline int modnn(int x){
+	while (x >= FEC_RS_N){
+		x -= FEC_RS_N;
+		x = (x >> 8) + (x & FEC_RS_N);
+	}
+	return x;
+}
+
+int fec_decoder_init(fec_decoder *d, size_t len, int depth){
+	if (depth < 1 || depth > FEC_DEPTH_MAX || len < (size_t)depth || len > (size_t)FEC_RS_K*depth) return -1;
+
+	tables();
+	d->len = len;
+	d->depth = depth;
+	d->block.assign(fec_rs_block_length(len, depth), 0);
+	d->decisions.assign(8*d->block.size() + FEC_K - 1, 0);
+	return 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Viterbi
+
+/*
+* States are the last 6 input bits, newest in bit 0. The old states i and i+32
+* both lead to the new states 2i (input 0) and 2i+1 (input 1); as both
+* polynomials tap the newest and the oldest bit, the branch from i+32 and the
+* branch with input 1 send the complement of the symbols of i with input 0:
+*
+*   new[2i]   = min(old[i] + bm[i],          old[i+32] + BM_MAX - bm[i])
+*   new[2i+1] = min(old[i] + BM_MAX - bm[i], old[i+32] + bm[i])
+*
+* The decision bit of a new state is 1 when it comes from i+32.
+* bm[i] = cost(G1) + cost(G2), cost = 127 - s if the symbol is '1', 127 + s if '0'.
+*/
+
+static inline int clip(int8_t s){
+	return s < -127 ? -127 : s;
+}
+
+#ifdef __SSE2__
+
+static void acs(const int8_t *soft, size_t steps, uint64_t *decisions){
+	const fec_tables &t = tables();
+	__m128i m[8], sign0[4], sign1[4];
+	int16_t s0[32], s1[32];
+	size_t k;
+	int i;
+
+	// -1 where the expected symbol of old state i, input 0, is '1' (the cost is 127 - s)
+	for (i=0; i<32; i++){
+		s0[i] = (int16_t)-(t.symbols[2*i] >> 1);
+		s1[i] = (int16_t)-(t.symbols[2*i] & 1);
+	}
+	for (i=0; i<4; i++){
+		sign0[i] = _mm_loadu_si128((const __m128i *)(s0 + 8*i));
+		sign1[i] = _mm_loadu_si128((const __m128i *)(s1 + 8*i));
+	}
+
+	// the encoder starts at state 0
+	for (i=0; i<8; i++) m[i] = _mm_set1_epi16(3000);
+	m[0] = _mm_insert_epi16(m[0], 0, 0);
+
+	const __m128i half = _mm_set1_epi16(BM_MAX/2), full = _mm_set1_epi16(BM_MAX);
+
+	for (k=0; k<steps; k++){
+		__m128i a = _mm_set1_epi16((int16_t)clip(soft[2*k]));
+		__m128i b = _mm_set1_epi16((int16_t)clip(soft[2*k+1]));
+		__m128i n[8];
+		uint64_t dec = 0;
+
+		for (i=0; i<4; i++){
+			// (s ^ sign) - sign negates s where sign is -1
+			__m128i bm = _mm_add_epi16(half, _mm_add_epi16(_mm_sub_epi16(_mm_xor_si128(a, sign0[i]), sign0[i]),
+														   _mm_sub_epi16(_mm_xor_si128(b, sign1[i]), sign1[i])));
+			__m128i cm = _mm_sub_epi16(full, bm);
+			__m128i e0 = _mm_add_epi16(m[i], bm), e1 = _mm_add_epi16(m[i+4], cm);
+			__m128i o0 = _mm_add_epi16(m[i], cm), o1 = _mm_add_epi16(m[i+4], bm);
+			__m128i de = _mm_cmpgt_epi16(e0, e1), dd = _mm_cmpgt_epi16(o0, o1);
+			__m128i even = _mm_min_epi16(e0, e1), odd = _mm_min_epi16(o0, o1);
+
+			n[2*i] = _mm_unpacklo_epi16(even, odd);
+			n[2*i+1] = _mm_unpackhi_epi16(even, odd);
+			dec |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_packs_epi16(_mm_unpacklo_epi16(de, dd),
+																		  _mm_unpackhi_epi16(de, dd))) << (16*i);
+		}
+		decisions[k] = dec;
+
+		// metrics relative to state 0, they stay within (K-1)*BM_MAX of each other
+		__m128i ref = _mm_set1_epi16((int16_t)_mm_extract_epi16(n[0], 0));
+		for (i=0; i<8; i++) m[i] = _mm_sub_epi16(n[i], ref);
+	}
+}
+
+#else
+
+static void acs(const int8_t *soft, size_t steps, uint64_t *decisions){
+	const fec_tables &t = tables();
+	int16_t m[64], n[64];
+	size_t k;
+	int i;
+
+	for (i=0; i<64; i++) m[i] = 3000;
+	m[0] = 0;
+
+	for (k=0; k<steps; k++){
+		int a = clip(soft[2*k]), b = clip(soft[2*k+1]);
+		uint64_t dec = 0;
+
+		for (i=0; i<32; i++){
+			int sym = t.symbols[2*i];
+			int bm = BM_MAX/2 + (sym & 2 ? -a : a) + (sym & 1 ? -b : b);
+			int e0 = m[i] + bm, e1 = m[i+32] + BM_MAX - bm;
+			int o0 = m[i] + BM_MAX - bm, o1 = m[i+32] + bm;
+
+			n[2*i] = (int16_t)std::min(e0, e1);
+			n[2*i+1] = (int16_t)std::min(o0, o1);
+			dec |= (uint64_t)(e0 > e1) << (2*i) | (uint64_t)(o0 > o1) << (2*i+1);
+		}
+		decisions[k] = dec;
+		for (i=0; i<64; i++) m[i] = (int16_t)(n[i] - n[0]);
+	}
+}
+
+#endif
+
+int viterbi_decode(fec_decoder *d, const int8_t *soft, size_t nbits, uint8_t *out){
+	const fec_tables &t = tables();
+	size_t steps = nbits + FEC_K - 1, k;
+	unsigned int state = 0, sr = 0;
+	int errors = 0;
+
+	if (d->decisions.size() < steps) d->decisions.resize(steps);
+	acs(soft, steps, d->decisions.data());
+
+	// the tail leaves the encoder at state 0
+	memset(out, 0, (nbits + 7)/8);
+	for (k=steps; k-- > 0; ){
+		unsigned int bit = state & 1;
+
+		if (k < nbits) out[k/8] |= (uint8_t)(bit << (7 - k%8));
+		state = (state >> 1) | (unsigned int)((d->decisions[k] >> state) & 1) << 5;
+	}
+
+	// re-encode to count the symbols the channel flipped
+	for (k=0; k<steps; k++){
+		unsigned int bit = k < nbits ? (out[k/8] >> (7 - k%8)) & 1 : 0;
+		unsigned int sym;
+
+		sr = ((sr << 1) | bit) & 0x7F;
+		sym = t.symbols[sr];
+		errors += ((sym >> 1) != (unsigned int)(soft[2*k] > 0)) + ((sym & 1) != (unsigned int)(soft[2*k+1] > 0));
+	}
+
+	return errors;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Reed-Solomon
+
+int rs_decode(uint8_t *data, int pad){
+	const fec_tables &t = tables();
+	const int nn = FEC_RS_N - pad;
+	int s[FEC_RS_PARITY], lambda[FEC_RS_PARITY+1], b[FEC_RS_PARITY+1], tmp[FEC_RS_PARITY+1];
+	int omega[FEC_RS_PARITY+1], reg[FEC_RS_PARITY+1], root[FEC_RS_PARITY], loc[FEC_RS_PARITY];
+	int i, j, k, r, el, discr, deg_lambda, deg_omega, count, syn_error = 0;
+
+	if (pad < 0 || nn <= FEC_RS_PARITY) return -1;
+
+	// syndromes, evaluated at the roots alpha^(prim*(fcr+i))
+	for (i=0; i<FEC_RS_PARITY; i++) s[i] = data[0];
+	for (j=1; j<nn; j++){
+		for (i=0; i<FEC_RS_PARITY; i++){
+			if (s[i] == 0) s[i] = data[j];
+			else s[i] = data[j] ^ t.exp[modnn(t.log[s[i]] + (RS_FCR + i)*RS_PRIM)];
+		}
+	}
+	for (i=0; i<FEC_RS_PARITY; i++){
+		syn_error |= s[i];
+		s[i] = t.log[s[i]];
+	}
+	if (!syn_error) return 0;
+
+	// Berlekamp-Massey: error locator lambda
+	memset(lambda, 0, sizeof(lambda));
+	lambda[0] = 1;
+	for (i=0; i<=FEC_RS_PARITY; i++) b[i] = t.log[lambda[i]];
+
+	for (r=1, el=0; r<=FEC_RS_PARITY; r++){
+		discr = 0;
+		for (i=0; i<r; i++){
+			if (lambda[i] != 0 && s[r-i-1] != A0) discr ^= t.exp[modnn(t.log[lambda[i]] + s[r-i-1])];
+		}
+		discr = t.log[discr];
+
+		if (discr == A0){
+			memmove(&b[1], b, FEC_RS_PARITY*sizeof(b[0]));
+			b[0] = A0;
+			continue;
+		}
+
+		tmp[0] = lambda[0];
+		for (i=0; i<FEC_RS_PARITY; i++){
+			if (b[i] != A0) tmp[i+1] = lambda[i+1] ^ t.exp[modnn(discr + b[i])];
+			else tmp[i+1] = lambda[i+1];
+		}
+		if (2*el <= r - 1){
+			el = r - el;
+			for (i=0; i<=FEC_RS_PARITY; i++) b[i] = lambda[i] == 0 ? A0 : modnn(t.log[lambda[i]] - discr + FEC_RS_N);
+		}
+		else {
+			memmove(&b[1], b, FEC_RS_PARITY*sizeof(b[0]));
+			b[0] = A0;
+		}
+		memcpy(lambda, tmp, sizeof(lambda));
+	}
+
+	deg_lambda = 0;
+	for (i=0; i<=FEC_RS_PARITY; i++){
+		lambda[i] = t.log[lambda[i]];
+		if (lambda[i] != A0) deg_lambda = i;
+	}
+	if (deg_lambda > FEC_RS_PARITY/2) return -1;
+
+	// Chien search: the roots of lambda are the inverses of the error locations
+	memcpy(&reg[1], &lambda[1], FEC_RS_PARITY*sizeof(reg[0]));
+	count = 0;
+	for (i=1, k=RS_IPRIM-1; i<=FEC_RS_N; i++, k=modnn(k + RS_IPRIM)){
+		int q = 1;
+
+		for (j=deg_lambda; j>0; j--){
+			if (reg[j] != A0){
+				reg[j] = modnn(reg[j] + j);
+				q ^= t.exp[reg[j]];
+			}
+		}
+		if (q != 0) continue;
+		root[count] = i;
+		loc[count] = k;
+		if (++count == deg_lambda) break;
+	}
+	if (count != deg_lambda) return -1;
+
+	// error evaluator omega = s*lambda mod x^32
+	deg_omega = deg_lambda - 1;
+	for (i=0; i<=deg_omega; i++){
+		int v = 0;
+
+		for (j=i; j>=0; j--){
+			if (s[i-j] != A0 && lambda[j] != A0) v ^= t.exp[modnn(s[i-j] + lambda[j])];
+		}
+		omega[i] = t.log[v];
+	}
+
+	// Forney: error value = omega(x)*x^(fcr-1) / lambda'(x) at the inverse of the location
+	for (j=count-1; j>=0; j--){
+		int num1 = 0, num2, den = 0;
+
+		for (i=deg_omega; i>=0; i--){
+			if (omega[i] != A0) num1 ^= t.exp[modnn(omega[i] + i*root[j])];
+		}
+		num2 = t.exp[modnn(root[j]*(RS_FCR - 1) + FEC_RS_N)];
+		for (i=std::min(deg_lambda, FEC_RS_PARITY - 1) & ~1; i>=0; i-=2){
+			if (lambda[i+1] != A0) den ^= t.exp[modnn(lambda[i+1] + i*root[j])];
+		}
+		if (den == 0) return -1;
+		if (loc[j] < pad) return -1;		// an error in the bytes the shortened code doesn't send
+		if (num1 != 0) data[loc[j] - pad] ^= t.exp[modnn(t.log[num1] + t.log[num2] + FEC_RS_N - t.log[den])];
+	}
+
+	return count;
+}
+
+fec_result fec_rs_decode_block(uint8_t *block, size_t len, int depth){
+	fec_result res = {0, 0, 0};
+	uint8_t cw[FEC_RS_N];
+	int i;
+
+	for (i=0; i<depth; i++){
+		size_t count = (len - i + depth - 1)/depth, j;
+		int n;
+
+		for (j=0; j<count; j++) cw[j] = block[i + j*depth];
+		for (j=0; j<FEC_RS_PARITY; j++) cw[count + j] = block[len + i + j*depth];
+
+		n = rs_decode(cw, (int)(FEC_RS_K - count));
+		if (n < 0){
+			res.corrected = -1;
+			continue;
+		}
+		if (res.corrected >= 0) res.corrected += n;
+		res.worst = std::max(res.worst, n);
+		for (j=0; j<count; j++) block[i + j*depth] = cw[j];
+		for (j=0; j<FEC_RS_PARITY; j++) block[len + i + j*depth] = cw[count + j];
+	}
+
+	return res;
+}
+
+fec_result fec_decode(fec_decoder *d, const int8_t *soft, uint8_t *out){
+	int errors = viterbi_decode(d, soft, 8*d->block.size(), d->block.data());
+	fec_result res = fec_rs_decode_block(d->block.data(), d->len, d->depth);
+
+	res.bit_errors = errors;
+	memcpy(out, d->block.data(), d->len);
+	return res;
+}
+
+size_t fec_find_asm(const int8_t *soft, size_t n, float threshold){
+	int pattern[FEC_ASM_BITS];
+	size_t k;
+	int i;
+
+	for (i=0; i<FEC_ASM_BITS; i++) pattern[i] = (FEC_ASM >> (FEC_ASM_BITS - 1 - i)) & 1 ? 1 : -1;
+
+	for (k=0; k+FEC_ASM_BITS<=n; k++){
+		int corr = 0, energy = 0;
+
+		for (i=0; i<FEC_ASM_BITS; i++){
+			corr += pattern[i]*soft[k+i];
+			energy += abs(soft[k+i]);
+		}
+		if (corr > 0 && corr >= threshold*energy) return k + FEC_ASM_BITS;
+	}
+	return n;
+}
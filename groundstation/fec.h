@@ -0,0 +1,94 @@
+//============================================================================
+// Name        : fec.h
+// Description : FEC decoder of the downlink blocks: Viterbi K=7 r=1/2 and RS(255,223)
+//============================================================================
+
+#ifndef FEC_H_
+#define FEC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/*
+* Decodes the blocks of obdh/obdh_v1/util/fec.c:
+*
+* | ASM 0x1ACFFC1D | conv K=7 r=1/2 ( data | RS parity, interleaved by depth ) |
+*
+* The frame length and the interleaving depth are not sent: both ends use the
+* same values for a kind of frame.
+*
+* Input is the soft bits of iq_demod -S (one int8 per bit, positive for '1',
+* 0 for an erasure), with -n: the block goes to the radio as is, without NRZI
+* and bit stuffing.
+*
+* The Viterbi add-compare-select runs on 16 bit metrics with SSE2, 32
+* butterflies in 4 vectors per bit, with a scalar version for other targets.
+* RS decoding is Berlekamp-Massey, Chien search and Forney on log tables.
+*/
+
+#define FEC_RS_N			255
+#define FEC_RS_K			223
+#define FEC_RS_PARITY		32
+#define FEC_DEPTH_MAX		8
+#define FEC_ASM				0x1ACFFC1DUL
+#define FEC_ASM_BITS		32
+#define FEC_K				7			// constraint length
+
+/* Bytes of the RS block of a frame */
+static inline size_t fec_rs_block_length(size_t len, int depth){
+	return len + FEC_RS_PARITY*(size_t)depth;
+}
+
+/* Soft bits after the ASM: coded RS block and tail */
+static inline size_t fec_coded_bits(size_t len, int depth){
+	return 2*(8*fec_rs_block_length(len, depth) + FEC_K - 1);
+}
+
+typedef struct {
+	size_t len;							// frame bytes
+	int depth;							// RS interleaving
+	std::vector<uint64_t> decisions;	// one bit per state and input bit
+	std::vector<uint8_t> block;			// RS block out of the Viterbi decoder
+} fec_decoder;
+
+typedef struct {
+	int corrected;			// RS symbols corrected, -1 if a codeword failed
+	int worst;				// most symbols corrected in one codeword
+	int bit_errors;			// coded bits that differ from the re-encoded Viterbi output
+} fec_result;
+
+/* Returns 0 on success, -1 if len/depth can't be encoded (depth <= len <= 223*depth) */
+int fec_decoder_init(fec_decoder *d, size_t len, int depth);
+
+/*
+* Viterbi: nbits data bits (plus the 6 tail bits) from 2*(nbits + 6) soft
+* symbols, packed MSB first into out. Returns the number of symbols whose
+* sign disagrees with the decoded path (channel bit errors).
+*/
+int viterbi_decode(fec_decoder *d, const int8_t *soft, size_t nbits, uint8_t *out);
+
+/*
+* Corrects one codeword in place: 255 - pad bytes, data then parity.
+* Returns the symbols corrected or -1 if it can't be corrected.
+*/
+int rs_decode(uint8_t *codeword, int pad);
+
+/* Corrects an interleaved RS block in place, see fec_result */
+fec_result fec_rs_decode_block(uint8_t *block, size_t len, int depth);
+
+/*
+* Decodes the fec_coded_bits() soft bits following an ASM; the frame goes to
+* out (len bytes) and is valid if result.corrected >= 0.
+*/
+fec_result fec_decode(fec_decoder *d, const int8_t *soft, uint8_t *out);
+
+/*
+* Searches soft[0..n) for the ASM: returns the position of the first bit after it
+* or n if there is none. A match is a correlation of at least threshold (0..1)
+* times the energy of the 32 soft bits; 0,7 misses few ASMs at Es/N0 ~2 dB and
+* finds one in coded data once in ~10^5 bits.
+*/
+size_t fec_find_asm(const int8_t *soft, size_t n, float threshold);
+
+#endif /* FEC_H_ */
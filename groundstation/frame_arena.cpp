@@ -0,0 +1,91 @@
+//============================================================================
+// Name        : frame_arena.cpp
+// Description : Bump allocator for the per-frame decode state
+//============================================================================
+
+#include <stdlib.h>
+
+#include "frame_arena.h"
+
+struct arena_chunk {
+	arena_chunk *next;
+	size_t size;				// octets in data
+	alignas(16) uint8_t data[1];
+};
+
+void frame_arena_init(frame_arena *a, size_t chunk_size){
+	a->head = NULL;
+	a->chunks = NULL;
+	a->used = 0;
+	a->chunk_size = chunk_size ? chunk_size : FRAME_ARENA_CHUNK;
+	a->allocated = 0;
+	a->peak = 0;
+	a->mallocs = 0;
+}
+
+void frame_arena_free(frame_arena *a){
+	arena_chunk *c, *next;
+
+	for (c=a->chunks; c; c=next){
+		next = c->next;
+		free(c);
+	}
+	a->head = a->chunks = NULL;
+	a->used = 0;
+	a->allocated = 0;
+}
+
+void frame_arena_reset(frame_arena *a){
+	a->head = a->chunks;
+	a->used = 0;
+	a->allocated = 0;
+}
+
+void *frame_arena_alloc(frame_arena *a, size_t size, size_t align){
+	size_t off;
+	arena_chunk *c;
+
+	for (;;){
+		if (a->head){
+			off = (a->used + align - 1) & ~(align - 1);
+			if (off + size <= a->head->size){
+				a->used = off + size;
+				a->allocated += size;
+				if (a->allocated > a->peak) a->peak = a->allocated;
+				return a->head->data + off;
+			}
+			// next chunk kept from before the reset, if any
+			if (a->head->next){
+				a->head = a->head->next;
+				a->used = 0;
+				continue;
+			}
+		}
+
+		// new chunk at the end of the list, big enough for this allocation
+		size_t n = size + align > a->chunk_size ? size + align : a->chunk_size;
+		if ((c = (arena_chunk *)malloc(sizeof(arena_chunk) + n)) == NULL) return NULL;
+		c->next = NULL;
+		c->size = n;
+		a->mallocs++;
+
+		if (a->head) a->head->next = c;
+		else a->chunks = c;
+		a->head = c;
+		a->used = 0;
+	}
+}
+
+namespace {
+struct local_arena {
+	frame_arena a;
+	local_arena(){ frame_arena_init(&a, FRAME_ARENA_CHUNK); }
+	~local_arena(){ frame_arena_free(&a); }
+};
+}
+
+frame_arena *frame_arena_local(void){
+	static thread_local local_arena local;
+
+	return &local.a;
+}
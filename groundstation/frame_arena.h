@@ -0,0 +1,53 @@
+//============================================================================
+// Name        : frame_arena.h
+// Description : Bump allocator for the per-frame decode state
+//============================================================================
+
+#ifndef FRAME_ARENA_H_
+#define FRAME_ARENA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+* Allocations are carved out of large chunks and are never freed one by one:
+* frame_arena_reset() drops them all at once and keeps the chunks, so after
+* the first batch a decoder gets its memory without calling malloc.
+*
+* An arena belongs to one thread. frame_arena_local() gives each thread its
+* own, so a decoder working on frame_arena_local() is reentrant.
+*/
+
+#define FRAME_ARENA_CHUNK	((size_t)256 << 10)
+
+typedef struct arena_chunk arena_chunk;
+
+typedef struct {
+	arena_chunk *head;			// chunk being filled
+	arena_chunk *chunks;		// all the chunks, in allocation order
+	size_t used;				// octets used in head
+	size_t chunk_size;
+
+	size_t allocated;			// octets handed out since the last reset
+	size_t peak;
+	uint64_t mallocs;			// chunks allocated in the lifetime of the arena
+} frame_arena;
+
+void frame_arena_init(frame_arena *a, size_t chunk_size);
+void frame_arena_free(frame_arena *a);
+
+/* Releases every allocation; the chunks are reused by the next ones */
+void frame_arena_reset(frame_arena *a);
+
+/* size octets aligned to 'align' (power of two, at most 16). NULL if out of memory. */
+void *frame_arena_alloc(frame_arena *a, size_t size, size_t align);
+
+template <typename T>
+static inline T *frame_arena_new(frame_arena *a, size_t n = 1){
+	return (T *)frame_arena_alloc(a, n*sizeof(T), alignof(T) < 16 ? alignof(T) : 16);
+}
+
+/* Arena of the calling thread (created on first use, freed when the thread ends) */
+frame_arena *frame_arena_local(void);
+
+#endif /* FRAME_ARENA_H_ */
@@ -0,0 +1,37 @@
+//============================================================================
+// Name        : frame_view.cpp
+// Description : Decoded frame allocated in a frame_arena
+//============================================================================
+
+#include <string.h>
+
+#include "frame_view.h"
+
+const frame_view *frame_decode_view(frame_arena *a, const uint8_t *frame, size_t len,
+									uint64_t bit_pos, double time, int fields, int ax25_flags){
+	frame_view *v = frame_arena_new<frame_view>(a);
+	uint8_t *copy = frame_arena_new<uint8_t>(a, len);
+	double *values;
+
+	if (!v || !copy) return NULL;
+
+	memcpy(copy, frame, len);
+	if (ax25_decode_frame(copy, len, &v->ax25, ax25_flags) != 0) return NULL;
+
+	v->time = time;
+	v->bit_pos = bit_pos;
+	v->frame = copy;
+	v->frame_len = len;
+	v->schema = v->ax25.fcs_ok ? tlm_match(v->ax25.info, v->ax25.info_len) : NULL;
+	v->values = NULL;
+
+	if (v->schema && fields){
+		if ((values = frame_arena_new<double>(a, v->schema->nfields)) == NULL) v->schema = NULL;
+		else {
+			tlm_decode(v->schema, v->ax25.info, values);
+			v->values = values;
+		}
+	}
+
+	return v;
+}
@@ -0,0 +1,40 @@
+//============================================================================
+// Name        : frame_view.h
+// Description : Decoded frame allocated in a frame_arena
+//============================================================================
+
+#ifndef FRAME_VIEW_H_
+#define FRAME_VIEW_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ax25_decoder.h"
+#include "frame_arena.h"
+#include "tlm_schema.h"
+
+/*
+* Everything a view points to (the frame octets, the Info field, the field
+* values) is in the arena, so the view stays valid after the deframer reuses
+* its buffer, until the arena is reset. No heap allocation once the arena has
+* grown to the size of a batch.
+*/
+
+typedef struct {
+	double time;
+	uint64_t bit_pos;
+	ax25_frame ax25;			// ax25.info points into frame
+	const uint8_t *frame;		// as received, without flags
+	size_t frame_len;
+	const tlm_schema *schema;	// NULL if the Info field isn't telemetry or the FCS is wrong
+	const double *values;		// schema->nfields values, NULL without schema or fields
+} frame_view;
+
+/*
+* Parses, checks the FCS (ax25_flags as ax25_decode_frame()) and, with
+* 'fields', decodes the telemetry. NULL if the address field is malformed.
+*/
+const frame_view *frame_decode_view(frame_arena *a, const uint8_t *frame, size_t len,
+									uint64_t bit_pos, double time, int fields = 1, int ax25_flags = 0);
+
+#endif /* FRAME_VIEW_H_ */
@@ -0,0 +1,325 @@
+//============================================================================
+// Name        : fsk_demod.cpp
+// Description : 2-(G)FSK demodulator: complex baseband IQ samples to soft bits
+//============================================================================
+
+#include <math.h>
+#include <string.h>
+
+#include "fsk_demod.h"
+
+#define DECIM_SPS_MIN		20		// samples per symbol kept after decimation
+#define DC_ALPHA			(1.0f/256)
+#define AMP_ALPHA			(1.0f/64)
+#define TONE_WINDOW			0.6		// of the symbol, integrated by the tone detector
+#define CLOCK_KP			0.01	// Gardner loop, proportional and integral gains
+#define CLOCK_KI			0.00005
+
+void fsk_default_config(fsk_config *cfg){
+	cfg->sample_rate = 48000;
+	cfg->symbol_rate = 1200;
+	cfg->deviation = 4000;
+	cfg->bt = 0.5;
+	cfg->freq_offset = 0;
+	cfg->nrzi = 1;
+	cfg->invert = 0;
+	cfg->detector = FSK_DET_TONES;
+}
+
+size_t iq_sample_size(iq_format fmt){
+	return fmt == IQ_CF32 ? 8 : fmt == IQ_CS16 ? 4 : 2;
+}
+
+void iq_convert(const void *raw, size_t n, iq_format fmt, float *i, float *q){
+	size_t k;
+
+	switch (fmt){
+	case IQ_CF32: {
+		const float *p = (const float *)raw;
+		for (k=0; k<n; k++){
+			i[k] = p[2*k];
+			q[k] = p[2*k+1];
+		}
+		break;
+	}
+	case IQ_CS16: {
+		const int16_t *p = (const int16_t *)raw;
+		for (k=0; k<n; k++){
+			i[k] = p[2*k]*(1.0f/32768);
+			q[k] = p[2*k+1]*(1.0f/32768);
+		}
+		break;
+	}
+	case IQ_CU8: {
+		const uint8_t *p = (const uint8_t *)raw;
+		for (k=0; k<n; k++){
+			i[k] = (p[2*k] - 127.5f)*(1.0f/128);
+			q[k] = (p[2*k+1] - 127.5f)*(1.0f/128);
+		}
+		break;
+	}
+	}
+}
+
+/* ---------------------------------- kernels ---------------------------------- */
+
+/* Dot product of ntaps (multiple of 8) values: 8 partial sums, one vector register */
+static inline float dot8(const float *h, const float *x, size_t ntaps){
+	float acc[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+	size_t k, j;
+
+	for (k=0; k<ntaps; k+=8)
+		for (j=0; j<8; j++) acc[j] += h[k+j]*x[k+j];
+
+	return ((acc[0] + acc[4]) + (acc[1] + acc[5])) + ((acc[2] + acc[6]) + (acc[3] + acc[7]));
+}
+
+/* atan2 with ~1e-5 rad error, branchless so it vectorizes */
+static inline float fast_atan2(float y, float x){
+	float ax = fabsf(x), ay = fabsf(y);
+	float mx = ax > ay ? ax : ay, mn = ax > ay ? ay : ax;
+	float a = mn/(mx + 1e-30f), s = a*a;
+	float r = ((-0.0464964749f*s + 0.15931422f)*s - 0.327622764f)*s*a + a;
+
+	r = ay > ax ? 1.57079637f - r : r;
+	r = x < 0 ? 3.14159274f - r : r;
+	return y < 0 ? -r : r;
+}
+
+/* Windowed sinc low pass, cutoff in Hz, padded with zeros to a multiple of 8 */
+static void design_lowpass(std::vector<float> &h, double fs, double cutoff, double transition){
+	size_t n = (size_t)ceil(5.5*fs/transition) | 1, k;		// Blackman
+	double fc = cutoff/fs, sum = 0;
+
+	h.assign((n + 7) & ~(size_t)7, 0.0f);
+	for (k=0; k<n; k++){
+		double t = (double)k - (n - 1)/2.0;
+		double w = 0.42 - 0.5*cos(2*M_PI*k/(n - 1)) + 0.08*cos(4*M_PI*k/(n - 1));
+		double v = t == 0 ? 2*fc : sin(2*M_PI*fc*t)/(M_PI*t);
+
+		h[k] = (float)(v*w);
+		sum += v*w;
+	}
+	for (k=0; k<n; k++) h[k] = (float)(h[k]/sum);
+}
+
+/* Frequency pulse of one symbol through the gaussian filter, the matched filter of the discriminator output */
+static void design_matched(std::vector<float> &h, double sps, double bt){
+	size_t n = (size_t)ceil(2*sps) | 1, k;
+	double sigma = sqrt(log(2.0))/(2*M_PI*bt), sum = 0;
+
+	h.assign((n + 7) & ~(size_t)7, 0.0f);
+	for (k=0; k<n; k++){
+		double t = ((double)k - (n - 1)/2.0)/sps;		// in symbols
+		// rectangle of one symbol convolved with the gaussian: difference of two erfs
+		double v = 0.5*(erf((t + 0.5)/(sqrt(2.0)*sigma)) - erf((t - 0.5)/(sqrt(2.0)*sigma)));
+
+		h[k] = (float)v;
+		sum += v;
+	}
+	for (k=0; k<n; k++) h[k] = (float)(h[k]/sum);
+}
+
+int fsk_demod_init(fsk_demod *d, const fsk_config *cfg){
+	double band = cfg->deviation + cfg->symbol_rate;		// one side, Carson
+	size_t k, nbox;
+
+	if (cfg->symbol_rate <= 0 || cfg->sample_rate < 2*band) return -1;
+
+	d->cfg = *cfg;
+	d->decim = (unsigned int)(cfg->sample_rate/(DECIM_SPS_MIN*cfg->symbol_rate));
+	if (d->decim < 1) d->decim = 1;
+	// keep the whole signal inside the decimated band
+	while (d->decim > 1 && cfg->sample_rate/d->decim < 2.4*band) d->decim--;
+	d->fs = cfg->sample_rate/d->decim;
+	d->sps = d->fs/cfg->symbol_rate;
+
+	design_lowpass(d->chan_taps, cfg->sample_rate, band + 0.25*cfg->symbol_rate,
+				   d->decim > 1 ? d->fs/2 - band : cfg->sample_rate/2 - band);
+	design_matched(d->mf_taps, d->sps, cfg->bt);
+
+	d->nco_phase = 0;
+	fsk_demod_set_offset(d, cfg->freq_offset);
+
+	d->i.assign(d->chan_taps.size() - 1 + FSK_BLOCK, 0.0f);
+	d->q.assign(d->chan_taps.size() - 1 + FSK_BLOCK, 0.0f);
+	d->samples = 0;
+	d->di.resize(FSK_BLOCK);
+	d->dq.resize(FSK_BLOCK);
+	d->last_i = d->last_q = 0;
+	d->freq.assign(d->mf_taps.size() - 1 + FSK_BLOCK, 0.0f);
+
+	nbox = (size_t)lround(TONE_WINDOW*d->sps);
+	d->box_taps.assign((nbox + 7) & ~(size_t)7, 0.0f);
+	for (k=0; k<nbox; k++) d->box_taps[k] = 1.0f;
+	d->tone_re.resize(FSK_BLOCK);
+	d->tone_im.resize(FSK_BLOCK);
+	for (k=0; k<FSK_BLOCK; k++){
+		double ph = -2*M_PI*cfg->deviation*(double)k/d->fs;
+		d->tone_re[k] = (float)cos(ph);
+		d->tone_im[k] = (float)sin(ph);
+	}
+	d->tone_phase = 0;
+	d->up_i.assign(d->box_taps.size() - 1 + FSK_BLOCK, 0.0f);
+	d->up_q.assign(d->box_taps.size() - 1 + FSK_BLOCK, 0.0f);
+	d->dn_i.assign(d->box_taps.size() - 1 + FSK_BLOCK, 0.0f);
+	d->dn_q.assign(d->box_taps.size() - 1 + FSK_BLOCK, 0.0f);
+
+	d->y.assign(FSK_BLOCK + (size_t)ceil(4*d->sps) + 16, 0.0f);
+	d->y_len = 0;
+	d->mu = d->sps;
+	d->period = d->sps;
+	d->prev_sym = 0;
+	d->dc = 0;
+	d->amp = 1;
+	d->symbols = 0;
+
+	return 0;
+}
+
+void fsk_demod_set_offset(fsk_demod *d, double freq_offset){
+	size_t k;
+
+	d->cfg.freq_offset = freq_offset;
+	d->nco_re.resize(FSK_BLOCK);
+	d->nco_im.resize(FSK_BLOCK);
+	for (k=0; k<FSK_BLOCK; k++){
+		double ph = -2*M_PI*freq_offset*(double)k/d->cfg.sample_rate;
+		d->nco_re[k] = (float)cos(ph);
+		d->nco_im[k] = (float)sin(ph);
+	}
+}
+
+/* Linear interpolation of y[] at a fractional position */
+static inline float interp(const float *y, double t){
+	size_t k = (size_t)t;
+	float f = (float)(t - (double)k);
+
+	return y[k] + f*(y[k+1] - y[k]);
+}
+
+size_t fsk_demod_process(fsk_demod *d, const float *in_i, const float *in_q, size_t n, float *out){
+	const size_t ntaps = d->chan_taps.size(), nmf = d->mf_taps.size();
+	float *xi = d->i.data() + ntaps - 1, *xq = d->q.data() + ntaps - 1;
+	const float *a = d->di.data(), *b = d->dq.data();
+	float *f = d->freq.data() + nmf - 1, *y;
+	size_t k, nd, nout = 0;
+	double drop;
+
+	if (n > FSK_BLOCK) n = FSK_BLOCK;
+
+	// frequency shift: x*exp(-j(w k + phase)), the table times the phasor of the block start
+	if (d->cfg.freq_offset != 0){
+		const float cr = (float)cos(d->nco_phase), ci = (float)sin(d->nco_phase);
+		const float *tr = d->nco_re.data(), *ti = d->nco_im.data();
+
+		for (k=0; k<n; k++){
+			float pr = tr[k]*cr - ti[k]*ci, pi = tr[k]*ci + ti[k]*cr;
+
+			xi[k] = in_i[k]*pr - in_q[k]*pi;
+			xq[k] = in_i[k]*pi + in_q[k]*pr;
+		}
+		d->nco_phase = fmod(d->nco_phase - 2*M_PI*d->cfg.freq_offset*(double)n/d->cfg.sample_rate, 2*M_PI);
+	}
+	else {
+		memcpy(xi, in_i, n*sizeof(float));
+		memcpy(xq, in_q, n*sizeof(float));
+	}
+
+	// channel filter, one output every D inputs (window k ends at the new sample k)
+	k = (size_t)((d->decim - d->samples % d->decim) % d->decim);
+	for (nd=0; k<n; k+=d->decim, nd++){
+		d->di[nd] = dot8(d->chan_taps.data(), d->i.data() + k, ntaps);
+		d->dq[nd] = dot8(d->chan_taps.data(), d->q.data() + k, ntaps);
+	}
+	d->samples += n;
+	memmove(d->i.data(), d->i.data() + n, (ntaps - 1)*sizeof(float));
+	memmove(d->q.data(), d->q.data() + n, (ntaps - 1)*sizeof(float));
+
+	if (nd == 0) return 0;
+
+	if (d->cfg.detector == FSK_DET_DISCRIMINATOR){
+		// discriminator: angle of x[k]*conj(x[k-1]), scaled so the deviation gives +-1
+		const float scale = (float)(d->fs/(2*M_PI*d->cfg.deviation))*(d->cfg.invert ? -1.0f : 1.0f);
+
+		f[0] = scale*fast_atan2(b[0]*d->last_i - a[0]*d->last_q, a[0]*d->last_i + b[0]*d->last_q);
+		for (k=1; k<nd; k++)
+			f[k] = scale*fast_atan2(b[k]*a[k-1] - a[k]*b[k-1], a[k]*a[k-1] + b[k]*b[k-1]);
+		d->last_i = a[nd-1];
+		d->last_q = b[nd-1];
+
+		// matched filter
+		y = d->y.data() + d->y_len;
+		for (k=0; k<nd; k++) y[k] = dot8(d->mf_taps.data(), d->freq.data() + k, nmf);
+		memmove(d->freq.data(), d->freq.data() + nd, (nmf - 1)*sizeof(float));
+	}
+	else {
+		// mix each tone down to 0 Hz, integrate over one symbol, compare the energies
+		const size_t nbox = d->box_taps.size();
+		const float cr = (float)cos(d->tone_phase), ci = (float)sin(d->tone_phase);
+		const float *tr = d->tone_re.data(), *ti = d->tone_im.data();
+		const float sign = d->cfg.invert ? -1.0f : 1.0f;
+		float *ui = d->up_i.data() + nbox - 1, *uq = d->up_q.data() + nbox - 1;
+		float *wi = d->dn_i.data() + nbox - 1, *wq = d->dn_q.data() + nbox - 1;
+
+		for (k=0; k<nd; k++){
+			float pr = tr[k]*cr - ti[k]*ci, pi = tr[k]*ci + ti[k]*cr;	// exp(-j(w k + phase))
+
+			ui[k] = a[k]*pr - b[k]*pi;
+			uq[k] = a[k]*pi + b[k]*pr;
+			wi[k] = a[k]*pr + b[k]*pi;		// times the conjugate: exp(+j(w k + phase))
+			wq[k] = b[k]*pr - a[k]*pi;
+		}
+		d->tone_phase = fmod(d->tone_phase - 2*M_PI*d->cfg.deviation*(double)nd/d->fs, 2*M_PI);
+
+		y = d->y.data() + d->y_len;
+		for (k=0; k<nd; k++){
+			float zi = dot8(d->box_taps.data(), d->up_i.data() + k, nbox);
+			float zq = dot8(d->box_taps.data(), d->up_q.data() + k, nbox);
+			float vi = dot8(d->box_taps.data(), d->dn_i.data() + k, nbox);
+			float vq = dot8(d->box_taps.data(), d->dn_q.data() + k, nbox);
+			float eu = zi*zi + zq*zq, ed = vi*vi + vq*vq;
+
+			y[k] = sign*(eu - ed)/(eu + ed + 1e-20f);
+		}
+		memmove(d->up_i.data(), d->up_i.data() + nd, (nbox - 1)*sizeof(float));
+		memmove(d->up_q.data(), d->up_q.data() + nd, (nbox - 1)*sizeof(float));
+		memmove(d->dn_i.data(), d->dn_i.data() + nd, (nbox - 1)*sizeof(float));
+		memmove(d->dn_q.data(), d->dn_q.data() + nd, (nbox - 1)*sizeof(float));
+	}
+	d->y_len += nd;
+
+	// clock recovery: Gardner timing error on the symbol and the sample half a symbol before
+	y = d->y.data();
+	while (d->mu + 1 < (double)d->y_len){
+		float raw = interp(y, d->mu);
+		float cur = raw - d->dc;
+		float mid = interp(y, d->mu - d->period/2) - d->dc;
+		float e = mid*(d->prev_sym - cur)/(d->amp*d->amp + 1e-9f);
+
+		e = e > 1 ? 1 : e < -1 ? -1 : e;
+		d->period += CLOCK_KI*e*d->sps;
+		if (d->period > 1.02*d->sps) d->period = 1.02*d->sps;
+		if (d->period < 0.98*d->sps) d->period = 0.98*d->sps;
+		d->mu += d->period + CLOCK_KP*e*d->sps;
+
+		d->dc += DC_ALPHA*(raw - d->dc);
+		d->amp += AMP_ALPHA*(fabsf(cur) - d->amp);
+
+		// NRZI: same tone as the last symbol is a '1'
+		out[nout++] = d->cfg.nrzi ? cur*d->prev_sym/(d->amp*d->amp + 1e-9f) : cur/(d->amp + 1e-9f);
+		d->prev_sym = cur;
+		d->symbols++;
+	}
+
+	// keep the samples the next symbol (and its mid point) still needs
+	drop = floor(d->mu - d->period) - 1;
+	if (drop > 0){
+		k = (size_t)drop;
+		memmove(y, y + k, (d->y_len - k)*sizeof(float));
+		d->y_len -= k;
+		d->mu -= (double)k;
+	}
+
+	return nout;
+}
@@ -0,0 +1,123 @@
+//============================================================================
+// Name        : fsk_demod.h
+// Description : 2-(G)FSK demodulator: complex baseband IQ samples to soft bits
+//============================================================================
+
+#ifndef FSK_DEMOD_H_
+#define FSK_DEMOD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/*
+* Beacon downlink (ttc/beacon/inc/cc11xx_floripasat_reg_config.h):
+* 2-GFSK, 1,2 ksps, deviation ~4 kHz, 437,5 MHz.
+*
+* IQ (fs) -> frequency shift -> channel FIR, decimation by D -> detector
+* -> clock recovery (Gardner) -> NRZI -> soft bits
+*
+* Detectors:
+*  - tones (default): a matched filter per tone (mixed to +-deviation and
+*    integrated over the middle 60% of the symbol, where the gaussian
+*    filter leaves the tone steady), soft value from the two energies.
+*    With h = 2*4/1,2 ~ 6,7 the tones are orthogonal; ~1 dB better than
+*    the discriminator at the decoding threshold. The carrier must be within
+*    ~1/4 of the symbol rate: set freq_offset from the Doppler prediction.
+*  - discriminator: FM discriminator followed by the matched filter of the
+*    gaussian frequency pulse. Tolerates any offset inside the channel
+*    filter (the DC is tracked), but needs a strong signal.
+*
+* A soft bit is positive for '1', its magnitude ~1 for a clean symbol.
+* The kernels work on blocks of separate I and Q float arrays and are written
+* so the compiler vectorizes them (-O3; -march=native for AVX).
+*/
+
+typedef enum {
+	IQ_CF32 = 0,		// interleaved float32 (GNU Radio, SDR#)
+	IQ_CS16,			// interleaved int16
+	IQ_CU8				// interleaved uint8, offset 127.5 (rtl_sdr)
+} iq_format;
+
+typedef enum {
+	FSK_DET_TONES = 0,
+	FSK_DET_DISCRIMINATOR
+} fsk_detector;
+
+typedef struct {
+	double sample_rate;		// Hz
+	double symbol_rate;		// symbols/s
+	double deviation;		// Hz
+	double bt;				// gaussian filter bandwidth-time product
+	double freq_offset;		// Hz, carrier position in the IQ (Doppler, tuning error)
+	int nrzi;				// 1: a '0' is a change of tone (AX.25)
+	int invert;				// swap the tones
+	fsk_detector detector;
+} fsk_config;
+
+typedef struct {
+	fsk_config cfg;
+	unsigned int decim;			// D
+	double fs;					// sample rate after decimation
+	double sps;					// samples per symbol after decimation
+
+	std::vector<float> chan_taps;	// channel filter, padded to a multiple of 8
+	std::vector<float> mf_taps;		// matched filter, padded to a multiple of 8
+	std::vector<float> box_taps;	// integrator of the tone detector
+
+	// frequency shift: phasor table for a block, and the phase at the start of the next block
+	std::vector<float> nco_re, nco_im;
+	double nco_phase;
+
+	// each filter input holds taps-1 samples of history followed by the block
+	std::vector<float> i, q;		// channel filter input
+	uint64_t samples;				// input samples seen
+	std::vector<float> di, dq;		// decimated
+	float last_i, last_q;
+	std::vector<float> freq;		// discriminator output, matched filter input
+
+	// tone detector: +deviation mixer table for a block (the -deviation one is its conjugate)
+	std::vector<float> tone_re, tone_im;
+	double tone_phase;
+	std::vector<float> up_i, up_q, dn_i, dn_q;	// mixed to each tone, integrator input
+
+	// clock recovery
+	std::vector<float> y;			// matched filter output
+	size_t y_len;
+	double mu;					// position of the next symbol in y[]
+	double period;				// symbol period estimate
+	float prev_sym;
+	float dc;
+	float amp;
+
+	uint64_t symbols;
+} fsk_demod;
+
+void fsk_default_config(fsk_config *cfg);
+
+/* Returns 0 on success or -1 if the sample rate is too low for the signal */
+int fsk_demod_init(fsk_demod *d, const fsk_config *cfg);
+
+/*
+* Moves the frequency shift to a new carrier offset (Doppler) between two
+* blocks, the phase goes on. Recomputes a table of FSK_BLOCK phasors: call
+* it when the offset has moved by a few Hz, not every block.
+*/
+void fsk_demod_set_offset(fsk_demod *d, double freq_offset);
+
+/* Samples in a block for iq_convert()/fsk_demod_process() */
+#define FSK_BLOCK		8192
+
+/* Converts n complex samples to separate I and Q arrays */
+void iq_convert(const void *raw, size_t n, iq_format fmt, float *i, float *q);
+
+/* Bytes per complex sample */
+size_t iq_sample_size(iq_format fmt);
+
+/*
+* Demodulates n samples (n <= FSK_BLOCK). Writes the soft bits to out, which
+* must hold n values, and returns how many.
+*/
+size_t fsk_demod_process(fsk_demod *d, const float *i, const float *q, size_t n, float *out);
+
+#endif /* FSK_DEMOD_H_ */
@@ -0,0 +1,394 @@
+//============================================================================
+// Name        : hdlc.cpp
+// Description : Streaming HDLC deframer (flag hunt, bit destuffing) and bit stuffer
+//============================================================================
+
+#include <string.h>
+
+#include "hdlc.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define HDLC_HAVE_X86_AVX2 1
+#include <immintrin.h>
+#else
+#define HDLC_HAVE_X86_AVX2 0
+#endif
+
+#define SKIP_MIN_BYTES	32		// shorter buffers are pushed bit by bit while hunting
+
+void hdlc_deframer_init(hdlc_deframer *d, hdlc_frame_cb cb, void *user){
+	memset(d, 0, sizeof(*d));
+	d->cb = cb;
+	d->user = user;
+	d->destuff = 1;
+	d->min_len = HDLC_MIN_FRAME;
+	d->max_len = HDLC_MAX_FRAME;
+}
+
+void hdlc_deframer_reset(hdlc_deframer *d){
+	d->len = 0;
+	d->cur = 0;
+	d->nbits = 0;
+	d->ones = 0;
+	d->in_frame = 0;
+}
+
+static inline void start_frame(hdlc_deframer *d){
+	d->len = 0;
+	d->cur = 0;
+	d->nbits = 0;
+	d->in_frame = 1;
+	d->frame_start = d->bit_pos + 1;
+}
+
+/* Flag received: the 0 and the six 1s of the flag were already appended as data */
+static inline void end_frame(hdlc_deframer *d){
+	size_t total = d->len*8 + d->nbits;
+
+	if (d->in_frame && total > 7){
+		total -= 7;
+
+		if (total % 8 || total/8 < d->min_len) d->bad_len++;
+		else {
+			d->frames++;
+			d->cb(d->buf, total/8, d->frame_start, d->user);
+		}
+	}
+	start_frame(d);
+}
+
+static inline void append_bit(hdlc_deframer *d, int b){
+	if (!d->in_frame) return;
+
+	d->cur |= (uint8_t)(b << d->nbits);
+	if (++d->nbits == 8){
+		if (d->len == d->max_len){		// too long, hunt for the next flag
+			d->bad_len++;
+			d->in_frame = 0;
+			return;
+		}
+		d->buf[d->len++] = d->cur;
+		d->cur = 0;
+		d->nbits = 0;
+	}
+}
+
+static inline void push_bit(hdlc_deframer *d, int b){
+	if (b){
+		d->ones++;
+		if (d->ones >= 7 && d->destuff){	// abort sequence
+			if (d->ones == 7 && d->in_frame) d->aborts++;
+			d->in_frame = 0;
+		}
+		else append_bit(d, 1);
+	}
+	else {
+		if (d->ones == 6) end_frame(d);
+		else if (d->ones == 5 && d->destuff) ;	// stuffed zero
+		else append_bit(d, 0);
+		d->ones = 0;
+	}
+	d->bit_pos++;
+}
+
+void hdlc_push_bits(hdlc_deframer *d, const uint8_t *bits, size_t n){
+	size_t i;
+
+	for(i=0; i<n; i++){
+		uint8_t b = bits[i];
+
+		if (b == '0' || b == '1') b -= '0';
+		else if (b > 1) continue;
+
+		push_bit(d, b);
+	}
+}
+
+static inline int get_bit(const uint8_t *data, uint64_t bit){
+	return (data[bit >> 3] >> (bit & 7)) & 1;
+}
+
+/* Ones right before 'bit', up to 7 (7 stands for 7 or more) */
+static int ones_before(const uint8_t *data, uint64_t bit){
+	int n = 0;
+
+	while (n < 7 && bit > 0 && get_bit(data, bit - 1)){
+		n++;
+		bit--;
+	}
+	return n;
+}
+
+static inline void push_byte(hdlc_deframer *d, uint8_t b, int from){
+	int j;
+
+	for(j=from; j<8; j++) push_bit(d, (b >> j) & 1);
+}
+
+/*
+* While hunting, only a flag changes the state. The first byte is pushed bit by
+* bit (a flag there can use ones of the previous buffer); after it, the bits
+* up to the next flag found by hdlc_find_flag() are skipped and d->ones is set
+* to what pushing them would have left.
+*/
+void hdlc_push_bytes(hdlc_deframer *d, const uint8_t *data, size_t n){
+	size_t i = 0;
+	uint64_t nbits, k;
+
+	while (i < n){
+		if (d->in_frame || n - i < SKIP_MIN_BYTES){
+			push_byte(d, data[i++], 0);
+			continue;
+		}
+
+		push_byte(d, data[i], 0);
+		if (d->in_frame){
+			i++;
+			continue;
+		}
+
+		nbits = (uint64_t)(n - i)*8;
+		k = hdlc_find_flag(data + i, nbits, 1);
+
+		if (k < 8){							// the flag ends in the next byte: no skip
+			push_byte(d, data[i+1], 0);
+			i += 2;
+		}
+		else if (k < nbits){				// skip to the flag, its leading 0 clears the ones
+			d->bit_pos += k - 8;
+			d->ones = 0;
+			push_byte(d, data[i + k/8], (int)(k & 7));
+			i += k/8 + 1;
+		}
+		else {								// no flag: skip to the last byte
+			d->bit_pos += nbits - 16;
+			d->ones = ones_before(data + i, nbits - 8);
+			push_byte(d, data[n-1], 0);
+			i = n;
+		}
+	}
+}
+
+size_t hdlc_stuff_frame(const uint8_t *frame, size_t len, uint8_t *bits, size_t max_bits){
+	size_t n = 0, i;
+	int j, ones = 0;
+
+	// worst case: one stuffed bit every 5 bits
+	if (max_bits < 16 + len*8 + (len*8)/5) return 0;
+
+	for(j=0; j<8; j++) bits[n++] = (HDLC_FLAG >> j) & 1;
+
+	for(i=0; i<len; i++){
+		for(j=0; j<8; j++){
+			uint8_t b = (frame[i] >> j) & 1;
+
+			bits[n++] = b;
+			if (b && ++ones == 5){
+				bits[n++] = 0;
+				ones = 0;
+			}
+			else if (!b) ones = 0;
+		}
+	}
+
+	for(j=0; j<8; j++) bits[n++] = (HDLC_FLAG >> j) & 1;
+
+	return n;
+}
+
+/* ------------------------------ flag search ------------------------------- */
+
+static inline uint64_t load64(const uint8_t *p){
+	uint64_t w;
+
+	memcpy(&w, p, 8);		// little endian: bit j of p[k] is bit 8*k+j of w
+	return w;
+}
+
+/* Bits [64*i, 64*i+64) of the buffer, zero past nbits */
+static inline uint64_t word_at(const uint8_t *data, uint64_t nbits, uint64_t i){
+	uint64_t base = i*64, w = 0;
+
+	if (base >= nbits) return 0;
+	if (base + 64 <= nbits) return load64(data + i*8);
+
+	memcpy(&w, data + i*8, (size_t)((nbits - base + 7) >> 3));
+	return w & (((uint64_t)1 << (nbits - base)) - 1);
+}
+
+/* Offsets of the word that can start a flag (its 8 bits are in the buffer) */
+static inline uint64_t flag_limit(uint64_t nbits, uint64_t i){
+	uint64_t base = i*64;
+
+	if (base + 64 + 7 <= nbits) return ~(uint64_t)0;
+	if (base + 8 > nbits) return 0;
+	return ((uint64_t)1 << (nbits - 7 - base)) - 1;
+}
+
+/*
+* Bit k of s_j is bit k+j of the stream. A flag starts at k when
+* ~s_0 & s_1 & ... & s_6 & ~s_7; an abort when s_0 & ... & s_6 and the bit
+* before k is 0. Zeros past the end can't fake ones, so only flags need
+* flag_limit().
+*/
+static inline void word_masks(uint64_t w0, uint64_t w1, uint64_t prev, uint64_t *flags, uint64_t *aborts){
+	uint64_t s1 = w0 >> 1 | w1 << 63, s2 = w0 >> 2 | w1 << 62, s3 = w0 >> 3 | w1 << 61;
+	uint64_t s4 = w0 >> 4 | w1 << 60, s5 = w0 >> 5 | w1 << 59, s6 = w0 >> 6 | w1 << 58;
+	uint64_t s7 = w0 >> 7 | w1 << 57;
+	uint64_t ones = s1 & s2 & s3 & s4 & s5 & s6;
+
+	*flags = ~w0 & ones & ~s7;
+	*aborts = w0 & ones & ~(w0 << 1 | prev >> 63);
+}
+
+/* Appends the events of one word in bit order, returns the new count */
+static inline size_t emit(uint64_t flags, uint64_t aborts, uint64_t base, hdlc_sync *out, size_t n, size_t max){
+	uint64_t all = flags | aborts;
+	int k;
+
+	while (all && n < max){
+		k = __builtin_ctzll(all);
+		out[n].bit = base + (uint64_t)k;
+		out[n].abort = (int)((aborts >> k) & 1);
+		n++;
+		all &= all - 1;
+	}
+	return n;
+}
+
+size_t hdlc_scan_naive(const uint8_t *data, uint64_t nbits, hdlc_sync *out, size_t max){
+	uint64_t k;
+	size_t n = 0;
+	int j;
+
+	for (k=0; k<nbits && n<max; k++){
+		if (k + 8 <= nbits && !get_bit(data, k) && !get_bit(data, k + 7)){
+			for (j=1; j<7 && get_bit(data, k + j); j++);
+			if (j == 7){
+				out[n].bit = k;
+				out[n++].abort = 0;
+				continue;
+			}
+		}
+		if (k + 7 <= nbits && (k == 0 || !get_bit(data, k - 1))){
+			for (j=0; j<7 && get_bit(data, k + j); j++);
+			if (j == 7){
+				out[n].bit = k;
+				out[n++].abort = 1;
+			}
+		}
+	}
+	return n;
+}
+
+/* Words [first, last) with the word method */
+static size_t scan_words(const uint8_t *data, uint64_t nbits, uint64_t first, uint64_t last,
+						 hdlc_sync *out, size_t n, size_t max){
+	uint64_t i, w0, w1, prev, flags, aborts;
+
+	prev = first ? word_at(data, nbits, first - 1) : 0;
+	w0 = word_at(data, nbits, first);
+
+	for (i=first; i<last && n<max; i++){
+		w1 = word_at(data, nbits, i + 1);
+		word_masks(w0, w1, prev, &flags, &aborts);
+		n = emit(flags & flag_limit(nbits, i), aborts, i*64, out, n, max);
+		prev = w0;
+		w0 = w1;
+	}
+	return n;
+}
+
+size_t hdlc_scan_word(const uint8_t *data, uint64_t nbits, hdlc_sync *out, size_t max){
+	return scan_words(data, nbits, 0, (nbits + 63)/64, out, 0, max);
+}
+
+uint64_t hdlc_find_flag(const uint8_t *data, uint64_t nbits, uint64_t from){
+	uint64_t i, last = (nbits + 63)/64, w0, w1, prev, flags, aborts;
+
+	if (from >= nbits) return nbits;
+
+	i = from/64;
+	prev = i ? word_at(data, nbits, i - 1) : 0;
+	w0 = word_at(data, nbits, i);
+
+	for (; i<last; i++){
+		w1 = word_at(data, nbits, i + 1);
+		word_masks(w0, w1, prev, &flags, &aborts);
+		flags &= flag_limit(nbits, i);
+		if (i == from/64) flags &= ~(((uint64_t)1 << (from & 63)) - 1);
+		if (flags) return i*64 + (uint64_t)__builtin_ctzll(flags);
+		prev = w0;
+		w0 = w1;
+	}
+	return nbits;
+}
+
+#if HDLC_HAVE_X86_AVX2
+
+int hdlc_has_avx2(void){
+	return __builtin_cpu_supports("avx2");
+}
+
+/*
+* Same masks on 4 words per step: lane j of A is word i+j, B is the next word
+* (one load 8 bytes further) and C the previous one. Word 0 and the words
+* whose next word isn't whole are done by scan_words().
+*/
+__attribute__((target("avx2")))
+size_t hdlc_scan_avx2(const uint8_t *data, uint64_t nbits, hdlc_sync *out, size_t max){
+	uint64_t nwords = (nbits + 63)/64, full = nbits/64, i;
+	uint64_t flags[4], aborts[4];
+	size_t n;
+	int j;
+
+	if (!hdlc_has_avx2()) return hdlc_scan_word(data, nbits, out, max);
+
+	n = scan_words(data, nbits, 0, nwords < 1 ? nwords : 1, out, 0, max);
+
+	for (i=1; i + 5 <= full && n < max; i+=4){
+		const uint8_t *p = data + i*8;
+		__m256i a = _mm256_loadu_si256((const __m256i *)p);
+		__m256i b = _mm256_loadu_si256((const __m256i *)(p + 8));
+		__m256i c = _mm256_loadu_si256((const __m256i *)(p - 8));
+		__m256i ones = _mm256_or_si256(_mm256_srli_epi64(a, 1), _mm256_slli_epi64(b, 63));
+
+		ones = _mm256_and_si256(ones, _mm256_or_si256(_mm256_srli_epi64(a, 2), _mm256_slli_epi64(b, 62)));
+		ones = _mm256_and_si256(ones, _mm256_or_si256(_mm256_srli_epi64(a, 3), _mm256_slli_epi64(b, 61)));
+		ones = _mm256_and_si256(ones, _mm256_or_si256(_mm256_srli_epi64(a, 4), _mm256_slli_epi64(b, 60)));
+		ones = _mm256_and_si256(ones, _mm256_or_si256(_mm256_srli_epi64(a, 5), _mm256_slli_epi64(b, 59)));
+		ones = _mm256_and_si256(ones, _mm256_or_si256(_mm256_srli_epi64(a, 6), _mm256_slli_epi64(b, 58)));
+
+		__m256i s7 = _mm256_or_si256(_mm256_srli_epi64(a, 7), _mm256_slli_epi64(b, 57));
+		__m256i prev = _mm256_or_si256(_mm256_slli_epi64(a, 1), _mm256_srli_epi64(c, 63));
+		__m256i f = _mm256_andnot_si256(s7, _mm256_andnot_si256(a, ones));
+		__m256i ab = _mm256_andnot_si256(prev, _mm256_and_si256(a, ones));
+
+		// nothing in most of the noise between frames
+		if (_mm256_testz_si256(_mm256_or_si256(f, ab), _mm256_or_si256(f, ab))) continue;
+
+		_mm256_storeu_si256((__m256i *)flags, f);
+		_mm256_storeu_si256((__m256i *)aborts, ab);
+		for (j=0; j<4; j++) n = emit(flags[j], aborts[j], (i + j)*64, out, n, max);
+	}
+
+	return scan_words(data, nbits, i < nwords ? i : nwords, nwords, out, n, max);
+}
+
+#else
+
+int hdlc_has_avx2(void){
+	return 0;
+}
+
+size_t hdlc_scan_avx2(const uint8_t *data, uint64_t nbits, hdlc_sync *out, size_t max){
+	return hdlc_scan_word(data, nbits, out, max);
+}
+
+#endif
+
+size_t hdlc_scan(const uint8_t *data, uint64_t nbits, hdlc_sync *out, size_t max){
+	static const int avx2 = hdlc_has_avx2();
+
+	return avx2 ? hdlc_scan_avx2(data, nbits, out, max) : hdlc_scan_word(data, nbits, out, max);
+}
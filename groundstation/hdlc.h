@@ -0,0 +1,95 @@
+//============================================================================
+// Name        : hdlc.h
+// Description : Streaming HDLC deframer (flag hunt, bit destuffing) and bit stuffer
+//============================================================================
+
+#ifndef HDLC_H_
+#define HDLC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HDLC_FLAG			0x7E
+#define HDLC_MIN_FRAME		17		// 2 addresses + control + FCS
+#define HDLC_MAX_FRAME		330		// 560 bits of address + control + PID + 256 B info + FCS
+
+/* Called for each complete frame (octets between the flags, FCS included) */
+typedef void (*hdlc_frame_cb)(const uint8_t *frame, size_t len, uint64_t bit_pos, void *user);
+
+typedef struct {
+	hdlc_frame_cb cb;
+	void *user;
+
+	int destuff;				// 0 for captures written without bit stuffing (frame.txt)
+	size_t min_len;
+	size_t max_len;
+
+	uint8_t buf[HDLC_MAX_FRAME];
+	size_t len;					// complete octets in buf
+	uint8_t cur;				// octet being assembled (LSB first)
+	int nbits;					// bits in cur
+	int ones;					// consecutive ones received
+	int in_frame;				// 0 while hunting for a flag
+
+	uint64_t bit_pos;			// bits consumed since init
+	uint64_t frame_start;		// bit_pos of the first bit after the opening flag
+
+	uint64_t frames;			// statistics
+	uint64_t aborts;
+	uint64_t bad_len;
+} hdlc_deframer;
+
+void hdlc_deframer_init(hdlc_deframer *d, hdlc_frame_cb cb, void *user);
+
+/* One bit per byte: 0/1 or the ASCII '0'/'1' of the capture files. Other bytes are skipped. */
+void hdlc_push_bits(hdlc_deframer *d, const uint8_t *bits, size_t n);
+
+/*
+* Packed bits, each byte sent LSB first. While hunting, the bits up to the
+* next flag are skipped with hdlc_find_flag() instead of being pushed one by one.
+*/
+void hdlc_push_bytes(hdlc_deframer *d, const uint8_t *data, size_t n);
+
+/* Discards a partial frame (e.g. end of a capture file) and goes back to hunting */
+void hdlc_deframer_reset(hdlc_deframer *d);
+
+/*
+* Writes flag + frame (bit stuffed) + flag as one bit per byte.
+* Returns the number of bits written or 0 if max_bits is too small.
+*/
+size_t hdlc_stuff_frame(const uint8_t *frame, size_t len, uint8_t *bits, size_t max_bits);
+
+/* ------------------------------ flag search ------------------------------- */
+
+/*
+* Sync events in a packed bit buffer (bit j of data[k] is bit 8*k+j):
+*  - flag: the 8 bits 01111110 start at 'bit' (overlapping flags share their 0)
+*  - abort: a run of 7 or more ones starts at 'bit'
+* Events are returned in bit order, at most 'max' of them; a buffer of
+* HDLC_SCAN_MAX(nbits) events always holds them all.
+*
+* hdlc_scan_naive() checks every bit offset and is the reference.
+* hdlc_scan_word() tests the 64 offsets of a word at once with shifts and
+* ANDs, hdlc_scan_avx2() does 4 words per step. hdlc_scan() runs the fastest
+* one this CPU supports.
+*/
+
+typedef struct {
+	uint64_t bit;
+	int abort;
+} hdlc_sync;
+
+#define HDLC_SCAN_MAX(nbits)	((nbits)/7 + 1)
+
+size_t hdlc_scan_naive(const uint8_t *data, uint64_t nbits, hdlc_sync *out, size_t max);
+size_t hdlc_scan_word(const uint8_t *data, uint64_t nbits, hdlc_sync *out, size_t max);
+size_t hdlc_scan_avx2(const uint8_t *data, uint64_t nbits, hdlc_sync *out, size_t max);
+size_t hdlc_scan(const uint8_t *data, uint64_t nbits, hdlc_sync *out, size_t max);
+
+/* First flag starting at or after bit 'from', nbits if none */
+uint64_t hdlc_find_flag(const uint8_t *data, uint64_t nbits, uint64_t from);
+
+/* 1 if hdlc_scan_avx2() runs AVX2 code on this CPU (else it runs hdlc_scan_word()) */
+int hdlc_has_avx2(void);
+
+#endif /* HDLC_H_ */
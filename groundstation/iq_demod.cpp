@@ -0,0 +1,307 @@
+//============================================================================
+// Name        : iq_demod.cpp
+// Description : Demodulates an IQ recording into a bit capture
+//============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <math.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "fsk_demod.h"
+#include "capture_reader.h"
+
+/*
+* The output is a packed binary capture (8 bits per byte, LSB first) for
+* ax25_batch, or with -S one signed byte per bit (+127 = sure '1'), the soft
+* input of the FEC decoders.
+*
+* With a Doppler profile of pass_predict (-P, and -t the time of the first
+* sample) only the samples inside the passes are demodulated. Each pass starts
+* a new demodulator already tuned to the Doppler at AOS and goes to its own
+* capture, output_YYYYMMDD_HHMMSS.bin (the stamp of its first sample, for
+* ax25_batch); the frequency shift follows the profile during the pass.
+*/
+
+#define DOPPLER_UPDATE_HZ	5.0		// retune when the Doppler moved this much
+
+typedef struct {
+	double time;
+	double doppler;
+} profile_point;
+
+typedef struct {
+	size_t first, last;			// points of the pass in the profile
+} profile_pass;
+
+typedef struct {
+	FILE *fp;
+	uint8_t acc;
+	uint64_t nbits;
+} bit_writer;
+
+static void usage(const char *prog){
+	fprintf(stderr, "Usage: %s -s sample_rate [-f cf32|cs16|cu8] [-o offset_hz] [-d deviation_hz] [-b baud]\n"
+					"       [-D] [-n] [-i] [-S] [-P profile.csv -t start] input.iq output\n", prog);
+	fprintf(stderr, "  -f  sample format (default: cf32)\n");
+	fprintf(stderr, "  -o  carrier offset in the recording (default: 0)\n");
+	fprintf(stderr, "  -d  deviation (default: 4000)\n");
+	fprintf(stderr, "  -b  symbol rate (default: 1200)\n");
+	fprintf(stderr, "  -D  FM discriminator instead of the tone filters\n");
+	fprintf(stderr, "  -n  no NRZI\n");
+	fprintf(stderr, "  -i  invert the tones\n");
+	fprintf(stderr, "  -S  soft output, one int8 per bit\n");
+	fprintf(stderr, "  -P  Doppler profile of pass_predict: demodulate the passes only, one output per pass\n");
+	fprintf(stderr, "  -t  time of the first sample: seconds since the epoch or YYYY-MM-DDTHH:MM:SS (UTC)\n");
+}
+
+static int parse_time(const char *s, double *t){
+	struct tm tm;
+	char *end;
+
+	*t = strtod(s, &end);
+	if (end != s && *end == '\0') return 0;
+
+	memset(&tm, 0, sizeof(tm));
+	end = strptime(s, "%Y-%m-%dT%H:%M:%S", &tm);
+	if (!end || (*end && strcmp(end, "Z") != 0)) return -1;
+	*t = (double)timegm(&tm);
+	return 0;
+}
+
+/* time,pass,...,doppler_hz lines of pass_predict -o */
+static int load_profile(const char *path, std::vector<profile_point> &pts, std::vector<profile_pass> &passes){
+	FILE *fp = fopen(path, "r");
+	char line[256];
+	profile_point p;
+	unsigned int pass, last_pass = ~0u;
+	double az, el, range, rate;
+
+	if (!fp) return -1;
+
+	while (fgets(line, sizeof(line), fp)){
+		if (sscanf(line, "%lf,%u,%lf,%lf,%lf,%lf,%lf", &p.time, &pass, &az, &el, &range, &rate, &p.doppler) != 7) continue;
+		if (!pts.empty() && p.time <= pts.back().time) continue;
+
+		if (pass != last_pass){
+			profile_pass pp = {pts.size(), pts.size()};
+			passes.push_back(pp);
+			last_pass = pass;
+		}
+		passes.back().last = pts.size();
+		pts.push_back(p);
+	}
+
+	fclose(fp);
+	return passes.empty() ? -1 : 0;
+}
+
+/* Doppler at t inside the pass, linear between the points */
+static double doppler_at(const std::vector<profile_point> &pts, const profile_pass *pp, double t){
+	size_t lo = pp->first, hi = pp->last, m;
+
+	if (t <= pts[lo].time) return pts[lo].doppler;
+	if (t >= pts[hi].time) return pts[hi].doppler;
+	while (hi - lo > 1){
+		m = (lo + hi)/2;
+		if (pts[m].time <= t) lo = m;
+		else hi = m;
+	}
+	return pts[lo].doppler + (pts[hi].doppler - pts[lo].doppler)*(t - pts[lo].time)/(pts[hi].time - pts[lo].time);
+}
+
+static void write_bits(bit_writer *w, const float *soft, size_t nsym, int soft_out, uint8_t *buf){
+	size_t j, nb = 0;
+
+	if (soft_out){
+		for (j=0; j<nsym; j++){
+			float v = soft[j]*64;
+			buf[j] = (uint8_t)(int8_t)(v > 127 ? 127 : v < -127 ? -127 : v);
+		}
+		fwrite(buf, 1, nsym, w->fp);
+		return;
+	}
+
+	for (j=0; j<nsym; j++, w->nbits++){
+		w->acc |= (uint8_t)((soft[j] > 0) << (w->nbits & 7));
+		if ((w->nbits & 7) == 7){
+			buf[nb++] = w->acc;
+			w->acc = 0;
+		}
+	}
+	fwrite(buf, 1, nb, w->fp);
+}
+
+static int close_bits(bit_writer *w, int soft_out){
+	if (!soft_out && (w->nbits & 7)) fputc(w->acc, w->fp);
+	return fclose(w->fp);
+}
+
+/* output_YYYYMMDD_HHMMSS.bin, the stamp ax25_batch reads the start time from */
+static std::string pass_path(const char *output, double t){
+	std::string base(output);
+	time_t sec = (time_t)t;
+	struct tm tm;
+	char stamp[32];
+
+	if (base.size() > 4 && base.compare(base.size() - 4, 4, ".bin") == 0) base.resize(base.size() - 4);
+	gmtime_r(&sec, &tm);
+	strftime(stamp, sizeof(stamp), "_%Y%m%d_%H%M%S.bin", &tm);
+	return base + stamp;
+}
+
+int main(int argc, char **argv){
+	static fsk_demod d;
+	fsk_config cfg;
+	iq_format fmt = IQ_CF32;
+	capture_map in;
+	bit_writer w;
+	std::vector<float> i(FSK_BLOCK), q(FSK_BLOCK), soft(FSK_BLOCK);
+	std::vector<uint8_t> buf(FSK_BLOCK);
+	std::vector<profile_point> pts;
+	std::vector<profile_pass> passes;
+	const char *profile_path = NULL;
+	double start = NAN, base_offset, shift, aos, los;
+	uint64_t nsamples, k, end, demodulated = 0;
+	size_t n, nsym, pass;
+	int c, soft_out = 0;
+
+	fsk_default_config(&cfg);
+	cfg.sample_rate = 0;
+
+	while ((c = getopt(argc, argv, "s:f:o:d:b:DniSP:t:h")) != -1){
+		switch (c){
+		case 's': cfg.sample_rate = atof(optarg); break;
+		case 'f':
+			if (strcmp(optarg, "cf32") == 0) fmt = IQ_CF32;
+			else if (strcmp(optarg, "cs16") == 0) fmt = IQ_CS16;
+			else if (strcmp(optarg, "cu8") == 0) fmt = IQ_CU8;
+			else {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'o': cfg.freq_offset = atof(optarg); break;
+		case 'd': cfg.deviation = atof(optarg); break;
+		case 'b': cfg.symbol_rate = atof(optarg); break;
+		case 'D': cfg.detector = FSK_DET_DISCRIMINATOR; break;
+		case 'n': cfg.nrzi = 0; break;
+		case 'i': cfg.invert = 1; break;
+		case 'S': soft_out = 1; break;
+		case 'P': profile_path = optarg; break;
+		case 't':
+			if (parse_time(optarg, &start) != 0){
+				fprintf(stderr, "ERROR, bad time %s\n", optarg);
+				return 1;
+			}
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (argc - optind != 2 || cfg.sample_rate <= 0 || (profile_path && isnan(start))){
+		usage(argv[0]);
+		return 1;
+	}
+	if (profile_path && load_profile(profile_path, pts, passes) != 0){
+		fprintf(stderr, "ERROR, no pass in the profile %s\n", profile_path);
+		return 1;
+	}
+	if (fsk_demod_init(&d, &cfg) != 0){
+		fprintf(stderr, "ERROR, the sample rate is too low for %.0f Hz deviation at %.0f baud\n",
+				cfg.deviation, cfg.symbol_rate);
+		return 1;
+	}
+	if (capture_map_open(&in, argv[optind], 0) != 0){
+		fprintf(stderr, "ERROR, can't open %s\n", argv[optind]);
+		return 1;
+	}
+
+	nsamples = in.size/iq_sample_size(fmt);
+	base_offset = cfg.freq_offset;
+
+	auto t0 = std::chrono::steady_clock::now();
+
+	if (!profile_path){
+		if ((w.fp = fopen(argv[optind + 1], "wb")) == NULL){
+			fprintf(stderr, "ERROR, can't open %s\n", argv[optind + 1]);
+			return 1;
+		}
+		w.acc = 0;
+		w.nbits = 0;
+
+		for (k=0; k<nsamples; k+=n){
+			n = (size_t)std::min<uint64_t>(FSK_BLOCK, nsamples - k);
+			iq_convert(in.data + k*iq_sample_size(fmt), n, fmt, i.data(), q.data());
+			nsym = fsk_demod_process(&d, i.data(), q.data(), n, soft.data());
+			write_bits(&w, soft.data(), nsym, soft_out, buf.data());
+		}
+		demodulated = nsamples;
+
+		if (close_bits(&w, soft_out) != 0){
+			fprintf(stderr, "ERROR, can't write %s\n", argv[optind + 1]);
+			return 1;
+		}
+	}
+	else for (pass=0; pass<passes.size(); pass++){
+		const profile_pass *pp = &passes[pass];
+		std::string path;
+
+		// from the first whole second of the pass, so that the stamp of the file is exact
+		aos = ceil(pts[pp->first].time);
+		los = pts[pp->last].time;
+		k = aos > start ? (uint64_t)ceil((aos - start)*cfg.sample_rate) : 0;
+		end = los > start ? std::min<uint64_t>(nsamples, (uint64_t)((los - start)*cfg.sample_rate)) : 0;
+		if (k >= end) continue;
+
+		shift = doppler_at(pts, pp, start + k/cfg.sample_rate);
+		cfg.freq_offset = base_offset + shift;
+		fsk_demod_init(&d, &cfg);
+
+		path = pass_path(argv[optind + 1], start + k/cfg.sample_rate);
+		if ((w.fp = fopen(path.c_str(), "wb")) == NULL){
+			fprintf(stderr, "ERROR, can't open %s\n", path.c_str());
+			return 1;
+		}
+		w.acc = 0;
+		w.nbits = 0;
+		demodulated += end - k;
+
+		for (; k<end; k+=n){
+			double dop;
+
+			n = (size_t)std::min<uint64_t>(FSK_BLOCK, end - k);
+			dop = doppler_at(pts, pp, start + (k + n/2)/cfg.sample_rate);
+			if (fabs(dop - shift) >= DOPPLER_UPDATE_HZ){
+				shift = dop;
+				fsk_demod_set_offset(&d, base_offset + shift);
+			}
+
+			iq_convert(in.data + k*iq_sample_size(fmt), n, fmt, i.data(), q.data());
+			nsym = fsk_demod_process(&d, i.data(), q.data(), n, soft.data());
+			write_bits(&w, soft.data(), nsym, soft_out, buf.data());
+		}
+
+		if (close_bits(&w, soft_out) != 0){
+			fprintf(stderr, "ERROR, can't write %s\n", path.c_str());
+			return 1;
+		}
+		fprintf(stderr, "pass %u: %s, %llu bits\n", (unsigned)pass, path.c_str(), (unsigned long long)d.symbols);
+	}
+
+	double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+	capture_map_close(&in);
+
+	fprintf(stderr, "%llu samples (%.1f s), %llu demodulated in %.3f s: %.0fx real time (D %u, %.1f samples/symbol)\n",
+			(unsigned long long)nsamples, nsamples/cfg.sample_rate, (unsigned long long)demodulated, s,
+			nsamples/cfg.sample_rate/s, d.decim, d.sps);
+	return 0;
+}
@@ -0,0 +1,207 @@
+//============================================================================
+// Name        : pass_predict.cpp
+// Description : Passes of a satellite over the station and their Doppler profile
+//============================================================================
+
+#include <math.h>
+
+#include "pass_predict.h"
+
+// WGS-84
+#define WGS84_A			6378.137			// km
+#define WGS84_F			(1/298.257223563)
+#define EARTH_RATE		7.292115e-5			// rad/s
+
+#define DEG				(M_PI/180)
+
+void station_init(station *st, double lat_deg, double lon_deg, double alt_m){
+	double e2 = WGS84_F*(2 - WGS84_F), s, n;
+
+	st->lat = lat_deg*DEG;
+	st->lon = lon_deg*DEG;
+	st->alt = alt_m/1000;
+
+	s = sin(st->lat);
+	n = WGS84_A/sqrt(1 - e2*s*s);
+	st->ecef[0] = (n + st->alt)*cos(st->lat)*cos(st->lon);
+	st->ecef[1] = (n + st->alt)*cos(st->lat)*sin(st->lon);
+	st->ecef[2] = (n*(1 - e2) + st->alt)*s;
+}
+
+int look_at(const sgp4_orbit *o, const station *st, double t, look_angles *la){
+	double r[3], v[3], re[3], ve[3], d[3], g, cg, sg, sl, cl, sp, cp, e, n, u;
+
+	if (sgp4_propagate(o, t, r, v) != 0) return -1;
+
+	// TEME -> earth fixed: rotation by the sidereal time, minus the earth rotation in the velocity
+	g = sgp4_gmst(t);
+	cg = cos(g);
+	sg = sin(g);
+	re[0] = cg*r[0] + sg*r[1];
+	re[1] = -sg*r[0] + cg*r[1];
+	re[2] = r[2];
+	ve[0] = cg*v[0] + sg*v[1] + EARTH_RATE*re[1];
+	ve[1] = -sg*v[0] + cg*v[1] - EARTH_RATE*re[0];
+	ve[2] = v[2];
+
+	d[0] = re[0] - st->ecef[0];
+	d[1] = re[1] - st->ecef[1];
+	d[2] = re[2] - st->ecef[2];
+
+	// east, north, up
+	sl = sin(st->lon);
+	cl = cos(st->lon);
+	sp = sin(st->lat);
+	cp = cos(st->lat);
+	e = -sl*d[0] + cl*d[1];
+	n = -sp*cl*d[0] - sp*sl*d[1] + cp*d[2];
+	u = cp*cl*d[0] + cp*sl*d[1] + sp*d[2];
+
+	la->range = sqrt(d[0]*d[0] + d[1]*d[1] + d[2]*d[2]);
+	la->el = asin(u/la->range);
+	la->az = atan2(e, n);
+	if (la->az < 0) la->az += 2*M_PI;
+	la->range_rate = (d[0]*ve[0] + d[1]*ve[1] + d[2]*ve[2])/la->range;
+
+	return 0;
+}
+
+/* Elevation at t, -pi/2 if the orbit can't be propagated */
+static double elevation(const sgp4_orbit *o, const station *st, double t){
+	look_angles la;
+
+	return look_at(o, st, t, &la) == 0 ? la.el : -M_PI/2;
+}
+
+/* Time in [a, b] where the elevation crosses min_el, below at a when rising */
+static double crossing(const sgp4_orbit *o, const station *st, double a, double b, double min_el, int rising){
+	double m;
+
+	while (b - a > PASS_TOLERANCE){
+		m = (a + b)/2;
+		if ((elevation(o, st, m) >= min_el) == rising) b = m;
+		else a = m;
+	}
+	return (a + b)/2;
+}
+
+/* Highest elevation in [a, b] (one maximum): golden section */
+static double culmination(const sgp4_orbit *o, const station *st, double a, double b){
+	const double r = 0.6180339887498949;
+	double c = b - r*(b - a), d = a + r*(b - a);
+	double fc = elevation(o, st, c), fd = elevation(o, st, d);
+
+	while (b - a > PASS_TOLERANCE){
+		if (fc > fd){
+			b = d;
+			d = c;
+			fd = fc;
+			c = b - r*(b - a);
+			fc = elevation(o, st, c);
+		}
+		else {
+			a = c;
+			c = d;
+			fc = fd;
+			d = a + r*(b - a);
+			fd = elevation(o, st, d);
+		}
+	}
+	return (a + b)/2;
+}
+
+/* Culmination, maximum elevation and azimuths of p (aos and los set), kept if its AOS is before 'to' */
+static void pass_end(const sgp4_orbit *o, const station *st, pass_window *p, double to,
+					 std::vector<pass_window> &passes){
+	look_angles la;
+
+	p->max_el = elevation(o, st, p->tca);
+	look_at(o, st, p->aos, &la);
+	p->aos_az = la.az;
+	look_at(o, st, p->los, &la);
+	p->los_az = la.az;
+	if (p->aos < to) passes.push_back(*p);
+}
+
+std::vector<pass_window> pass_predict(const sgp4_orbit *o, const station *st, double from, double to,
+									  double min_el){
+	std::vector<pass_window> passes;
+	pass_window p;
+	double t, el, prev, prev2 = -M_PI/2, a, best = 0, best_t = 0;
+	int up;
+
+	el = elevation(o, st, from);
+	up = el >= min_el;
+	if (up){
+		p.aos = from;
+		best = el;
+		best_t = from;
+	}
+	prev = el;
+
+	// Two steps past 'to': a grazing pass is seen one step after its maximum
+	for (t=from + PASS_STEP; ; t+=PASS_STEP){
+		if (!up && t - 2*PASS_STEP >= to) break;
+		el = elevation(o, st, t);
+
+		// Maximum between the steps, below min_el on them: a grazing pass may be inside
+		if (!up && el < min_el && prev > prev2 && prev >= el){
+			a = t - 2*PASS_STEP > from ? t - 2*PASS_STEP : from;
+			p.tca = culmination(o, st, a, t);
+			if (elevation(o, st, p.tca) >= min_el){
+				p.aos = crossing(o, st, a, p.tca, min_el, 1);
+				p.los = crossing(o, st, p.tca, t, min_el, 0);
+				pass_end(o, st, &p, to, passes);
+			}
+		}
+
+		if (!up && el >= min_el){
+			up = 1;
+			p.aos = crossing(o, st, t - PASS_STEP, t, min_el, 1);
+			best = el;
+			best_t = t;
+		}
+		else if (up && el < min_el){
+			up = 0;
+			p.los = crossing(o, st, t - PASS_STEP, t, min_el, 0);
+			p.tca = culmination(o, st, best_t - PASS_STEP > p.aos ? best_t - PASS_STEP : p.aos,
+								best_t + PASS_STEP < p.los ? best_t + PASS_STEP : p.los);
+			pass_end(o, st, &p, to, passes);
+		}
+		else if (up && el > best){
+			best = el;
+			best_t = t;
+		}
+
+		prev2 = prev;
+		prev = el;
+	}
+
+	return passes;
+}
+
+std::vector<doppler_point> pass_doppler(const sgp4_orbit *o, const station *st, const pass_window *p,
+										double f_hz, double step){
+	std::vector<doppler_point> profile;
+	doppler_point d;
+	look_angles la;
+	double t;
+	int last = 0;
+
+	for (t=p->aos; !last; t+=step){
+		if (t >= p->los){
+			t = p->los;
+			last = 1;
+		}
+		if (look_at(o, st, t, &la) != 0) continue;
+
+		d.time = t;
+		d.az = la.az;
+		d.el = la.el;
+		d.range = la.range;
+		d.range_rate = la.range_rate;
+		d.doppler = -la.range_rate/SPEED_OF_LIGHT*f_hz;
+		profile.push_back(d);
+	}
+	return profile;
+}
@@ -0,0 +1,84 @@
+//============================================================================
+// Name        : pass_predict.h
+// Description : Passes of a satellite over the station and their Doppler profile
+//============================================================================
+
+#ifndef PASS_PREDICT_H_
+#define PASS_PREDICT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "sgp4.h"
+
+/*
+* The satellite position (sgp4.h, TEME) is turned to earth fixed by the
+* sidereal time (polar motion and TEME/PEF differences are below 50 m) and
+* seen from the station (WGS-84 geodetic) as azimuth, elevation, range and
+* range rate. The Doppler shift of a carrier f is -range_rate/c*f.
+*
+* The passes are found by stepping PASS_STEP seconds: a rise or set of the
+* elevation above the minimum is refined by bisection to PASS_TOLERANCE. A
+* pass culminating just above the minimum can be shorter than the step and
+* fall between two samples, so each maximum of the elevation seen on the
+* steps below the minimum is refined too (golden section over the two steps
+* around it, as the culmination of a pass) and gives a pass if it is above.
+* This takes the elevation to have one maximum in 2*PASS_STEP, true of any
+* orbit whose period is above a few minutes.
+*/
+
+#define PASS_STEP			20.0	// s
+#define PASS_TOLERANCE		0.1		// s
+#define SPEED_OF_LIGHT		299792.458	// km/s
+
+typedef struct {
+	double lat;					// rad, geodetic
+	double lon;					// rad, east
+	double alt;					// km
+	double ecef[3];				// km
+} station;
+
+typedef struct {
+	double az;					// rad, from north through east
+	double el;					// rad
+	double range;				// km
+	double range_rate;			// km/s, > 0 going away
+} look_angles;
+
+typedef struct {
+	double aos;					// s since the epoch
+	double los;
+	double tca;					// time of the highest elevation
+	double max_el;				// rad
+	double aos_az;				// rad
+	double los_az;
+} pass_window;
+
+typedef struct {
+	double time;
+	double az;
+	double el;
+	double range;
+	double range_rate;
+	double doppler;				// Hz
+} doppler_point;
+
+/* lat, lon in degrees, alt in m */
+void station_init(station *st, double lat_deg, double lon_deg, double alt_m);
+
+/* Returns 0 or -1 if the orbit can't be propagated to t */
+int look_at(const sgp4_orbit *o, const station *st, double t, look_angles *la);
+
+/*
+* Passes with AOS in [from, to) and an elevation above min_el (rad), in time
+* order. A pass in progress at 'from' starts at 'from'.
+*/
+std::vector<pass_window> pass_predict(const sgp4_orbit *o, const station *st, double from, double to,
+									  double min_el);
+
+/* Look angles and Doppler of carrier f_hz every 'step' seconds from AOS to LOS */
+std::vector<doppler_point> pass_doppler(const sgp4_orbit *o, const station *st, const pass_window *p,
+										double f_hz, double step);
+
+#endif /* PASS_PREDICT_H_ */
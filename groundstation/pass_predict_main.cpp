@@ -0,0 +1,148 @@
+//============================================================================
+// Name        : pass_predict_main.cpp
+// Description : Pass windows and Doppler profiles of a satellite over the station
+//============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <math.h>
+#include <vector>
+
+#include "pass_predict.h"
+
+#define DEG		(M_PI/180)
+
+static void usage(const char *prog){
+	fprintf(stderr, "Usage: %s -T tle.txt [-n name] [-q lat,lon[,alt]] [-f from] [-d hours] [-e degrees]\n"
+					"       [-F hz] [-p seconds -o profile.csv]\n", prog);
+	fprintf(stderr, "  -T  TLE file (2 or 3 lines per satellite)\n");
+	fprintf(stderr, "  -n  name or catalog number in the file (default: the first)\n");
+	fprintf(stderr, "  -q  station latitude, longitude (degrees) and altitude (m) (default: -27.6017,-48.5178,20, UFSC)\n");
+	fprintf(stderr, "  -f  start: seconds since the epoch or YYYY-MM-DDTHH:MM:SS (UTC) (default: now)\n");
+	fprintf(stderr, "  -d  hours to predict (default: 24)\n");
+	fprintf(stderr, "  -e  minimum elevation (default: 0)\n");
+	fprintf(stderr, "  -F  carrier for the Doppler (default: 437500000)\n");
+	fprintf(stderr, "  -p  -o  Doppler profile of each pass, a point every p seconds, for iq_demod -P\n");
+}
+
+static int parse_time(const char *s, double *t){
+	struct tm tm;
+	char *end;
+
+	*t = strtod(s, &end);
+	if (end != s && *end == '\0') return 0;
+
+	memset(&tm, 0, sizeof(tm));
+	end = strptime(s, "%Y-%m-%dT%H:%M:%S", &tm);
+	if (!end || (*end && strcmp(end, "Z") != 0)) return -1;
+	*t = (double)timegm(&tm);
+	return 0;
+}
+
+static void print_time(FILE *out, double t){
+	time_t sec = (time_t)t;
+	struct tm tm;
+	char buf[32];
+
+	gmtime_r(&sec, &tm);
+	strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+	fprintf(out, "%s.%03dZ", buf, (int)((t - (double)sec)*1000));
+}
+
+int main(int argc, char **argv){
+	const char *tle_path = NULL, *name = NULL, *profile_path = NULL;
+	double lat = -27.6017, lon = -48.5178, alt = 20;
+	double from = (double)time(NULL), hours = 24, min_el = 0, freq = 437.5e6, step = 0;
+	std::vector<pass_window> passes;
+	sgp4_orbit orbit;
+	station st;
+	tle el;
+	FILE *fp, *prof = NULL;
+	size_t k, i;
+	int c;
+
+	while ((c = getopt(argc, argv, "T:n:q:f:d:e:F:p:o:h")) != -1){
+		switch (c){
+		case 'T': tle_path = optarg; break;
+		case 'n': name = optarg; break;
+		case 'q':
+			if (sscanf(optarg, "%lf,%lf,%lf", &lat, &lon, &alt) < 2){
+				fprintf(stderr, "ERROR, bad station %s\n", optarg);
+				return 1;
+			}
+			break;
+		case 'f':
+			if (parse_time(optarg, &from) != 0){
+				fprintf(stderr, "ERROR, bad time %s\n", optarg);
+				return 1;
+			}
+			break;
+		case 'd': hours = atof(optarg); break;
+		case 'e': min_el = atof(optarg); break;
+		case 'F': freq = atof(optarg); break;
+		case 'p': step = atof(optarg); break;
+		case 'o': profile_path = optarg; break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (!tle_path || optind != argc || hours <= 0 || (step > 0) != (profile_path != NULL)){
+		usage(argv[0]);
+		return 1;
+	}
+	if (!(fp = fopen(tle_path, "r"))){
+		fprintf(stderr, "ERROR, can't open %s\n", tle_path);
+		return 1;
+	}
+	if (tle_read(fp, name, &el) != 0){
+		fprintf(stderr, "ERROR, no element set %s in %s\n", name ? name : "", tle_path);
+		fclose(fp);
+		return 1;
+	}
+	fclose(fp);
+
+	if (sgp4_init(&orbit, &el) != 0){
+		fprintf(stderr, "ERROR, %s is not a near earth orbit\n", el.name);
+		return 1;
+	}
+	if (fabs(from - el.epoch) > 14*86400)
+		fprintf(stderr, "WARNING, the elements of %s are %.0f days from the start\n", el.name, fabs(from - el.epoch)/86400);
+
+	station_init(&st, lat, lon, alt);
+	passes = pass_predict(&orbit, &st, from, from + hours*3600, min_el*DEG);
+
+	printf("aos,los,duration_s,tca,max_el,aos_az,los_az\n");
+	for (k=0; k<passes.size(); k++){
+		const pass_window *p = &passes[k];
+
+		print_time(stdout, p->aos);
+		putchar(',');
+		print_time(stdout, p->los);
+		printf(",%.0f,", p->los - p->aos);
+		print_time(stdout, p->tca);
+		printf(",%.1f,%.1f,%.1f\n", p->max_el/DEG, p->aos_az/DEG, p->los_az/DEG);
+	}
+
+	if (profile_path){
+		if (!(prof = fopen(profile_path, "w"))){
+			fprintf(stderr, "ERROR, can't open %s\n", profile_path);
+			return 1;
+		}
+		fprintf(prof, "time,pass,az,el,range_km,range_rate_km_s,doppler_hz\n");
+		for (k=0; k<passes.size(); k++){
+			std::vector<doppler_point> d = pass_doppler(&orbit, &st, &passes[k], freq, step);
+
+			for (i=0; i<d.size(); i++)
+				fprintf(prof, "%.3f,%u,%.2f,%.2f,%.3f,%.5f,%.1f\n", d[i].time, (unsigned)k, d[i].az/DEG,
+						d[i].el/DEG, d[i].range, d[i].range_rate, d[i].doppler);
+		}
+		fclose(prof);
+	}
+
+	return 0;
+}
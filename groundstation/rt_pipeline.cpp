@@ -0,0 +1,301 @@
+//============================================================================
+// Name        : rt_pipeline.cpp
+// Description : Real-time decode pipeline (capture -> deframe -> CRC -> decode -> store)
+//============================================================================
+
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <thread>
+
+#include "rt_pipeline.h"
+#include "ax25_decoder.h"
+#include "dedup_index.h"
+#include "hdlc.h"
+#include "spsc_ring.h"
+
+#define RT_CHUNK	4096		// bytes the deframer takes from the input ring at a time
+
+typedef struct {
+	std::atomic<uint64_t> in, out, full, high_water;
+} stage_counters;
+
+struct rt_pipeline {
+	rt_options opt;
+
+	spsc_ring<uint8_t> input;
+	spsc_ring<decoded_frame> deframed, checked, decoded;
+
+	std::atomic<int> input_done, deframe_done, crc_done, decode_done;
+
+	std::atomic<uint64_t> bytes_in, bytes_dropped, fcs_errors, duplicates, backlog, backlog_max;
+	stage_counters deframe, crc, decode, store;
+
+	std::thread threads[4];
+
+	rt_pipeline(const rt_options &o)
+		: opt(o), input(o.input_bytes), deframed(o.frame_slots), checked(o.frame_slots), decoded(o.frame_slots){}
+};
+
+void rt_default_options(rt_options *opt){
+	opt->bitrate = 1200;
+	opt->start_time = 0;
+	opt->text = 0;
+	opt->destuff = 1;
+	opt->keep_bad = 0;
+	opt->dedup_window = 0;
+	opt->input_bytes = (size_t)1 << 20;		// ~2 h at 1200 bit/s
+	opt->frame_slots = 1024;
+	opt->store = NULL;
+	opt->user = NULL;
+}
+
+/* Spins, then yields, then sleeps while a stage has nothing to do */
+static void idle(int *spins){
+	if (++*spins < 64) return;
+	if (*spins < 128) std::this_thread::yield();
+	else std::this_thread::sleep_for(std::chrono::microseconds(200));
+}
+
+static void seen(std::atomic<uint64_t> &high_water, size_t n){
+	if (n > high_water.load(std::memory_order_relaxed)) high_water.store(n, std::memory_order_relaxed);
+}
+
+/* Waits for room in the next ring; only deframe, CRC and decode wait */
+static void push_wait(spsc_ring<decoded_frame> &ring, const decoded_frame &f, stage_counters &c){
+	int spins = 0;
+
+	if (!ring.push(f)){
+		c.full.fetch_add(1, std::memory_order_relaxed);
+		while (!ring.push(f)) idle(&spins);
+	}
+	c.out.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void deframe_cb(const uint8_t *frame, size_t len, uint64_t bit_pos, void *user){
+	rt_pipeline *p = (rt_pipeline *)user;
+	decoded_frame rec;
+
+	rec.time = p->opt.start_time + (double)bit_pos/p->opt.bitrate;
+	rec.file = 0;
+	rec.bit_pos = bit_pos;
+	rec.frame_len = (uint16_t)len;
+	memcpy(rec.frame, frame, len);
+
+	push_wait(p->deframed, rec, p->deframe);
+}
+
+static void deframe_stage(rt_pipeline *p){
+	uint8_t chunk[RT_CHUNK];
+	hdlc_deframer d;
+	size_t n;
+	int spins = 0, done;
+
+	hdlc_deframer_init(&d, deframe_cb, p);
+	d.destuff = p->opt.destuff;
+
+	for (;;){
+		done = p->input_done.load(std::memory_order_acquire);
+		seen(p->deframe.high_water, p->input.size());
+
+		if ((n = p->input.pop_n(chunk, sizeof(chunk))) == 0){
+			if (done) break;
+			idle(&spins);
+			continue;
+		}
+		spins = 0;
+		p->deframe.in.fetch_add(n, std::memory_order_relaxed);
+
+		if (p->opt.text) hdlc_push_bits(&d, chunk, n);
+		else hdlc_push_bytes(&d, chunk, n);
+	}
+
+	p->deframe_done.store(1, std::memory_order_release);
+}
+
+/* Parses the frame and checks the FCS; the Info field is found again from info_len */
+static void crc_stage(rt_pipeline *p){
+	decoded_frame rec;
+	ax25_frame f;
+	int spins = 0, done;
+
+	for (;;){
+		done = p->deframe_done.load(std::memory_order_acquire);
+		seen(p->crc.high_water, p->deframed.size());
+
+		if (!p->deframed.pop(rec)){
+			if (done) break;
+			idle(&spins);
+			continue;
+		}
+		spins = 0;
+		p->crc.in.fetch_add(1, std::memory_order_relaxed);
+
+		if (ax25_decode_frame(rec.frame, rec.frame_len, &f) != 0) continue;
+		if (!f.fcs_ok){
+			p->fcs_errors.fetch_add(1, std::memory_order_relaxed);
+			if (!p->opt.keep_bad) continue;
+		}
+
+		memcpy(rec.destination, f.destination, sizeof(rec.destination));
+		memcpy(rec.source, f.source, sizeof(rec.source));
+		rec.control = f.control;
+		rec.pid = f.pid;
+		rec.info_len = (uint16_t)f.info_len;
+		rec.fcs_ok = f.fcs_ok;
+		rec.schema = NULL;
+
+		push_wait(p->checked, rec, p->crc);
+	}
+
+	p->crc_done.store(1, std::memory_order_release);
+}
+
+static void decode_stage(rt_pipeline *p){
+	std::deque<decoded_frame> backlog;
+	decoded_frame rec;
+	const uint8_t *info;
+	dedup_index dedup;
+	int spins = 0, done, busy;
+
+	if (p->opt.dedup_window > 0) dedup_init(&dedup, DEDUP_CAPACITY, p->opt.dedup_window);
+
+	for (;;){
+		done = p->crc_done.load(std::memory_order_acquire);
+		seen(p->decode.high_water, p->checked.size());
+		busy = 0;
+
+		// the backlog goes first, so the store stage sees the frames in order
+		while (!backlog.empty() && p->decoded.push(backlog.front())){
+			backlog.pop_front();
+			p->decode.out.fetch_add(1, std::memory_order_relaxed);
+			busy = 1;
+		}
+		p->backlog.store(backlog.size(), std::memory_order_relaxed);
+
+		if (p->checked.pop(rec)){
+			p->decode.in.fetch_add(1, std::memory_order_relaxed);
+			busy = 1;
+
+			if (p->opt.dedup_window > 0 && rec.fcs_ok &&
+				dedup_check(&dedup, dedup_key(rec.frame, rec.frame_len), rec.time)){
+				p->duplicates.fetch_add(1, std::memory_order_relaxed);
+				continue;
+			}
+
+			info = rec.frame + rec.frame_len - AX25_FCS_LEN - rec.info_len;
+			rec.schema = rec.fcs_ok ? tlm_match(info, rec.info_len) : NULL;
+			if (rec.schema) tlm_decode(rec.schema, info, rec.values);
+
+			if (backlog.empty() && p->decoded.push(rec)) p->decode.out.fetch_add(1, std::memory_order_relaxed);
+			else {
+				p->decode.full.fetch_add(1, std::memory_order_relaxed);
+				backlog.push_back(rec);
+				if (backlog.size() > p->backlog_max.load(std::memory_order_relaxed))
+					p->backlog_max.store(backlog.size(), std::memory_order_relaxed);
+			}
+		}
+
+		if (busy) spins = 0;
+		else if (done && backlog.empty()) break;
+		else idle(&spins);
+	}
+
+	p->decode_done.store(1, std::memory_order_release);
+}
+
+static void store_stage(rt_pipeline *p){
+	decoded_frame rec;
+	int spins = 0, done;
+
+	for (;;){
+		done = p->decode_done.load(std::memory_order_acquire);
+		seen(p->store.high_water, p->decoded.size());
+
+		if (!p->decoded.pop(rec)){
+			if (done) break;
+			idle(&spins);
+			continue;
+		}
+		spins = 0;
+		p->store.in.fetch_add(1, std::memory_order_relaxed);
+
+		if (p->opt.store) p->opt.store(&rec, p->opt.user);
+		p->store.out.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+rt_pipeline *rt_pipeline_start(const rt_options *opt){
+	rt_pipeline *p;
+
+	if (opt->bitrate <= 0 || opt->input_bytes == 0 || opt->frame_slots == 0) return NULL;
+
+	p = new rt_pipeline(*opt);
+	if (p->opt.start_time == 0)
+		p->opt.start_time = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+	p->input_done = p->deframe_done = p->crc_done = p->decode_done = 0;
+	p->bytes_in = p->bytes_dropped = p->fcs_errors = p->duplicates = p->backlog = p->backlog_max = 0;
+	for (stage_counters *c : {&p->deframe, &p->crc, &p->decode, &p->store})
+		c->in = c->out = c->full = c->high_water = 0;
+
+	p->threads[0] = std::thread(deframe_stage, p);
+	p->threads[1] = std::thread(crc_stage, p);
+	p->threads[2] = std::thread(decode_stage, p);
+	p->threads[3] = std::thread(store_stage, p);
+
+	return p;
+}
+
+size_t rt_pipeline_push(rt_pipeline *p, const uint8_t *data, size_t n){
+	size_t k = p->input.push_n(data, n);
+
+	p->bytes_in.fetch_add(k, std::memory_order_relaxed);
+	if (k < n) p->bytes_dropped.fetch_add(n - k, std::memory_order_relaxed);
+	return k;
+}
+
+void rt_pipeline_push_wait(rt_pipeline *p, const uint8_t *data, size_t n){
+	size_t k;
+	int spins = 0;
+
+	while (n > 0){
+		k = p->input.push_n(data, n);
+		p->bytes_in.fetch_add(k, std::memory_order_relaxed);
+		data += k;
+		n -= k;
+		if (k == 0) idle(&spins);
+		else spins = 0;
+	}
+}
+
+static void copy_stage(rt_stage_stats *s, const stage_counters &c){
+	s->in = c.in.load(std::memory_order_relaxed);
+	s->out = c.out.load(std::memory_order_relaxed);
+	s->full = c.full.load(std::memory_order_relaxed);
+	s->high_water = c.high_water.load(std::memory_order_relaxed);
+}
+
+void rt_pipeline_stats(const rt_pipeline *p, rt_stats *stats){
+	stats->bytes_in = p->bytes_in.load(std::memory_order_relaxed);
+	stats->bytes_dropped = p->bytes_dropped.load(std::memory_order_relaxed);
+	copy_stage(&stats->deframe, p->deframe);
+	copy_stage(&stats->crc, p->crc);
+	copy_stage(&stats->decode, p->decode);
+	copy_stage(&stats->store, p->store);
+	stats->fcs_errors = p->fcs_errors.load(std::memory_order_relaxed);
+	stats->duplicates = p->duplicates.load(std::memory_order_relaxed);
+	stats->backlog = p->backlog.load(std::memory_order_relaxed);
+	stats->backlog_max = p->backlog_max.load(std::memory_order_relaxed);
+}
+
+void rt_pipeline_stop(rt_pipeline *p, rt_stats *stats){
+	int i;
+
+	p->input_done.store(1, std::memory_order_release);
+	for (i=0; i<4; i++) p->threads[i].join();
+
+	if (stats) rt_pipeline_stats(p, stats);
+	delete p;
+}
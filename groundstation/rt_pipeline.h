@@ -0,0 +1,86 @@
+//============================================================================
+// Name        : rt_pipeline.h
+// Description : Real-time decode pipeline (capture -> deframe -> CRC -> decode -> store)
+//============================================================================
+
+#ifndef RT_PIPELINE_H_
+#define RT_PIPELINE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "batch_decoder.h"
+
+/*
+* The receiver thread calls rt_pipeline_push() with the bits as they arrive.
+* Each stage runs on its own thread and the stages are connected by
+* single-producer/single-consumer rings (spsc_ring.h):
+*
+*   push() -> [bytes] -> deframe -> [frames] -> CRC -> [frames] -> decode -> [frames] -> store
+*
+* push() never blocks: it copies into the input ring, sized for minutes of
+* bits, and counts the bytes that don't fit as dropped. deframe, CRC and decode
+* wait when their output ring is full (counted in 'full'). The decode stage
+* never waits on the store ring: when the store stage (disk) is slow, decoded
+* frames go to a backlog in memory that is sent to the store ring as it drains,
+* so a slow disk can't hold back the input.
+*
+* The store callback runs on the store thread, one frame at a time in arrival
+* order. decoded_frame::file is always 0.
+*/
+
+typedef void (*rt_store_cb)(const decoded_frame *f, void *user);
+
+typedef struct {
+	double bitrate;				// bits/s of the input
+	double start_time;			// time of the first bit, seconds since the epoch (0 = now)
+	int text;					// input is '0'/'1' characters instead of packed bits
+	int destuff;				// 0 for input without bit stuffing
+	int keep_bad;				// also store frames with a wrong FCS
+	double dedup_window;		// s, the decode stage drops copies of a frame (0 = keep all)
+	size_t input_bytes;			// input ring
+	size_t frame_slots;			// each frame ring
+	rt_store_cb store;
+	void *user;
+} rt_options;
+
+typedef struct {
+	uint64_t in;				// items taken from the input ring
+	uint64_t out;				// items given to the next stage
+	uint64_t full;				// times the output ring was full
+	uint64_t high_water;		// largest occupancy seen of the input ring
+} rt_stage_stats;
+
+typedef struct {
+	uint64_t bytes_in;			// bytes accepted by push()
+	uint64_t bytes_dropped;		// bytes that didn't fit in the input ring
+	rt_stage_stats deframe;		// in: bytes, out: frames
+	rt_stage_stats crc;			// out: frames with a good FCS (or all with keep_bad)
+	rt_stage_stats decode;		// full: frames sent to the backlog
+	rt_stage_stats store;
+	uint64_t fcs_errors;
+	uint64_t duplicates;
+	uint64_t backlog;			// frames waiting for the store ring
+	uint64_t backlog_max;
+} rt_stats;
+
+typedef struct rt_pipeline rt_pipeline;
+
+void rt_default_options(rt_options *opt);
+
+/* Starts the stage threads. Returns NULL on error. */
+rt_pipeline *rt_pipeline_start(const rt_options *opt);
+
+/* Input bits, from one thread only. Returns the bytes accepted (n unless the input ring is full). */
+size_t rt_pipeline_push(rt_pipeline *p, const uint8_t *data, size_t n);
+
+/* Same, but waits for room instead of dropping: for input read from a file, not at line rate */
+void rt_pipeline_push_wait(rt_pipeline *p, const uint8_t *data, size_t n);
+
+/* Snapshot of the counters, from any thread */
+void rt_pipeline_stats(const rt_pipeline *p, rt_stats *stats);
+
+/* End of input: drains every stage, joins the threads and frees p. stats may be NULL. */
+void rt_pipeline_stop(rt_pipeline *p, rt_stats *stats);
+
+#endif /* RT_PIPELINE_H_ */
@@ -0,0 +1,343 @@
+//============================================================================
+// Name        : sgp4.cpp
+// Description : Two-line element sets and the SGP4 orbit propagator
+//============================================================================
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#include "sgp4.h"
+
+// WGS-72
+#define RE			6378.135				// km
+#define XKE			0.0743669161331734132	// 60/sqrt(RE^3/mu), 1/min
+#define J2			0.001082616
+#define J3			-0.00000253881
+#define J4			-0.00000165597
+#define J3OJ2		(J3/J2)
+
+#define TWO_PI		6.283185307179586
+#define DEG			(TWO_PI/360)
+#define X2O3		(2.0/3.0)
+
+/* ---------------------------------- TLE ---------------------------------- */
+
+/* Field of 'len' characters at column 'col' (1 based) */
+static double field(const char *line, int col, int len){
+	char buf[24];
+
+	memcpy(buf, line + col - 1, (size_t)len);
+	buf[len] = '\0';
+	return atof(buf);
+}
+
+/* " 12345-4" -> 0.12345e-4 */
+static double implied_exp(const char *line, int col){
+	char buf[16];
+	double m;
+
+	buf[0] = '.';
+	memcpy(buf + 1, line + col, 5);
+	buf[6] = '\0';
+	m = atof(buf);
+	if (line[col - 1] == '-') m = -m;
+	return m*pow(10.0, field(line, col + 6, 2));
+}
+
+static int checksum_ok(const char *line){
+	int sum = 0, i;
+
+	for (i=0; i<68; i++){
+		if (line[i] >= '0' && line[i] <= '9') sum += line[i] - '0';
+		else if (line[i] == '-') sum++;
+	}
+	return line[68] < '0' || line[68] > '9' || sum % 10 == line[68] - '0';
+}
+
+int tle_parse(const char *line0, const char *line1, const char *line2, tle *el){
+	char buf[16];
+	struct tm tm;
+	double day;
+	int year;
+	size_t n;
+
+	if (strlen(line1) < 69 || strlen(line2) < 69 || line1[0] != '1' || line2[0] != '2') return -1;
+	if (!checksum_ok(line1) || !checksum_ok(line2)) return -1;
+
+	el->catalog = (int)field(line1, 3, 5);
+	if ((int)field(line2, 3, 5) != el->catalog) return -1;
+
+	if (line0 && *line0){
+		if (line0[0] == '0' && line0[1] == ' ') line0 += 2;
+		for (n=0; n<sizeof(el->name) - 1 && line0[n] && line0[n] != '\r' && line0[n] != '\n'; n++) el->name[n] = line0[n];
+		while (n > 0 && el->name[n-1] == ' ') n--;
+		el->name[n] = '\0';
+	}
+	else snprintf(el->name, sizeof(el->name), "%05d", el->catalog);
+
+	year = (int)field(line1, 19, 2);
+	year += year < 57 ? 2000 : 1900;
+	day = field(line1, 21, 12);
+	memset(&tm, 0, sizeof(tm));
+	tm.tm_year = year - 1900;
+	tm.tm_mday = 1;
+	el->epoch = (double)timegm(&tm) + (day - 1)*86400;
+
+	el->bstar = implied_exp(line1, 54);
+	el->inclination = field(line2, 9, 8)*DEG;
+	el->raan = field(line2, 18, 8)*DEG;
+	buf[0] = '.';
+	memcpy(buf + 1, line2 + 26, 7);
+	buf[8] = '\0';
+	el->eccentricity = atof(buf);
+	el->arg_perigee = field(line2, 35, 8)*DEG;
+	el->mean_anomaly = field(line2, 44, 8)*DEG;
+	el->mean_motion = field(line2, 53, 11)*TWO_PI/1440;
+
+	return el->mean_motion > 0 && el->eccentricity < 1 ? 0 : -1;
+}
+
+int tle_read(FILE *fp, const char *match, tle *el){
+	char l0[128] = "", l1[128] = "", l2[128];
+
+	while (fgets(l2, sizeof(l2), fp)){
+		if (l2[0] == '2' && l1[0] == '1' && tle_parse(l0, l1, l2, el) == 0){
+			if (!match || strcmp(el->name, match) == 0 || atoi(match) == el->catalog) return 0;
+		}
+		memcpy(l0, l1, sizeof(l0));
+		memcpy(l1, l2, sizeof(l1));
+	}
+	return -1;
+}
+
+/* --------------------------------- SGP4 ---------------------------------- */
+
+int sgp4_init(sgp4_orbit *o, const tle *el){
+	double ecco = el->eccentricity, inclo = el->inclination, bstar = el->bstar;
+	double eccsq, omeosq, rteosq, cosio, cosio2, sinio, ak, d1, del, adel, po, posq, rp;
+	double ss, qzms2t, sfour, qzms24, perige, pinvsq, tsi, etasq, eeta, psisq, coef, coef1, cc2, cc3;
+	double cosio4, temp1, temp2, temp3, xhdot1, con42, cc1sq, temp;
+
+	memset(o, 0, sizeof(*o));
+	o->el = *el;
+
+	eccsq = ecco*ecco;
+	omeosq = 1 - eccsq;
+	rteosq = sqrt(omeosq);
+	cosio = cos(inclo);
+	cosio2 = cosio*cosio;
+	sinio = sin(inclo);
+
+	// un-Kozai the mean motion
+	ak = pow(XKE/el->mean_motion, X2O3);
+	d1 = 0.75*J2*(3*cosio2 - 1)/(rteosq*omeosq);
+	del = d1/(ak*ak);
+	adel = ak*(1 - del*del - del*(1.0/3 + 134*del*del/81));
+	del = d1/(adel*adel);
+	o->no = el->mean_motion/(1 + del);
+
+	if (TWO_PI/o->no >= 225 || ecco < 0 || omeosq <= 0) return -1;		// deep space
+
+	o->ao = pow(XKE/o->no, X2O3);
+	po = o->ao*omeosq;
+	posq = po*po;
+	con42 = 1 - 5*cosio2;
+	o->con41 = -con42 - cosio2 - cosio2;
+	rp = o->ao*(1 - ecco);
+	o->isimp = rp < 220/RE + 1;
+
+	// atmosphere: s and (q0 - s)^4, lowered for a perigee below 156 km
+	ss = 78/RE + 1;
+	qzms2t = pow((120 - 78)/RE, 4);
+	sfour = ss;
+	qzms24 = qzms2t;
+	perige = (rp - 1)*RE;
+	if (perige < 156){
+		sfour = perige < 98 ? 20 : perige - 78;
+		qzms24 = pow((120 - sfour)/RE, 4);
+		sfour = sfour/RE + 1;
+	}
+
+	pinvsq = 1/posq;
+	tsi = 1/(o->ao - sfour);
+	o->eta = o->ao*ecco*tsi;
+	etasq = o->eta*o->eta;
+	eeta = ecco*o->eta;
+	psisq = fabs(1 - etasq);
+	coef = qzms24*pow(tsi, 4);
+	coef1 = coef/pow(psisq, 3.5);
+	cc2 = coef1*o->no*(o->ao*(1 + 1.5*etasq + eeta*(4 + etasq)) +
+			0.375*J2*tsi/psisq*o->con41*(8 + 3*etasq*(8 + etasq)));
+	o->cc1 = bstar*cc2;
+	cc3 = ecco > 1e-4 ? -2*coef*tsi*J3OJ2*o->no*sinio/ecco : 0;
+	o->x1mth2 = 1 - cosio2;
+	o->cc4 = 2*o->no*coef1*o->ao*omeosq*(o->eta*(2 + 0.5*etasq) + ecco*(0.5 + 2*etasq) -
+			J2*tsi/(o->ao*psisq)*(-3*o->con41*(1 - 2*eeta + etasq*(1.5 - 0.5*eeta)) +
+			0.75*o->x1mth2*(2*etasq - eeta*(1 + etasq))*cos(2*el->arg_perigee)));
+	o->cc5 = 2*coef1*o->ao*omeosq*(1 + 2.75*(etasq + eeta) + eeta*etasq);
+
+	// secular rates
+	cosio4 = cosio2*cosio2;
+	temp1 = 1.5*J2*pinvsq*o->no;
+	temp2 = 0.5*temp1*J2*pinvsq;
+	temp3 = -0.46875*J4*pinvsq*pinvsq*o->no;
+	o->mdot = o->no + 0.5*temp1*rteosq*o->con41 + 0.0625*temp2*rteosq*(13 - 78*cosio2 + 137*cosio4);
+	o->argpdot = -0.5*temp1*con42 + 0.0625*temp2*(7 - 114*cosio2 + 395*cosio4) +
+			temp3*(3 - 36*cosio2 + 49*cosio4);
+	xhdot1 = -temp1*cosio;
+	o->nodedot = xhdot1 + (0.5*temp2*(4 - 19*cosio2) + 2*temp3*(3 - 7*cosio2))*cosio;
+
+	o->omgcof = bstar*cc3*cos(el->arg_perigee);
+	o->xmcof = ecco > 1e-4 ? -X2O3*coef*bstar/eeta : 0;
+	o->nodecf = 3.5*omeosq*xhdot1*o->cc1;
+	o->t2cof = 1.5*o->cc1;
+	o->xlcof = -0.25*J3OJ2*sinio*(3 + 5*cosio)/(fabs(cosio + 1) > 1.5e-12 ? 1 + cosio : 1.5e-12);
+	o->aycof = -0.5*J3OJ2*sinio;
+	o->delmo = pow(1 + o->eta*cos(el->mean_anomaly), 3);
+	o->sinmao = sin(el->mean_anomaly);
+	o->x7thm1 = 7*cosio2 - 1;
+
+	if (!o->isimp){
+		cc1sq = o->cc1*o->cc1;
+		o->d2 = 4*o->ao*tsi*cc1sq;
+		temp = o->d2*tsi*o->cc1/3;
+		o->d3 = (17*o->ao + sfour)*temp;
+		o->d4 = 0.5*temp*o->ao*tsi*(221*o->ao + 31*sfour)*o->cc1;
+		o->t3cof = o->d2 + 2*cc1sq;
+		o->t4cof = 0.25*(3*o->d3 + o->cc1*(12*o->d2 + 10*cc1sq));
+		o->t5cof = 0.2*(3*o->d4 + 12*o->cc1*o->d3 + 6*o->d2*o->d2 + 15*cc1sq*(2*o->d2 + cc1sq));
+	}
+
+	return 0;
+}
+
+int sgp4_propagate(const sgp4_orbit *o, double t, double r[3], double v[3]){
+	const tle *el = &o->el;
+	double tsince = (t - el->epoch)/60;		// min
+	double t2 = tsince*tsince, xmdf, argpdf, nodedf, argpm, mm, nodem, tempa, tempe, templ;
+	double delomg, delm, temp, t3, t4, am, nm, em, xlm, axnl, aynl, xl, u, eo1, tem5;
+	double sineo1 = 0, coseo1 = 1, ecose, esine, el2, pl, rl, rdotl, rvdotl, betal;
+	double sinu, cosu, su, sin2u, cos2u, temp1, temp2, mrt, xnode, xinc, mvt, rvdot;
+	double sinsu, cossu, snod, cnod, sini, cosi, xmx, xmy, ux, uy, uz, vx, vy, vz;
+	const double vkmpersec = RE*XKE/60;
+	int ktr;
+
+	xmdf = el->mean_anomaly + o->mdot*tsince;
+	argpdf = el->arg_perigee + o->argpdot*tsince;
+	nodedf = el->raan + o->nodedot*tsince;
+	argpm = argpdf;
+	mm = xmdf;
+	nodem = nodedf + o->nodecf*t2;
+	tempa = 1 - o->cc1*tsince;
+	tempe = el->bstar*o->cc4*tsince;
+	templ = o->t2cof*t2;
+
+	if (!o->isimp){
+		delomg = o->omgcof*tsince;
+		delm = o->xmcof*(pow(1 + o->eta*cos(xmdf), 3) - o->delmo);
+		temp = delomg + delm;
+		mm = xmdf + temp;
+		argpm = argpdf - temp;
+		t3 = t2*tsince;
+		t4 = t3*tsince;
+		tempa = tempa - o->d2*t2 - o->d3*t3 - o->d4*t4;
+		tempe = tempe + el->bstar*o->cc5*(sin(mm) - o->sinmao);
+		templ = templ + o->t3cof*t3 + t4*(o->t4cof + tsince*o->t5cof);
+	}
+
+	am = pow(XKE/o->no, X2O3)*tempa*tempa;
+	nm = XKE/pow(am, 1.5);
+	em = el->eccentricity - tempe;
+	if (em >= 1 || em < -0.001) return -1;
+	if (em < 1e-6) em = 1e-6;
+	mm = mm + o->no*templ;
+	xlm = mm + argpm + nodem;
+
+	nodem = fmod(nodem, TWO_PI);
+	argpm = fmod(argpm, TWO_PI);
+	xlm = fmod(xlm, TWO_PI);
+	mm = fmod(xlm - argpm - nodem, TWO_PI);
+
+	// long period periodics
+	axnl = em*cos(argpm);
+	temp = 1/(am*(1 - em*em));
+	aynl = em*sin(argpm) + temp*o->aycof;
+	xl = mm + argpm + nodem + temp*o->xlcof*axnl;
+
+	// Kepler's equation
+	u = fmod(xl - nodem, TWO_PI);
+	eo1 = u;
+	tem5 = 9999.9;
+	for (ktr=0; fabs(tem5) >= 1e-12 && ktr < 10; ktr++){
+		sineo1 = sin(eo1);
+		coseo1 = cos(eo1);
+		tem5 = (u - aynl*coseo1 + axnl*sineo1 - eo1)/(1 - coseo1*axnl - sineo1*aynl);
+		if (fabs(tem5) >= 0.95) tem5 = tem5 > 0 ? 0.95 : -0.95;
+		eo1 += tem5;
+	}
+
+	// short period preliminary quantities
+	ecose = axnl*coseo1 + aynl*sineo1;
+	esine = axnl*sineo1 - aynl*coseo1;
+	el2 = axnl*axnl + aynl*aynl;
+	pl = am*(1 - el2);
+	if (pl < 0) return -1;
+
+	rl = am*(1 - ecose);
+	rdotl = sqrt(am)*esine/rl;
+	rvdotl = sqrt(pl)/rl;
+	betal = sqrt(1 - el2);
+	temp = esine/(1 + betal);
+	sinu = am/rl*(sineo1 - aynl - axnl*temp);
+	cosu = am/rl*(coseo1 - axnl + aynl*temp);
+	su = atan2(sinu, cosu);
+	sin2u = (cosu + cosu)*sinu;
+	cos2u = 1 - 2*sinu*sinu;
+	temp = 1/pl;
+	temp1 = 0.5*J2*temp;
+	temp2 = temp1*temp;
+
+	// short periodics
+	mrt = rl*(1 - 1.5*temp2*betal*o->con41) + 0.5*temp1*o->x1mth2*cos2u;
+	su = su - 0.25*temp2*o->x7thm1*sin2u;
+	xnode = nodem + 1.5*temp2*cos(el->inclination)*sin2u;
+	xinc = el->inclination + 1.5*temp2*cos(el->inclination)*sin(el->inclination)*cos2u;
+	mvt = rdotl - nm*temp1*o->x1mth2*sin2u/XKE;
+	rvdot = rvdotl + nm*temp1*(o->x1mth2*cos2u + 1.5*o->con41)/XKE;
+
+	// orientation vectors
+	sinsu = sin(su);
+	cossu = cos(su);
+	snod = sin(xnode);
+	cnod = cos(xnode);
+	sini = sin(xinc);
+	cosi = cos(xinc);
+	xmx = -snod*cosi;
+	xmy = cnod*cosi;
+	ux = xmx*sinsu + cnod*cossu;
+	uy = xmy*sinsu + snod*cossu;
+	uz = sini*sinsu;
+	vx = xmx*cossu - cnod*sinsu;
+	vy = xmy*cossu - snod*sinsu;
+	vz = sini*cossu;
+
+	r[0] = mrt*ux*RE;
+	r[1] = mrt*uy*RE;
+	r[2] = mrt*uz*RE;
+	v[0] = (mvt*ux + rvdot*vx)*vkmpersec;
+	v[1] = (mvt*uy + rvdot*vy)*vkmpersec;
+	v[2] = (mvt*uz + rvdot*vz)*vkmpersec;
+
+	return mrt < 1 ? -1 : 0;		// below the surface: decayed
+}
+
+double sgp4_gmst(double t){
+	double tut1 = (t/86400 + 2440587.5 - 2451545.0)/36525;
+	double g = -6.2e-6*tut1*tut1*tut1 + 0.093104*tut1*tut1 +
+			(876600.0*3600 + 8640184.812866)*tut1 + 67310.54841;	// s
+
+	g = fmod(g*DEG/240, TWO_PI);
+	return g < 0 ? g + TWO_PI : g;
+}
@@ -0,0 +1,62 @@
+//============================================================================
+// Name        : sgp4.h
+// Description : Two-line element sets and the SGP4 orbit propagator
+//============================================================================
+
+#ifndef SGP4_H_
+#define SGP4_H_
+
+#include <stdio.h>
+
+/*
+* SGP4 of Spacetrack Report #3 as revised by Vallado et al. (AIAA 2006-6753),
+* WGS-72 constants, near earth only: the TLE of an orbit of 225 minutes or
+* more (SDP4, deep space) is rejected, FloripaSat and the other LEO cubesats
+* are far below. Positions and velocities are in the TEME frame of the
+* element set, in km and km/s.
+*/
+
+typedef struct {
+	char name[32];				// line 0, or the catalog number
+	int catalog;
+	double epoch;				// s since the epoch (UTC)
+	double bstar;				// 1/earth radii
+	double inclination;			// rad
+	double raan;				// rad
+	double eccentricity;
+	double arg_perigee;			// rad
+	double mean_anomaly;		// rad
+	double mean_motion;			// rad/min (Kozai)
+} tle;
+
+typedef struct {
+	tle el;
+	int isimp;					// perigee below 220 km: truncated drag terms
+	double no;					// un-Kozai'd mean motion, rad/min
+	double ao, con41, x1mth2, x7thm1, eta, cc1, cc4, cc5, d2, d3, d4;
+	double delmo, sinmao, mdot, argpdot, nodedot, nodecf, omgcof, xmcof;
+	double t2cof, t3cof, t4cof, t5cof, xlcof, aycof;
+} sgp4_orbit;
+
+/* Parses lines 1 and 2 (line 0 may be NULL). Returns 0 or -1 if they are malformed. */
+int tle_parse(const char *line0, const char *line1, const char *line2, tle *el);
+
+/*
+* Reads the first element set of a TLE file (2 or 3 lines per set) whose
+* name or catalog number is 'match' (NULL: the first). Returns 0 or -1.
+*/
+int tle_read(FILE *fp, const char *match, tle *el);
+
+/* Returns 0 or -1 for a deep space or invalid element set */
+int sgp4_init(sgp4_orbit *o, const tle *el);
+
+/*
+* Position and velocity at t (s since the epoch, UTC). Returns 0, or -1 when
+* the elements have decayed or gone out of their domain at t.
+*/
+int sgp4_propagate(const sgp4_orbit *o, double t, double r[3], double v[3]);
+
+/* Greenwich mean sidereal time (rad) at t (UT1 ~ UTC) */
+double sgp4_gmst(double t);
+
+#endif /* SGP4_H_ */
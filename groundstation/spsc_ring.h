@@ -0,0 +1,115 @@
+//============================================================================
+// Name        : spsc_ring.h
+// Description : Lock-free single-producer/single-consumer ring buffer
+//============================================================================
+
+#ifndef SPSC_RING_H_
+#define SPSC_RING_H_
+
+#include <stddef.h>
+#include <atomic>
+#include <vector>
+
+/*
+* One thread pushes, one thread pops, no locks. The capacity is rounded up to
+* a power of two. head and tail are padded to their own cache lines, and each side
+* keeps a copy of the other side's index so it only reads the shared one when
+* the ring looks full (producer) or empty (consumer).
+*
+* T must be copyable; items are copied in and out.
+*/
+
+#define SPSC_CACHE_LINE		64
+
+template <typename T>
+class spsc_ring {
+public:
+	explicit spsc_ring(size_t capacity = 1024){
+		size_t n = 2;
+
+		while (n < capacity) n <<= 1;
+		buf.resize(n);
+		mask = n - 1;
+		head.store(0, std::memory_order_relaxed);
+		tail.store(0, std::memory_order_relaxed);
+		head_cache = tail_cache = 0;
+	}
+
+	size_t capacity() const { return mask + 1; }
+
+	/* Items in the ring (exact only from the producer or the consumer thread) */
+	size_t size() const {
+		return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+	}
+
+	/* Producer. Returns false if the ring is full. */
+	bool push(const T &item){
+		size_t t = tail.load(std::memory_order_relaxed);
+
+		if (t - head_cache > mask){
+			head_cache = head.load(std::memory_order_acquire);
+			if (t - head_cache > mask) return false;
+		}
+		buf[t & mask] = item;
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	/* Producer. Copies as many of the n items as fit, returns how many. */
+	size_t push_n(const T *items, size_t n){
+		size_t t = tail.load(std::memory_order_relaxed), room, i;
+
+		room = mask + 1 - (t - head_cache);
+		if (room < n){
+			head_cache = head.load(std::memory_order_acquire);
+			room = mask + 1 - (t - head_cache);
+		}
+		if (n > room) n = room;
+		for (i=0; i<n; i++) buf[(t + i) & mask] = items[i];
+		tail.store(t + n, std::memory_order_release);
+		return n;
+	}
+
+	/* Consumer. Returns false if the ring is empty. */
+	bool pop(T &item){
+		size_t h = head.load(std::memory_order_relaxed);
+
+		if (h == tail_cache){
+			tail_cache = tail.load(std::memory_order_acquire);
+			if (h == tail_cache) return false;
+		}
+		item = buf[h & mask];
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	/* Consumer. Copies up to n items, returns how many. */
+	size_t pop_n(T *items, size_t n){
+		size_t h = head.load(std::memory_order_relaxed), avail, i;
+
+		avail = tail_cache - h;
+		if (avail < n){
+			tail_cache = tail.load(std::memory_order_acquire);
+			avail = tail_cache - h;
+		}
+		if (n > avail) n = avail;
+		for (i=0; i<n; i++) items[i] = buf[(h + i) & mask];
+		head.store(h + n, std::memory_order_release);
+		return n;
+	}
+
+private:
+	std::vector<T> buf;
+	size_t mask;
+
+	// padding instead of alignas, so the ring can be allocated with new in C++14
+	char pad0[SPSC_CACHE_LINE];
+	std::atomic<size_t> head;		// next item to pop
+	size_t tail_cache;				// consumer's copy of tail
+	char pad1[SPSC_CACHE_LINE - 2*sizeof(size_t)];
+	std::atomic<size_t> tail;		// next free slot
+	size_t head_cache;				// producer's copy of head
+	char pad2[SPSC_CACHE_LINE - 2*sizeof(size_t)];
+};
+
+#endif /* SPSC_RING_H_ */
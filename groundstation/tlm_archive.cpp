@@ -0,0 +1,254 @@
+//============================================================================
+// Name        : tlm_archive.cpp
+// Description : Append-only columnar archive of decoded telemetry
+//============================================================================
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "tlm_archive.h"
+
+#define ALIGN8(n)	(((n) + 7) & ~(uint64_t)7)
+
+static void fill_header(tlm_archive_header *h, const tlm_schema *schema, uint32_t block_rows){
+	memset(h, 0, sizeof(*h));
+	memcpy(h->magic, TLM_ARCHIVE_MAGIC, sizeof(TLM_ARCHIVE_MAGIC));
+	h->version = TLM_ARCHIVE_VERSION;
+	h->nfields = schema ? (uint32_t)schema->nfields : 0;
+	h->block_rows = block_rows;
+	h->header_size = (uint32_t)(sizeof(*h) + h->nfields*sizeof(tlm_archive_field));
+	if (schema) strncpy(h->schema, schema->name, sizeof(h->schema) - 1);
+}
+
+static void fill_field(tlm_archive_field *f, const tlm_field *src){
+	memset(f, 0, sizeof(*f));
+	strncpy(f->name, src->name, sizeof(f->name) - 1);
+	strncpy(f->unit, src->unit, sizeof(f->unit) - 1);
+	f->scale = src->scale;
+	f->offset = src->offset;
+}
+
+/* Size of the valid part of an existing archive (complete blocks only), 0 if it doesn't match */
+static uint64_t valid_size(FILE *fp, uint64_t file_size, const tlm_archive_header *expect,
+						   const tlm_schema *schema){
+	tlm_archive_header h;
+	tlm_archive_field f, g;
+	tlm_block_header b;
+	uint64_t pos;
+	uint32_t i;
+
+	if (fread(&h, sizeof(h), 1, fp) != 1) return 0;
+	if (memcmp(h.magic, expect->magic, sizeof(h.magic)) != 0 || h.version != expect->version ||
+		h.nfields != expect->nfields || strncmp(h.schema, expect->schema, sizeof(h.schema)) != 0) return 0;
+
+	for (i=0; i<h.nfields; i++){
+		fill_field(&g, &schema->fields[i]);
+		if (fread(&f, sizeof(f), 1, fp) != 1 || strncmp(f.name, g.name, sizeof(f.name)) != 0) return 0;
+	}
+
+	pos = h.header_size;
+	while (pos + sizeof(b) <= file_size){
+		fseeko(fp, (off_t)pos, SEEK_SET);
+		if (fread(&b, sizeof(b), 1, fp) != 1 || b.magic != TLM_BLOCK_MAGIC || pos + b.block_size > file_size) break;
+		pos += b.block_size;
+	}
+	return pos;
+}
+
+int tlm_archive_create(tlm_archive_writer *w, const char *path, const tlm_schema *schema, uint32_t block_rows){
+	tlm_archive_header h;
+	tlm_archive_field f;
+	struct stat st;
+	uint32_t i;
+
+	if (block_rows == 0) block_rows = TLM_BLOCK_ROWS;
+
+	w->schema = schema;
+	w->nfields = schema ? (uint32_t)schema->nfields : 0;
+	w->nrows = 0;
+	fill_header(&h, schema, block_rows);
+
+	if (stat(path, &st) == 0 && st.st_size > 0){
+		uint64_t keep;
+
+		if ((w->fp = fopen(path, "r+b")) == NULL) return -1;
+		if ((keep = valid_size(w->fp, (uint64_t)st.st_size, &h, schema)) == 0){
+			fclose(w->fp);
+			return -1;		// another schema or not an archive
+		}
+		// drop a block cut short by a crash
+		if (keep < (uint64_t)st.st_size && ftruncate(fileno(w->fp), (off_t)keep) != 0){
+			fclose(w->fp);
+			return -1;
+		}
+		fseeko(w->fp, 0, SEEK_SET);
+		if (fread(&h, sizeof(h), 1, w->fp) != 1){
+			fclose(w->fp);
+			return -1;
+		}
+		block_rows = h.block_rows;
+		fseeko(w->fp, (off_t)keep, SEEK_SET);
+	}
+	else {
+		if ((w->fp = fopen(path, "wb")) == NULL) return -1;
+		fwrite(&h, sizeof(h), 1, w->fp);
+		for (i=0; i<w->nfields; i++){
+			fill_field(&f, &schema->fields[i]);
+			fwrite(&f, sizeof(f), 1, w->fp);
+		}
+	}
+
+	w->block_rows = block_rows;
+	w->time.resize(block_rows);
+	w->columns.resize((size_t)block_rows*w->nfields);
+	w->offsets.assign(1, 0);
+	w->offsets.reserve(block_rows + 1);
+	w->raw.clear();
+
+	return ferror(w->fp) ? -1 : 0;
+}
+
+int tlm_archive_append(tlm_archive_writer *w, double time, const double *values,
+					   const uint8_t *frame, size_t frame_len){
+	uint32_t k;
+
+	w->time[w->nrows] = time;
+	for (k=0; k<w->nfields; k++) w->columns[(size_t)k*w->block_rows + w->nrows] = values[k];
+
+	w->raw.insert(w->raw.end(), frame, frame + frame_len);
+	w->offsets.push_back((uint32_t)w->raw.size());
+
+	if (++w->nrows == w->block_rows) return tlm_archive_flush(w);
+	return 0;
+}
+
+int tlm_archive_flush(tlm_archive_writer *w){
+	static const uint8_t pad[8] = {0};
+	std::vector<tlm_zone> zones(w->nfields);
+	tlm_block_header b;
+	uint32_t n = w->nrows, i, k;
+	uint64_t offsets_size = ALIGN8((uint64_t)(n + 1)*sizeof(uint32_t));
+	uint64_t raw_size = ALIGN8(w->raw.size());
+
+	if (n == 0) return 0;
+
+	b.magic = TLM_BLOCK_MAGIC;
+	b.nrows = n;
+	b.block_size = sizeof(b) + w->nfields*sizeof(tlm_zone) + (uint64_t)(1 + w->nfields)*n*sizeof(double)
+				   + offsets_size + raw_size;
+	b.raw_size = w->raw.size();
+	b.t_min = b.t_max = w->time[0];
+	for (i=1; i<n; i++){
+		if (w->time[i] < b.t_min) b.t_min = w->time[i];
+		if (w->time[i] > b.t_max) b.t_max = w->time[i];
+	}
+
+	for (k=0; k<w->nfields; k++){
+		const double *c = &w->columns[(size_t)k*w->block_rows];
+
+		zones[k].min = zones[k].max = c[0];
+		for (i=1; i<n; i++){
+			if (c[i] < zones[k].min) zones[k].min = c[i];
+			if (c[i] > zones[k].max) zones[k].max = c[i];
+		}
+	}
+
+	fwrite(&b, sizeof(b), 1, w->fp);
+	if (w->nfields) fwrite(zones.data(), sizeof(tlm_zone), w->nfields, w->fp);
+	fwrite(w->time.data(), sizeof(double), n, w->fp);
+	for (k=0; k<w->nfields; k++) fwrite(&w->columns[(size_t)k*w->block_rows], sizeof(double), n, w->fp);
+	fwrite(w->offsets.data(), sizeof(uint32_t), n + 1, w->fp);
+	fwrite(pad, 1, offsets_size - (n + 1)*sizeof(uint32_t), w->fp);
+	if (!w->raw.empty()) fwrite(w->raw.data(), 1, w->raw.size(), w->fp);
+	fwrite(pad, 1, raw_size - w->raw.size(), w->fp);
+
+	w->nrows = 0;
+	w->offsets.assign(1, 0);
+	w->raw.clear();
+
+	return (fflush(w->fp) != 0 || ferror(w->fp)) ? -1 : 0;
+}
+
+int tlm_archive_close(tlm_archive_writer *w){
+	int ret = tlm_archive_flush(w);
+
+	if (fclose(w->fp) != 0) ret = -1;
+	w->fp = NULL;
+	return ret;
+}
+
+int tlm_archive_open(tlm_archive *a, const char *path){
+	struct stat st;
+	uint64_t pos;
+	void *p;
+	int fd;
+
+	a->base = NULL;
+	a->blocks.clear();
+	a->rows = 0;
+
+	if ((fd = open(path, O_RDONLY)) < 0) return -1;
+	if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(tlm_archive_header)){
+		close(fd);
+		return -1;
+	}
+
+	p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED) return -1;
+
+	a->base = (const uint8_t *)p;
+	a->size = (size_t)st.st_size;
+	a->hdr = (const tlm_archive_header *)a->base;
+
+	if (memcmp(a->hdr->magic, TLM_ARCHIVE_MAGIC, sizeof(TLM_ARCHIVE_MAGIC)) != 0 ||
+		a->hdr->version != TLM_ARCHIVE_VERSION || a->hdr->header_size > a->size){
+		tlm_archive_unmap(a);
+		return -1;
+	}
+	a->fields = (const tlm_archive_field *)(a->base + sizeof(tlm_archive_header));
+
+	madvise(p, a->size, MADV_SEQUENTIAL);
+
+	for (pos=a->hdr->header_size; pos + sizeof(tlm_block_header) <= a->size; ){
+		const tlm_block_header *h = (const tlm_block_header *)(a->base + pos);
+		const uint8_t *q = a->base + pos + sizeof(*h);
+		tlm_block b;
+
+		if (h->magic != TLM_BLOCK_MAGIC || pos + h->block_size > a->size) break;
+
+		b.hdr = h;
+		b.zones = (const tlm_zone *)q;
+		q += a->hdr->nfields*sizeof(tlm_zone);
+		b.time = (const double *)q;
+		q += h->nrows*sizeof(double);
+		b.columns = (const double *)q;
+		q += (size_t)a->hdr->nfields*h->nrows*sizeof(double);
+		b.offsets = (const uint32_t *)q;
+		q += ALIGN8((h->nrows + 1)*sizeof(uint32_t));
+		b.raw = q;
+
+		a->blocks.push_back(b);
+		a->rows += h->nrows;
+		pos += h->block_size;
+	}
+
+	return 0;
+}
+
+void tlm_archive_unmap(tlm_archive *a){
+	if (a->base) munmap((void *)a->base, a->size);
+	a->base = NULL;
+	a->blocks.clear();
+}
+
+int tlm_archive_field_index(const tlm_archive *a, const char *name){
+	uint32_t i;
+
+	for (i=0; i<a->hdr->nfields; i++)
+		if (strncmp(a->fields[i].name, name, sizeof(a->fields[i].name)) == 0) return (int)i;
+	return -1;
+}
@@ -0,0 +1,132 @@
+//============================================================================
+// Name        : tlm_archive.h
+// Description : Append-only columnar archive of decoded telemetry
+//============================================================================
+
+#ifndef TLM_ARCHIVE_H_
+#define TLM_ARCHIVE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+#include "tlm_schema.h"
+
+/*
+* One archive per schema (or raw frames only, schema NULL). Little endian,
+* every section 8 byte aligned so the columns can be used in place from mmap:
+*
+* | file header | field descriptors | block | block | ...
+*
+* block:
+* | block header | zone map (min, max per field) | time[n] | field 0[n] | ... |
+* | field k-1[n] | frame offsets[n+1] | raw frames |
+*
+* Columns are float64 (time in seconds since the epoch, values already scaled).
+* Blocks are only appended; a block cut short by a crash is ignored by the
+* reader and dropped by the next writer.
+*/
+
+#define TLM_ARCHIVE_MAGIC		"FSATARC"
+#define TLM_ARCHIVE_VERSION		1
+#define TLM_BLOCK_MAGIC			0x314B4C42		// "BLK1"
+#define TLM_BLOCK_ROWS			4096
+
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t nfields;
+	uint32_t block_rows;		// rows per block (the last block may have less)
+	uint32_t header_size;		// file header + field descriptors
+	char schema[16];			// "" for raw frames only
+} tlm_archive_header;
+
+typedef struct {
+	char name[24];
+	char unit[8];
+	double scale;
+	double offset;
+} tlm_archive_field;
+
+typedef struct {
+	uint32_t magic;
+	uint32_t nrows;
+	uint64_t block_size;		// header included
+	double t_min;
+	double t_max;
+	uint64_t raw_size;			// octets of raw frames
+} tlm_block_header;
+
+typedef struct {
+	double min;
+	double max;
+} tlm_zone;
+
+/* ---------------------------------- writer ---------------------------------- */
+
+typedef struct {
+	FILE *fp;
+	const tlm_schema *schema;
+	uint32_t nfields;
+	uint32_t block_rows;
+
+	std::vector<double> time;
+	std::vector<double> columns;	// field k of row i at [k*block_rows + i]
+	std::vector<uint32_t> offsets;
+	std::vector<uint8_t> raw;
+	uint32_t nrows;
+} tlm_archive_writer;
+
+/*
+* Creates the archive or opens it for append (its header must match the schema).
+* Returns 0 on success, -1 on error.
+*/
+int tlm_archive_create(tlm_archive_writer *w, const char *path, const tlm_schema *schema, uint32_t block_rows);
+
+/* values: one per schema field (ignored for raw archives) */
+int tlm_archive_append(tlm_archive_writer *w, double time, const double *values,
+					   const uint8_t *frame, size_t frame_len);
+
+/* Writes the pending rows as a block */
+int tlm_archive_flush(tlm_archive_writer *w);
+
+int tlm_archive_close(tlm_archive_writer *w);
+
+/* ---------------------------------- reader ---------------------------------- */
+
+typedef struct {
+	const tlm_block_header *hdr;
+	const tlm_zone *zones;		// nfields entries
+	const double *time;
+	const double *columns;		// field k at columns + k*nrows
+	const uint32_t *offsets;	// nrows + 1
+	const uint8_t *raw;
+} tlm_block;
+
+typedef struct {
+	const uint8_t *base;
+	size_t size;
+	const tlm_archive_header *hdr;
+	const tlm_archive_field *fields;
+	std::vector<tlm_block> blocks;
+	uint64_t rows;
+} tlm_archive;
+
+/* Maps the file read-only and indexes its blocks. Returns 0 on success, -1 on error. */
+int tlm_archive_open(tlm_archive *a, const char *path);
+void tlm_archive_unmap(tlm_archive *a);
+
+/* Field index by name, -1 if absent */
+int tlm_archive_field_index(const tlm_archive *a, const char *name);
+
+static inline const double *tlm_block_column(const tlm_block *b, int field){
+	return b->columns + (size_t)field*b->hdr->nrows;
+}
+
+static inline const uint8_t *tlm_block_frame(const tlm_block *b, uint32_t row, size_t *len){
+	*len = b->offsets[row+1] - b->offsets[row];
+	return b->raw + b->offsets[row];
+}
+
+#endif /* TLM_ARCHIVE_H_ */
@@ -0,0 +1,190 @@
+//============================================================================
+// Name        : tlm_query.cpp
+// Description : Time range scans, field filters and windowed aggregates over a telemetry archive
+//============================================================================
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <map>
+#include <string>
+
+#include "tlm_query.h"
+
+void tlm_query_init(tlm_query *q){
+	q->t_min = -INFINITY;
+	q->t_max = INFINITY;
+	q->filters = NULL;
+	q->nfilters = 0;
+}
+
+int tlm_parse_filter(const tlm_archive *a, const char *expr, tlm_filter *f){
+	static const struct { const char *op; tlm_op code; } ops[] = {
+		{"<=", TLM_LE}, {">=", TLM_GE}, {"==", TLM_EQ}, {"!=", TLM_NE}, {"&=", TLM_BITS_ALL},
+		{"<", TLM_LT}, {">", TLM_GT}, {"=", TLM_EQ}, {"&", TLM_BITS_ANY},
+	};
+	size_t n = strcspn(expr, "<>=!&"), k;
+	char *end;
+
+	if (n == 0 || expr[n] == '\0') return -1;
+	if ((f->field = tlm_archive_field_index(a, std::string(expr, n).c_str())) < 0) return -1;
+
+	for (k=0; k<sizeof(ops)/sizeof(ops[0]); k++)
+		if (strncmp(expr + n, ops[k].op, strlen(ops[k].op)) == 0) break;
+	if (k == sizeof(ops)/sizeof(ops[0])) return -1;
+
+	f->op = ops[k].code;
+	expr += n + strlen(ops[k].op);
+	f->value = (f->op == TLM_BITS_ANY || f->op == TLM_BITS_ALL) ? (double)strtoull(expr, &end, 0) : strtod(expr, &end);
+
+	return (end == expr || *end) ? -1 : 0;
+}
+
+int tlm_zone_may_match(const tlm_zone *z, const tlm_filter *f){
+	uint64_t mask = (uint64_t)f->value;
+
+	switch (f->op){
+	case TLM_LT: return z->min < f->value;
+	case TLM_LE: return z->min <= f->value;
+	case TLM_GT: return z->max > f->value;
+	case TLM_GE: return z->max >= f->value;
+	case TLM_EQ: return z->min <= f->value && f->value <= z->max;
+	case TLM_NE: return !(z->min == f->value && z->max == f->value);
+	// a value with one of the bits is at least the lowest bit; all of them, at least the mask
+	case TLM_BITS_ANY: return mask && (z->min < 0 || z->max >= (double)(mask & -mask));
+	case TLM_BITS_ALL: return z->min < 0 || z->max >= (double)mask;
+	}
+	return 1;
+}
+
+static int block_may_match(const tlm_block *b, const tlm_query *q){
+	size_t k;
+
+	if (b->hdr->nrows == 0 || b->hdr->t_max < q->t_min || b->hdr->t_min >= q->t_max) return 0;
+	for (k=0; k<q->nfilters; k++)
+		if (!tlm_zone_may_match(&b->zones[q->filters[k].field], &q->filters[k])) return 0;
+	return 1;
+}
+
+/* sel[i] &= predicate, one branchless loop per operator */
+static void apply_filter(const double *c, uint32_t n, const tlm_filter *f, uint8_t *sel){
+	const double v = f->value;
+	const int64_t mask = (int64_t)f->value;
+	uint32_t i;
+
+	switch (f->op){
+	case TLM_LT: for (i=0; i<n; i++) sel[i] &= c[i] < v; break;
+	case TLM_LE: for (i=0; i<n; i++) sel[i] &= c[i] <= v; break;
+	case TLM_GT: for (i=0; i<n; i++) sel[i] &= c[i] > v; break;
+	case TLM_GE: for (i=0; i<n; i++) sel[i] &= c[i] >= v; break;
+	case TLM_EQ: for (i=0; i<n; i++) sel[i] &= c[i] == v; break;
+	case TLM_NE: for (i=0; i<n; i++) sel[i] &= c[i] != v; break;
+	case TLM_BITS_ANY: for (i=0; i<n; i++) sel[i] &= ((int64_t)c[i] & mask) != 0; break;
+	case TLM_BITS_ALL: for (i=0; i<n; i++) sel[i] &= ((int64_t)c[i] & mask) == mask; break;
+	}
+}
+
+/* Selection vector of rows [from, from+n) of the block, returns the rows selected */
+static uint32_t select_rows(const tlm_block *b, const tlm_query *q, uint32_t from, uint32_t n, uint8_t *sel){
+	const double *t = b->time + from;
+	const double t_min = q->t_min, t_max = q->t_max;
+	uint32_t i, count = 0;
+	size_t k;
+
+	for (i=0; i<n; i++) sel[i] = (t[i] >= t_min) & (t[i] < t_max);
+	for (k=0; k<q->nfilters; k++)
+		apply_filter(tlm_block_column(b, q->filters[k].field) + from, n, &q->filters[k], sel);
+	for (i=0; i<n; i++) count += sel[i];
+
+	return count;
+}
+
+/* Calls fn(block, first row, rows, selection) for each chunk of the blocks that may match */
+template <typename F>
+static void scan(const tlm_archive *a, const tlm_query *q, tlm_query_stats *stats, F fn){
+	uint8_t sel[TLM_SCAN_ROWS];
+	tlm_query_stats st;
+	uint32_t from, n, count;
+	size_t k;
+
+	memset(&st, 0, sizeof(st));
+
+	for (k=0; k<a->blocks.size(); k++){
+		const tlm_block *b = &a->blocks[k];
+
+		st.blocks++;
+		if (!block_may_match(b, q)){
+			st.blocks_skipped++;
+			continue;
+		}
+
+		for (from=0; from<b->hdr->nrows; from+=n){
+			n = b->hdr->nrows - from < TLM_SCAN_ROWS ? b->hdr->nrows - from : TLM_SCAN_ROWS;
+			count = select_rows(b, q, from, n, sel);
+			st.rows_scanned += n;
+			st.rows_selected += count;
+			if (count) fn(b, from, n, sel);
+		}
+	}
+
+	if (stats) *stats = st;
+}
+
+int tlm_query_rows(const tlm_archive *a, const tlm_query *q, tlm_row_cb cb, void *user,
+				   tlm_query_stats *stats){
+	size_t k;
+
+	for (k=0; k<q->nfilters; k++)
+		if (q->filters[k].field < 0 || (uint32_t)q->filters[k].field >= a->hdr->nfields) return -1;
+
+	scan(a, q, stats, [&](const tlm_block *b, uint32_t from, uint32_t n, const uint8_t *sel){
+		uint32_t i;
+
+		for (i=0; i<n; i++)
+			if (sel[i]) cb(a, b, from + i, user);
+	});
+	return 0;
+}
+
+std::vector<tlm_window> tlm_query_aggregate(const tlm_archive *a, const tlm_query *q, int field,
+											double window, double origin, tlm_query_stats *stats){
+	std::map<int64_t, tlm_window> windows;
+	std::vector<tlm_window> out;
+	size_t k;
+
+	if (field < 0 || (uint32_t)field >= a->hdr->nfields) return out;
+	for (k=0; k<q->nfilters; k++)
+		if (q->filters[k].field < 0 || (uint32_t)q->filters[k].field >= a->hdr->nfields) return out;
+
+	scan(a, q, stats, [&](const tlm_block *b, uint32_t from, uint32_t n, const uint8_t *sel){
+		const double *t = b->time + from, *c = tlm_block_column(b, field) + from;
+		tlm_window *w = NULL;
+		int64_t cur = 0, idx;
+		uint32_t i;
+
+		// the rows are mostly in time order: the window is looked up only when it changes
+		for (i=0; i<n; i++){
+			if (!sel[i]) continue;
+
+			idx = window > 0 ? (int64_t)floor((t[i] - origin)/window) : 0;
+			if (!w || idx != cur){
+				auto it = windows.find(idx);
+				if (it == windows.end()){
+					tlm_window nw = {window > 0 ? origin + (double)idx*window : t[i], 0, c[i], c[i], 0};
+					it = windows.insert(std::make_pair(idx, nw)).first;
+				}
+				w = &it->second;
+				cur = idx;
+			}
+
+			w->count++;
+			w->sum += c[i];
+			if (c[i] < w->min) w->min = c[i];
+			if (c[i] > w->max) w->max = c[i];
+			if (window <= 0 && t[i] < w->start) w->start = t[i];
+		}
+	});
+
+	for (auto &it : windows) out.push_back(it.second);
+	return out;
+}
@@ -0,0 +1,87 @@
+//============================================================================
+// Name        : tlm_query.h
+// Description : Time range scans, field filters and windowed aggregates over a telemetry archive
+//============================================================================
+
+#ifndef TLM_QUERY_H_
+#define TLM_QUERY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "tlm_archive.h"
+
+/*
+* A query is a time range [t_min, t_max) and filters that must all hold
+* (field op value). Blocks whose time range or zone map (min/max of each
+* field) can't match are skipped without reading their columns. The other
+* blocks are scanned column by column, TLM_SCAN_ROWS rows at a time: each
+* predicate ANDs a 0/1 selection vector in a branchless loop the compiler
+* vectorizes, then the selected rows are read.
+*
+* The bit operators test the integer value of the field: TLM_BITS_ANY holds
+* when (value & mask) != 0, TLM_BITS_ALL when all the bits of mask are set.
+*/
+
+#define TLM_SCAN_ROWS		1024
+
+typedef enum {
+	TLM_LT, TLM_LE, TLM_GT, TLM_GE, TLM_EQ, TLM_NE, TLM_BITS_ANY, TLM_BITS_ALL
+} tlm_op;
+
+typedef struct {
+	int field;					// index in the archive
+	tlm_op op;
+	double value;				// mask for the bit operators
+} tlm_filter;
+
+typedef struct {
+	double t_min;
+	double t_max;
+	const tlm_filter *filters;
+	size_t nfilters;
+} tlm_query;
+
+typedef struct {
+	double start;				// window [start, start + window)
+	uint64_t count;
+	double min;
+	double max;
+	double sum;					// mean = sum/count
+} tlm_window;
+
+typedef struct {
+	uint64_t blocks;
+	uint64_t blocks_skipped;	// by time range or zone map
+	uint64_t rows_scanned;
+	uint64_t rows_selected;
+} tlm_query_stats;
+
+/* Called for each selected row, in archive order */
+typedef void (*tlm_row_cb)(const tlm_archive *a, const tlm_block *b, uint32_t row, void *user);
+
+/* Whole archive, no filter */
+void tlm_query_init(tlm_query *q);
+
+/*
+* Parses "name<value" (also <=, >, >=, ==, !=) or "name&mask" (any bit set) or
+* "name&=mask" (all bits set). Returns 0 or -1 if the field or operator is unknown.
+*/
+int tlm_parse_filter(const tlm_archive *a, const char *expr, tlm_filter *f);
+
+/* 1 if the zone map of the block can hold a row matching f */
+int tlm_zone_may_match(const tlm_zone *z, const tlm_filter *f);
+
+int tlm_query_rows(const tlm_archive *a, const tlm_query *q, tlm_row_cb cb, void *user,
+				   tlm_query_stats *stats);
+
+/*
+* min/max/mean of a field over the selected rows, per window of 'window' seconds
+* aligned to 'origin' (window <= 0: one window for everything). Only the
+* windows with rows are returned, in time order.
+*/
+std::vector<tlm_window> tlm_query_aggregate(const tlm_archive *a, const tlm_query *q, int field,
+											double window, double origin, tlm_query_stats *stats);
+
+#endif /* TLM_QUERY_H_ */
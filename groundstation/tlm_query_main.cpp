@@ -0,0 +1,172 @@
+//============================================================================
+// Name        : tlm_query_main.cpp
+// Description : Command line queries over the telemetry archives
+//============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include "tlm_query.h"
+
+typedef struct {
+	std::vector<int> columns;
+} print_ctx;
+
+static void usage(const char *prog){
+	fprintf(stderr, "Usage: %s [-f from] [-t to] [-w filter]... [-c fields] [-a field [-W seconds] [-O origin]] [-v] archive.tlm\n", prog);
+	fprintf(stderr, "  -f  -t  time range [from, to): seconds since the epoch or YYYY-MM-DDTHH:MM:SS (UTC)\n");
+	fprintf(stderr, "  -w  filter, all must hold: field<v, <=, >, >=, ==, !=, field&mask (any bit), field&=mask (all bits)\n");
+	fprintf(stderr, "  -c  comma separated fields to print (default: all)\n");
+	fprintf(stderr, "  -a  min, max and mean of this field instead of the rows\n");
+	fprintf(stderr, "  -W  aggregate per window of this many seconds (default: one window)\n");
+	fprintf(stderr, "  -O  start of the first window (default: 0, the epoch)\n");
+	fprintf(stderr, "  -v  blocks skipped and rows scanned on stderr\n");
+}
+
+static int parse_time(const char *s, double *t){
+	struct tm tm;
+	char *end;
+
+	*t = strtod(s, &end);
+	if (end != s && *end == '\0') return 0;
+
+	memset(&tm, 0, sizeof(tm));
+	end = strptime(s, "%Y-%m-%dT%H:%M:%S", &tm);
+	if (!end || (*end && strcmp(end, "Z") != 0)) return -1;
+	*t = (double)timegm(&tm);
+	return 0;
+}
+
+static void print_time(FILE *out, double t){
+	time_t sec = (time_t)t;
+	struct tm tm;
+	char buf[32];
+
+	gmtime_r(&sec, &tm);
+	strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+	fprintf(out, "%s.%03dZ", buf, (int)((t - (double)sec)*1000));
+}
+
+static void print_row(const tlm_archive *, const tlm_block *b, uint32_t row, void *user){
+	print_ctx *ctx = (print_ctx *)user;
+	size_t k;
+
+	print_time(stdout, b->time[row]);
+	for (k=0; k<ctx->columns.size(); k++) printf(",%.10g", tlm_block_column(b, ctx->columns[k])[row]);
+	putchar('\n');
+}
+
+int main(int argc, char **argv){
+	std::vector<tlm_filter> filters;
+	tlm_query q;
+	tlm_query_stats st;
+	tlm_archive a;
+	print_ctx ctx;
+	const char *columns = NULL, *agg = NULL;
+	const char *from = NULL, *to = NULL;
+	std::vector<const char *> exprs;
+	double window = 0, origin = 0;
+	int c, verbose = 0;
+	size_t k;
+
+	tlm_query_init(&q);
+
+	while ((c = getopt(argc, argv, "f:t:w:c:a:W:O:vh")) != -1){
+		switch (c){
+		case 'f': from = optarg; break;
+		case 't': to = optarg; break;
+		case 'w': exprs.push_back(optarg); break;
+		case 'c': columns = optarg; break;
+		case 'a': agg = optarg; break;
+		case 'W': window = atof(optarg); break;
+		case 'O':
+			if (parse_time(optarg, &origin) != 0){
+				fprintf(stderr, "ERROR, bad time %s\n", optarg);
+				return 1;
+			}
+			break;
+		case 'v': verbose = 1; break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (optind != argc - 1){
+		usage(argv[0]);
+		return 1;
+	}
+	if ((from && parse_time(from, &q.t_min) != 0) || (to && parse_time(to, &q.t_max) != 0)){
+		fprintf(stderr, "ERROR, bad time range\n");
+		return 1;
+	}
+	if (tlm_archive_open(&a, argv[optind]) != 0){
+		fprintf(stderr, "ERROR, can't open archive %s\n", argv[optind]);
+		return 1;
+	}
+
+	filters.resize(exprs.size());
+	for (k=0; k<exprs.size(); k++)
+		if (tlm_parse_filter(&a, exprs[k], &filters[k]) != 0){
+			fprintf(stderr, "ERROR, bad filter %s\n", exprs[k]);
+			return 1;
+		}
+	q.filters = filters.data();
+	q.nfilters = filters.size();
+
+	if (agg){
+		int field = tlm_archive_field_index(&a, agg);
+		std::vector<tlm_window> w;
+
+		if (field < 0){
+			fprintf(stderr, "ERROR, unknown field %s\n", agg);
+			return 1;
+		}
+		w = tlm_query_aggregate(&a, &q, field, window, origin, &st);
+
+		printf("start,count,min,max,mean\n");
+		for (k=0; k<w.size(); k++){
+			print_time(stdout, w[k].start);
+			printf(",%llu,%.10g,%.10g,%.10g\n", (unsigned long long)w[k].count, w[k].min, w[k].max, w[k].sum/w[k].count);
+		}
+	}
+	else {
+		if (columns){
+			std::string list(columns);
+			size_t pos = 0, end;
+
+			do {
+				end = list.find(',', pos);
+				std::string name = list.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+				int field = tlm_archive_field_index(&a, name.c_str());
+
+				if (field < 0){
+					fprintf(stderr, "ERROR, unknown field %s\n", name.c_str());
+					return 1;
+				}
+				ctx.columns.push_back(field);
+				pos = end + 1;
+			} while (end != std::string::npos);
+		}
+		else for (k=0; k<a.hdr->nfields; k++) ctx.columns.push_back((int)k);
+
+		printf("time");
+		for (k=0; k<ctx.columns.size(); k++) printf(",%.24s", a.fields[ctx.columns[k]].name);
+		putchar('\n');
+
+		tlm_query_rows(&a, &q, print_row, &ctx, &st);
+	}
+
+	if (verbose)
+		fprintf(stderr, "%llu blocks, %llu skipped, %llu rows scanned, %llu selected\n",
+				(unsigned long long)st.blocks, (unsigned long long)st.blocks_skipped,
+				(unsigned long long)st.rows_scanned, (unsigned long long)st.rows_selected);
+
+	tlm_archive_unmap(&a);
+	return 0;
+}
@@ -0,0 +1,124 @@
+//============================================================================
+// Name        : tlm_schema.cpp
+// Description : Table driven decoder of the telemetry carried in the Info field
+//============================================================================
+
+#include <string.h>
+#include <math.h>
+
+#include "tlm_schema.h"
+
+#define BYTE(n)	((n)*8)
+
+/*
+* EPS Info field (39 octets, 16/24 bit values MSB first), in the order of the
+* old decoders of ax_25.cpp. TEMP_REG and VOLT_REG are the 11 upper bits of
+* their 16 bit registers.
+*/
+static const tlm_field eps_fields[] = {
+	// name				unit	 bit offset			width LE signed scale							offset
+	{"V_panel_0",		"V",	 BYTE(0),			16,   0, 0,		6.1035*193.1/1e6,				0},
+	{"V_panel_1",		"V",	 BYTE(2),			16,   0, 0,		6.1035*193.1/1e6,				0},
+	{"V_panel_2",		"V",	 BYTE(4),			16,   0, 0,		6.1035*193.1/1e6,				0},
+	{"I_ADC_0",			"mA",	 BYTE(6),			16,   0, 0,		6.1035/(50*25*16.5),			0},
+	{"I_ADC_1",			"mA",	 BYTE(8),			16,   0, 0,		6.1035/(50*25*16.5),			0},
+	{"I_ADC_2",			"mA",	 BYTE(10),			16,   0, 0,		6.1035/(50*25*16.5),			0},
+	{"V_ADC_total",		"V",	 BYTE(12),			16,   0, 0,		6.1035*4/1e4,					0},
+	{"MSP_TS",			"C",	 BYTE(14),			16,   0, 0,		6.1035e-4/0.00355,				-0.986/0.00355},
+	{"AVC",				"A",	 BYTE(16),			16,   0, 1,		1.5625e-6/0.015,				0},
+	{"TEMP_REG",		"C",	 BYTE(18),			11,   0, 1,		0.125,							0},
+	{"VOLT_REG",		"V",	 BYTE(20),			11,   0, 1,		4.883e-3,						0},
+	{"CURRENT_REG",		"A",	 BYTE(22),			16,   0, 1,		1.5625e-6/0.015,				0},
+	{"ACCUM_CURRENT",	"Ah",	 BYTE(24),			16,   0, 0,		6.25e-6/0.015,					0},
+	{"VR_STATUS",		"",		 BYTE(26),			8,    0, 0,		1,								0},
+	{"RTD_1",			"",		 BYTE(27),			24,   0, 0,		1,								0},
+	{"RTD_2",			"",		 BYTE(30),			24,   0, 0,		1,								0},
+	{"RTD_3",			"",		 BYTE(33),			24,   0, 0,		1,								0},
+	{"RTD_4",			"",		 BYTE(36),			24,   0, 0,		1,								0},
+};
+
+/*
+* uG frame: SOF "{{{" + payload (35 octets) + EOF, see uG_encode_dataframe().
+* IMU scales follow IMU_ACC_RANGE (16 g) and IMU_GYR_RANGE in hal/engmodel1.h,
+* EPS scales follow eps_data2string(). The internal temperature is the raw
+* ADC12 code (its conversion needs the calibration of each MCU).
+*/
+static const tlm_field ug_fields[] = {
+	// name				unit	 bit offset			width LE signed scale							offset
+	{"sysclock_s",		"s",	 BYTE(3),			16,   0, 0,		1,								0},
+	{"sysclock_ms",		"ms",	 BYTE(5),			16,   0, 0,		1,								0},
+	{"obdh_temp_adc",	"",		 BYTE(7),			16,   0, 0,		1,								0},
+	{"obdh_status",		"",		 BYTE(9),			8,    0, 0,		1,								0},
+	{"acc_x",			"g",	 BYTE(10),			16,   0, 1,		16.0/32768,						0},
+	{"acc_y",			"g",	 BYTE(12),			16,   0, 1,		16.0/32768,						0},
+	{"acc_z",			"g",	 BYTE(14),			16,   0, 1,		16.0/32768,						0},
+	{"gyr_x",			"",		 BYTE(16),			16,   0, 1,		2.0/32768,						0},
+	{"gyr_y",			"",		 BYTE(18),			16,   0, 1,		2.0/32768,						0},
+	{"gyr_z",			"",		 BYTE(20),			16,   0, 1,		2.0/32768,						0},
+	{"radio_counter",	"",		 BYTE(22),			16,   0, 0,		1,								0},
+	{"radio_signal",	"",		 BYTE(24),			16,   0, 0,		1,								0},
+	{"bat_current",		"A",	 BYTE(26),			16,   0, 1,		0.0000015625/0.015,				0},
+	{"bat1_voltage",	"V",	 BYTE(28),			16,   0, 0,		0.004886,						0},
+	{"bat2_voltage",	"V",	 BYTE(30),			16,   0, 0,		0.004886,						0},
+	{"bat_temp",		"C",	 BYTE(32),			16,   0, 0,		0.125,							0},
+	{"bat_accum",		"Ah",	 BYTE(34),			16,   0, 0,		0.00000625/0.015,				0},
+	{"bat_protection",	"",		 BYTE(36),			8,    0, 0,		1,								0},
+	{"crc8",			"",		 BYTE(37),			8,    0, 0,		1,								0},
+};
+
+#define NFIELDS(x)	(sizeof(x)/sizeof(x[0]))
+
+static_assert(NFIELDS(eps_fields) <= TLM_MAX_FIELDS && NFIELDS(ug_fields) <= TLM_MAX_FIELDS, "too many fields");
+
+const tlm_schema eps_schema = {"eps", 39, NULL, eps_fields, NFIELDS(eps_fields)};
+const tlm_schema ug_schema = {"ug", 41, "{{{", ug_fields, NFIELDS(ug_fields)};
+
+const tlm_schema *const tlm_schemas[] = {&eps_schema, &ug_schema, NULL};
+
+const tlm_schema *tlm_match(const uint8_t *info, size_t len){
+	const tlm_schema *const *s;
+
+	for (s=tlm_schemas; *s; s++){
+		if ((*s)->payload_len != len) continue;
+		if ((*s)->magic && memcmp(info, (*s)->magic, strlen((*s)->magic)) != 0) continue;
+		return *s;
+	}
+	return NULL;
+}
+
+void tlm_decode_raw(const tlm_schema *s, const uint8_t *payload, int64_t *raw){
+	size_t i;
+
+	for (i=0; i<s->nfields; i++) raw[i] = tlm_raw(&s->fields[i], payload);
+}
+
+void tlm_decode(const tlm_schema *s, const uint8_t *payload, double *values){
+	const tlm_field *f = s->fields;
+	size_t i;
+
+	for (i=0; i<s->nfields; i++, f++) values[i] = (double)tlm_raw(f, payload)*f->scale + f->offset;
+}
+
+void tlm_encode(const tlm_schema *s, const double *values, uint8_t *payload){
+	const tlm_field *f = s->fields;
+	double raw, lo, hi;
+	size_t i;
+
+	if (s->magic) memcpy(payload, s->magic, strlen(s->magic));
+
+	for (i=0; i<s->nfields; i++, f++){
+		hi = f->is_signed ? ldexp(1.0, f->width - 1) - 1 : ldexp(1.0, f->width) - 1;
+		lo = f->is_signed ? -hi - 1 : 0;
+		raw = round((values[i] - f->offset)/f->scale);
+		if (!(raw >= lo)) raw = lo;		// NaN too
+		if (raw > hi) raw = hi;
+		tlm_put_raw(f, payload, (int64_t)raw);
+	}
+}
+
+void tlm_print(FILE *out, const tlm_schema *s, const double *values){
+	size_t i;
+
+	for (i=0; i<s->nfields; i++)
+		fprintf(out, "%s: %g %s\n", s->fields[i].name, values[i], s->fields[i].unit);
+}
@@ -0,0 +1,104 @@
+//============================================================================
+// Name        : tlm_schema.h
+// Description : Table driven decoder of the telemetry carried in the Info field
+//============================================================================
+
+#ifndef TLM_SCHEMA_H_
+#define TLM_SCHEMA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+* Each telemetry value is one entry of a field table:
+*
+*   value = raw*scale + offset
+*
+* raw is taken from 'width' bits starting at 'bit_offset' (bit 0 is the MSB of
+* the first octet, so MSB first fields can start at any bit) and sign extended
+* when is_signed is set. little_endian fields must be byte aligned and a
+* multiple of 8 bits wide.
+*
+* A new field is a new table entry in tlm_schema.cpp; nothing else changes.
+*/
+
+#define TLM_MAX_FIELDS	32
+
+typedef struct {
+	const char *name;
+	const char *unit;
+	uint16_t bit_offset;
+	uint8_t width;				// 1..32
+	uint8_t little_endian;
+	uint8_t is_signed;
+	double scale;
+	double offset;
+} tlm_field;
+
+typedef struct {
+	const char *name;
+	size_t payload_len;			// Info field length of this telemetry frame
+	const char *magic;			// first octets of the payload (NULL if none)
+	const tlm_field *fields;
+	size_t nfields;
+} tlm_schema;
+
+extern const tlm_schema eps_schema;		// EPS housekeeping (the old ADC_*, *_REG, RTD decoders)
+extern const tlm_schema ug_schema;		// OBDH uG frame (obdh/obdh_v1/interfaces/uG.c)
+
+/* All the known schemas, NULL terminated */
+extern const tlm_schema *const tlm_schemas[];
+
+/* Schema of an Info field (length and magic), NULL if none matches */
+const tlm_schema *tlm_match(const uint8_t *info, size_t len);
+
+static inline int64_t tlm_raw(const tlm_field *f, const uint8_t *payload){
+	const uint8_t *p = payload + (f->bit_offset >> 3);
+	unsigned int skip = f->bit_offset & 7;
+	unsigned int n = (skip + f->width + 7) >> 3, i;
+	uint64_t v = 0, sign = (uint64_t)1 << (f->width - 1);
+
+	if (f->little_endian)
+		for (i=n; i>0; i--) v = v << 8 | p[i-1];
+	else {
+		for (i=0; i<n; i++) v = v << 8 | p[i];
+		v >>= n*8 - skip - f->width;
+	}
+	v &= (sign << 1) - 1;
+
+	return f->is_signed ? (int64_t)(v ^ sign) - (int64_t)sign : (int64_t)v;
+}
+
+/* Writes the 'width' low bits of raw where tlm_raw() reads them, leaves the other bits */
+static inline void tlm_put_raw(const tlm_field *f, uint8_t *payload, int64_t raw){
+	uint8_t *p = payload + (f->bit_offset >> 3);
+	unsigned int skip = f->bit_offset & 7;
+	unsigned int n = (skip + f->width + 7) >> 3, shift = n*8 - skip - f->width, i;
+	uint64_t mask = (((uint64_t)1 << (f->width - 1)) << 1) - 1;
+	uint64_t v = (uint64_t)raw & mask;
+
+	if (f->little_endian)
+		for (i=0; i<n; i++, v >>= 8) p[i] = (uint8_t)v;
+	else {
+		v <<= shift;
+		mask <<= shift;
+		for (i=n; i>0; i--, v >>= 8, mask >>= 8) p[i-1] = (uint8_t)((p[i-1] & ~mask) | v);
+	}
+}
+
+/* Single pass over the field table; payload must hold schema->payload_len octets */
+void tlm_decode_raw(const tlm_schema *s, const uint8_t *payload, int64_t *raw);
+void tlm_decode(const tlm_schema *s, const uint8_t *payload, double *values);
+
+/*
+* Inverse of tlm_decode(): raw = round((value - offset)/scale), clamped to the
+* range of the field. Writes the magic and the fields, the other octets of the
+* payload are left as they are.
+*/
+void tlm_encode(const tlm_schema *s, const double *values, uint8_t *payload);
+
+/* One "name: value unit" line per field */
+void tlm_print(FILE *out, const tlm_schema *s, const double *values);
+
+#endif /* TLM_SCHEMA_H_ */
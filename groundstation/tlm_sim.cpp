@@ -0,0 +1,307 @@
+//============================================================================
+// Name        : tlm_sim.cpp
+// Description : Simulated downlink: telemetry models, framing and channel errors
+//============================================================================
+
+#include <string.h>
+#include <math.h>
+
+#include "tlm_sim.h"
+#include "ax25_encoder.h"
+#include "hdlc.h"
+#include "crc_template.h"
+
+#define BAT_CAPACITY		2.5		// Ah
+#define LOAD_CURRENT		0.3		// A
+#define PANEL_CURRENT		0.45	// A, one panel facing the sun
+#define NO_ERROR			UINT64_MAX
+
+static const double two_pi = 6.283185307179586;
+
+void tlm_sim_default_options(tlm_sim_options *o){
+	o->seed = 1;
+	o->bitrate = 1200;
+	o->start = 0;
+	o->eps_period = 10;
+	o->ug_period = 10;
+	o->tumble_rate = 0.05;
+	o->ber = 0;
+	o->burst_rate = 0;
+	o->burst_len = 64;
+	o->slip_prob = 0;
+}
+
+/* xorshift64* */
+static uint64_t next_u64(tlm_sim *s){
+	s->rng ^= s->rng >> 12;
+	s->rng ^= s->rng << 25;
+	s->rng ^= s->rng >> 27;
+	return s->rng*2685821657736338717ULL;
+}
+
+/* (0, 1] */
+static double uniform(tlm_sim *s){
+	return (double)((next_u64(s) >> 11) + 1)/9007199254740992.0;
+}
+
+static double gauss(tlm_sim *s){
+	return sqrt(-2*log(uniform(s)))*cos(two_pi*uniform(s));
+}
+
+/* Bits before the next event of probability p per bit */
+static uint64_t geometric(tlm_sim *s, double p){
+	double n;
+
+	if (p <= 0) return NO_ERROR;
+	if (p >= 1) return 0;
+	n = floor(log(uniform(s))/log1p(-p));
+	return n < 1e18 ? (uint64_t)n : NO_ERROR;
+}
+
+void tlm_sim_init(tlm_sim *s, const tlm_sim_options *o, tlm_sim_frame_cb cb, void *user){
+	memset(s, 0, sizeof(*s));
+	s->o = *o;
+	s->cb = cb;
+	s->user = user;
+	s->rng = o->seed*0x9E3779B97F4A7C15ULL + 1;
+
+	s->next_error = geometric(s, o->ber);
+	s->next_burst = geometric(s, o->burst_rate/o->bitrate);
+
+	s->next_eps = o->eps_period > 0 ? o->start : INFINITY;
+	s->next_ug = o->ug_period > 0 ? o->start + o->ug_period/2 : INFINITY;
+	s->soc = 0.7;
+	s->bat_temp = 15;
+	s->panel_temp = 10;
+	s->last_model = o->start;
+}
+
+/* ------------------------------- models ---------------------------------- */
+
+typedef struct {
+	int sun;
+	double k[3];				// illumination of each panel, 0..1
+	double bat_current;			// A, > 0 charging
+	double cell_voltage;
+	uint8_t protection;
+} eps_state;
+
+static double orbit_phase(const tlm_sim *s, double t){
+	double p = fmod(t - s->o.start, ORBIT_PERIOD)/ORBIT_PERIOD;
+	return p < 0 ? p + 1 : p;
+}
+
+/* Battery and temperatures from the last update to t */
+static void update_models(tlm_sim *s, double t, eps_state *e){
+	double angle = s->o.tumble_rate*(t - s->o.start), dt = t - s->last_model, charge = 0;
+	int i;
+
+	e->sun = orbit_phase(s, t) < 1 - ECLIPSE_FRACTION;
+	for (i=0; i<3; i++){
+		e->k[i] = e->sun ? cos(angle + i*two_pi/3) : 0;
+		if (e->k[i] < 0) e->k[i] = 0;
+		charge += PANEL_CURRENT*e->k[i];
+	}
+
+	e->bat_current = charge - LOAD_CURRENT;
+	if (s->soc >= 1 && e->bat_current > 0) e->bat_current = 0;		// charge regulator
+
+	if (dt > 0){
+		s->soc += e->bat_current*dt/3600/BAT_CAPACITY;
+		if (s->soc > 1) s->soc = 1;
+		if (s->soc < 0) s->soc = 0;
+		s->panel_temp += ((e->sun ? 40 : -20) - s->panel_temp)*(1 - exp(-dt/900));
+		s->bat_temp += ((e->sun ? 25 : 5) - s->bat_temp)*(1 - exp(-dt/3000));
+		s->last_model = t;
+	}
+
+	e->cell_voltage = 3.3 + 0.85*s->soc + 0.05*e->bat_current;
+	e->protection = (uint8_t)((e->cell_voltage > 4.15 ? 0x04 : 0) | (e->cell_voltage < 3.2 ? 0x08 : 0));
+}
+
+/* 24 bit code of a PT100 at temp against a 400 ohm reference */
+static double rtd_code(double temp){
+	return 100*(1 + 0.00385*temp)/400*8388608;
+}
+
+static void eps_values(tlm_sim *s, const eps_state *e, double *v){
+	int i;
+
+	for (i=0; i<3; i++){
+		v[i] = e->sun ? 4.2 + 1.0*e->k[i] + 0.01*gauss(s) : 0.02*uniform(s);	// V_panel_i
+		v[3 + i] = 12*e->k[i] + 0.05*uniform(s);								// I_ADC_i
+	}
+	v[6] = 2*e->cell_voltage;						// V_ADC_total
+	v[7] = s->panel_temp + 5;						// MSP_TS
+	v[8] = e->bat_current;							// AVC
+	v[9] = s->bat_temp;								// TEMP_REG
+	v[10] = e->cell_voltage;						// VOLT_REG
+	v[11] = e->bat_current + 0.005*gauss(s);		// CURRENT_REG
+	v[12] = s->soc*BAT_CAPACITY;					// ACCUM_CURRENT
+	v[13] = e->protection;							// VR_STATUS
+	for (i=0; i<4; i++) v[14 + i] = rtd_code(s->panel_temp + 3*i + 0.1*gauss(s));	// RTD_1..4
+}
+
+static void ug_values(tlm_sim *s, const eps_state *e, double t, double *v){
+	static const double axis[3] = {0.30, 0.50, 0.81};
+	double uptime = t - s->o.start;
+	int i;
+
+	v[0] = fmod(floor(uptime), 65536);				// sysclock_s
+	v[1] = floor((uptime - floor(uptime))*1000);	// sysclock_ms
+	v[2] = 2000 + 6*(s->panel_temp + 5);			// obdh_temp_adc
+	v[3] = 0;										// obdh_status
+	for (i=0; i<3; i++){
+		v[4 + i] = 0.01*gauss(s);									// acc_*
+		v[7 + i] = axis[i]*s->o.tumble_rate + 0.002*gauss(s);		// gyr_*
+	}
+	v[10] = s->radio_counter++;						// radio_counter
+	v[11] = 100 + 10*uniform(s);					// radio_signal
+	v[12] = e->bat_current;							// bat_current
+	v[13] = e->cell_voltage;						// bat1_voltage
+	v[14] = e->cell_voltage + 0.01;					// bat2_voltage
+	v[15] = s->bat_temp;							// bat_temp
+	v[16] = s->soc*BAT_CAPACITY;					// bat_accum
+	v[17] = e->protection;							// bat_protection
+	v[18] = 0;										// crc8, set after
+}
+
+/* Info field of the frame sent at t, returns its length */
+static size_t build_info(tlm_sim *s, const tlm_schema *schema, double t, uint8_t *info, double *values){
+	eps_state e;
+
+	update_models(s, t, &e);
+	memset(info, 0x20, schema->payload_len);		// as uG_encode_dataframe()
+
+	if (schema == &ug_schema){
+		ug_values(s, &e, t, values);
+		tlm_encode(schema, values, info);
+		// CRC8(ugFrame + 3, 34) of uG_encode_crc(), which covers ugFrame[4..34]
+		info[37] = crc8_ug::compute(info + 4, 31);
+		info[38] = '}';
+		info[39] = '\n';
+		info[40] = '\r';
+	}
+	else {
+		eps_values(s, &e, values);
+		tlm_encode(schema, values, info);
+	}
+
+	tlm_decode(schema, info, values);
+	return schema->payload_len;
+}
+
+/* ------------------------------- channel --------------------------------- */
+
+/* Writes one bit through the channel errors, returns 1 if it was changed */
+static int put_bit(tlm_sim *s, uint8_t b, std::vector<uint8_t> &out){
+	uint8_t sent = b;
+
+	if (s->burst_left){
+		sent = (uint8_t)(next_u64(s) >> 63);
+		s->burst_left--;
+	}
+	else if (s->bit == s->next_burst){
+		sent = (uint8_t)(next_u64(s) >> 63);
+		s->burst_left = s->o.burst_len ? s->o.burst_len - 1 : 0;
+		s->next_burst = s->bit + s->o.burst_len + geometric(s, s->o.burst_rate/s->o.bitrate);
+	}
+	if (s->bit == s->next_error){
+		sent ^= 1;
+		s->next_error += 1 + geometric(s, s->o.ber);
+	}
+
+	s->acc |= (uint8_t)(sent << s->nacc);
+	if (++s->nacc == 8){
+		out.push_back(s->acc);
+		s->acc = 0;
+		s->nacc = 0;
+	}
+	s->bit++;
+
+	return sent != b;
+}
+
+static void put_flag(tlm_sim *s, std::vector<uint8_t> &out){
+	int i;
+
+	for (i=0; i<8; i++) put_bit(s, (AX25_FLAG >> i) & 1, out);
+}
+
+/* Loses a stuffed zero of the frame or adds a zero, returns the new length */
+static size_t slip(tlm_sim *s, uint8_t *bits, size_t n){
+	size_t stuffed[2*AX25_FRAME_MAX], nstuffed = 0, k, pos;
+	int ones = 0;
+
+	for (k=8; k<n - 8; k++){
+		if (bits[k]){
+			ones++;
+			continue;
+		}
+		if (ones == 5) stuffed[nstuffed++] = k;
+		ones = 0;
+	}
+
+	if (nstuffed && (next_u64(s) & 1)){
+		pos = stuffed[next_u64(s) % nstuffed];
+		memmove(bits + pos, bits + pos + 1, n - pos - 1);
+		return n - 1;
+	}
+
+	pos = 8 + next_u64(s) % (n - 16);
+	memmove(bits + pos + 1, bits + pos, n - pos);
+	bits[pos] = 0;
+	return n + 1;
+}
+
+static void put_frame(tlm_sim *s, const tlm_schema *schema, double t, std::vector<uint8_t> &out){
+	static const ax25_header hdr = {"PY0EFS", ax25_ssid(0, 0, 0), "FSAT", ax25_ssid(1, 0, 1), 0x03, AX25_PID_NO_L3};
+	uint8_t info[AX25_INFO_MAX], frame[AX25_FRAME_MAX], bits[2*AX25_FRAME_MAX*8 + 1];
+	tlm_sim_frame f;
+	size_t len, n, k;
+
+	f.time = t;
+	f.bit_pos = s->bit;
+	f.schema = schema;
+	f.errors = 0;
+	f.info_len = build_info(s, schema, t, info, f.values);
+
+	len = ax25_encode_frame(frame, sizeof(frame), &hdr, info, f.info_len);
+	n = hdlc_stuff_frame(frame + 1, len - 2, bits, sizeof(bits) - 1);
+
+	f.slipped = s->o.slip_prob > 0 && uniform(s) <= s->o.slip_prob;
+	if (f.slipped) n = slip(s, bits, n);
+
+	for (k=0; k<n; k++) f.errors += (uint32_t)put_bit(s, bits[k], out);
+	f.bits = (uint32_t)n;
+
+	s->frames++;
+	if (f.errors || f.slipped) s->frames_hit++;
+	if (s->cb) s->cb(&f, s->user);
+}
+
+void tlm_sim_run(tlm_sim *s, double seconds, std::vector<uint8_t> &out){
+	uint64_t end = (uint64_t)(seconds*s->o.bitrate);
+	double t, next;
+
+	while (s->bit < end){
+		t = s->o.start + (double)s->bit/s->o.bitrate;
+		next = s->next_eps < s->next_ug ? s->next_eps : s->next_ug;
+
+		if (next > t){
+			put_flag(s, out);
+			continue;
+		}
+
+		// frames queued while the channel was busy go out one after the other
+		if (s->next_eps <= s->next_ug){
+			put_frame(s, &eps_schema, t, out);
+			s->next_eps += s->o.eps_period;
+		}
+		else {
+			put_frame(s, &ug_schema, t, out);
+			s->next_ug += s->o.ug_period;
+		}
+		put_flag(s, out);
+	}
+}
@@ -0,0 +1,108 @@
+//============================================================================
+// Name        : tlm_sim.h
+// Description : Simulated downlink: telemetry models, framing and channel errors
+//============================================================================
+
+#ifndef TLM_SIM_H_
+#define TLM_SIM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "tlm_schema.h"
+
+/*
+* Bit stream of the satellite as ax25_batch/ax25_rt read it: AX.25 frames,
+* bit stuffed, with flags in between, packed LSB first. The Info fields are
+* built by tlm_encode() from models of the satellite:
+*
+*   EPS   orbit of ORBIT_PERIOD s with an eclipse; panel voltages and currents
+*         follow the sun and the tumbling of the satellite, the battery
+*         charges in the sun and discharges in the eclipse (cell voltage from
+*         the state of charge and the current), temperatures (battery, MCU,
+*         RTD_1..4 as PT100 codes) lag the sun;
+*   IMU   tumbling at a constant rate: gyro = rate + noise, accelerometer
+*         noise around 0 g;
+*   OBDH  sysclock (s, ms) since boot, radio frame counter, the uG frame
+*         CRC8 as uG_encode_crc() computes it.
+*
+* An EPS frame is queued every eps_period seconds and a uG frame every
+* ug_period seconds (0: never); the channel sends them in order at 'bitrate'
+* and sends flags while idle. The errors are applied to the stuffed bits:
+*
+*   ber         independent bit flips
+*   burst_rate  bursts per second of channel time, each 'burst_len' random bits
+*   slip_prob   probability that a frame loses one of its stuffed zeros or
+*               gets an extra zero (clock slips): the deframer sees six ones
+*               or the octets shifted by one bit
+*
+* The stream only depends on the options: the same seed gives the same bits.
+*/
+
+#define ORBIT_PERIOD		5640.0	// s
+#define ECLIPSE_FRACTION	0.37
+
+typedef struct {
+	uint64_t seed;
+	double bitrate;
+	double start;				// time of the first bit (s since the epoch)
+	double eps_period;			// s, 0: no EPS frames
+	double ug_period;			// s, 0: no uG frames
+	double tumble_rate;			// rad/s around a fixed axis
+	double ber;
+	double burst_rate;
+	uint32_t burst_len;
+	double slip_prob;
+} tlm_sim_options;
+
+typedef struct {
+	double time;				// first bit (satellite time)
+	uint64_t bit_pos;			// of the opening flag in the stream
+	uint32_t bits;				// flags included, after errors
+	const tlm_schema *schema;
+	size_t info_len;
+	uint32_t errors;			// bits flipped inside the frame
+	int slipped;
+	double values[TLM_MAX_FIELDS];	// as sent (quantized by the schema)
+} tlm_sim_frame;
+
+/* Called once a frame is written to the stream, in stream order */
+typedef void (*tlm_sim_frame_cb)(const tlm_sim_frame *f, void *user);
+
+typedef struct {
+	tlm_sim_options o;
+	tlm_sim_frame_cb cb;
+	void *user;
+
+	uint64_t rng;
+	uint64_t bit;				// bits written so far
+	uint64_t next_error;		// bit of the next independent error
+	uint64_t next_burst;		// bit where the next burst starts
+	uint32_t burst_left;
+	uint8_t acc;				// partial output byte
+	unsigned int nacc;
+
+	double next_eps;			// satellite time of the next frame of each kind
+	double next_ug;
+	double soc;					// battery state of charge, 0..1
+	double bat_temp;
+	double panel_temp;
+	double last_model;			// time of the last model update
+	uint16_t radio_counter;
+
+	uint64_t frames;
+	uint64_t frames_hit;		// with bit errors or a slip
+} tlm_sim;
+
+void tlm_sim_default_options(tlm_sim_options *o);
+
+void tlm_sim_init(tlm_sim *s, const tlm_sim_options *o, tlm_sim_frame_cb cb, void *user);
+
+/*
+* Generates the stream up to 'seconds' of channel time after start and
+* appends the complete octets to out. Calls can go on where the last ended.
+*/
+void tlm_sim_run(tlm_sim *s, double seconds, std::vector<uint8_t> &out);
+
+#endif /* TLM_SIM_H_ */
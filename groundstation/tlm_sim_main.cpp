@@ -0,0 +1,181 @@
+//============================================================================
+// Name        : tlm_sim_main.cpp
+// Description : Simulated satellite bit stream for load tests of the decoders
+//============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "tlm_sim.h"
+
+#define CHUNK_SECONDS	1.0		// channel time generated per write
+
+typedef struct {
+	FILE *out;
+} truth_ctx;
+
+static void usage(const char *prog){
+	fprintf(stderr, "Usage: %s [-d seconds] [-r bitrate] [-e period] [-u period] [-w rad/s] [-s seed] [-t start]\n"
+					"       [-b ber] [-B bursts/s] [-L bits] [-S prob] [-x speed] [-T truth.csv] [-v] [out.bin]\n", prog);
+	fprintf(stderr, "  -d  channel time to generate (default: 3600)\n");
+	fprintf(stderr, "  -r  bitrate in bit/s (default: 1200)\n");
+	fprintf(stderr, "  -e  -u  seconds between EPS / uG frames, 0: none (default: 10)\n");
+	fprintf(stderr, "  -w  tumbling rate (default: 0.05)\n");
+	fprintf(stderr, "  -s  seed (default: 1), the same seed gives the same stream\n");
+	fprintf(stderr, "  -t  time of the first bit: seconds since the epoch or YYYY-MM-DDTHH:MM:SS (default: now)\n");
+	fprintf(stderr, "  -b  bit error rate\n");
+	fprintf(stderr, "  -B  error bursts per second\n");
+	fprintf(stderr, "  -L  bits per burst (default: 64)\n");
+	fprintf(stderr, "  -S  probability of a bit slip in a frame (lost or extra stuffed bit)\n");
+	fprintf(stderr, "  -x  write at this many times the bitrate, 0: as fast as possible (default: 0)\n");
+	fprintf(stderr, "  -T  CSV of the frames sent, values as ax25_batch prints them\n");
+	fprintf(stderr, "  -v  counts on stderr\n");
+	fprintf(stderr, "  out.bin: packed bits, LSB first (default: stdout)\n");
+}
+
+static int parse_time(const char *s, double *t){
+	struct tm tm;
+	char *end;
+
+	*t = strtod(s, &end);
+	if (end != s && *end == '\0') return 0;
+
+	memset(&tm, 0, sizeof(tm));
+	end = strptime(s, "%Y-%m-%dT%H:%M:%S", &tm);
+	if (!end || (*end && strcmp(end, "Z") != 0)) return -1;
+	*t = (double)timegm(&tm);
+	return 0;
+}
+
+static void print_time(FILE *out, double t){
+	time_t sec = (time_t)t;
+	struct tm tm;
+	char buf[32];
+
+	gmtime_r(&sec, &tm);
+	strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+	fprintf(out, "%s.%03dZ", buf, (int)((t - (double)sec)*1000));
+}
+
+static void print_header(FILE *out){
+	const tlm_schema *const *s;
+	size_t i;
+
+	fprintf(out, "time,bit,info_len,errors,slipped");
+	for (s=tlm_schemas; *s; s++)
+		for (i=0; i<(*s)->nfields; i++) fprintf(out, ",%s.%s", (*s)->name, (*s)->fields[i].name);
+	fputc('\n', out);
+}
+
+static void truth_frame(const tlm_sim_frame *f, void *user){
+	truth_ctx *ctx = (truth_ctx *)user;
+	const tlm_schema *const *s;
+	size_t i;
+
+	print_time(ctx->out, f->time);
+	fprintf(ctx->out, ",%llu,%u,%u,%d", (unsigned long long)f->bit_pos, (unsigned)f->info_len,
+			(unsigned)f->errors, f->slipped);
+	for (s=tlm_schemas; *s; s++)
+		for (i=0; i<(*s)->nfields; i++){
+			if (*s == f->schema) fprintf(ctx->out, ",%.10g", f->values[i]);
+			else fputc(',', ctx->out);
+		}
+	fputc('\n', ctx->out);
+}
+
+int main(int argc, char **argv){
+	tlm_sim_options o;
+	tlm_sim s;
+	truth_ctx truth;
+	std::vector<uint8_t> buf;
+	const char *truth_path = NULL;
+	double duration = 3600, speed = 0, t;
+	int c, verbose = 0;
+	FILE *out = stdout;
+
+	tlm_sim_default_options(&o);
+	o.start = (double)time(NULL);
+	truth.out = NULL;
+
+	while ((c = getopt(argc, argv, "d:r:e:u:w:s:t:b:B:L:S:x:T:vh")) != -1){
+		switch (c){
+		case 'd': duration = atof(optarg); break;
+		case 'r': o.bitrate = atof(optarg); break;
+		case 'e': o.eps_period = atof(optarg); break;
+		case 'u': o.ug_period = atof(optarg); break;
+		case 'w': o.tumble_rate = atof(optarg); break;
+		case 's': o.seed = strtoull(optarg, NULL, 0); break;
+		case 't':
+			if (parse_time(optarg, &o.start) != 0){
+				fprintf(stderr, "ERROR, bad time %s\n", optarg);
+				return 1;
+			}
+			break;
+		case 'b': o.ber = atof(optarg); break;
+		case 'B': o.burst_rate = atof(optarg); break;
+		case 'L': o.burst_len = (uint32_t)atol(optarg); break;
+		case 'S': o.slip_prob = atof(optarg); break;
+		case 'x': speed = atof(optarg); break;
+		case 'T': truth_path = optarg; break;
+		case 'v': verbose = 1; break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (optind < argc - 1 || o.bitrate <= 0 || duration <= 0 || speed < 0 ||
+		o.eps_period < 0 || o.ug_period < 0 || o.ber < 0 || o.burst_rate < 0 || o.slip_prob < 0){
+		usage(argv[0]);
+		return 1;
+	}
+	if (optind == argc - 1 && !(out = fopen(argv[optind], "wb"))){
+		fprintf(stderr, "ERROR, can't open %s\n", argv[optind]);
+		return 1;
+	}
+	if (truth_path){
+		if (!(truth.out = fopen(truth_path, "w"))){
+			fprintf(stderr, "ERROR, can't open %s\n", truth_path);
+			return 1;
+		}
+		print_header(truth.out);
+	}
+
+	tlm_sim_init(&s, &o, truth.out ? truth_frame : NULL, &truth);
+
+	auto t0 = std::chrono::steady_clock::now();
+	for (t=0; t<duration; ){
+		t = t + CHUNK_SECONDS < duration ? t + CHUNK_SECONDS : duration;
+
+		buf.clear();
+		tlm_sim_run(&s, t, buf);
+		if (fwrite(buf.data(), 1, buf.size(), out) != buf.size()){
+			fprintf(stderr, "ERROR, write failed\n");
+			return 1;
+		}
+
+		// paced: the bits of channel time t are out at t/speed
+		if (speed > 0){
+			fflush(out);
+			std::this_thread::sleep_until(t0 + std::chrono::duration<double>(t/speed));
+		}
+	}
+	double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+	if (out != stdout) fclose(out);
+	else fflush(out);
+	if (truth.out) fclose(truth.out);
+
+	if (verbose)
+		fprintf(stderr, "%llu frames, %llu with errors, %llu bits, %.0fx real time\n",
+				(unsigned long long)s.frames, (unsigned long long)s.frames_hit,
+				(unsigned long long)s.bit, duration/wall);
+
+	return 0;
+}
@@ -0,0 +1,175 @@
+//============================================================================
+// Name        : uplink_cmd.cpp
+// Description : Telecommand dataframes in AX.25 UI frames and the time-tagged command queue
+//============================================================================
+
+#include <string.h>
+#include <algorithm>
+
+#include "uplink_cmd.h"
+#include "crc_template.h"
+
+uint8_t df_crc8(const uint8_t *p, size_t len){
+	return crc8_ug::compute(p, len);
+}
+
+size_t df_encode(uint8_t *out, size_t out_size, uint8_t from, uint8_t to,
+				 const uint8_t *data, size_t len){
+	if (len < 1 || len > DF_DATA_MAX || out_size < len + DF_OVERHEAD) return 0;
+
+	out[0] = DF_SOF;
+	out[1] = from;
+	out[2] = to;
+	memcpy(out + 3, data, len);
+	out[3 + len] = df_crc8(out + 1, len + 2);
+	out[4 + len] = DF_EOF;
+
+	return len + DF_OVERHEAD;
+}
+
+size_t df_parse(const uint8_t *in, size_t len, df_view *v){
+	size_t i;
+
+	if (len < DF_OVERHEAD + 1 || in[0] != DF_SOF) return 0;
+
+	// in[i] is EOF, in[i-1] the CRC of in[1..i-2], then the end or the next SOF
+	for (i=DF_OVERHEAD; i<len && i<DF_FRAME_MAX; i++){
+		if (in[i] != DF_EOF || (i + 1 < len && in[i+1] != DF_SOF)) continue;
+		if (df_crc8(in + 1, i - 2) != in[i-1]) continue;
+
+		v->from = in[1];
+		v->to = in[2];
+		v->data = in + 3;
+		v->len = i - 4;
+		return i + 1;
+	}
+	return 0;
+}
+
+/* ------------------------------ command queue ----------------------------- */
+
+static bool later(const uplink_cmd &a, const uplink_cmd &b){
+	return a.time > b.time || (a.time == b.time && a.id > b.id);
+}
+
+void uplink_init(uplink_queue *q, const char *destination, const char *source, uint8_t from){
+	q->hdr.destination = destination;
+	q->hdr.ssid_dest = ax25_ssid(1, 0, 0);
+	q->hdr.source = source;
+	q->hdr.ssid_source = ax25_ssid(0, 0, 1);
+	q->hdr.control = AX25_CONTROL_UI;
+	q->hdr.pid = AX25_PID_NO_L3;
+	q->from = from;
+	q->info_max = AX25_INFO_MAX;
+	q->next_id = 0;
+	q->heap.clear();
+}
+
+int64_t uplink_add(uplink_queue *q, double time, double expires, uint8_t to,
+				   const uint8_t *data, size_t len){
+	uplink_cmd c;
+
+	if (len < 1 || len > DF_DATA_MAX) return -1;
+
+	c.time = time;
+	c.expires = expires;
+	c.id = q->next_id++;
+	c.to = to;
+	c.len = (uint8_t)len;
+	memcpy(c.data, data, len);
+
+	q->heap.push_back(c);
+	std::push_heap(q->heap.begin(), q->heap.end(), later);
+	return c.id;
+}
+
+size_t uplink_pending(const uplink_queue *q){
+	return q->heap.size();
+}
+
+typedef struct {
+	double time;				// latest time tag, AOS at the earliest
+	double limit;				// earliest expiry
+	size_t octets;
+	uint16_t ncmds;
+	uint32_t cmds[AX25_INFO_MAX/(DF_OVERHEAD + 1)];	// indexes in the pass
+} frame_bin;
+
+size_t uplink_schedule(uplink_queue *q, double aos, double los, std::vector<uplink_frame> &frames,
+					   uplink_stats *stats){
+	std::vector<uplink_cmd> pass;
+	std::vector<uint32_t> order;
+	std::vector<frame_bin> bins;
+	uint8_t info[AX25_INFO_MAX];
+	size_t info_max = q->info_max, first = frames.size(), i, k, n;
+	uplink_stats st;
+
+	memset(&st, 0, sizeof(st));
+	if (info_max > AX25_INFO_MAX) info_max = AX25_INFO_MAX;
+	if (info_max < DF_FRAME_MAX) info_max = DF_FRAME_MAX;
+
+	// the commands tagged before LOS, in time tag order
+	while (!q->heap.empty() && q->heap.front().time < los){
+		std::pop_heap(q->heap.begin(), q->heap.end(), later);
+		uplink_cmd &c = q->heap.back();
+
+		if (c.expires < std::max(c.time, aos)) st.expired++;
+		else pass.push_back(c);
+		q->heap.pop_back();
+	}
+
+	// first fit by decreasing size
+	order.resize(pass.size());
+	for (i=0; i<pass.size(); i++) order[i] = (uint32_t)i;
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b){ return pass[a].len > pass[b].len; });
+
+	for (i=0; i<order.size(); i++){
+		const uplink_cmd &c = pass[order[i]];
+		size_t size = c.len + DF_OVERHEAD;
+		double t = std::max(c.time, aos);
+
+		for (k=0; k<bins.size(); k++)
+			if (bins[k].octets + size <= info_max && std::max(bins[k].time, t) <= std::min(bins[k].limit, c.expires)) break;
+
+		if (k == bins.size()){
+			frame_bin b;
+			b.time = t;
+			b.limit = c.expires;
+			b.octets = 0;
+			b.ncmds = 0;
+			bins.push_back(b);
+		}
+		frame_bin &b = bins[k];
+		b.time = std::max(b.time, t);
+		b.limit = std::min(b.limit, c.expires);
+		b.octets += size;
+		b.cmds[b.ncmds++] = order[i];
+	}
+
+	std::sort(bins.begin(), bins.end(), [](const frame_bin &a, const frame_bin &b){ return a.time < b.time; });
+
+	frames.resize(first + bins.size());
+	for (k=0; k<bins.size(); k++){
+		frame_bin &b = bins[k];
+		uplink_frame &f = frames[first + k];
+
+		// pass[] is in time tag order: so are the sorted indexes
+		std::sort(b.cmds, b.cmds + b.ncmds);
+		for (i=0, n=0; i<b.ncmds; i++){
+			const uplink_cmd &c = pass[b.cmds[i]];
+			n += df_encode(info + n, sizeof(info) - n, q->from, c.to, c.data, c.len);
+			f.ids[i] = c.id;
+		}
+
+		f.time = b.time;
+		f.ncmds = b.ncmds;
+		f.len = ax25_encode_frame(f.frame, sizeof(f.frame), &q->hdr, info, n);
+
+		st.commands += b.ncmds;
+		st.info_octets += n;
+	}
+	st.frames = bins.size();
+
+	if (stats) *stats = st;
+	return bins.size();
+}
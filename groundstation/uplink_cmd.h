@@ -0,0 +1,126 @@
+//============================================================================
+// Name        : uplink_cmd.h
+// Description : Telecommand dataframes in AX.25 UI frames and the time-tagged command queue
+//============================================================================
+
+#ifndef UPLINK_CMD_H_
+#define UPLINK_CMD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "ax25_encoder.h"
+
+/*
+* Floripasat dataframe (ttc/old/dataframe-diagram.txt):
+*
+* | SOF  | FROM | TO  | DATA      | CRC | EOF  |
+* | 0x7B | 1 B  | 1 B | 1 to 50 B | 1 B | 0x7D |
+*
+* The CRC is CRC8() of obdh/obdh_v1/util/crc.c (crc8_ug in crc_template.h)
+* over FROM, TO and DATA.
+*
+* An uplink frame is an AX.25 UI frame (control 0x03, PID 0xF0) whose Info
+* field holds one or more dataframes back to back. The dataframe has no
+* length field and DATA may hold 0x7D, so df_parse() takes the first EOF
+* that ends the buffer or comes before a SOF and whose CRC matches.
+*/
+
+#define DF_SOF				0x7B	// '{'
+#define DF_EOF				0x7D	// '}'
+#define DF_DATA_MAX			50
+#define DF_OVERHEAD			5		// SOF, FROM, TO, CRC, EOF
+#define DF_FRAME_MAX		(DF_OVERHEAD + DF_DATA_MAX)
+
+#define AX25_CONTROL_UI		0x03
+
+/* CRC of the dataframe fields p[0..len-1] (FROM, TO, DATA) */
+uint8_t df_crc8(const uint8_t *p, size_t len);
+
+/*
+* Writes SOF, FROM, TO, DATA, CRC, EOF into out.
+* Returns the number of bytes written or 0 if len is not 1..DF_DATA_MAX
+* or out_size is too small.
+*/
+size_t df_encode(uint8_t *out, size_t out_size, uint8_t from, uint8_t to,
+				 const uint8_t *data, size_t len);
+
+typedef struct {
+	uint8_t from;
+	uint8_t to;
+	const uint8_t *data;		// points into the parsed buffer
+	size_t len;
+} df_view;
+
+/* Dataframe at the start of in. Returns the bytes it takes or 0 if there is none. */
+size_t df_parse(const uint8_t *in, size_t len, df_view *v);
+
+/* ------------------------------ command queue ----------------------------- */
+
+/*
+* A command is not sent before its time tag and is dropped if it can't be
+* sent by its expiry time. uplink_schedule() takes the commands of one pass
+* and packs their dataframes into the fewest UI frames (first fit by
+* decreasing size): a command joins a frame if its dataframe fits in the
+* Info field and the frame can go out after the time tags and before the
+* expiry of all its commands. A frame is sent at the latest time tag of its
+* commands (AOS at the earliest), so batching trades a wait within the pass
+* for fewer frames; a command that must go out on time gets a short expiry.
+* Inside a frame the dataframes are in time tag order, which is the order
+* the OBDH executes them.
+*
+* The dataframes are written straight into the Info field and the FCS
+* comes from the table CRC: a frame takes a few microseconds.
+*/
+
+typedef struct {
+	double time;				// time tag: not sent before (s since the epoch)
+	double expires;				// dropped if not sent by then (INFINITY: never)
+	uint32_t id;				// order of uplink_add()
+	uint8_t to;
+	uint8_t len;
+	uint8_t data[DF_DATA_MAX];
+} uplink_cmd;
+
+typedef struct {
+	double time;				// send at
+	uint16_t ncmds;
+	uint32_t ids[AX25_INFO_MAX/(DF_OVERHEAD + 1)];	// commands, in the order of the dataframes
+	size_t len;					// octets in frame, both flags included
+	uint8_t frame[AX25_FRAME_MAX];
+} uplink_frame;
+
+typedef struct {
+	uint64_t commands;			// sent
+	uint64_t frames;
+	uint64_t expired;			// dropped before they could be sent
+	uint64_t info_octets;		// dataframes, the Info fields without padding
+} uplink_stats;
+
+typedef struct {
+	ax25_header hdr;			// UI frame to the satellite
+	uint8_t from;				// FROM of the dataframes
+	size_t info_max;			// dataframe octets per frame, up to AX25_INFO_MAX
+	uint32_t next_id;
+	std::vector<uplink_cmd> heap;	// min-heap on the time tag
+} uplink_queue;
+
+void uplink_init(uplink_queue *q, const char *destination, const char *source, uint8_t from);
+
+/* Queues a command. Returns its id or -1 if len is not 1..DF_DATA_MAX. */
+int64_t uplink_add(uplink_queue *q, double time, double expires, uint8_t to,
+				   const uint8_t *data, size_t len);
+
+/* Commands still queued */
+size_t uplink_pending(const uplink_queue *q);
+
+/*
+* Packs the commands tagged before los into frames for the pass [aos, los)
+* and appends them to frames in time order. The commands tagged later stay
+* queued. Returns the number of frames appended.
+*/
+size_t uplink_schedule(uplink_queue *q, double aos, double los, std::vector<uplink_frame> &frames,
+					   uplink_stats *stats);
+
+#endif /* UPLINK_CMD_H_ */
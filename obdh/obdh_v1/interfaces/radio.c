@@ -4,7 +4,18 @@
  *  Created on: 11 de mai de 2016
  *      Author: mario
  */
+#include <string.h>
 #include "radio.h"
+#include "../util/watchdog.h"
+
+static uint8_t rxBuffer[RX_BUFFER_SIZE];	// Last packet received (without the status bytes)
+static uint16_t rxLength = 0;				// Bytes in rxBuffer
+static rxState_t rxState = RX_START;		// Kept across runRX() calls
+static uint16_t rxTotal;					// Bytes of the packet being received (length header included)
+static uint16_t rxReceived;					// Bytes of it in rxBuffer
+static uint8_t rxFixed;						// Fixed packet length mode set for its end
+static uint8_t rxStatus[RX_STATUS_BYTES];
+static uint8_t rxStatusBytes;				// Status bytes read
 
 void readTransceiver(char* buffer){
 
@@ -12,102 +23,530 @@ void readTransceiver(char* buffer){
 
 }
 
-void radio_Setup(void){
+uint16_t radio_Setup(void){
+
+	uint16_t digest;
 
-	registerConfig();
+	digest = registerConfig();
 	manualCalibration();
-	// Set radio in RX
+	// Set radio in RX (infinite packet length, See runRX())
+	setPacketLength(PKT_CFG0_INFINITE);
 	trxSpiCmdStrobe(CC112X_SRX);
 
+	// Equal to radio_ConfigDigest() if the configuration was read back right
+	return digest;
 }
 
 void SPI_Setup(void){
     trxRfSpiInterfaceInit(2);				// ----> Configura USCI_A0 utilizado no FloripaSat
 }
 
-static void registerConfig(void) {
+/*******************************************************************************
+*   @fn         isConfigRegister
+*
+*   @brief      Checks if an address is a configuration register (with a
+*               reset value in resetValues/extResetValues).
+*
+*   @param      addr - register address (0x2Fxx in the extended space)
+*
+*   @return     1 or 0
+*/
+static uint8_t isConfigRegister(uint16_t addr) {
 
-	uint16_t i;
-    uint8_t writeByte;
+	if((addr >> 8) == 0x2F) {
+		return (addr & 0x00FF) < CONFIG_EXT_REGS;
+	}
+	return addr < CONFIG_REGS;
+}
 
-    trxSpiCmdStrobe(CC112X_SRES);													// Reset radio
+/*******************************************************************************
+*   @fn         isResetValue
+*
+*   @brief      Checks if a setting is the reset value of its register.
+*
+*   @param      setting - register setting
+*
+*   @return     1 or 0
+*/
+static uint8_t isResetValue(const registerSetting_t *setting) {
 
-    for(i = 0; i < (sizeof(preferredSettings)/sizeof(registerSetting_t)); i++) {	// Write registers to radio
-        	writeByte = preferredSettings[i].data;
-        	cc112xSpiWriteReg(preferredSettings[i].addr, &writeByte, 1);
-        }
+	if(!isConfigRegister(setting->addr)) {
+		return 0;
+	}
+	if((setting->addr >> 8) == 0x2F) {
+		return extResetValues[setting->addr & 0x00FF] == setting->data;
+	}
+	return resetValues[setting->addr] == setting->data;
+}
 
+/*******************************************************************************
+*   @fn         runLength
+*
+*   @brief      Number of settings, from the first one, with consecutive
+*               addresses in the same register space (one burst access).
+*
+*   @param      settings   - first setting
+*   @param      n          - settings left in the table
+*   @param      configOnly - stops at the first non configuration register
+*
+*   @return     1 to CONFIG_MAX_BURST
+*/
+static uint16_t runLength(const registerSetting_t *settings, uint16_t n, uint8_t configOnly) {
 
+	uint16_t len = 1;
 
+	while((len < n) && (len < CONFIG_MAX_BURST)) {
+		if((settings[len].addr != settings[len-1].addr + 1) || ((settings[len].addr >> 8) != (settings[0].addr >> 8))) {
+			break;
+		}
+		if(configOnly && !isConfigRegister(settings[len].addr)) {
+			break;
+		}
+		len++;
+	}
+	return len;
 }
 
 /*******************************************************************************
-*   @fn         runRX
+*   @fn         crc16
+*
+*   @brief      One byte of CRC-16-CCITT (0x1021).
+*
+*   @param      crc  - current value
+*   @param      byte - new byte
+*
+*   @return     updated value
+*/
+static uint16_t crc16(uint16_t crc, uint8_t byte) {
+
+	uint8_t i;
+
+	crc ^= (uint16_t)byte << 8;
+	for(i = 0; i < 8; i++) {
+		crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+	return crc;
+}
+
+/*******************************************************************************
+*   @fn         writeSettings
 *
-*   @brief      Puts radio in RX and waits for packets. Function assumes
-*               that status bytes are appended in the RX_FIFO
-*               Update packet counter and display for each packet received.
+*   @brief      Writes a settings table in burst accesses. With skipReset, the
+*               configuration registers at their reset value are not written,
+*               unless they are CONFIG_MAX_GAP or less between two written
+*               settings of the same burst.
+*
+*   @param      settings  - table
+*   @param      n         - number of settings
+*   @param      skipReset - skip the reset values (radio just reset)
+*
+*   @return     none
+*/
+static void writeSettings(const registerSetting_t *settings, uint16_t n, uint8_t skipReset) {
+
+	uint8_t buffer[CONFIG_MAX_BURST];
+	uint16_t i, j, k, run, first, last;
+
+	for(i = 0; i < n; i += run) {
+		run = runLength(&settings[i], n - i, 0);
+
+		j = i;
+		while(j < i + run) {
+			if(skipReset && isResetValue(&settings[j])) {
+				j++;
+				continue;
+			}
+			first = j;
+			last = j;
+			for(k = j + 1; k < i + run; k++) {
+				if(skipReset && isResetValue(&settings[k])) {
+					continue;
+				}
+				if(k - last - 1 > CONFIG_MAX_GAP) {
+					break;
+				}
+				last = k;
+			}
+			for(k = first; k <= last; k++) {
+				buffer[k - first] = settings[k].data;
+			}
+			cc112xSpiWriteReg(settings[first].addr, buffer, last - first + 1);
+			j = last + 1;
+		}
+	}
+}
+
+/*******************************************************************************
+*   @fn         readBackSettings
+*
+*   @brief      Reads back the configuration registers of a settings table in
+*               burst accesses.
+*
+*   @param      settings - table
+*   @param      n        - number of settings
+*   @param      match    - set to 0 if a register differs from the table
+*
+*   @return     digest of the values read (see radio_ConfigDigest())
+*/
+static uint16_t readBackSettings(const registerSetting_t *settings, uint16_t n, uint8_t *match) {
+
+	uint8_t buffer[CONFIG_MAX_BURST];
+	uint16_t i, k, run;
+	uint16_t crc = 0xFFFF;
+
+	*match = 1;
+	for(i = 0; i < n; i += run) {
+		if(!isConfigRegister(settings[i].addr)) {
+			run = 1;
+			continue;
+		}
+		run = runLength(&settings[i], n - i, 1);
+		cc112xSpiReadReg(settings[i].addr, buffer, run);
+
+		for(k = 0; k < run; k++) {
+			crc = crc16(crc, (uint8_t)(settings[i+k].addr >> 8));
+			crc = crc16(crc, (uint8_t)(settings[i+k].addr & 0x00FF));
+			crc = crc16(crc, buffer[k]);
+			if(buffer[k] != settings[i+k].data) {
+				*match = 0;
+			}
+		}
+	}
+	return crc;
+}
+
+/*******************************************************************************
+*   @fn         radio_ConfigDigest
+*
+*   @brief      CRC-16-CCITT (0x1021, initial 0xFFFF) of the address (MSB
+*               first) and value of the configuration registers of
+*               preferredSettings, in the table order. registerConfig() (and
+*               radio_Setup()) returns the same digest over the values read
+*               back.
+*
+*   @param      none
+*
+*   @return     digest
+*/
+uint16_t radio_ConfigDigest(void) {
+
+	uint16_t i;
+	uint16_t crc = 0xFFFF;
+
+	for(i = 0; i < sizeof(preferredSettings)/sizeof(registerSetting_t); i++) {
+		if(isConfigRegister(preferredSettings[i].addr)) {
+			crc = crc16(crc, (uint8_t)(preferredSettings[i].addr >> 8));
+			crc = crc16(crc, (uint8_t)(preferredSettings[i].addr & 0x00FF));
+			crc = crc16(crc, preferredSettings[i].data);
+		}
+	}
+	return crc;
+}
+
+/*******************************************************************************
+*   @fn         registerConfig
+*
+*   @brief      Resets the radio and writes preferredSettings in burst
+*               accesses, skipping the registers already at their reset value.
+*               The configuration registers are read back; on a mismatch the
+*               whole table is written again.
 *
 *   @param      none
 *
+*   @return     readback digest (see radio_ConfigDigest())
+*/
+static uint16_t registerConfig(void) {
+
+	uint16_t n = sizeof(preferredSettings)/sizeof(registerSetting_t);
+	uint16_t digest;
+	uint8_t match;
+
+    trxSpiCmdStrobe(CC112X_SRES);													// Reset radio
+
+    writeSettings(preferredSettings, n, 1);										// Write registers to radio
+    digest = readBackSettings(preferredSettings, n, &match);
+    if(!match) {
+    	writeSettings(preferredSettings, n, 0);
+    	digest = readBackSettings(preferredSettings, n, &match);
+    }
+    return digest;
+}
+
+/*******************************************************************************
+*   @fn         setPacketLength
+*
+*   @brief      Writes the packet length mode (PKT_CFG0.LENGTH_CONFIG).
+*
+*   @param      cfg0 - PKT_CFG0_FIXED, PKT_CFG0_VARIABLE or PKT_CFG0_INFINITE
+*
 *   @return     none
 */
-static void runRX(char* buffer) {
+static void setPacketLength(uint8_t cfg0) {
+
+	cc112xSpiWriteReg(CC112X_PKT_CFG0, &cfg0, 1);
+}
+
+/*******************************************************************************
+*   @fn         rxClockMs
+*
+*   @brief      Reads the system clock in ms, modulo 2^16. The seconds are
+*               read again after the milliseconds in case the clock
+*               interrupt ran in between.
+*
+*   @param      none
+*
+*   @return     sysclock_s * 1000 + sysclock_ms, modulo 2^16
+*/
+static uint16_t rxClockMs(void) {
+
+	uint16_t s, ms;
+
+	do {
+		s  = sysclock_read_s();
+		ms = sysclock_read_ms();
+	} while(s != sysclock_read_s());
+
+	return s * 1000 + ms;
+}
+
+/*******************************************************************************
+*   @fn         waitRxBytes
+*
+*   @brief      Waits for bytes in the RX FIFO, polling NUM_RXBYTES every
+*               millisecond and kicking the watchdog. The timeout is measured
+*               on the system clock (util/sysclock.h), so the time spent in
+*               the SPI accesses counts towards it.
+*
+*   @param      rxBytes - number of bytes in the RX FIFO (output)
+*               timeout - longest wait in ms
+*
+*   @return     1, or 0 on timeout or RX FIFO error
+*/
+static uint8_t waitRxBytes(uint8_t *rxBytes, uint8_t timeout) {
 
-//	debug("runRX() init");
-	uint8_t rxBuffer[150] = { 0 };
-	uint8_t rxBytes;
 	uint8_t marcState;
+	uint16_t start = rxClockMs();
+
+	while(1) {
+		wdt_reset_counter();
+		cc112xSpiReadReg(CC112X_NUM_RXBYTES, rxBytes, 1);
+		if(*rxBytes != 0) {
+			// Read MARCSTATE to check for RX FIFO error
+			cc112xSpiReadReg(CC112X_MARCSTATE, &marcState, 1);
+			return (marcState & 0x1F) != RX_FIFO_ERROR;
+		}
+		if((uint16_t)(rxClockMs() - start) >= timeout) {
+			return 0;
+		}
+		__delay_cycles(DELAY_1_MS_IN_CYCLES);
+	}
+}
 
+/*******************************************************************************
+*   @fn         rxRestart
+*
+*   @brief      Ends the packet being received and puts the radio back in RX
+*               (infinite packet length), waiting for the next one.
+*
+*   @param      flush - 1 to flush the RX FIFO (timeout, RX FIFO error or
+*               packet rejected)
+*
+*   @return     none
+*/
+static void rxRestart(uint8_t flush) {
+
+	if(flush) {
+		trxSpiCmdStrobe(CC112X_SIDLE);
+		trxSpiCmdStrobe(CC112X_SFRX);
+	}
+	setPacketLength(PKT_CFG0_INFINITE);
+	trxSpiCmdStrobe(CC112X_SRX);
+	rxState = RX_START;
+}
+
+/*******************************************************************************
+*   @fn         rxHeader
+*
+*   @brief      Listens RX_IDLE_MS for the start of a packet and reads its
+*               length header: a normal packet starts with its length (below
+*               STREAM_FLAG), a streamed one (longer than the FIFO, sent by
+*               the beacon) with [STREAM_FLAG | length MSB, length LSB].
+*               A packet longer than RX_BUFFER_SIZE is rejected here and the
+*               rest of it flushed (the radio looks for the next sync word).
+*
+*   @param      none
+*
+*   @return     1 if a packet is being received (RX_DATA), else 0
+*/
+static uint8_t rxHeader(void) {
+
+	uint8_t header[STREAM_HEADER];
+	uint8_t rxBytes = 0;
+	uint8_t pktLen;
 
 	// Set radio in RX
-//	debug("trxSpiCmdStrobe() init");
 	trxSpiCmdStrobe(CC112X_SRX);
 
-	// Read number of bytes in RX FIFO
-//	debug("cc112xSpiReadReg() init");
-	cc112xSpiReadReg(CC112X_NUM_RXBYTES, &rxBytes, 1);
-//	debug_uint("rxBytes:", rxBytes);
+	// Even if there's no data to read, wait for a specific time
+	// to make radio reading functions timming static.
+	if(!waitRxBytes(&rxBytes, RX_IDLE_MS)) {
+		// Flush on RX FIFO error
+		rxRestart(rxBytes != 0);
+		return 0;
+	}
 
-	// Check that we have bytes in FIFO
-	if (rxBytes != 0) {
+	cc112xSpiReadRxFifo(&header[0], 1);
+	rxReceived = 1;
+	if(header[0] & STREAM_FLAG) {
+		if(!waitRxBytes(&rxBytes, RX_TIMEOUT_MS)) {
+			rxRestart(1);
+			return 0;
+		}
+		cc112xSpiReadRxFifo(&header[1], 1);
+		rxReceived = STREAM_HEADER;
+		rxTotal = STREAM_HEADER + (((uint16_t)(header[0] & ~STREAM_FLAG) << 8) | header[1]);
+	} else {
+		rxTotal = header[0] + 1;
+	}
 
-//		debug_uint("\n\n\rrxBytes:", rxBytes);
+	if(rxTotal > RX_BUFFER_SIZE) {
+		debug_uint("\tRadio packet too long:", rxTotal);
+		rxRestart(1);
+		return 0;
+	}
 
-		// Read MARCSTATE to check for RX FIFO error
-		// ~20ms
-		cc112xSpiReadReg(CC112X_MARCSTATE, &marcState, 1);
+	pktLen = (uint8_t)(rxTotal & 0x00FF);
+	cc112xSpiWriteReg(CC112X_PKT_LEN, &pktLen, 1);
 
-		// Mask out MARCSTATE bits and check if we have a RX FIFO error
-		if ((marcState & 0x1F) == RX_FIFO_ERROR) {
-//			Flush RX FIFO
-//			trxSpiCmdStrobe(CC112X_SFRX);
+	// rxBuffer now holds the packet being received
+	rxLength = 0;
+	memcpy(rxBuffer, header, rxReceived);
+	rxFixed = 0;
+	rxStatusBytes = 0;
+	rxState = RX_DATA;
+	return 1;
+}
 
-		} else {
-//			debug("(marcState & 0x1F) == RX_FIFO_ERROR  ELSE");
-//			// Read n bytes from RX FIFO
+/*******************************************************************************
+*   @fn         rxEnd
+*
+*   @brief      End of the packet (status bytes read): keeps it if its CRC is
+*               right and puts the radio back in RX.
+*
+*   @param      buffer - four bytes of the last normal packet (output)
+*
+*   @return     none
+*/
+static void rxEnd(char* buffer) {
 
-			cc112xSpiReadRxFifo(rxBuffer, rxBytes);
+	if(rxStatus[1] & RX_CRC_OK) {
+		rxLength = rxTotal;
 
-			//			debug("Printing radio buffer...");
-			debug_array("\tRadio data:", rxBuffer, rxBytes );
-//			debug_array_ascii("Radio ASCII:", rxBuffer, rxBytes );
+		if(rxBuffer[0] & STREAM_FLAG) {
+			debug_uint("\tRadio stream bytes:", rxTotal - STREAM_HEADER);
+		} else {
+			debug_array("\tRadio data:", (char*)rxBuffer, rxLength);
+//			debug_array_ascii("Radio ASCII:", rxBuffer, rxLength );
 			buffer[0] = rxBuffer[1];
 			buffer[1] = rxBuffer[2];
 			buffer[2] = rxBuffer[6];
 			buffer[3] = rxBuffer[7];
 		}
+	}
 
-	} else {
-		// even if there's no data to read, wait for a specific time
-		// to make radio reading functions timming static.
-	    __delay_cycles(DELAY_50_MS_IN_CYCLES);
-	    __delay_cycles(DELAY_10_MS_IN_CYCLES);
-	    __delay_cycles(DELAY_1_MS_IN_CYCLES);
+	rxRestart(0);
+}
+
+/*******************************************************************************
+*   @fn         runRX
+*
+*   @brief      Puts radio in RX and waits for packets, draining the RX FIFO
+*               while the packet is received. Function assumes that status
+*               bytes are appended in the RX_FIFO.
+*
+*               The radio receives in the infinite packet length mode and
+*               the length is taken from the first bytes (See rxHeader()).
+*               PKT_LEN is set to the packet length modulo 256 and the mode
+*               is switched to fixed length once fewer than 256 bytes are
+*               left, so the radio ends the packet (and appends the status
+*               bytes) at the last byte. The packet must be caught before
+*               its end: runRX() listens for RX_IDLE_MS.
+*
+*               A call drains for at most RX_SLICE_MS: a longer packet (a
+*               stream of 1 KB takes 6.8 s at 1200 bps) is received over
+*               several calls, the RX FIFO (128 bytes, 850 ms) holding what
+*               arrives in between. The watchdog is kicked while waiting for
+*               bytes (See waitRxBytes()).
+*
+*               The packet is kept in rxBuffer (See radio_LastPacket()) if
+*               its CRC is right, and bytes 1, 2, 6 and 7 of a normal packet
+*               are copied to buffer.
+*
+*   @param      buffer - four bytes of the last normal packet (output)
+*
+*   @return     none
+*/
+static void runRX(char* buffer) {
+
+	uint8_t rxBytes = 0;
+	uint16_t start = rxClockMs();
+	uint16_t n;
+
+	if((rxState == RX_START) && !rxHeader()) {
+		return;
 	}
 
-	// Set radio back in RX
-	trxSpiCmdStrobe(CC112X_SRX);
+	while(rxState != RX_START) {
+		// The byte counter of the fixed length mode counts modulo 256
+		if((rxState == RX_DATA) && !rxFixed && (rxTotal - rxReceived < 256)) {
+			setPacketLength(PKT_CFG0_FIXED);
+			rxFixed = 1;
+		}
+
+		// Rest of the packet on the next call
+		if((uint16_t)(rxClockMs() - start) >= RX_SLICE_MS) {
+			return;
+		}
+
+		if(!waitRxBytes(&rxBytes, RX_TIMEOUT_MS)) {
+			// Timeout (packet caught after its end) or RX FIFO error
+			rxRestart(1);
+			return;
+		}
+
+		if(rxState == RX_DATA) {
+			n = rxBytes;
+			if(n > rxTotal - rxReceived) {
+				n = rxTotal - rxReceived;
+			}
+			cc112xSpiReadRxFifo(&rxBuffer[rxReceived], (uint8_t)n);
+			rxReceived += n;
+			if(rxReceived == rxTotal) {
+				rxState = RX_STATUS;
+			}
+		} else {
+			// Status bytes, appended at the end of the packet
+			cc112xSpiReadRxFifo(&rxStatus[rxStatusBytes], 1);
+			if(++rxStatusBytes == RX_STATUS_BYTES) {
+				rxEnd(buffer);
+			}
+		}
+	}
+}
+
+/*******************************************************************************
+*   @fn         radio_LastPacket
+*
+*   @brief      Last packet received by runRX() with the right CRC.
+*
+*   @param      data - the packet, length header included (output)
+*
+*   @return     Bytes of the packet (up to RX_BUFFER_SIZE), 0 if none
+*/
+uint16_t radio_LastPacket(const uint8_t **data) {
+
+	*data = rxBuffer;
+	return rxLength;
 }
 
 void trxRfSpiInterfaceInit(uint8_t prescalerValue){
@@ -26,11 +26,28 @@
 */
 
 #define RX_FIFO_ERROR           0x11
+#define RX_BUFFER_SIZE          1024		// Longest packet kept by runRX() (longer ones are rejected at the header)
+#define RX_STATUS_BYTES         2			// RSSI and CRC_OK/LQI appended to the packet (PKT_CFG1.APPEND_STATUS)
+#define RX_CRC_OK               0x80		// CRC_OK bit of the second status byte
+#define RX_TIMEOUT_MS           50			// Longest wait for the next byte of a packet (1200 bps: 6.7 ms per byte)
+#define RX_IDLE_MS              61			// Time runRX() listens for the start of a packet
+#define RX_SLICE_MS             250			// Longest time a runRX() call drains a packet (the rest on the next call)
+
+#define PKT_CFG0_FIXED          0x00		// PKT_CFG0.LENGTH_CONFIG: fixed packet length (PKT_LEN)
+#define PKT_CFG0_VARIABLE       0x20		// PKT_CFG0.LENGTH_CONFIG: variable packet length (first byte)
+#define PKT_CFG0_INFINITE       0x40		// PKT_CFG0.LENGTH_CONFIG: infinite packet length
+#define STREAM_FLAG             0x80		// First byte of the length header of a streamed packet (beacon cc11xx_stream.h)
+#define STREAM_HEADER           2			// [STREAM_FLAG | length MSB, length LSB]
 #define PKTLEN                  30  		// 1 < PKTLEN < 126
 #define GPIO3                   0x80		// P2.7 (1000 0000)	FloripaSat
 #define GPIO2                   0x20		// P1.5 (0010 0000) FloripaSat
 #define GPIO0                   0x40		// P1.6 (0100 0000) FloripaSat
 
+#define CONFIG_REGS             0x2F		// Configuration registers, normal space (0x00 - 0x2E)
+#define CONFIG_EXT_REGS         0x3A		// Configuration registers, extended space (0x2F00 - 0x2F39)
+#define CONFIG_MAX_BURST        32			// Longest burst access of registerConfig()
+#define CONFIG_MAX_GAP          2			// Registers at reset value kept inside a burst instead of splitting it
+
 /*******************************************************************************
 * LOCAL VARIABLES
 */
@@ -112,6 +129,13 @@ typedef struct
 
 typedef uint8_t rfStatus_t;
 
+typedef enum
+{
+  RX_START,			// Listening for the start of a packet
+  RX_DATA,			// Packet bytes
+  RX_STATUS			// Status bytes appended after the packet
+}rxState_t;
+
 /******************************************************************************
  * PROTOTYPES
  */
@@ -368,11 +392,37 @@ static void manualCalibration(void);
 
 void readTransceiver(char*);
 void SPI_Setup(void);
-void radio_Setup(void);
-static void registerConfig(void);
+uint16_t radio_Setup(void);
+static uint16_t registerConfig(void);
+uint16_t radio_ConfigDigest(void);
+uint16_t radio_LastPacket(const uint8_t **data);
 static void runRX(char*);
+static void setPacketLength(uint8_t cfg0);
 static void manualCalibration(void);
 
+/* Reset values of the configuration registers (CC112x User's Guide, tables 4 and 5) */
+static const uint8_t resetValues[CONFIG_REGS]=
+{
+    0x06, 0x07, 0x30, 0x3C, 0x93, 0x0B, 0x51, 0xDE,		// IOCFG3 - SYNC0
+    0x0A, 0x17, 0x06, 0x03, 0x4C, 0x14, 0x2A, 0x40,		// SYNC_CFG1 - FREQ_IF_CFG
+    0xC4, 0x14, 0x46, 0x0D, 0x43, 0xA9, 0x2A, 0x36,		// IQIC - AGC_REF
+    0x00, 0x00, 0x91, 0x20, 0xAA, 0xC3, 0x80, 0x00,		// AGC_CS_THR - DEV_ADDR
+    0x0B, 0x02, 0x08, 0x21, 0x00, 0x00, 0x04, 0x05,		// SETTLING_CFG - PKT_CFG1
+    0x00, 0x0F, 0x00, 0x7F, 0x56, 0x7C, 0x03			// PKT_CFG0 - PKT_LEN
+};
+
+static const uint8_t extResetValues[CONFIG_EXT_REGS]=
+{
+    0x04, 0x20, 0x0A, 0x00, 0x00, 0x00, 0x01, 0x00,		// IF_MIX_CFG - RCCAL_FINE
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,		// RCCAL_COARSE - IF_ADC2
+    0xA6, 0x04, 0x08, 0x5A, 0x00, 0x20, 0x00, 0x00,		// IF_ADC1 - FS_CAL0
+    0x28, 0x01, 0x00, 0x03, 0xFF, 0x1F, 0x00, 0x51,		// FS_CHP - FS_PFD
+    0x2C, 0x11, 0x00, 0x14, 0x00, 0x00, 0x00, 0x81,		// FS_PRE - FS_VCO0
+    0x00, 0x02, 0x00, 0x00, 0x10, 0x00, 0x00, 0x01,		// GBIAS6 - IFAMP
+    0x01, 0x01, 0x0C, 0xA0, 0x03, 0x04, 0x00, 0x00,		// LNA - XOSC0
+    0x00, 0x00											// ANALOG_SPARE - PA_CFG3
+};
+
 //todo new configuration of radio ** to be tested **
 static const registerSetting_t preferredSettings[]=
 {
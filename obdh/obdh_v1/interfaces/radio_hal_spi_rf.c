@@ -18,9 +18,26 @@
 #include "radio.h"
 #include <stdint.h>
 
+/******************************************************************************
+ * CONSTANTS
+ */
+
+/* Burst data phases of TRX_SPI_DMA_MIN bytes or more are moved by DMA:
+ * channel 0 drains UCA0RXBUF on UCA0RXIFG (trigger 16), channel 1 feeds
+ * UCA0TXBUF on UCA0TXIFG (trigger 17). The CPU sleeps in LPM0 (SMCLK keeps
+ * running the SPI clock) until the DMA0 interrupt. */
+#define TRX_SPI_DMA_MIN        4
+
+/******************************************************************************
+ * LOCAL VARIABLES
+ */
+static uint8_t trxSpiDummyTx = 0;
+static uint8_t trxSpiDummyRx;
+
 /******************************************************************************
  * LOCAL FUNCTIONS
  */
+static void trxSpiDmaBurst(uint8_t addr, uint8_t *pData, uint16_t len);
 
 
 ///******************************************************************************
@@ -179,8 +196,7 @@ rfStatus_t trxSpiCmdStrobe(uint8_t cmd)
 	while(TRXEM_PORT_IN & TRXEM_SPI_MISO_PIN);
 //    __delay_cycles(DELAY_5_MS_IN_CYCLES);
 	TRXEM_SPI_TX(cmd);
-//	TRXEM_SPI_WAIT_DONE();
-	__delay_cycles(DELAY_5_MS_IN_CYCLES);
+	TRXEM_SPI_WAIT_DONE();
 	rc = TRXEM_SPI_RX();
 	TRXEM_SPI_END();
 	return(rc);
@@ -212,8 +228,7 @@ rfStatus_t trx8BitRegAccess(uint8_t accessType, uint8_t addrByte, uint8_t *pData
 
 	/* Pull CS_N low and wait for SO to go low before communication starts */
 	TRXEM_SPI_BEGIN();
-//	while(TRXEM_PORT_IN & TRXEM_SPI_MISO_PIN);
-    __delay_cycles(DELAY_1_MS_IN_CYCLES);
+	while(TRXEM_PORT_IN & TRXEM_SPI_MISO_PIN);
 	/* send register address byte */
 	TRXEM_SPI_TX(accessType|addrByte);
 	TRXEM_SPI_WAIT_DONE();
@@ -249,17 +264,14 @@ rfStatus_t trx16BitRegAccess(uint8_t accessType, uint8_t extAddr, uint8_t regAdd
 	uint8_t readValue;
 
 	TRXEM_SPI_BEGIN();
-//	while(TRXEM_PORT_IN & TRXEM_SPI_MISO_PIN);
-    __delay_cycles(DELAY_5_MS_IN_CYCLES);
+	while(TRXEM_PORT_IN & TRXEM_SPI_MISO_PIN);
 	/* send extended address byte with access type bits set */
 	TRXEM_SPI_TX(accessType|extAddr);
-//	TRXEM_SPI_WAIT_DONE();
-	__delay_cycles(DELAY_5_MS_IN_CYCLES);
+	TRXEM_SPI_WAIT_DONE();
 	/* Storing chip status */
 	readValue = TRXEM_SPI_RX();
 	TRXEM_SPI_TX(regAddr);
-//	TRXEM_SPI_WAIT_DONE();
-	__delay_cycles(DELAY_5_MS_IN_CYCLES);
+	TRXEM_SPI_WAIT_DONE();
 	/* Communicate len number of bytes */
 	trxReadWriteBurstSingle(accessType|extAddr,pData,len);
 	TRXEM_SPI_END();
@@ -301,11 +313,15 @@ static void trxReadWriteBurstSingle(uint8_t addr,uint8_t *pData,uint16_t len)
   {
     if(addr&RADIO_BURST_ACCESS)
     {
+      if(len >= TRX_SPI_DMA_MIN)
+      {
+        trxSpiDmaBurst(addr, pData, len);
+        return;
+      }
       for (i = 0; i < len; i++)
       {
           TRXEM_SPI_TX(0);            /* Possible to combining read and write as one access type */
-//          TRXEM_SPI_WAIT_DONE();
-          __delay_cycles(DELAY_5_MS_IN_CYCLES);
+          TRXEM_SPI_WAIT_DONE();
           *pData = TRXEM_SPI_RX();     /* Store pData from last pData RX */
           pData++;
       }
@@ -322,6 +338,11 @@ static void trxReadWriteBurstSingle(uint8_t addr,uint8_t *pData,uint16_t len)
     if(addr&RADIO_BURST_ACCESS)
     {
       /* Communicate len number of bytes: if TX - the procedure doesn't overwrite pData */
+      if(len >= TRX_SPI_DMA_MIN)
+      {
+        trxSpiDmaBurst(addr, pData, len);
+        return;
+      }
       for (i = 0; i < len; i++)
       {
         TRXEM_SPI_TX(*pData);
@@ -337,3 +358,83 @@ static void trxReadWriteBurstSingle(uint8_t addr,uint8_t *pData,uint16_t len)
   }
   return;
 }
+
+/*******************************************************************************
+ * @fn          trxSpiDmaBurst
+ * @brief       Moves the data phase of a burst access (len >= TRX_SPI_DMA_MIN) by DMA.
+ *              The first byte is written by the CPU, the other len - 1 by
+ *              channel 1 as UCA0TXBUF empties; channel 0 stores the len
+ *              received bytes (the data read or, in a write, dummies) and
+ *              interrupts when the last one is in. Called with CS_N low.
+ *
+ * input parameters
+ * @param       addr  - Header byte (read/write and burst bits)
+ * @param       pData - Data to be written, or buffer for the data read
+ * @param       len   - Number of data bytes
+ *
+ * output parameters
+ * @return      void
+ */
+static void trxSpiDmaBurst(uint8_t addr, uint8_t *pData, uint16_t len)
+{
+	uint16_t gie = __get_interrupt_state();
+
+	__disable_interrupt();
+
+	DMACTL0 = DMA0TSEL_16 | DMA1TSEL_17;	/* UCA0RXIFG, UCA0TXIFG */
+
+	if(addr&RADIO_READ_ACCESS)
+	{
+		__data16_write_addr((unsigned short)&DMA0DA, (unsigned long)pData);
+		DMA0CTL = DMADT_0 | DMADSTINCR_3 | DMASRCINCR_0 | DMADSTBYTE | DMASRCBYTE;
+		__data16_write_addr((unsigned short)&DMA1SA, (unsigned long)&trxSpiDummyTx);
+		DMA1CTL = DMADT_0 | DMADSTINCR_0 | DMASRCINCR_0 | DMADSTBYTE | DMASRCBYTE;
+	}
+	else
+	{
+		__data16_write_addr((unsigned short)&DMA0DA, (unsigned long)&trxSpiDummyRx);
+		DMA0CTL = DMADT_0 | DMADSTINCR_0 | DMASRCINCR_0 | DMADSTBYTE | DMASRCBYTE;
+		__data16_write_addr((unsigned short)&DMA1SA, (unsigned long)(pData + 1));
+		DMA1CTL = DMADT_0 | DMADSTINCR_0 | DMASRCINCR_3 | DMADSTBYTE | DMASRCBYTE;
+	}
+	__data16_write_addr((unsigned short)&DMA0SA, (unsigned long)&UCA0RXBUF);
+	__data16_write_addr((unsigned short)&DMA1DA, (unsigned long)&UCA0TXBUF);
+	DMA0SZ = len;
+	DMA1SZ = len - 1;
+
+	UCA0IFG &= ~UCRXIFG;
+	DMA0CTL |= DMAEN | DMAIE;
+	DMA1CTL |= DMAEN;
+
+	/* First byte by software: its TXIFG triggers channel 1 for the others */
+	UCA0TXBUF = (addr&RADIO_READ_ACCESS) ? 0 : *pData;
+
+	/* DMAEN of channel 0 is cleared with the last byte; the DMA interrupt
+	 * only wakes the CPU, so GIE stays off between the check and the sleep */
+	while(DMA0CTL & DMAEN)
+	{
+		__bis_SR_register(LPM0_bits + GIE);
+		__disable_interrupt();
+	}
+
+	__set_interrupt_state(gie);
+	return;
+}
+
+/*******************************************************************************
+ * @fn          DMA_ISR
+ * @brief       End of a DMA burst: wakes the CPU.
+ */
+#pragma vector=DMA_VECTOR
+__interrupt void DMA_ISR(void)
+{
+	switch(__even_in_range(DMAIV, 16))
+	{
+	case 2:							// DMA0IFG: trxSpiDmaBurst() done
+		DMA0CTL &= ~DMAIE;
+		__bic_SR_register_on_exit(LPM0_bits);
+		break;
+	default:
+		break;
+	}
+}
@@ -8,7 +8,7 @@
 #include "crc.h"
 
 char CRC8(char *data, uint16_t length) {
-	char CRC, inbyte, Mix;    		// CRC, inbyte e Mix tem 8 bits
+	uint8_t CRC = 0, inbyte, Mix;	// CRC, inbyte e Mix tem 8 bits (sem sinal, senao CRC >>= 1 replica o bit 7)
 	int i, j;
 	for (i = 1; i < length - 2 ; i++) {          // contagem dos bytes(de 1 a n-2 para o floripa sat)
 		inbyte = data[i];
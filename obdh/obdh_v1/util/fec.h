@@ -0,0 +1,68 @@
+/*
+ * fec.h
+ *
+ *  Created on: 17 de out de 2026
+ *
+ * Forward error correction of the downlink frames, encoder side.
+ *
+ * Block: | ASM (4) | conv( data (len) | RS parity (32*depth) ) |
+ *
+ *  - Reed-Solomon (255,223) CCSDS (x^8+x^7+x^2+x+1, fcr 112, prim 11,
+ *    conventional basis), shortened to the frame length. With depth I the
+ *    data byte j belongs to codeword j % I and the parity bytes follow
+ *    interleaved the same way, so a burst of up to 16*I bytes is corrected.
+ *  - Convolutional K=7 r=1/2 (171/133 octal, no inversion), 6 zero tail bits.
+ *    Bits are MSB first, the G1 symbol before G2.
+ *  - ASM 0x1ACFFC1D, not coded, to find the block in the bit stream.
+ *
+ * Only table lookups and 8/16 bit integer operations: ~1 KB of flash for the
+ * tables, 32 bytes of stack, no multiplications.
+ * The ground side is groundstation/fec.h.
+ */
+
+#ifndef UTIL_FEC_H_
+#define UTIL_FEC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define FEC_RS_K			223
+#define FEC_RS_PARITY		32
+#define FEC_DEPTH_MAX		8
+#define FEC_ASM				0x1ACFFC1DUL
+#define FEC_ASM_LENGTH		4
+
+// bytes of the RS block and of the whole coded block
+#define FEC_RS_BLOCK_LENGTH(len, depth)		((len) + FEC_RS_PARITY*(depth))
+#define FEC_BLOCK_LENGTH(len, depth)		(FEC_ASM_LENGTH + 2*FEC_RS_BLOCK_LENGTH(len, depth) + 2)
+
+/*
+ * Parity of one (shortened) codeword: len data bytes read every stride bytes,
+ * the 32 parity bytes written every pstride bytes.
+ */
+void rs_encode(const uint8_t *data, uint8_t len, uint8_t stride, uint8_t *parity, uint8_t pstride);
+
+/*
+ * Appends the interleaved parity to the len data bytes of block (len <= 223*depth).
+ * Returns the RS block length, 0 if len or depth are out of range.
+ */
+uint16_t fec_rs_block(uint8_t *block, uint16_t len, uint8_t depth);
+
+/* Convolutional code with tail, out holds 2*len + 2 bytes. Returns the bytes written. */
+uint16_t fec_conv_encode(const uint8_t *in, uint16_t len, uint8_t *out);
+
+/*
+ * Whole block: RS parity is appended to block (which must hold
+ * FEC_RS_BLOCK_LENGTH(len, depth) bytes), then ASM and the convolutional code
+ * go to out (FEC_BLOCK_LENGTH(len, depth) bytes). Returns the bytes in out, 0 on error.
+ */
+uint16_t fec_encode(uint8_t *block, uint16_t len, uint8_t depth, uint8_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UTIL_FEC_H_ */
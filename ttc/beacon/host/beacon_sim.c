@@ -0,0 +1,374 @@
+/*
+ * beacon_sim.c
+ *
+ * Copyright (C) 2016, Universidade Federal de Santa Catarina
+ *
+ * This file is part of FloripaSat-TTC.
+ *
+ * FloripaSat-TTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FloripaSat-TTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FloripaSat-TTC.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file beacon_sim.c
+ *
+ * \brief Runs the beacon main loop (events.c, beacon.c) against the host mock (spi_mock.h).
+ *
+ * The loop of main.c is run for SIM_PERIODS beacon periods: LPM3 between
+ * the RTC ticks and the end of packet edges of the CC1175 GPIO2, LPM0 during
+ * the SPI transfers and the PA settling time (Timer_A1). For each period it
+ * prints the time the CPU was active (interrupt routines, SPI byte waits and
+ * SIM_LOOP_CYCLES per wake-up for the loop body), in LPM0 and in LPM3, and
+ * the time the PA was on. STX must come BEACON_PA_SETTLING_MS after the PA
+ * is turned on.
+ *
+ * Then a SIM_STREAM_LEN bytes packet is streamed (cc11xx_stream.h), with the
+ * ring buffer fed on each wake-up, and its air time is compared with the
+ * same data in packets of the variable packet length mode. A second stream,
+ * whose producer runs dry, must end with a TX FIFO underflow, and a third,
+ * whose end of packet edge is lost, must be aborted by the beacon timeout
+ * and the beacon go on. The exit status is 1 if a check fails.
+ *
+ * \version 1.0-dev
+ *
+ * \date 17/10/2026
+ *
+ * \addtogroup spi_mock
+ * \{
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../inc/cc11xx_spi.h"
+#include "../inc/cc11xx_config.h"
+#include "../inc/cc11xx_floripasat_reg_config.h"
+#include "../inc/cc11xx_stream.h"
+#include "../inc/beacon.h"
+#include "../inc/events.h"
+#include "../inc/rf6886.h"
+#include "../inc/rf-switch.h"
+#include "../inc/uart-eps.h"
+
+#define SIM_PERIODS         6
+#define SIM_LOST_EDGE       4       /**< Period with the GPIO2 edge lost (TX timeout) */
+#define SIM_LOOP_CYCLES     400     /**< Main loop body per wake-up (event dispatch, beacon_Tick()) */
+#define SIM_STREAM_LEN      4096    /**< Data bytes of the streamed packet */
+#define SIM_STREAM_DRY      1000    /**< Bytes given by the producer before it runs dry (underflow case) */
+#define SIM_STREAM_LOST     600     /**< Data bytes of the stream whose end of packet edge is lost */
+#define SIM_PKT_DATA        126     /**< Data bytes per packet in the variable packet length mode (length byte + 126 < 128) */
+
+#define N_REGS              (sizeof(reg_values)/sizeof(RegistersSettings))
+
+// Interrupt routines of events.c
+void events_RTC_ISR();
+void events_GDO_ISR();
+void events_Timer_ISR();
+
+static int failures = 0;
+
+static bool pa_on = false;
+static uint64_t pa_since = 0;
+static uint64_t pa_ns = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok)
+    {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+/* Drivers not built for the host */
+void rf6886_Enable()
+{
+    pa_on = true;
+    pa_since = spi_mock.now;
+}
+
+void rf6886_Disable()
+{
+    if (pa_on)
+    {
+        pa_ns += spi_mock.now - pa_since;
+        pa_on = false;
+    }
+}
+
+void rf6886_SetVreg(float v_reg)
+{
+    (void)v_reg;
+}
+
+void rf_switch_Enable()
+{
+}
+
+void rf_switch_Disable()
+{
+}
+
+/* One EPS frame per second */
+uint8_t UART_EPS_GetBattery(EPSBatteryData *data)
+{
+    data->bat1_voltage  = 0x0300;
+    data->bat2_voltage  = 0x0301;
+    data->frames        = (uint16_t)(spi_mock.now/1000000000ULL);
+
+    return (data->frames > 0) ? STATUS_SUCCESS : STATUS_FAIL;
+}
+
+/* As cc11xx.c, without the debug output (cc11xx.c also holds the calibration and the LED) */
+uint8_t cc11xx_CmdStrobe(uint8_t cmd)
+{
+    if (cmd == CC11XX_STX)
+    {
+        check(pa_on && (spi_mock.now - pa_since >= BEACON_PA_SETTLING_MS*1000000ULL), "STX after the PA settling time");
+    }
+
+    return cc11xx_SPI_Transfer(0x00, cmd, NULL, 0);
+}
+
+uint8_t cc11xx_WriteTXFIFO(uint8_t *pData, uint8_t len)
+{
+    return cc11xx_SPI_Transfer(CC11XX_WRITE_ACCESS, CC11XX_BURST_TXFIFO, pData, len);
+}
+
+/* Port 1 interrupt with the GPIO2 edges lost (the GPIO0 ones still come) */
+static void sim_LostEdgeISR()
+{
+    spi_mock.p1ifg &= ~CC11XX_GPIO2_PIN;
+    events_GDO_ISR();
+}
+
+/* One pass of the main loop of main.c */
+static uint8_t sim_Loop()
+{
+    uint8_t events = events_Wait();
+
+    __delay_cycles(SIM_LOOP_CYCLES);
+
+    if (events & EVENTS_TX_END)
+    {
+        beacon_TxEnd();
+    }
+
+    if (events & EVENTS_RTC_TICK)
+    {
+        beacon_Tick();
+    }
+
+    return events;
+}
+
+/*
+ * One stream of len data bytes (beacon_Stream()), of which the producer has
+ * only the first avail, fed from the main loop. With lost, the end of packet
+ * edge is lost and the stream must be aborted by the timeout of beacon_Tick().
+ */
+static void sim_Stream(uint16_t len, uint16_t avail, bool lost)
+{
+    static uint8_t data[SIM_STREAM_LEN];
+    static uint8_t capture[CC11XX_STREAM_HEADER + SIM_STREAM_LEN];
+    uint8_t regs[sizeof(spi_mock.regs)];
+    uint64_t start = spi_mock.now, sleep = spi_mock.sleep_ns, pa = pa_ns;
+    uint32_t wakeups = spi_mock.wakeups, refills = spi_mock.port1_irqs;
+    uint32_t packets = spi_mock.tx_packets, underflows = spi_mock.tx_underflows;
+    uint64_t elapsed, active, chunked;
+    uint16_t given, i;
+    bool complete = avail >= len;
+
+    for(i=0; i<len; i++)
+    {
+        data[i] = (uint8_t)(i*7 + (i >> 8));
+    }
+
+    memcpy(regs, spi_mock.regs, sizeof(regs));
+    spi_mock.tx_capture = capture;
+    spi_mock.tx_capture_size = sizeof(capture);
+    spi_mock.tx_capture_len = 0;
+    if (lost)
+    {
+        spi_mock.port1_isr = sim_LostEdgeISR;
+    }
+
+    given = beacon_Stream(len, data, avail);
+    check(given > 0, "stream start");
+    check(pa_on, "stream: PA on");
+    check(spi_mock.p1ie & CC11XX_GPIO0_PIN, "stream: GPIO0 interrupt enabled");
+    check(beacon_Transmit() == STATUS_FAIL, "stream: no beacon packet while streaming");
+
+    while(cc11xx_StreamActive())
+    {
+        sim_Loop();
+
+        // The producer: as much as the ring buffer takes
+        if (given < avail)
+        {
+            given += cc11xx_StreamWrite(&data[given], avail - given);
+        }
+    }
+
+    // A beacon packet may start on the tick that ended the stream
+    spi_mock.tx_capture = NULL;
+    spi_mock.port1_isr = events_GDO_ISR;
+    spi_mock.p1ifg = 0;
+    packets = spi_mock.tx_packets - packets;
+    check(memcmp(regs, spi_mock.regs, sizeof(regs)) == 0, "stream: registers restored");
+    check(!(spi_mock.p1ie & CC11XX_GPIO0_PIN), "stream: GPIO0 interrupt disabled");
+
+    elapsed = spi_mock.now - start;
+    active = elapsed - (spi_mock.sleep_ns - sleep);
+
+    printf("stream %4u/%4u bytes %6.1f s: active %7.3f ms (%6.3f%%), %3u wake-ups, %3u GPIO interrupts, %u underflow(s), "
+           "PA on %6.1f ms%s\n", avail, len, elapsed/1e9, active/1e6, 100.0*active/elapsed, spi_mock.wakeups - wakeups,
+           spi_mock.port1_irqs - refills, spi_mock.tx_underflows - underflows, (pa_ns - pa)/1e6,
+           lost ? ", end of packet lost" : "");
+
+    check(spi_mock.tx_overflows == 0, "stream: TX FIFO overflows");
+
+    if (complete)
+    {
+        check(packets == 1, "stream: one packet");
+        check(spi_mock.tx_underflows == underflows, "stream: no underflow");
+        check(spi_mock.tx_capture_len == (uint32_t)CC11XX_STREAM_HEADER + len, "stream: packet length");
+        check((capture[0] == (CC11XX_STREAM_FLAG | (len >> 8))) && (capture[1] == (len & 0xFF)), "stream: length header");
+        check(memcmp(&capture[CC11XX_STREAM_HEADER], data, len) == 0, "stream: data");
+
+        if (!lost)
+        {
+            // The same data in packets of the variable packet length mode (length byte, up to SIM_PKT_DATA bytes)
+            chunked = (uint64_t)((len + SIM_PKT_DATA - 1)/SIM_PKT_DATA)*(SPI_MOCK_RADIO_HEADER + 1 + SPI_MOCK_RADIO_CRC) + len;
+            printf("air time: %u bytes streamed %.1f s, in %u packets %.1f s\n", len,
+                   (SPI_MOCK_RADIO_HEADER + CC11XX_STREAM_HEADER + len + SPI_MOCK_RADIO_CRC)*8.0/SPI_MOCK_RADIO_BPS,
+                   (len + SIM_PKT_DATA - 1)/SIM_PKT_DATA, chunked*8.0/SPI_MOCK_RADIO_BPS);
+        }
+    }
+    else
+    {
+        check(packets == 0, "dry stream: no packet");
+        check(spi_mock.tx_underflows - underflows == 1, "dry stream: one underflow");
+    }
+
+    // End of a beacon packet started on the last tick, if any
+    while(pa_on)
+    {
+        sim_Loop();
+    }
+    check(spi_mock.state == 0, "stream: radio in IDLE");
+}
+
+/* One beacon period (BEACON_PERIOD_S ticks) of the main loop of main.c */
+static void sim_Period(int n)
+{
+    uint64_t start = spi_mock.now, sleep = spi_mock.sleep_ns, lpm3 = spi_mock.lpm3_ns, pa = pa_ns;
+    uint32_t wakeups = spi_mock.wakeups, isr = spi_mock.rtc_irqs + spi_mock.ta_irqs + spi_mock.port1_irqs + spi_mock.usci_isr + spi_mock.dma_isr;
+    uint32_t packets = spi_mock.tx_packets;
+    uint64_t elapsed, active;
+    uint8_t ticks = 0;
+
+    while(ticks < BEACON_PERIOD_S)
+    {
+        if (sim_Loop() & EVENTS_RTC_TICK)
+        {
+            ticks++;
+        }
+    }
+
+    elapsed = spi_mock.now - start;
+    active = elapsed - (spi_mock.sleep_ns - sleep);
+
+    printf("period %d %6.1f s: active %7.3f ms (%6.3f%%), LPM0 %6.3f%%, LPM3 %7.3f%%, %3u wake-ups, %3u interrupts, "
+           "PA on %6.1f ms, %u packet(s)\n", n, elapsed/1e9, active/1e6, 100.0*active/elapsed,
+           100.0*(spi_mock.sleep_ns - sleep - (spi_mock.lpm3_ns - lpm3))/elapsed, 100.0*(spi_mock.lpm3_ns - lpm3)/elapsed,
+           spi_mock.wakeups - wakeups,
+           spi_mock.rtc_irqs + spi_mock.ta_irqs + spi_mock.port1_irqs + spi_mock.usci_isr + spi_mock.dma_isr - isr,
+           (pa_ns - pa)/1e6, spi_mock.tx_packets - packets);
+
+    check(spi_mock.tx_packets - packets == 1, "one packet per period");
+    check(100.0*active/elapsed < 1.0, "active time under 1%");
+    check(!pa_on, "PA off at the end of the period");
+    check(!(spi_mock.p1ie & CC11XX_GPIO0_PIN), "GPIO0 interrupt disabled out of a stream");
+}
+
+int main()
+{
+    uint32_t packets;
+    uint8_t ticks;
+    int i;
+
+    spi_mock_Reset(SPICLK);
+    spi_mock.sysrstiv = SYSRSTIV_BOR;
+    spi_mock.rtc_isr = events_RTC_ISR;
+    spi_mock.port1_isr = events_GDO_ISR;
+    spi_mock.ta_isr = events_Timer_ISR;
+    spi_mock.sr = GIE;
+
+    check(cc11xx_SPI_Init() == STATUS_SUCCESS, "SPI init");
+    cc11xx_LoadConfig(reg_values, N_REGS);
+    beacon_Init();
+    check(events_Init() == STATUS_SUCCESS, "events init");
+
+    printf("busy-wait loop (delay_s(1), TX polling): active 100%% of every period\n");
+
+    for(i=0; i<SIM_PERIODS; i++)
+    {
+        if (i == SIM_LOST_EDGE)
+        {
+            // GPIO2 stuck low: no end of packet event, the scheduler times out
+            spi_mock.port1_isr = NULL;
+            sim_Period(i);
+            spi_mock.p1ifg = 0;
+            spi_mock.port1_isr = events_GDO_ISR;
+
+            check(spi_mock.state == 0, "radio in IDLE after the TX timeout");
+            continue;
+        }
+
+        sim_Period(i);
+    }
+
+    sim_Stream(SIM_STREAM_LEN, SIM_STREAM_LEN, false);
+    sim_Stream(SIM_STREAM_LEN, SIM_STREAM_DRY, false);
+    sim_Stream(SIM_STREAM_LOST, SIM_STREAM_LOST, true);
+
+    // The beacon goes on after the stream timeout
+    packets = spi_mock.tx_packets;
+    for(ticks=0; (ticks <= BEACON_PERIOD_S) && (spi_mock.tx_packets == packets); )
+    {
+        if (sim_Loop() & EVENTS_RTC_TICK)
+        {
+            ticks++;
+        }
+    }
+    check(spi_mock.tx_packets > packets, "beacon packets after the stream timeout");
+
+    printf("%u RTC + %u Timer_A1 + %u port 1 + %u USCI + %u DMA interrupts, %u overruns, %u TXBUF collisions\n",
+           spi_mock.rtc_irqs, spi_mock.ta_irqs, spi_mock.port1_irqs, spi_mock.usci_isr, spi_mock.dma_isr, spi_mock.overruns,
+           spi_mock.tx_collisions);
+    check(spi_mock.overruns == 0, "RXBUF overruns");
+    check(spi_mock.tx_collisions == 0, "TXBUF collisions");
+
+    if (failures)
+    {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+
+    return 0;
+}
+
+//! \} End of spi_mock group
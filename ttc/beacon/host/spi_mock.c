@@ -0,0 +1,1041 @@
+/*
+ * spi_mock.c
+ *
+ * Copyright (C) 2016, Universidade Federal de Santa Catarina
+ *
+ * This file is part of FloripaSat-TTC.
+ *
+ * FloripaSat-TTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FloripaSat-TTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FloripaSat-TTC.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file spi_mock.c
+ *
+ * \brief Host mock of the USCI_B0, the DMA and the CC1175 SPI interface (implementation)
+ *
+ * \version 1.0-dev
+ *
+ * \date 17/10/2026
+ *
+ * \addtogroup spi_mock
+ * \{
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "spi_mock.h"
+#include "../inc/cc11xx_config.h"
+
+#define SPI_MOCK_TRIGGER_RX     18      // UCB0RXIFG
+#define SPI_MOCK_TRIGGER_TX     19      // UCB0TXIFG
+
+#define CHIP_STROBE_FIRST       0x30
+#define CHIP_STROBE_LAST        0x3D
+#define CHIP_FIFO               0x3F
+#define CHIP_EXT                0x2F
+#define CHIP_GDO0_PIN           GPIO_PIN6   // P1.6
+#define CHIP_GDO2_PIN           GPIO_PIN5   // P1.5
+#define CHIP_IOCFG0             0x03
+#define CHIP_FIFO_CFG           0x1E
+#define CHIP_PKT_CFG0           0x28
+#define CHIP_PKT_LEN            0x2E
+#define CHIP_TXFIFO_THR         0x02        // IOCFGx.GPIOx_CFG
+
+#define SPI_MOCK_SECOND         1000000000ULL
+
+SPIMock spi_mock;
+
+static void spi_mock_WriteTXBUF(uint8_t data);
+
+/**
+ * \fn spi_mock_RadioTime
+ *
+ * \brief Air time of a number of bytes.
+ */
+static uint64_t spi_mock_RadioTime(uint16_t bytes)
+{
+    return (uint64_t)bytes*8*SPI_MOCK_SECOND/SPI_MOCK_RADIO_BPS;
+}
+
+/**
+ * \fn spi_mock_SetPin
+ *
+ * \brief New level of a CC1175 GPIO on port 1: sets P1IFG on the edge selected by P1IES.
+ */
+static void spi_mock_SetPin(bool *pin, uint8_t bit, bool level)
+{
+    if (level == *pin)
+    {
+        return;
+    }
+
+    *pin = level;
+    if (((spi_mock.p1ies & bit) != 0) != level)
+    {
+        spi_mock.p1ifg |= bit;
+    }
+}
+
+static void spi_mock_SetGDO2(bool level)
+{
+    spi_mock_SetPin(&spi_mock.gdo2, CHIP_GDO2_PIN, level);
+}
+
+/**
+ * \fn spi_mock_UpdateGDO0
+ *
+ * \brief GPIO0 after a change of the TX FIFO or of IOCFG0/FIFO_CFG.
+ *
+ * TXFIFO_THR: asserted with 127 - FIFO_THR bytes or more in the TX FIFO.
+ */
+static void spi_mock_UpdateGDO0()
+{
+    uint8_t cfg = spi_mock.regs[CHIP_IOCFG0];
+
+    if ((cfg & 0x3F) != CHIP_TXFIFO_THR)
+    {
+        return;
+    }
+
+    spi_mock_SetPin(&spi_mock.gdo0, CHIP_GDO0_PIN,
+                    (spi_mock.tx_fifo_len >= 127 - (spi_mock.regs[CHIP_FIFO_CFG] & 0x7F)) != ((cfg & 0x40) != 0));
+}
+
+/**
+ * \fn spi_mock_TxByte
+ *
+ * \brief Start of the next byte of the packet, from the TX FIFO (underflow if empty).
+ */
+static void spi_mock_TxByte()
+{
+    uint8_t byte;
+
+    if (spi_mock.tx_fifo_len == 0)
+    {
+        // GPIO2 also de-asserts on an underflow
+        spi_mock_SetGDO2(false);
+        spi_mock.tx_phase = 0;
+        spi_mock.state = 7;         // TX_FIFO_ERROR
+        spi_mock.tx_underflows++;
+        return;
+    }
+
+    byte = spi_mock.tx_fifo[0];
+    memmove(spi_mock.tx_fifo, spi_mock.tx_fifo + 1, --spi_mock.tx_fifo_len);
+    spi_mock_UpdateGDO0();
+
+    if (spi_mock.tx_count == 0)
+    {
+        spi_mock.tx_first = byte;
+    }
+    spi_mock.tx_count++;
+
+    if (spi_mock.tx_capture && (spi_mock.tx_capture_len < spi_mock.tx_capture_size))
+    {
+        spi_mock.tx_capture[spi_mock.tx_capture_len++] = byte;
+    }
+
+    spi_mock.tx_edge += spi_mock_RadioTime(1);
+}
+
+/**
+ * \fn spi_mock_ResetRegs
+ *
+ * \brief Configuration registers of the radio to their reset values, the others to 0.
+ */
+static void spi_mock_ResetRegs()
+{
+    memset(spi_mock.regs, 0, sizeof(spi_mock.regs));
+    memset(spi_mock.ext, 0, sizeof(spi_mock.ext));
+    memcpy(spi_mock.regs, cc11xx_reset_values, CC11XX_CONFIG_REGS);
+    memcpy(spi_mock.ext, cc11xx_ext_reset_values, CC11XX_CONFIG_EXT_REGS);
+}
+
+/**
+ * \fn spi_mock_TxLast
+ *
+ * \brief Checks if the byte just sent ends the packet (PKT_CFG0.LENGTH_CONFIG).
+ *
+ * The byte counter of the fixed length mode counts modulo 256 (PKT_LEN = 0: 256 bytes).
+ */
+static bool spi_mock_TxLast()
+{
+    switch((spi_mock.regs[CHIP_PKT_CFG0] >> 5) & 0x03)
+    {
+        case 0:
+            return (spi_mock.tx_count & 0xFF) == spi_mock.regs[CHIP_PKT_LEN];
+        case 1:
+            return spi_mock.tx_count == (uint32_t)spi_mock.tx_first + 1;
+        default:
+            return false;
+    }
+}
+
+/**
+ * \fn spi_mock_TxEdge
+ *
+ * \brief End of a phase or of a byte of the transmission (TXOFF_MODE = IDLE).
+ */
+static void spi_mock_TxEdge()
+{
+    switch(spi_mock.tx_phase)
+    {
+        case 1:
+            // Sync word sent: GPIO2 asserts, the packet follows
+            spi_mock_SetGDO2(true);
+            spi_mock.tx_phase = 2;
+            spi_mock.tx_count = 0;
+            spi_mock_TxByte();
+            break;
+        case 2:
+            if (spi_mock_TxLast())
+            {
+                spi_mock.tx_phase = 3;
+                spi_mock.tx_edge += spi_mock_RadioTime(SPI_MOCK_RADIO_CRC);
+            }
+            else
+            {
+                spi_mock_TxByte();
+            }
+            break;
+        default:
+            spi_mock_SetGDO2(false);
+            spi_mock.tx_phase = 0;
+            spi_mock.state = 0;
+            spi_mock.tx_packets++;
+            break;
+    }
+}
+
+/**
+ * \fn spi_mock_Strobe
+ *
+ * \brief Command strobe received by the radio.
+ */
+static void spi_mock_Strobe(uint8_t cmd)
+{
+    if (spi_mock.n_strobes < sizeof(spi_mock.strobes))
+    {
+        spi_mock.strobes[spi_mock.n_strobes++] = cmd;
+    }
+
+    switch(cmd)
+    {
+        case 0x30:  // SRES
+            spi_mock_ResetRegs();
+            spi_mock.tx_fifo_len = 0;
+            spi_mock.rx_fifo_len = spi_mock.rx_fifo_pos = 0;
+            spi_mock.state = 0;
+            spi_mock.tx_phase = 0;
+            spi_mock_SetGDO2(false);
+            break;
+        case 0x34:  // SRX
+            spi_mock.state = 1;
+            break;
+        case 0x35:  // STX
+            if (spi_mock.state == 0)
+            {
+                spi_mock.tx_phase = 1;
+                spi_mock.tx_edge = spi_mock.now + spi_mock_RadioTime(SPI_MOCK_RADIO_HEADER);
+            }
+            spi_mock.state = 2;
+            break;
+        case 0x36:  // SIDLE
+            spi_mock.state = 0;
+            spi_mock.tx_phase = 0;
+            spi_mock_SetGDO2(false);
+            break;
+        case 0x3A:  // SFRX
+            spi_mock.rx_fifo_len = spi_mock.rx_fifo_pos = 0;
+            break;
+        case 0x3B:  // SFTX
+            spi_mock.tx_fifo_len = 0;
+            spi_mock_UpdateGDO0();
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * \fn spi_mock_Radio
+ *
+ * \brief One byte exchanged with the radio (CC112X/CC1175 User's Guide, section 3.2).
+ *
+ * \param mosi is the byte sent by the MCU.
+ *
+ * \return The byte sent back.
+ */
+static uint8_t spi_mock_Radio(uint8_t mosi)
+{
+    uint8_t status = (uint8_t)(spi_mock.state << 4);
+    uint16_t n = spi_mock.spi_byte++;
+    bool read = (spi_mock.header & 0x80) != 0;
+    bool burst = (spi_mock.header & 0x40) != 0;
+    uint8_t miso = 0;
+
+    if (spi_mock.csn)
+    {
+        return 0xFF;
+    }
+
+    if (n == 0)
+    {
+        spi_mock.header = mosi;
+        spi_mock.addr = mosi & 0x3F;
+        spi_mock.ext_access = spi_mock.addr == CHIP_EXT;
+        if ((spi_mock.addr >= CHIP_STROBE_FIRST) && (spi_mock.addr <= CHIP_STROBE_LAST))
+        {
+            spi_mock_Strobe(spi_mock.addr);
+        }
+        return status;
+    }
+
+    if (spi_mock.ext_access && (n == 1))
+    {
+        spi_mock.addr = mosi;
+        return status;
+    }
+
+    // Single access: one data byte
+    if (!burst && (n > (spi_mock.ext_access ? 2 : 1)))
+    {
+        return 0;
+    }
+
+    if (!spi_mock.ext_access && (spi_mock.addr == CHIP_FIFO))
+    {
+        if (read)
+        {
+            if (spi_mock.rx_fifo_pos < spi_mock.rx_fifo_len)
+            {
+                miso = spi_mock.rx_fifo[spi_mock.rx_fifo_pos++];
+            }
+        }
+        else if (spi_mock.tx_fifo_len < sizeof(spi_mock.tx_fifo))
+        {
+            spi_mock.tx_fifo[spi_mock.tx_fifo_len++] = mosi;
+            spi_mock_UpdateGDO0();
+        }
+        else
+        {
+            spi_mock.tx_overflows++;
+        }
+        return miso;
+    }
+
+    if (spi_mock.ext_access)
+    {
+        if (read)
+        {
+            miso = spi_mock.ext[spi_mock.addr];
+        }
+        else
+        {
+            spi_mock.ext[spi_mock.addr] = mosi;
+        }
+    }
+    else if (spi_mock.addr < sizeof(spi_mock.regs))
+    {
+        if (read)
+        {
+            miso = spi_mock.regs[spi_mock.addr];
+        }
+        else
+        {
+            spi_mock.regs[spi_mock.addr] = mosi;
+            spi_mock_UpdateGDO0();
+        }
+    }
+
+    if (burst)
+    {
+        spi_mock.addr++;
+    }
+
+    return miso;
+}
+
+static uint8_t spi_mock_Load(uintptr_t addr)
+{
+    if (addr == (uintptr_t)&spi_mock.rxbuf)
+    {
+        spi_mock.rxifg = false;
+        return spi_mock.rxbuf;
+    }
+    return *(uint8_t *)addr;
+}
+
+static void spi_mock_Store(uintptr_t addr, uint8_t data)
+{
+    if (addr == (uintptr_t)&spi_mock.txbuf)
+    {
+        spi_mock_WriteTXBUF(data);
+    }
+    else
+    {
+        *(uint8_t *)addr = data;
+    }
+}
+
+/**
+ * \fn spi_mock_Trigger
+ *
+ * \brief Rising edge of a DMA trigger: one transfer of each channel waiting on it.
+ */
+static void spi_mock_Trigger(uint8_t trigger)
+{
+    int i;
+
+    for(i=0; i<SPI_MOCK_DMA_CHANNELS; i++)
+    {
+        SPIMockDMA *ch = &spi_mock.dma[i];
+
+        if (!ch->enabled || (ch->trigger != trigger))
+        {
+            continue;
+        }
+
+        spi_mock_Store(ch->dst, spi_mock_Load(ch->src));
+        spi_mock.dma_moves++;
+
+        if (ch->src_dir == DMA_DIRECTION_INCREMENT)
+        {
+            ch->src++;
+        }
+        if (ch->dst_dir == DMA_DIRECTION_INCREMENT)
+        {
+            ch->dst++;
+        }
+
+        if (--ch->left == 0)
+        {
+            ch->enabled = false;
+            ch->ifg = true;
+        }
+    }
+}
+
+static void spi_mock_StartShift(uint8_t data)
+{
+    spi_mock.shift = data;
+    spi_mock.shifting = true;
+    spi_mock.shift_end = spi_mock.now + spi_mock.byte_ns;
+    spi_mock.txifg = true;
+    spi_mock_Trigger(SPI_MOCK_TRIGGER_TX);
+}
+
+static void spi_mock_WriteTXBUF(uint8_t data)
+{
+    spi_mock.txifg = false;
+
+    if (!spi_mock.shifting)
+    {
+        spi_mock_StartShift(data);
+        return;
+    }
+
+    if (spi_mock.txbuf_full)
+    {
+        spi_mock.tx_collisions++;
+    }
+    spi_mock.txbuf = data;
+    spi_mock.txbuf_full = true;
+}
+
+/**
+ * \fn spi_mock_ShiftEnd
+ *
+ * \brief End of the byte being shifted.
+ */
+static void spi_mock_ShiftEnd()
+{
+    spi_mock.shifting = false;
+    spi_mock.bytes++;
+
+    if (spi_mock.rxifg)
+    {
+        spi_mock.overruns++;
+    }
+    spi_mock.rxbuf = spi_mock_Radio(spi_mock.shift);
+    spi_mock.rxifg = true;
+    spi_mock_Trigger(SPI_MOCK_TRIGGER_RX);
+
+    if (spi_mock.txbuf_full)
+    {
+        spi_mock.txbuf_full = false;
+        spi_mock_StartShift(spi_mock.txbuf);
+    }
+}
+
+/**
+ * \fn spi_mock_Step
+ *
+ * \brief Runs to the next peripheral event (end of a SPI byte, RTC second, Timer_A1 compare, transmission phase), if not after limit.
+ *
+ * \return false if there is no event up to limit.
+ */
+static bool spi_mock_Step(uint64_t limit)
+{
+    uint64_t t = UINT64_MAX;
+    int source = 0;
+
+    if (spi_mock.shifting)
+    {
+        t = spi_mock.shift_end;
+        source = 1;
+    }
+    if (spi_mock.rtc_on && (spi_mock.rtc_next < t))
+    {
+        t = spi_mock.rtc_next;
+        source = 2;
+    }
+    if ((spi_mock.tx_phase != 0) && (spi_mock.tx_edge < t))
+    {
+        t = spi_mock.tx_edge;
+        source = 3;
+    }
+    if (spi_mock.ta_on && (spi_mock.ta_next < t))
+    {
+        t = spi_mock.ta_next;
+        source = 4;
+    }
+
+    if ((source == 0) || (t > limit))
+    {
+        return false;
+    }
+
+    if (spi_mock.now < t)
+    {
+        spi_mock.now = t;
+    }
+
+    switch(source)
+    {
+        case 1:
+            spi_mock_ShiftEnd();
+            break;
+        case 2:
+            spi_mock.rtc_ifg = true;
+            spi_mock.rtc_next += SPI_MOCK_SECOND;
+            break;
+        case 4:
+            spi_mock.ta_ifg = true;
+            spi_mock.ta_next += spi_mock.ta_period;
+            break;
+        default:
+            spi_mock_TxEdge();
+            break;
+    }
+
+    return true;
+}
+
+/**
+ * \fn spi_mock_Dispatch
+ *
+ * \brief Runs the interrupt routines of the pending, enabled flags (if GIE).
+ */
+static void spi_mock_Dispatch()
+{
+    while((spi_mock.sr & GIE) && !spi_mock.in_isr)
+    {
+        uint16_t saved = spi_mock.sr;
+        bool dma = false;
+        bool usci = spi_mock.rxie && spi_mock.rxifg;
+        bool port1 = (spi_mock.p1ie & spi_mock.p1ifg) && spi_mock.port1_isr;
+        bool ta = spi_mock.ta_ie && spi_mock.ta_ifg && spi_mock.ta_isr;
+        bool rtc = spi_mock.rtc_ie && spi_mock.rtc_ifg && spi_mock.rtc_isr;
+        int i;
+
+        for(i=0; i<SPI_MOCK_DMA_CHANNELS; i++)
+        {
+            dma |= spi_mock.dma[i].ie && spi_mock.dma[i].ifg;
+        }
+
+        if (!dma && !usci && !port1 && !ta && !rtc)
+        {
+            return;
+        }
+
+        // Entry: SR saved, GIE and LPM bits cleared
+        spi_mock.in_isr = true;
+        spi_mock.exit_clear = 0;
+        spi_mock.sr = 0;
+
+        spi_mock.now += (uint64_t)SPI_MOCK_ISR_CYCLES*1000000000ULL/SPI_MOCK_MCLK;
+        spi_mock.isr_ns += (uint64_t)SPI_MOCK_ISR_CYCLES*1000000000ULL/SPI_MOCK_MCLK;
+
+        // DMA has the higher priority on the MSP430F6659
+        if (dma)
+        {
+            spi_mock.dma_isr++;
+            cc11xx_SPI_DMA_ISR();
+        }
+        else if (usci)
+        {
+            spi_mock.usci_isr++;
+            cc11xx_SPI_USCI_ISR();
+        }
+        else if (port1)
+        {
+            spi_mock.port1_irqs++;
+            spi_mock.port1_isr();
+        }
+        else if (ta)
+        {
+            // CCR0 CCIFG is cleared when its interrupt is taken
+            spi_mock.ta_ifg = false;
+            spi_mock.ta_irqs++;
+            spi_mock.ta_isr();
+        }
+        else
+        {
+            spi_mock.rtc_irqs++;
+            spi_mock.rtc_isr();
+        }
+
+        spi_mock.sr = saved & ~spi_mock.exit_clear;
+        spi_mock.in_isr = false;
+    }
+}
+
+void spi_mock_Reset(uint32_t spi_clock)
+{
+    memset(&spi_mock, 0, sizeof(spi_mock));
+    spi_mock_ResetRegs();
+    spi_mock.byte_ns = (uint32_t)(8000000000ULL/spi_clock);
+    spi_mock.csn = true;
+    spi_mock.txifg = true;
+}
+
+void spi_mock_Run(uint64_t ns)
+{
+    uint64_t end = spi_mock.now + ns;
+
+    while(spi_mock_Step(end))
+    {
+        spi_mock_Dispatch();
+    }
+    if (spi_mock.now < end)
+    {
+        spi_mock.now = end;
+    }
+}
+
+uint16_t spi_mock_GetSR()
+{
+    return spi_mock.sr;
+}
+
+void spi_mock_SetSR(uint16_t sr)
+{
+    spi_mock.sr = sr;
+    spi_mock_Dispatch();
+}
+
+void spi_mock_BisSR(uint16_t bits)
+{
+    bool slept = false;
+
+    spi_mock.sr |= bits;
+    spi_mock_Dispatch();
+
+    while(spi_mock.sr & CPUOFF)
+    {
+        uint64_t start = spi_mock.now, isr = spi_mock.isr_ns, t;
+        bool lpm3 = (spi_mock.sr & SCG1) != 0;
+
+        if (lpm3 && spi_mock.shifting)
+        {
+            fprintf(stderr, "ERROR, LPM3 (SMCLK off) with a byte on the bus\n");
+            exit(2);
+        }
+
+        if (!spi_mock_Step(UINT64_MAX))
+        {
+            fprintf(stderr, "ERROR, the CPU sleeps with nothing to wake it up (deadlock)\n");
+            exit(2);
+        }
+        spi_mock_Dispatch();
+
+        t = (spi_mock.now - start) - (spi_mock.isr_ns - isr);
+        spi_mock.sleep_ns += t;
+        if (lpm3)
+        {
+            spi_mock.lpm3_ns += t;
+        }
+        slept = true;
+    }
+
+    if (slept)
+    {
+        spi_mock.wakeups++;
+    }
+}
+
+void spi_mock_BicSR(uint16_t bits)
+{
+    spi_mock.sr &= ~bits;
+}
+
+void spi_mock_BicSROnExit(uint16_t bits)
+{
+    spi_mock.exit_clear |= bits;
+}
+
+uint16_t spi_mock_ReadSYSRSTIV()
+{
+    uint16_t cause = spi_mock.sysrstiv;
+
+    spi_mock.sysrstiv = SYSRSTIV_NONE;
+
+    return cause;
+}
+
+void GPIO_setAsPeripheralModuleFunctionInputPin(uint8_t port, uint16_t pins)
+{
+    (void)port;
+    (void)pins;
+}
+
+void GPIO_setAsOutputPin(uint8_t port, uint16_t pins)
+{
+    (void)port;
+    (void)pins;
+}
+
+void GPIO_setOutputHighOnPin(uint8_t port, uint16_t pins)
+{
+    if ((port == GPIO_PORT_P2) && (pins & GPIO_PIN0) && !spi_mock.csn)
+    {
+        spi_mock.csn = true;
+        spi_mock.accesses++;
+        spi_mock.csn_low_ns += spi_mock.now - spi_mock.csn_fall;
+        if (spi_mock.shifting)
+        {
+            fprintf(stderr, "ERROR, CSn high in the middle of a byte\n");
+            exit(2);
+        }
+    }
+}
+
+void GPIO_setOutputLowOnPin(uint8_t port, uint16_t pins)
+{
+    if ((port == GPIO_PORT_P2) && (pins & GPIO_PIN0) && spi_mock.csn)
+    {
+        spi_mock.csn = false;
+        spi_mock.spi_byte = 0;
+        spi_mock.csn_fall = spi_mock.now;
+    }
+}
+
+uint8_t GPIO_getInputPinValue(uint8_t port, uint16_t pins)
+{
+    if ((port == GPIO_PORT_P2) && (pins & GPIO_PIN2))
+    {
+        return spi_mock.miso_busy ? GPIO_INPUT_PIN_HIGH : GPIO_INPUT_PIN_LOW;
+    }
+    if ((port == GPIO_PORT_P1) && (pins & CHIP_GDO0_PIN))
+    {
+        return spi_mock.gdo0 ? GPIO_INPUT_PIN_HIGH : GPIO_INPUT_PIN_LOW;
+    }
+    if ((port == GPIO_PORT_P1) && (pins & CHIP_GDO2_PIN))
+    {
+        return spi_mock.gdo2 ? GPIO_INPUT_PIN_HIGH : GPIO_INPUT_PIN_LOW;
+    }
+    return GPIO_INPUT_PIN_LOW;
+}
+
+void GPIO_setAsInputPin(uint8_t port, uint16_t pins)
+{
+    (void)port;
+    (void)pins;
+}
+
+void GPIO_selectInterruptEdge(uint8_t port, uint16_t pins, uint8_t edgeSelect)
+{
+    if (port == GPIO_PORT_P1)
+    {
+        if (edgeSelect == GPIO_HIGH_TO_LOW_TRANSITION)
+        {
+            spi_mock.p1ies |= (uint8_t)pins;
+        }
+        else
+        {
+            spi_mock.p1ies &= (uint8_t)~pins;
+        }
+    }
+}
+
+void GPIO_enableInterrupt(uint8_t port, uint16_t pins)
+{
+    if (port == GPIO_PORT_P1)
+    {
+        spi_mock.p1ie |= (uint8_t)pins;
+    }
+}
+
+void GPIO_disableInterrupt(uint8_t port, uint16_t pins)
+{
+    if (port == GPIO_PORT_P1)
+    {
+        spi_mock.p1ie &= (uint8_t)~pins;
+    }
+}
+
+void GPIO_clearInterrupt(uint8_t port, uint16_t pins)
+{
+    if (port == GPIO_PORT_P1)
+    {
+        spi_mock.p1ifg &= (uint8_t)~pins;
+    }
+}
+
+uint16_t GPIO_getInterruptStatus(uint8_t port, uint16_t pins)
+{
+    return (port == GPIO_PORT_P1) ? (spi_mock.p1ifg & pins) : 0;
+}
+
+uint32_t UCS_getSMCLK()
+{
+    return 4000000;
+}
+
+bool UCS_turnOnLFXT1WithTimeout(uint16_t xt1drive, uint8_t xcap, uint16_t timeout)
+{
+    (void)xt1drive;
+    (void)xcap;
+    (void)timeout;
+
+    return STATUS_SUCCESS;
+}
+
+uint16_t BattBak_unlockBackupSubSystem(uint16_t base)
+{
+    (void)base;
+
+    return BATTBAK_UNLOCKSUCCESS;
+}
+
+void RTC_B_initCalendar(uint16_t base, Calendar *time, uint16_t format)
+{
+    (void)base;
+    (void)time;
+    (void)format;
+}
+
+void RTC_B_startClock(uint16_t base)
+{
+    (void)base;
+
+    spi_mock.rtc_on = true;
+    spi_mock.rtc_next = spi_mock.now + SPI_MOCK_SECOND;
+}
+
+void RTC_B_enableInterrupt(uint16_t base, uint8_t mask)
+{
+    (void)base;
+
+    if (mask & RTC_B_CLOCK_READ_READY_INTERRUPT)
+    {
+        spi_mock.rtc_ie = true;
+    }
+}
+
+uint8_t RTC_B_getInterruptStatus(uint16_t base, uint8_t mask)
+{
+    (void)base;
+
+    return (mask & RTC_B_CLOCK_READ_READY_INTERRUPT) && spi_mock.rtc_ifg ? RTC_B_CLOCK_READ_READY_INTERRUPT : 0;
+}
+
+void RTC_B_clearInterrupt(uint16_t base, uint8_t mask)
+{
+    (void)base;
+
+    if (mask & RTC_B_CLOCK_READ_READY_INTERRUPT)
+    {
+        spi_mock.rtc_ifg = false;
+    }
+}
+
+void Timer_A_initUpMode(uint16_t baseAddress, Timer_A_initUpModeParam *param)
+{
+    (void)baseAddress;
+
+    spi_mock.ta_ie = (param->captureCompareInterruptEnable_CCR0_CCIE == TIMER_A_CCIE_CCR0_INTERRUPT_ENABLE);
+    spi_mock.ta_ifg = false;
+    spi_mock.ta_period = ((uint64_t)param->timerPeriod + 1)*SPI_MOCK_SECOND/SPI_MOCK_ACLK;
+
+    // TACLR: TAR counts from 0, CCIFG when it reaches TA1CCR0, then every TA1CCR0 + 1
+    spi_mock.ta_next = spi_mock.now + (uint64_t)param->timerPeriod*SPI_MOCK_SECOND/SPI_MOCK_ACLK;
+    spi_mock.ta_on = param->startTimer;
+}
+
+void Timer_A_stop(uint16_t baseAddress)
+{
+    (void)baseAddress;
+
+    spi_mock.ta_on = false;
+}
+
+bool USCI_B_SPI_initMaster(uint16_t base, USCI_B_SPI_initMasterParam *param)
+{
+    (void)base;
+
+    spi_mock.byte_ns = (uint32_t)(8000000000ULL/param->desiredSpiClock);
+    return STATUS_SUCCESS;
+}
+
+void USCI_B_SPI_enable(uint16_t base)
+{
+    (void)base;
+}
+
+void USCI_B_SPI_transmitData(uint16_t base, uint8_t data)
+{
+    (void)base;
+
+    spi_mock_WriteTXBUF(data);
+}
+
+uint8_t USCI_B_SPI_receiveData(uint16_t base)
+{
+    (void)base;
+
+    spi_mock.rxifg = false;
+    return spi_mock.rxbuf;
+}
+
+void USCI_B_SPI_enableInterrupt(uint16_t base, uint8_t mask)
+{
+    (void)base;
+
+    if (mask & USCI_B_SPI_RECEIVE_INTERRUPT)
+    {
+        spi_mock.rxie = true;
+    }
+}
+
+void USCI_B_SPI_disableInterrupt(uint16_t base, uint8_t mask)
+{
+    (void)base;
+
+    if (mask & USCI_B_SPI_RECEIVE_INTERRUPT)
+    {
+        spi_mock.rxie = false;
+    }
+}
+
+uint8_t USCI_B_SPI_getInterruptStatus(uint16_t base, uint8_t mask)
+{
+    (void)base;
+
+    return ((mask & USCI_B_SPI_RECEIVE_INTERRUPT) && spi_mock.rxifg ? USCI_B_SPI_RECEIVE_INTERRUPT : 0) |
+           ((mask & USCI_B_SPI_TRANSMIT_INTERRUPT) && spi_mock.txifg ? USCI_B_SPI_TRANSMIT_INTERRUPT : 0);
+}
+
+void USCI_B_SPI_clearInterrupt(uint16_t base, uint8_t mask)
+{
+    (void)base;
+
+    if (mask & USCI_B_SPI_RECEIVE_INTERRUPT)
+    {
+        spi_mock.rxifg = false;
+    }
+    if (mask & USCI_B_SPI_TRANSMIT_INTERRUPT)
+    {
+        spi_mock.txifg = false;
+    }
+}
+
+uintptr_t USCI_B_SPI_getReceiveBufferAddressForDMA(uint16_t base)
+{
+    (void)base;
+
+    return (uintptr_t)&spi_mock.rxbuf;
+}
+
+uintptr_t USCI_B_SPI_getTransmitBufferAddressForDMA(uint16_t base)
+{
+    (void)base;
+
+    return (uintptr_t)&spi_mock.txbuf;
+}
+
+void DMA_init(DMA_initParam *param)
+{
+    SPIMockDMA *ch = &spi_mock.dma[param->channelSelect >> 4];
+
+    ch->trigger = param->triggerSourceSelect;
+    ch->size = param->transferSize;
+    ch->enabled = false;
+}
+
+void DMA_setSrcAddress(uint8_t channel, uintptr_t addr, uint16_t dir)
+{
+    spi_mock.dma[channel >> 4].src = addr;
+    spi_mock.dma[channel >> 4].src_dir = dir;
+}
+
+void DMA_setDstAddress(uint8_t channel, uintptr_t addr, uint16_t dir)
+{
+    spi_mock.dma[channel >> 4].dst = addr;
+    spi_mock.dma[channel >> 4].dst_dir = dir;
+}
+
+void DMA_setTransferSize(uint8_t channel, uint16_t size)
+{
+    spi_mock.dma[channel >> 4].size = size;
+}
+
+void DMA_enableTransfers(uint8_t channel)
+{
+    SPIMockDMA *ch = &spi_mock.dma[channel >> 4];
+
+    ch->enabled = ch->size != 0;
+    ch->left = ch->size;
+}
+
+void DMA_disableTransfers(uint8_t channel)
+{
+    spi_mock.dma[channel >> 4].enabled = false;
+}
+
+void DMA_enableInterrupt(uint8_t channel)
+{
+    spi_mock.dma[channel >> 4].ie = true;
+}
+
+void DMA_disableInterrupt(uint8_t channel)
+{
+    spi_mock.dma[channel >> 4].ie = false;
+}
+
+uint16_t DMA_getInterruptStatus(uint8_t channel)
+{
+    return spi_mock.dma[channel >> 4].ifg ? DMA_INT_ACTIVE : DMA_INT_INACTIVE;
+}
+
+void DMA_clearInterrupt(uint8_t channel)
+{
+    spi_mock.dma[channel >> 4].ifg = false;
+}
+
+//! \} End of spi_mock implementation group
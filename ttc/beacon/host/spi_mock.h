@@ -0,0 +1,402 @@
+/*
+ * spi_mock.h
+ *
+ * Copyright (C) 2016, Universidade Federal de Santa Catarina
+ *
+ * This file is part of FloripaSat-TTC.
+ *
+ * FloripaSat-TTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FloripaSat-TTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FloripaSat-TTC.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file spi_mock.h
+ *
+ * \brief Host (Linux) mock of the MCU peripherals used by the cc11xx SPI engine and the beacon main loop.
+ *
+ * Replaces driverlib.h when the beacon sources are built with -DCC11XX_HOST:
+ * the USCI_B0 (TXBUF, shift register, RXBUF, UCRXIFG/UCTXIFG, UCRXIE), the
+ * DMA channels (triggers, addresses, sizes, DMAIFG/DMAIE), the CSn and MISO
+ * pins, the status register (GIE, LPM bits), the RTC_B read ready interrupt,
+ * the CCR0 compare of Timer_A1 (up mode on ACLK), the port 1 interrupt of the CC1175 GPIO2 and, on the other end of the
+ * bus, the SPI interface of a CC1175 (register spaces, FIFOs, strobes) with
+ * the timing of a transmission: the TX FIFO is sent one byte at a time in
+ * the packet length mode of PKT_CFG0 (fixed, variable or infinite), GPIO0
+ * follows the TX FIFO threshold (IOCFG0 = TXFIFO_THR) and GPIO2 the packet
+ * (PKT_SYNC_RXTX).
+ *
+ * Time only runs while the CPU sleeps (__bis_SR_register() with the LPM
+ * bits) or in spi_mock_Run() (and __delay_cycles()): the bytes shift at
+ * SPICLK, the flags trigger the DMA channels and, with GIE set, the
+ * interrupt routines, which act SPI_MOCK_ISR_CYCLES after the flag. Sleeping
+ * in LPM3 (SMCLK off) with a byte on the bus is an error.
+ *
+ * \version 1.0-dev
+ *
+ * \date 17/10/2026
+ *
+ * \defgroup spi_mock SPI mock
+ * \ingroup cc11xx_spi
+ * \{
+ */
+
+#ifndef SPI_MOCK_H_
+#define SPI_MOCK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define STATUS_SUCCESS          0x01
+#define STATUS_FAIL             0x00
+
+// GPIO
+#define GPIO_PORT_P1            1
+#define GPIO_PORT_P2            2
+#define GPIO_PIN0               (0x0001)
+#define GPIO_PIN1               (0x0002)
+#define GPIO_PIN2               (0x0004)
+#define GPIO_PIN3               (0x0008)
+#define GPIO_PIN4               (0x0010)
+#define GPIO_PIN5               (0x0020)
+#define GPIO_PIN6               (0x0040)
+#define GPIO_PIN7               (0x0080)
+#define GPIO_INPUT_PIN_HIGH     (0x01)
+#define GPIO_INPUT_PIN_LOW      (0x00)
+#define GPIO_HIGH_TO_LOW_TRANSITION (0x01)
+#define GPIO_LOW_TO_HIGH_TRANSITION (0x00)
+
+// RTC_B, XT1 and backup subsystem
+#define RTC_B_BASE                          0x04A0
+#define RTC_B_CLOCK_READ_READY_INTERRUPT    0x10
+#define RTC_B_FORMAT_BINARY                 0x00
+#define BAK_BATT_BASE                       0x04C0
+#define BATTBAK_UNLOCKSUCCESS               0x00
+#define UCS_XT1_DRIVE_0                     0x0000
+#define UCS_XCAP_3                          0x000C
+
+// Timer_A1 (up mode, CCR0 compare)
+#define TIMER_A1_BASE                       0x0380
+#define TIMER_A_CLOCKSOURCE_ACLK            0x0100
+#define TIMER_A_CLOCKSOURCE_DIVIDER_1       0x00
+#define TIMER_A_TAIE_INTERRUPT_DISABLE      0x00
+#define TIMER_A_CCIE_CCR0_INTERRUPT_ENABLE  0x0010
+#define TIMER_A_DO_CLEAR                    0x0004
+
+typedef struct Timer_A_initUpModeParam
+{
+    uint16_t clockSource;
+    uint16_t clockSourceDivider;
+    uint16_t timerPeriod;
+    uint16_t timerInterruptEnable_TAIE;
+    uint16_t captureCompareInterruptEnable_CCR0_CCIE;
+    uint16_t timerClear;
+    bool startTimer;
+} Timer_A_initUpModeParam;
+
+typedef struct Calendar
+{
+    uint8_t Seconds;
+    uint8_t Minutes;
+    uint8_t Hours;
+    uint8_t DayOfWeek;
+    uint8_t DayOfMonth;
+    uint8_t Month;
+    uint16_t Year;
+} Calendar;
+
+// Reset causes
+#define SYSRSTIV                    spi_mock_ReadSYSRSTIV()
+#define SYSRSTIV_NONE               (0x0000)
+#define SYSRSTIV_BOR                (0x0002)
+#define SYSRSTIV_RSTNMI             (0x0004)
+#define SYSRSTIV_SVSL               (0x000C)
+#define SYSRSTIV_SVSH               (0x000E)
+#define SYSRSTIV_WDTTO              (0x0016)
+#define SYSRSTIV_WDTKEY             (0x0018)
+
+// USCI_B SPI
+#define USCI_B0_BASE                                            0x05E0
+#define USCI_B_SPI_RECEIVE_INTERRUPT                            0x01
+#define USCI_B_SPI_TRANSMIT_INTERRUPT                           0x02
+#define USCI_B_SPI_CLOCKSOURCE_SMCLK                            0x80
+#define USCI_B_SPI_MSB_FIRST                                    0x20
+#define USCI_B_SPI_PHASE_DATA_CHANGED_ONFIRST_CAPTURED_ON_NEXT  0x00
+#define USCI_B_SPI_CLOCKPOLARITY_INACTIVITY_HIGH                0x40
+
+typedef struct USCI_B_SPI_initMasterParam
+{
+    uint8_t selectClockSource;
+    uint32_t clockSourceFrequency;
+    uint32_t desiredSpiClock;
+    uint8_t msbFirst;
+    uint8_t clockPhase;
+    uint8_t clockPolarity;
+} USCI_B_SPI_initMasterParam;
+
+// DMA
+#define DMA_CHANNEL_0               (0x00)
+#define DMA_CHANNEL_1               (0x10)
+#define DMA_TRIGGERSOURCE_18        (18)
+#define DMA_TRIGGERSOURCE_19        (19)
+#define DMA_TRANSFER_SINGLE         (0x0000)
+#define DMA_SIZE_SRCBYTE_DSTBYTE    (0x00C0)
+#define DMA_TRIGGER_RISINGEDGE      (0x00)
+#define DMA_DIRECTION_UNCHANGED     (0x0000)
+#define DMA_DIRECTION_INCREMENT     (0x0300)
+#define DMA_INT_INACTIVE            (0x0)
+#define DMA_INT_ACTIVE              (0x0008)
+
+#define SPI_MOCK_DMA_CHANNELS       8
+#define SPI_MOCK_MCLK               4000000     /**< F_CPU of the beacon */
+#define SPI_MOCK_ACLK               32768       /**< XT1 */
+#define SPI_MOCK_ISR_CYCLES         50          /**< Interrupt entry, body and RETI, before the routine acts */
+#define SPI_MOCK_RADIO_BPS          1200        /**< Symbol rate of the CC1175 (2-GFSK: 1 bit per symbol) */
+#define SPI_MOCK_RADIO_HEADER       8           /**< Preamble and sync word bytes, before GPIO2 (PKT_SYNC_RXTX) asserts */
+#define SPI_MOCK_RADIO_CRC          2           /**< CRC bytes after the packet */
+
+typedef struct DMA_initParam
+{
+    uint8_t channelSelect;
+    uint16_t transferModeSelect;
+    uint16_t transferSize;
+    uint8_t triggerSourceSelect;
+    uint8_t transferUnitSelect;
+    uint8_t triggerTypeSelect;
+} DMA_initParam;
+
+// Status register
+#define GIE                         (0x0008)
+#define CPUOFF                      (0x0010)
+#define SCG0                        (0x0040)
+#define SCG1                        (0x0080)
+#define LPM0_bits                   (CPUOFF)
+#define LPM3_bits                   (SCG1 + SCG0 + CPUOFF)
+
+// Interrupt routines: plain functions called by the mock
+#define __interrupt
+
+#define __get_interrupt_state()         spi_mock_GetSR()
+#define __set_interrupt_state(x)        spi_mock_SetSR(x)
+#define __disable_interrupt()           spi_mock_BicSR(GIE)
+#define __enable_interrupt()            spi_mock_BisSR(GIE)
+#define __bis_SR_register(x)            spi_mock_BisSR(x)
+#define __bic_SR_register_on_exit(x)    spi_mock_BicSROnExit(x)
+#define __delay_cycles(x)               spi_mock_Run((uint64_t)(x)*1000000000ULL/SPI_MOCK_MCLK)
+
+/**
+ * \struct SPIMockDMA
+ *
+ * \brief One DMA channel.
+ */
+typedef struct
+{
+    bool enabled;                   /**< DMAEN */
+    bool ie;                        /**< DMAIE */
+    bool ifg;                       /**< DMAIFG */
+    uint8_t trigger;
+    uintptr_t src;
+    uintptr_t dst;
+    uint16_t src_dir;
+    uint16_t dst_dir;
+    uint16_t size;                  /**< DMAxSZ */
+    uint16_t left;                  /**< Transfers to the end of the block */
+} SPIMockDMA;
+
+/**
+ * \struct SPIMock
+ *
+ * \brief State of the mock and counters.
+ */
+typedef struct
+{
+    uint64_t now;                   /**< ns */
+    uint32_t byte_ns;               /**< 8 SPI clocks */
+
+    // USCI_B0
+    uint8_t txbuf;
+    uint8_t rxbuf;
+    uint8_t shift;
+    bool txbuf_full;
+    bool shifting;
+    uint64_t shift_end;
+    bool rxifg;
+    bool txifg;
+    bool rxie;
+
+    SPIMockDMA dma[SPI_MOCK_DMA_CHANNELS];
+
+    // CPU
+    uint16_t sr;                    /**< GIE | LPM bits */
+    uint16_t exit_clear;            /**< Bits cleared from the saved SR at the end of the running ISR */
+    bool in_isr;
+    uint16_t sysrstiv;              /**< Reset cause read once from SYSRSTIV */
+
+    // RTC_B
+    bool rtc_on;
+    bool rtc_ie;                    /**< RTCRDYIE */
+    bool rtc_ifg;                   /**< RTCRDYIFG */
+    uint64_t rtc_next;              /**< Next second */
+    void (*rtc_isr)();              /**< RTC_VECTOR routine (none in spi_sim) */
+
+    // Timer_A1
+    bool ta_on;                     /**< MC = up */
+    bool ta_ie;                     /**< TA1CCR0 CCIE */
+    bool ta_ifg;                    /**< TA1CCR0 CCIFG */
+    uint64_t ta_period;             /**< TA1CCR0 + 1 ACLK periods, in ns */
+    uint64_t ta_next;               /**< Next compare */
+    void (*ta_isr)();               /**< TIMER1_A0_VECTOR routine (none in spi_sim) */
+
+    // Port 1
+    uint8_t p1ie;
+    uint8_t p1ies;
+    uint8_t p1ifg;
+    void (*port1_isr)();            /**< PORT1_VECTOR routine (none in spi_sim) */
+
+    // Pins
+    bool csn;                       /**< CSn level */
+    bool miso_busy;                 /**< MISO (CHIP_RDYn) high */
+
+    // CC1175 SPI interface
+    uint8_t regs[0x2F];             /**< 0x00..0x2E */
+    uint8_t ext[0x100];             /**< 0x2F00..0x2FFF */
+    uint8_t tx_fifo[128];
+    uint16_t tx_fifo_len;
+    uint8_t rx_fifo[128];
+    uint16_t rx_fifo_len;
+    uint16_t rx_fifo_pos;
+    uint8_t strobes[64];            /**< Last command strobes */
+    uint16_t n_strobes;
+    uint8_t state;                  /**< STATE field of the chip status byte */
+    uint16_t spi_byte;              /**< Bytes of the current CSn low */
+    uint8_t header;
+    uint8_t addr;
+    bool ext_access;
+    bool gdo0;                      /**< GPIO0 level (TXFIFO_THR if so configured, on P1.6) */
+    bool gdo2;                      /**< GPIO2 level (PKT_SYNC_RXTX, on P1.5) */
+    uint8_t tx_phase;               /**< 0: no transmission, 1: preamble and sync word, 2: packet, 3: CRC */
+    uint64_t tx_edge;               /**< End of the current byte or phase */
+    uint32_t tx_count;              /**< Bytes of the packet sent */
+    uint8_t tx_first;               /**< First byte of the packet (length in variable packet length mode) */
+    uint8_t *tx_capture;            /**< If not NULL, the bytes sent are copied here (up to tx_capture_size) */
+    uint32_t tx_capture_size;
+    uint32_t tx_capture_len;
+
+    // Counters
+    uint32_t bytes;                 /**< Bytes on the bus */
+    uint32_t accesses;              /**< CSn low -> high */
+    uint32_t usci_isr;
+    uint32_t dma_isr;
+    uint32_t dma_moves;             /**< Bytes moved by DMA */
+    uint32_t overruns;              /**< RXBUF overwritten before it was read */
+    uint32_t tx_collisions;         /**< TXBUF written while full */
+    uint64_t isr_ns;                /**< Time in interrupt routines */
+    uint64_t sleep_ns;              /**< Time in LPM */
+    uint64_t lpm3_ns;               /**< Time in LPM3 (included in sleep_ns) */
+    uint32_t wakeups;               /**< Returns from LPM to the main loop */
+    uint32_t rtc_irqs;
+    uint32_t ta_irqs;
+    uint32_t port1_irqs;
+    uint32_t tx_packets;            /**< Packets sent (end of packet without underflow) */
+    uint32_t tx_underflows;         /**< Packets ended by an empty TX FIFO */
+    uint32_t tx_overflows;          /**< Bytes written to a full TX FIFO */
+    uint64_t csn_low_ns;            /**< Time with CSn low */
+    uint64_t csn_fall;
+} SPIMock;
+
+extern SPIMock spi_mock;
+
+/**
+ * \fn spi_mock_Reset
+ *
+ * \brief Resets the peripherals, the radio (configuration registers to their reset values) and the counters.
+ *
+ * \param spi_clock is the SPI clock in Hz.
+ *
+ * \return None
+ */
+void spi_mock_Reset(uint32_t spi_clock);
+
+/**
+ * \fn spi_mock_Run
+ *
+ * \brief Lets the peripherals run for ns nanoseconds with the CPU awake (busy in the main loop).
+ *
+ * \param ns is the time to run.
+ *
+ * \return None
+ */
+void spi_mock_Run(uint64_t ns);
+
+uint16_t spi_mock_GetSR();
+void spi_mock_SetSR(uint16_t sr);
+void spi_mock_BisSR(uint16_t bits);
+void spi_mock_BicSR(uint16_t bits);
+void spi_mock_BicSROnExit(uint16_t bits);
+uint16_t spi_mock_ReadSYSRSTIV();
+
+// Mocked driverlib
+void GPIO_setAsPeripheralModuleFunctionInputPin(uint8_t port, uint16_t pins);
+void GPIO_setAsOutputPin(uint8_t port, uint16_t pins);
+void GPIO_setOutputHighOnPin(uint8_t port, uint16_t pins);
+void GPIO_setOutputLowOnPin(uint8_t port, uint16_t pins);
+uint8_t GPIO_getInputPinValue(uint8_t port, uint16_t pins);
+void GPIO_setAsInputPin(uint8_t port, uint16_t pins);
+void GPIO_selectInterruptEdge(uint8_t port, uint16_t pins, uint8_t edgeSelect);
+void GPIO_enableInterrupt(uint8_t port, uint16_t pins);
+void GPIO_disableInterrupt(uint8_t port, uint16_t pins);
+void GPIO_clearInterrupt(uint8_t port, uint16_t pins);
+uint16_t GPIO_getInterruptStatus(uint8_t port, uint16_t pins);
+uint32_t UCS_getSMCLK();
+bool UCS_turnOnLFXT1WithTimeout(uint16_t xt1drive, uint8_t xcap, uint16_t timeout);
+uint16_t BattBak_unlockBackupSubSystem(uint16_t base);
+
+void RTC_B_initCalendar(uint16_t base, Calendar *time, uint16_t format);
+void RTC_B_startClock(uint16_t base);
+void RTC_B_enableInterrupt(uint16_t base, uint8_t mask);
+uint8_t RTC_B_getInterruptStatus(uint16_t base, uint8_t mask);
+void RTC_B_clearInterrupt(uint16_t base, uint8_t mask);
+
+void Timer_A_initUpMode(uint16_t baseAddress, Timer_A_initUpModeParam *param);
+void Timer_A_stop(uint16_t baseAddress);
+
+bool USCI_B_SPI_initMaster(uint16_t base, USCI_B_SPI_initMasterParam *param);
+void USCI_B_SPI_enable(uint16_t base);
+void USCI_B_SPI_transmitData(uint16_t base, uint8_t data);
+uint8_t USCI_B_SPI_receiveData(uint16_t base);
+void USCI_B_SPI_enableInterrupt(uint16_t base, uint8_t mask);
+void USCI_B_SPI_disableInterrupt(uint16_t base, uint8_t mask);
+uint8_t USCI_B_SPI_getInterruptStatus(uint16_t base, uint8_t mask);
+void USCI_B_SPI_clearInterrupt(uint16_t base, uint8_t mask);
+uintptr_t USCI_B_SPI_getReceiveBufferAddressForDMA(uint16_t base);
+uintptr_t USCI_B_SPI_getTransmitBufferAddressForDMA(uint16_t base);
+
+void DMA_init(DMA_initParam *param);
+void DMA_setSrcAddress(uint8_t channel, uintptr_t addr, uint16_t dir);
+void DMA_setDstAddress(uint8_t channel, uintptr_t addr, uint16_t dir);
+void DMA_setTransferSize(uint8_t channel, uint16_t size);
+void DMA_enableTransfers(uint8_t channel);
+void DMA_disableTransfers(uint8_t channel);
+void DMA_enableInterrupt(uint8_t channel);
+void DMA_disableInterrupt(uint8_t channel);
+uint16_t DMA_getInterruptStatus(uint8_t channel);
+void DMA_clearInterrupt(uint8_t channel);
+
+// Interrupt routines of the engine (cc11xx_spi.c)
+void cc11xx_SPI_USCI_ISR();
+void cc11xx_SPI_DMA_ISR();
+
+#endif // SPI_MOCK_H_
+
+//! \} End of spi_mock group
@@ -0,0 +1,353 @@
+/*
+ * spi_sim.c
+ *
+ * Copyright (C) 2016, Universidade Federal de Santa Catarina
+ *
+ * This file is part of FloripaSat-TTC.
+ *
+ * FloripaSat-TTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FloripaSat-TTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FloripaSat-TTC.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file spi_sim.c
+ *
+ * \brief Runs the cc11xx SPI engine against the host mock (spi_mock.h).
+ *
+ * Each case checks what the radio received or sent back and prints the bus
+ * time, the wire time (bytes x 8 SPI clocks), the interrupts and the time
+ * the CPU spent in LPM0. The exit status is 1 if a case fails.
+ *
+ * \version 1.0-dev
+ *
+ * \date 17/10/2026
+ *
+ * \addtogroup spi_mock
+ * \{
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../inc/cc11xx_spi.h"
+#include "../inc/cc11xx_config.h"
+#include "../inc/cc11xx_floripasat_reg_config.h"
+
+#define N_REGS      (sizeof(reg_values)/sizeof(RegistersSettings))
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok)
+    {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static void report(const char *name, uint64_t start, uint32_t bytes, uint32_t usci, uint32_t dma, uint64_t isr,
+                   uint64_t sleep)
+{
+    uint64_t elapsed = spi_mock.now - start;
+    uint64_t wire = (uint64_t)(spi_mock.bytes - bytes)*spi_mock.byte_ns;
+
+    printf("%-28s %4u bytes %8.1f us (wire %8.1f us) %3u USCI + %u DMA interrupts (%7.1f us), LPM0 %5.1f%%\n",
+           name, spi_mock.bytes - bytes, elapsed/1e3, wire/1e3, spi_mock.usci_isr - usci, spi_mock.dma_isr - dma,
+           (spi_mock.isr_ns - isr)/1e3, elapsed ? 100.0*(spi_mock.sleep_ns - sleep)/elapsed : 0.0);
+}
+
+#define BEGIN() \
+    uint64_t start = spi_mock.now, isr = spi_mock.isr_ns, sleep = spi_mock.sleep_ns; \
+    uint32_t bytes = spi_mock.bytes, usci = spi_mock.usci_isr, dma = spi_mock.dma_isr
+
+#define END(name)   report(name, start, bytes, usci, dma, isr, sleep)
+
+/* Checks the radio registers against a settings table */
+static bool sim_RadioHas(const RegistersSettings *settings, uint16_t n)
+{
+    uint16_t i;
+    bool ok = true;
+
+    for(i=0; i<n; i++)
+    {
+        uint16_t a = settings[i].addr;
+
+        ok &= ((a >> 8) ? spi_mock.ext[a & 0xFF] : spi_mock.regs[a]) == settings[i].data;
+    }
+
+    return ok;
+}
+
+/* The register configuration, one access per register (as cc11xx_RegConfig()) */
+static void sim_RegConfig()
+{
+    uint8_t value;
+    uint16_t i;
+    bool ok = true;
+
+    BEGIN();
+    for(i=0; i<N_REGS; i++)
+    {
+        value = reg_values[i].data;
+        cc11xx_SPI_Transfer(CC11XX_BURST_ACCESS | CC11XX_WRITE_ACCESS, reg_values[i].addr, &value, 1);
+    }
+    END("register config (1 by 1)");
+
+    check(sim_RadioHas(reg_values, N_REGS), "register config: radio registers");
+
+    {
+        BEGIN();
+        for(i=0; i<N_REGS; i++)
+        {
+            value = 0;
+            cc11xx_SPI_Transfer(CC11XX_SINGLE_ACCESS | CC11XX_READ_ACCESS, reg_values[i].addr, &value, 1);
+            ok &= value == reg_values[i].data;
+        }
+        END("register readback");
+    }
+    check(ok, "register readback");
+}
+
+/* The same configuration with cc11xx_LoadConfig(): bursts, reset values skipped, readback digest */
+static void sim_LoadConfig()
+{
+    static RegistersSettings full[CC11XX_CONFIG_REGS + CC11XX_CONFIG_EXT_REGS];
+    uint16_t i, k, digest;
+
+    // As exported by SmartRF Studio: every configuration register, most at the reset value
+    for(i=0; i<CC11XX_CONFIG_REGS; i++)
+    {
+        full[i].addr = i;
+        full[i].data = cc11xx_reset_values[i];
+    }
+    for(i=0; i<CC11XX_CONFIG_EXT_REGS; i++)
+    {
+        full[CC11XX_CONFIG_REGS + i].addr = (CC11XX_EXT_ADDR << 8) | i;
+        full[CC11XX_CONFIG_REGS + i].data = cc11xx_ext_reset_values[i];
+    }
+    for(i=0; i<N_REGS; i++)
+    {
+        for(k=0; k<sizeof(full)/sizeof(RegistersSettings); k++)
+        {
+            if (full[k].addr == reg_values[i].addr)
+            {
+                full[k].data = reg_values[i].data;
+            }
+        }
+    }
+
+    cc11xx_SPI_Transfer(0x00, CC11XX_SRES, NULL, 0);
+    {
+        BEGIN();
+        digest = cc11xx_LoadConfig(reg_values, N_REGS);
+        END("burst config + readback");
+    }
+    check(sim_RadioHas(reg_values, N_REGS), "burst config: radio registers");
+    check(digest == cc11xx_ConfigDigest(reg_values, N_REGS), "burst config: digest");
+
+    cc11xx_SPI_Transfer(0x00, CC11XX_SRES, NULL, 0);
+    {
+        BEGIN();
+        digest = cc11xx_LoadConfig(full, sizeof(full)/sizeof(RegistersSettings));
+        END("full table + readback");
+    }
+    check(sim_RadioHas(full, sizeof(full)/sizeof(RegistersSettings)), "full table: radio registers");
+    check(digest == cc11xx_ConfigDigest(full, sizeof(full)/sizeof(RegistersSettings)), "full table: digest");
+
+    // A register not at the expected reset value: caught by the readback, the table is written again
+    cc11xx_SPI_Transfer(0x00, CC11XX_SRES, NULL, 0);
+    spi_mock.regs[CC11XX_SYNC3] ^= 0xFF;
+    {
+        BEGIN();
+        digest = cc11xx_LoadConfig(full, sizeof(full)/sizeof(RegistersSettings));
+        END("full table (wrong reset)");
+    }
+    check(sim_RadioHas(full, sizeof(full)/sizeof(RegistersSettings)), "wrong reset: radio registers");
+    check(digest == cc11xx_ConfigDigest(full, sizeof(full)/sizeof(RegistersSettings)), "wrong reset: digest");
+}
+
+/* A full TX FIFO, then an RX FIFO drain: one DMA block each */
+static void sim_FIFO()
+{
+    uint8_t tx[128], rx[100];
+    uint16_t i;
+    uint8_t status;
+
+    for(i=0; i<sizeof(tx); i++)
+    {
+        tx[i] = (uint8_t)(i*7 + 1);
+    }
+
+    {
+        BEGIN();
+        cc11xx_SPI_Transfer(CC11XX_WRITE_ACCESS, CC11XX_BURST_TXFIFO, tx, sizeof(tx));
+        END("TX FIFO fill");
+    }
+    check((spi_mock.tx_fifo_len == sizeof(tx)) && !memcmp(spi_mock.tx_fifo, tx, sizeof(tx)), "TX FIFO contents");
+
+    for(i=0; i<sizeof(rx); i++)
+    {
+        spi_mock.rx_fifo[i] = (uint8_t)(255 - i);
+    }
+    spi_mock.rx_fifo_len = sizeof(rx);
+    spi_mock.rx_fifo_pos = 0;
+    spi_mock.state = 1;
+
+    {
+        BEGIN();
+        status = cc11xx_SPI_Transfer(CC11XX_READ_ACCESS, CC11XX_BURST_TXFIFO, rx, sizeof(rx));
+        END("RX FIFO drain");
+    }
+    check(status == 0x10, "chip status");
+    for(i=0; i<sizeof(rx); i++)
+    {
+        if (rx[i] != (uint8_t)(255 - i))
+        {
+            break;
+        }
+    }
+    check(i == sizeof(rx), "RX FIFO contents");
+}
+
+static uint8_t order[16];
+static uint8_t n_done = 0;
+static SPITransfer chained;
+
+static void sim_Done(SPITransfer *t)
+{
+    order[n_done++] = (uint8_t)(uintptr_t)t->arg;
+    if ((uintptr_t)t->arg == 0)
+    {
+        // From the callback: runs as soon as the queue gets to it
+        check(cc11xx_SPI_Submit(&chained) == STATUS_SUCCESS, "submit from a callback");
+    }
+}
+
+/* Queued transfers running while the CPU does something else */
+static void sim_Queue()
+{
+    static const uint16_t addr[CC11XX_SPI_QUEUE_SIZE] = {0x0000, 0x2F10, 0x0002, 0x2F30, 0x0008, 0x2F50, 0x0012, 0x2F70};
+    static uint8_t data[CC11XX_SPI_QUEUE_SIZE][16];
+    SPITransfer t[CC11XX_SPI_QUEUE_SIZE + 1];
+    uint8_t strobe_base = spi_mock.n_strobes;
+    uint8_t i;
+    bool ok = true;
+
+    memset(t, 0, sizeof(t));
+    memset(&chained, 0, sizeof(chained));
+    chained.access = 0;
+    chained.addr = CC11XX_STX;
+    chained.callback = sim_Done;
+    chained.arg = (void *)(uintptr_t)99;
+
+    BEGIN();
+    for(i=0; i<CC11XX_SPI_QUEUE_SIZE; i++)
+    {
+        memset(data[i], 0x40 + i, sizeof(data[i]));
+        t[i].access = CC11XX_BURST_ACCESS | CC11XX_WRITE_ACCESS;
+        t[i].addr = addr[i];                                        // extended and normal space
+        t[i].pData = data[i];
+        t[i].len = 1 + 2*i;                                         // by interrupt and by DMA
+        t[i].callback = sim_Done;
+        t[i].arg = (void *)(uintptr_t)i;
+        check(cc11xx_SPI_Submit(&t[i]) == STATUS_SUCCESS, "submit");
+    }
+    check(cc11xx_SPI_Submit(&t[CC11XX_SPI_QUEUE_SIZE]) == STATUS_FAIL, "queue full");
+
+    // Main loop busy for 5 ms
+    spi_mock_Run(5000000);
+    check(!cc11xx_SPI_Busy(), "queue drained");
+    END("8 queued + 1 chained (awake)");
+
+    for(i=0; i<CC11XX_SPI_QUEUE_SIZE; i++)
+    {
+        uint16_t k, a = t[i].addr & 0xFF;
+
+        ok &= t[i].done && (order[i] == i);
+        for(k=0; k<t[i].len; k++)
+        {
+            ok &= ((t[i].addr >> 8) ? spi_mock.ext[a + k] : spi_mock.regs[a + k]) == 0x40 + i;
+        }
+    }
+    check(ok, "queued transfers: order and data");
+    check(chained.done && (n_done == CC11XX_SPI_QUEUE_SIZE + 1) && (order[CC11XX_SPI_QUEUE_SIZE] == 99) &&
+          (spi_mock.n_strobes == strobe_base + 1) && (spi_mock.strobes[strobe_base] == CC11XX_STX),
+          "chained command strobe");
+}
+
+/* CHIP_RDYn stuck high: the transfers end with CC11XX_STATUS_CHIP_RDYn_H, the queue moves on */
+static void sim_NotReady()
+{
+    static uint8_t data[8] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88};
+    SPITransfer t[2];
+    uint8_t before[sizeof(data)];
+
+    memcpy(before, &spi_mock.regs[0x10], sizeof(before));
+    memset(t, 0, sizeof(t));
+    t[0].access = CC11XX_BURST_ACCESS | CC11XX_WRITE_ACCESS;
+    t[0].addr = 0x0010;
+    t[0].pData = data;
+    t[0].len = sizeof(data);
+    t[1].access = 0;
+    t[1].addr = CC11XX_SNOP;
+
+    spi_mock.miso_busy = true;
+    check((cc11xx_SPI_Submit(&t[0]) == STATUS_SUCCESS) && (cc11xx_SPI_Submit(&t[1]) == STATUS_SUCCESS),
+          "chip not ready: submit");
+    check(t[0].done && t[1].done && !cc11xx_SPI_Busy() && spi_mock.csn, "chip not ready: transfers done, CSn high");
+    check((t[0].status == CC11XX_STATUS_CHIP_RDYn_H) && (t[1].status == CC11XX_STATUS_CHIP_RDYn_H) &&
+          !memcmp(before, &spi_mock.regs[0x10], sizeof(before)), "chip not ready: status, nothing written");
+    check(cc11xx_SPI_Transfer(0x00, CC11XX_SNOP, NULL, 0) == CC11XX_STATUS_CHIP_RDYn_H, "chip not ready: blocking call");
+
+    spi_mock.miso_busy = false;
+    check((cc11xx_SPI_Transfer(CC11XX_BURST_ACCESS | CC11XX_WRITE_ACCESS, 0x0010, data, sizeof(data)) &
+           CC11XX_STATUS_CHIP_RDYn_H) == 0 && !memcmp(data, &spi_mock.regs[0x10], sizeof(data)), "chip ready again");
+}
+
+int main()
+{
+    spi_mock_Reset(SPICLK);
+    spi_mock.sr = GIE;
+
+    check(cc11xx_SPI_Init() == STATUS_SUCCESS, "init");
+
+    sim_RegConfig();
+    sim_LoadConfig();
+    sim_FIFO();
+    sim_Queue();
+    sim_NotReady();
+
+    // A caller with the interrupts disabled gets them back disabled
+    spi_mock.sr = 0;
+    cc11xx_SPI_Transfer(0x00, CC11XX_SNOP, NULL, 0);
+    check((spi_mock.sr & GIE) == 0, "interrupt state of the caller kept");
+    spi_mock.sr = GIE;
+
+    printf("%u accesses, %u bytes, %u bytes by DMA, %u overruns, %u TXBUF collisions\n", spi_mock.accesses,
+           spi_mock.bytes, spi_mock.dma_moves, spi_mock.overruns, spi_mock.tx_collisions);
+    check(spi_mock.overruns == 0, "RXBUF overruns");
+    check(spi_mock.tx_collisions == 0, "TXBUF collisions");
+
+    if (failures)
+    {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+
+    return 0;
+}
+
+//! \} End of spi_mock group
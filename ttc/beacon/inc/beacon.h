@@ -0,0 +1,202 @@
+/*
+ * beacon.h
+ *
+ * Copyright (C) 2016, Universidade Federal de Santa Catarina
+ *
+ * This file is part of FloripaSat-TTC.
+ *
+ * FloripaSat-TTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FloripaSat-TTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FloripaSat-TTC.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file beacon.h
+ *
+ * \brief Beacon scheduler: periodic packets, payload rotation and PA gating.
+ *
+ * \version 1.0-dev
+ *
+ * \date 17/10/2026
+ *
+ * \defgroup beacon_sched Beacon scheduler
+ * \ingroup beacon
+ * \{
+ */
+
+#ifndef BEACON_H_
+#define BEACON_H_
+
+#include <stdint.h>
+
+#include "events.h"
+
+#ifndef DEBUG_MODE
+#define DEBUG_MODE true
+#endif // DEBUG_MODE
+
+#define BEACON_ID                   "FloripaSat"    /**< Satellite identification, at the start of every packet */
+#define BEACON_ID_LEN               10              /**< Bytes of BEACON_ID (without '\0') */
+#define BEACON_PERIOD_S             10              /**< Time between two packets (s) */
+#define BEACON_PA_VREG              3.1             /**< RF6886 Vreg1/2 during a transmission (V) */
+#define BEACON_PA_SETTLING_MS       1               /**< From PA Vreg on to RF drive (RF6886 turn on sequence) */
+#define BEACON_PA_SETTLING_TICKS    ((BEACON_PA_SETTLING_MS*EVENTS_TIMER_HZ + 999)/1000)    /**< BEACON_PA_SETTLING_MS in ACLK periods, rounded up */
+#define BEACON_TX_TIMEOUT_S         2               /**< Ticks without the end of packet event before the transmission is aborted (the longest packet takes ~240 ms at 1,2 ksps) */
+#define BEACON_BPS                  1200            /**< Bits/s on air (1,2 ksps 2-GFSK), for the timeout of a stream */
+#define BEACON_STREAM_OVERHEAD      16              /**< Bytes of a stream besides the data (length header, preamble, sync word, CRC), rounded up */
+#define BEACON_EPS_AGE_MAX          0xFF            /**< Age of the EPS data sent when none was ever received */
+#define BEACON_RESETS_MAGIC         0xB5C3          /**< Marks the reset counters as valid (kept in NOINIT RAM) */
+
+/**
+ * \defgroup beacon_payloads Payload types
+ * \ingroup beacon_sched
+ *
+ * \brief Packet structure (after the length byte of the CC1175 variable packet length mode):
+ *      - BEACON_ID (10 bytes)
+ *      - Payload type (1 byte)
+ *      - Packet counter (1 byte)
+ *      - Payload:
+ *          - BEACON_PAYLOAD_EPS: battery 1 voltage (2 bytes), battery 2 voltage (2 bytes), age of the EPS data in seconds (1 byte, saturated)
+ *          - BEACON_PAYLOAD_UPTIME: seconds since the last reset (4 bytes)
+ *          - BEACON_PAYLOAD_RESETS: power-on, watchdog and other resets (2 bytes each)
+ *          .
+ *      .
+ *
+ * All the fields are MSB first.
+ *
+ * \{
+ */
+#define BEACON_PAYLOAD_EPS          0x01            /**< EPS battery state */
+#define BEACON_PAYLOAD_UPTIME       0x02            /**< Time since the last reset */
+#define BEACON_PAYLOAD_RESETS       0x03            /**< Reset counters */
+
+#define BEACON_ROTATION             {BEACON_PAYLOAD_EPS, BEACON_PAYLOAD_UPTIME, BEACON_PAYLOAD_EPS, BEACON_PAYLOAD_RESETS}  /**< Payload of each packet, in turn */
+#define BEACON_MAX_PACKET_LEN       (BEACON_ID_LEN + 2 + 6)                                                                 /**< Longest packet (without the length byte) */
+//! \} End of beacon_payloads
+
+/**
+ * \struct BeaconResets
+ *
+ * \brief Reset counters (SYSRSTIV), kept across resets in NOINIT RAM.
+ *
+ * They are cleared when the RAM content is lost (magic value does not match).
+ *
+ */
+typedef struct
+{
+    uint16_t magic;                 /**< BEACON_RESETS_MAGIC when valid */
+    uint16_t power_on;              /**< Brownout/power-on resets */
+    uint16_t watchdog;              /**< Watchdog timeouts and password violations */
+    uint16_t other;                 /**< RSTn/NMI, software, flash, ... */
+} BeaconResets;
+
+/**
+ * \fn beacon_Init
+ *
+ * \brief Initialization of the beacon scheduler.
+ *
+ * Reads the reset cause (SYSRSTIV) and updates the reset counters. The PA and
+ * the RF switch must be initialized (rf6886_Init(), rf_switch_Init()) and are
+ * left off.
+ *
+ * \return None
+ */
+void beacon_Init();
+
+/**
+ * \fn beacon_Tick
+ *
+ * \brief One second of the scheduler.
+ *
+ * Counts the uptime and the age of the EPS data, and starts the next packet
+ * every BEACON_PERIOD_S seconds (See beacon_Transmit()). A transmission
+ * (packet or stream) still running after its timeout is aborted: SIDLE,
+ * SFTX, cc11xx_StreamEnd() for a stream, PA and RF switch off.
+ *
+ * Called on each RTC tick (EVENTS_RTC_TICK).
+ *
+ * \return None
+ */
+void beacon_Tick();
+
+/**
+ * \fn beacon_BuildPacket
+ *
+ * \brief Builds the next packet of the rotation.
+ *
+ * \param packet is the buffer (BEACON_MAX_PACKET_LEN + 1 bytes), starting with the length byte.
+ *
+ * \return Bytes to write in the TX FIFO (length byte included).
+ */
+uint8_t beacon_BuildPacket(uint8_t *packet);
+
+/**
+ * \fn beacon_Transmit
+ *
+ * \brief Starts the transmission of the next packet, with the PA and RF switch on only during the transmission.
+ *
+ * Sequence:
+ *      -# RF switch to beacon, PA Vreg1/2 on (RF6886 turn on sequence: RF drive last)
+ *      -# Packet to the TX FIFO while the PA settles (BEACON_PA_SETTLING_MS, timed by events_TimerStart())
+ *      -# Sleep to the end of the settling time (events_TimerWait()) and STX
+ *      .
+ *
+ * It returns without waiting for the end of the packet: the PA and the RF
+ * switch are turned off by beacon_TxEnd().
+ *
+ * \return Status. It can be:
+ *      - \b STATUS_SUCCESS
+ *      - \b STATUS_FAIL if a transmission (packet or stream) is already running.
+ *      .
+ */
+uint8_t beacon_Transmit();
+
+/**
+ * \fn beacon_Stream
+ *
+ * \brief Starts the transmission of a packet longer than the TX FIFO (See cc11xx_stream.h).
+ *
+ * Same PA and RF switch sequence as beacon_Transmit(), then
+ * cc11xx_StreamStart() once the PA has settled (it queues the first fill and
+ * STX together). The rest of the data is given with
+ * cc11xx_StreamWrite(). The stream ends in beacon_TxEnd(), or is aborted by
+ * beacon_Tick() BEACON_TX_TIMEOUT_S ticks after its air time.
+ *
+ * \param len is the number of data bytes of the packet (1 to CC11XX_STREAM_MAX_LEN).
+ * \param pData is the first data bytes.
+ * \param n is the number of bytes in pData.
+ *
+ * \return Number of bytes of pData taken, or 0 if the stream was not started (transmission running or len out of range).
+ */
+uint16_t beacon_Stream(uint16_t len, const uint8_t *pData, uint16_t n);
+
+/**
+ * \fn beacon_TxEnd
+ *
+ * \brief Ends the running transmission (packet or stream): PA and RF switch off.
+ *
+ * Called on the end of packet event (EVENTS_TX_END). The chip state tells
+ * a complete packet (back to IDLE, RFEND_CFG0.TXOFF_MODE) from a TX FIFO
+ * underflow, which is flushed. A stream is ended by cc11xx_StreamEnd().
+ * Ignored if no transmission is running.
+ *
+ * \return Status. It can be:
+ *      - \b STATUS_SUCCESS
+ *      - \b STATUS_FAIL if no transmission was running or the packet was not complete.
+ *      .
+ */
+uint8_t beacon_TxEnd();
+
+#endif // BEACON_H_
+
+//! \} End of beacon_sched group
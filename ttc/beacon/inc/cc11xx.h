@@ -39,7 +39,11 @@
 #ifndef CC11XX_H_
 #define CC11XX_H_
 
+#ifdef CC11XX_HOST
+#include "../host/spi_mock.h"
+#else
 #include "../driverlib/driverlib.h"
+#endif // CC11XX_HOST
 #include <stdint.h>
 
 #ifndef DEBUG_MODE
@@ -66,6 +70,11 @@
 #define CC11XX_MISO_PIN         GPIO_PIN2       /**< MISO pin = P2.2 */
 #define CC11XX_SCLK_PORT        GPIO_PORT_P2    /**< SCLK port = P2 */
 #define CC11XX_SCLK_PIN         GPIO_PIN3       /**< SCLK pin = P2.3*/
+
+#define CC11XX_GPIO0_PORT       GPIO_PORT_P1    /**< GPIO0 port = P1 */
+#define CC11XX_GPIO0_PIN        GPIO_PIN6       /**< GPIO0 pin = P1.6 */
+#define CC11XX_GPIO2_PORT       GPIO_PORT_P1    /**< GPIO2 port = P1 */
+#define CC11XX_GPIO2_PIN        GPIO_PIN5       /**< GPIO2 pin = P1.5 */
 //! \} End of pins
 
 #define SPICLK 400000                           /**< SPI clock frequency. */
@@ -492,11 +501,13 @@ void cc11xx_Init();
  * \brief Configuration of the registers of the cc11xx
  * 
  * This function takes an array with the address of a register and its value,
- * and writes the data using cc11xx_WriteReg().
+ * and writes the data in burst accesses using cc11xx_LoadConfig() (registers
+ * already at their reset value are skipped, so the chip must be just reset).
  * 
- * \return None
+ * \return Digest of the registers read back. Equal to
+ *         cc11xx_ConfigDigest(reg_values, ...) if the configuration is right.
  */
-void cc11xx_RegConfig();
+uint16_t cc11xx_RegConfig();
 
 /**
  * \fn cc11xx_WriteRef
@@ -571,20 +582,6 @@ uint8_t cc11xx_8BitRegAccess(uint8_t access_type, uint8_t addr_byte, uint8_t *pD
  */
 uint8_t cc11xx_16BitRegAccess(uint8_t access_type, uint8_t ext_addr, uint8_t reg_addr, uint8_t *pData, uint8_t len);
 
-/**
- * \fn cc11xx_ReadWriteBurstSingle
- * 
- * \brief Read/Write data using Burst/Single mode.
- * 
- * \param addr is the address of the register to be accessed.
- * \param pData is a pointer to the data to be written in the register (Write mode).
- *        Or a pointer to a variable to receive the register value.
- * \param len is the size of the data (pData).
- *
- * \return None
- */
-void cc11xx_ReadWriteBurstSingle(uint8_t addr, uint8_t *pData, uint16_t len);
-
 /**
  * \fn cc11xx_ManualReset
  * 
@@ -626,20 +623,6 @@ void cc11xx_ManualCalibration();
  */
 uint8_t cc11xx_WriteTXFIFO(uint8_t *pData, uint8_t len);
 
-/**
- * \fn cc11xx_SPI_Init
- * 
- * \brief Initialization of the MCU SPI.
- * 
- * Used interface: USCI_B0
- * 
- * \return Initialization status. It can be:
- *      - \b STATUS_SUCCESS
- *      - \b STATUS_FAIL
- *      .
- */
-uint8_t cc11xx_SPI_Init();
-
 #endif // CC11XX_H_
 
 //! \} End of CC1175 group
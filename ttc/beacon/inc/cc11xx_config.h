@@ -0,0 +1,127 @@
+/*
+ * cc11xx_config.h
+ *
+ * Copyright (C) 2016, Universidade Federal de Santa Catarina
+ *
+ * This file is part of FloripaSat-TTC.
+ *
+ * FloripaSat-TTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FloripaSat-TTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FloripaSat-TTC.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file cc11xx_config.h
+ *
+ * \brief Burst loading of register settings tables into the cc11xx.
+ *
+ * \version 1.0-dev
+ *
+ * \date 17/10/2026
+ *
+ * \defgroup cc11xx_config CC11XX configuration loader
+ * \ingroup cc1175
+ * \{
+ */
+
+#ifndef CC11XX_CONFIG_H_
+#define CC11XX_CONFIG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cc11xx.h"
+#include "cc11xx_floripasat_reg_config.h"
+
+#define CC11XX_CONFIG_REGS          0x2F    /**< Configuration registers of the normal space (0x00 - 0x2E) */
+#define CC11XX_CONFIG_EXT_REGS      0x3A    /**< Configuration registers of the extended space (0x2F00 - 0x2F39) */
+#define CC11XX_CONFIG_MAX_BURST     32      /**< Longest burst access of the loader */
+#define CC11XX_CONFIG_MAX_GAP       2       /**< Registers at their reset value kept inside a burst instead of splitting it */
+
+/**
+ * Reset values of the configuration registers, normal space.
+ *
+ * Reference: CC112X/CC1175 User's Guide, table 4.
+ *
+ */
+static const uint8_t cc11xx_reset_values[CC11XX_CONFIG_REGS] =
+{
+    0x06, 0x07, 0x30, 0x3C, 0x93, 0x0B, 0x51, 0xDE,     // IOCFG3 - SYNC0
+    0x0A, 0x17, 0x06, 0x03, 0x4C, 0x14, 0x2A, 0x40,     // SYNC_CFG1 - FREQ_IF_CFG
+    0xC4, 0x14, 0x46, 0x0D, 0x43, 0xA9, 0x2A, 0x36,     // IQIC - AGC_REF
+    0x00, 0x00, 0x91, 0x20, 0xAA, 0xC3, 0x80, 0x00,     // AGC_CS_THR - DEV_ADDR
+    0x0B, 0x02, 0x08, 0x21, 0x00, 0x00, 0x04, 0x05,     // SETTLING_CFG - PKT_CFG1
+    0x00, 0x0F, 0x00, 0x7F, 0x56, 0x7C, 0x03            // PKT_CFG0 - PKT_LEN
+};
+
+/**
+ * Reset values of the configuration registers, extended space.
+ *
+ * Reference: CC112X/CC1175 User's Guide, table 5.
+ *
+ */
+static const uint8_t cc11xx_ext_reset_values[CC11XX_CONFIG_EXT_REGS] =
+{
+    0x04, 0x20, 0x0A, 0x00, 0x00, 0x00, 0x01, 0x00,     // IF_MIX_CFG - RCCAL_FINE
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,     // RCCAL_COARSE - IF_ADC2
+    0xA6, 0x04, 0x08, 0x5A, 0x00, 0x20, 0x00, 0x00,     // IF_ADC1 - FS_CAL0
+    0x28, 0x01, 0x00, 0x03, 0xFF, 0x1F, 0x00, 0x51,     // FS_CHP - FS_PFD
+    0x2C, 0x11, 0x00, 0x14, 0x00, 0x00, 0x00, 0x81,     // FS_PRE - FS_VCO0
+    0x00, 0x02, 0x00, 0x00, 0x10, 0x00, 0x00, 0x01,     // GBIAS6 - IFAMP
+    0x01, 0x01, 0x0C, 0xA0, 0x03, 0x04, 0x00, 0x00,     // LNA - XOSC0
+    0x00, 0x00                                          // ANALOG_SPARE - PA_CFG3
+};
+
+/**
+ * \fn cc11xx_LoadConfig
+ *
+ * \brief Writes a register settings table with burst accesses and reads it back.
+ *
+ * Entries with consecutive addresses (in the table order, in the same
+ * register space) are written in one burst access. Entries of the
+ * configuration registers equal to their reset value are skipped, unless
+ * they are CC11XX_CONFIG_MAX_GAP or less between two written entries of
+ * the same burst. So the chip must be just reset (cc11xx_ManualReset() or
+ * cc11xx_SRESReset()).
+ *
+ * All the configuration registers of the table are then read back (in
+ * bursts too) and, if one of them differs from the table, the whole table
+ * is written again without skipping and read back once more.
+ *
+ * \param settings is the table (one entry per address).
+ * \param n is the number of entries.
+ *
+ * \return Digest of the read back values (See cc11xx_ConfigDigest()).
+ */
+uint16_t cc11xx_LoadConfig(const RegistersSettings *settings, uint16_t n);
+
+/**
+ * \fn cc11xx_ConfigDigest
+ *
+ * \brief Digest of the configuration registers of a settings table.
+ *
+ * CRC-16-CCITT (0x1021, initial value 0xFFFF) of the address (MSB first)
+ * and the value of each entry of the configuration registers, in the table
+ * order. cc11xx_LoadConfig() returns the same digest computed over the
+ * values read back.
+ *
+ * \param settings is the table.
+ * \param n is the number of entries.
+ *
+ * \return The digest.
+ */
+uint16_t cc11xx_ConfigDigest(const RegistersSettings *settings, uint16_t n);
+
+#endif // CC11XX_CONFIG_H_
+
+//! \} End of cc11xx_config group
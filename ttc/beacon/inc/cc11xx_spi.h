@@ -0,0 +1,176 @@
+/*
+ * cc11xx_spi.h
+ *
+ * Copyright (C) 2016, Universidade Federal de Santa Catarina
+ *
+ * This file is part of FloripaSat-TTC.
+ *
+ * FloripaSat-TTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FloripaSat-TTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FloripaSat-TTC.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file cc11xx_spi.h
+ *
+ * \brief Interrupt/DMA driven SPI transfers to the cc11xx.
+ *
+ * \version 1.0-dev
+ *
+ * \date 17/10/2026
+ *
+ * \defgroup cc11xx_spi CC11XX SPI
+ * \ingroup cc1175
+ * \{
+ */
+
+#ifndef CC11XX_SPI_H_
+#define CC11XX_SPI_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cc11xx.h"
+
+/**
+ * \defgroup spi_engine SPI transfer engine
+ * \ingroup cc11xx_spi
+ *
+ * \brief Queued, asynchronous transfers.
+ *
+ * A transfer (header byte, extended address, data) is queued with
+ * cc11xx_SPI_Submit() and runs in the background: the header bytes and the
+ * short data phases are moved by the USCI_B0 RX interrupt, the data phases
+ * of CC11XX_SPI_DMA_MIN bytes or more by two DMA channels (one feeding TXBUF
+ * on UCB0TXIFG, the other draining RXBUF on UCB0RXIFG), at the SPI clock
+ * with no CPU work per byte. When the last byte is in, CSn goes high, the
+ * callback of the transfer is called (interrupt context) and the next
+ * transfer of the queue starts.
+ *
+ * The CPU does poll once per transfer, and possibly in interrupt context
+ * (a transfer starts from the end of the previous one): after CSn goes low,
+ * MISO is read until the cc11xx pulls CHIP_RDYn low, at most
+ * CC11XX_SPI_READY_POLLS times. If it does not, the transfer is done with
+ * CC11XX_STATUS_CHIP_RDYn_H as status and nothing exchanged, and the next
+ * one is tried. A callback should check the status before submitting again.
+ *
+ * cc11xx_SPI_Wait() sleeps in LPM0 until a transfer is done. Deeper modes
+ * stop SMCLK, and with it the SPI clock.
+ *
+ * \note The engine needs the global interrupts enabled (GIE). The waits
+ * enable them while sleeping and give back the interrupt state of the caller.
+ *
+ * \{
+ */
+#define CC11XX_SPI_QUEUE_SIZE       8                       /**< Queued transfers (power of 2). */
+#define CC11XX_SPI_DMA_MIN          4                       /**< Shortest data phase moved by DMA (>= 2). */
+#define CC11XX_SPI_READY_POLLS      64                      /**< MISO reads for CHIP_RDYn (about 2 ms at the 1 MHz MCLK, the XOSC starts in well under 1 ms). */
+
+#define CC11XX_SPI_DMA_RX_CHANNEL   DMA_CHANNEL_0           /**< RXBUF -> memory */
+#define CC11XX_SPI_DMA_TX_CHANNEL   DMA_CHANNEL_1           /**< Memory -> TXBUF */
+#define CC11XX_SPI_DMA_RX_TRIGGER   DMA_TRIGGERSOURCE_18    /**< UCB0RXIFG (MSP430F6659 datasheet, DMA trigger assignments) */
+#define CC11XX_SPI_DMA_TX_TRIGGER   DMA_TRIGGERSOURCE_19    /**< UCB0TXIFG */
+
+#define CC11XX_EXT_ADDR             0x2F                    /**< Header address of the extended register space */
+//! \} End of spi_engine
+
+typedef struct SPITransfer SPITransfer;
+
+/**
+ * \struct SPITransfer
+ *
+ * \brief One CSn low to CSn high access of the cc11xx.
+ *
+ * The struct (and the data) must stay valid until the transfer is done.
+ *
+ */
+struct SPITransfer
+{
+    uint8_t access;                         /**< CC11XX_READ_ACCESS/CC11XX_WRITE_ACCESS | CC11XX_BURST_ACCESS/CC11XX_SINGLE_ACCESS */
+    uint16_t addr;                          /**< Register (0x2Fxx: extended space), FIFO or command strobe */
+    uint8_t *pData;                         /**< Data to write or buffer for the data read */
+    uint16_t len;                           /**< Data bytes (0 for a command strobe, 1 for a single access) */
+    uint8_t status;                         /**< Chip status byte, received with the header (CC11XX_STATUS_CHIP_RDYn_H: not run) */
+    volatile bool done;                     /**< Set when CSn is back high */
+    void (*callback)(SPITransfer *t);       /**< Called when done (interrupt context), or NULL */
+    void *arg;                              /**< Free for the callback */
+};
+
+/**
+ * \fn cc11xx_SPI_Init
+ *
+ * \brief Initialization of the MCU SPI and of the transfer engine.
+ *
+ * Used interface: USCI_B0, DMA channels 0 (RX) and 1 (TX).
+ *
+ * \return Initialization status. It can be:
+ *      - \b STATUS_SUCCESS
+ *      - \b STATUS_FAIL
+ *      .
+ */
+uint8_t cc11xx_SPI_Init();
+
+/**
+ * \fn cc11xx_SPI_Submit
+ *
+ * \brief Queues a transfer.
+ *
+ * The transfer starts at once if the bus is free. It can be called from a
+ * transfer callback to chain transfers.
+ *
+ * \param t is the transfer.
+ *
+ * \return Status. It can be:
+ *      - \b STATUS_SUCCESS
+ *      - \b STATUS_FAIL if the queue is full.
+ *      .
+ */
+uint8_t cc11xx_SPI_Submit(SPITransfer *t);
+
+/**
+ * \fn cc11xx_SPI_Wait
+ *
+ * \brief Sleeps (LPM0) until the transfer is done.
+ *
+ * \param t is a submitted transfer.
+ *
+ * \return None
+ */
+void cc11xx_SPI_Wait(SPITransfer *t);
+
+/**
+ * \fn cc11xx_SPI_Transfer
+ *
+ * \brief Runs one access and waits for it (LPM0).
+ *
+ * \param access is the access type (read/write, burst/single).
+ * \param addr is the register address (0x2Fxx in the extended space), FIFO or command strobe.
+ * \param pData is the data to be written, or the buffer for the data read.
+ * \param len is the size of the data (0 for a command strobe).
+ *
+ * \return Chip status
+ */
+uint8_t cc11xx_SPI_Transfer(uint8_t access, uint16_t addr, uint8_t *pData, uint16_t len);
+
+/**
+ * \fn cc11xx_SPI_Busy
+ *
+ * \brief Checks if there are transfers running or queued.
+ *
+ * \return true or false.
+ */
+bool cc11xx_SPI_Busy();
+
+#endif // CC11XX_SPI_H_
+
+//! \} End of cc11xx_spi group
@@ -0,0 +1,142 @@
+/*
+ * cc11xx_stream.h
+ *
+ * Copyright (C) 2016, Universidade Federal de Santa Catarina
+ *
+ * This file is part of FloripaSat-TTC.
+ *
+ * FloripaSat-TTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FloripaSat-TTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FloripaSat-TTC.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file cc11xx_stream.h
+ *
+ * \brief Transmission of packets longer than the cc11xx TX FIFO.
+ *
+ * The packet is sent in the infinite packet length mode (PKT_CFG0) and the
+ * TX FIFO is refilled from a ring buffer each time it drains below the
+ * threshold: GPIO0 (IOCFG0 = TXFIFO_THR) falls and the port interrupt calls
+ * cc11xx_StreamRefill(), which queues the FIFO write on the SPI engine. As
+ * the byte counter of the fixed length mode counts modulo 256, PKT_LEN is
+ * set to the packet length modulo 256 and the mode is switched to fixed
+ * length once fewer than 256 bytes are left to send, so the packet ends
+ * (with the CRC) at the last byte.
+ *
+ * The packet starts with a length header: CC11XX_STREAM_FLAG | length MSB,
+ * length LSB. The first byte of a normal packet (variable packet length
+ * mode) is its length, below 0x80, so a receiver in the infinite mode can
+ * handle both (See runRX() in the OBDH radio interface).
+ *
+ * \version 1.0-dev
+ *
+ * \date 17/10/2026
+ *
+ * \defgroup cc11xx_stream CC11XX streaming TX
+ * \ingroup cc1175
+ * \{
+ */
+
+#ifndef CC11XX_STREAM_H_
+#define CC11XX_STREAM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cc11xx.h"
+
+#define CC11XX_FIFO_SIZE            128                             /**< TX FIFO bytes */
+#define CC11XX_STREAM_RING_SIZE     512                             /**< Ring buffer bytes (power of 2) */
+#define CC11XX_STREAM_FIFO_THR      120                             /**< FIFO_CFG.FIFO_THR: GPIO0 falls with fewer than 127 - 120 bytes in the TX FIFO */
+#define CC11XX_STREAM_REFILL        (CC11XX_STREAM_FIFO_THR + 1)    /**< Longest refill (bytes free in the TX FIFO when GPIO0 falls) */
+#define CC11XX_STREAM_HEADER        2                               /**< Length header bytes */
+#define CC11XX_STREAM_FLAG          0x80                            /**< Marks the first byte of the length header */
+#define CC11XX_STREAM_MAX_LEN       0x7FFF                          /**< Longest data (without the length header) */
+
+#define CC11XX_PKT_CFG0_FIXED       0x00                            /**< PKT_CFG0.LENGTH_CONFIG: fixed packet length (PKT_LEN) */
+#define CC11XX_PKT_CFG0_VARIABLE    0x20                            /**< PKT_CFG0.LENGTH_CONFIG: variable packet length (first byte) */
+#define CC11XX_PKT_CFG0_INFINITE    0x40                            /**< PKT_CFG0.LENGTH_CONFIG: infinite packet length */
+#define CC11XX_IOCFG_TXFIFO_THR     0x02                            /**< IOCFGx.GPIOx_CFG: asserted with 127 - FIFO_THR bytes or more in the TX FIFO */
+
+/**
+ * \fn cc11xx_StreamStart
+ *
+ * \brief Starts the transmission of a long packet.
+ *
+ * Saves IOCFG0, FIFO_CFG, PKT_CFG0 and PKT_LEN (restored by
+ * cc11xx_StreamEnd()), queues the length header and the first data bytes in
+ * the ring buffer, fills the TX FIFO and strobes STX. The rest of the data
+ * is given with cc11xx_StreamWrite() while the packet is sent. The radio
+ * must be in IDLE, and the GPIO0 falling edge interrupt must call
+ * cc11xx_StreamRefill() (See events.h).
+ *
+ * \param len is the number of data bytes of the packet (1 to CC11XX_STREAM_MAX_LEN).
+ * \param pData is the first data bytes.
+ * \param n is the number of bytes in pData (the ones that do not fit in the ring buffer are not taken).
+ *
+ * \return Number of bytes of pData taken, or 0 if the packet was not started (stream running or len out of range).
+ */
+uint16_t cc11xx_StreamStart(uint16_t len, const uint8_t *pData, uint16_t n);
+
+/**
+ * \fn cc11xx_StreamWrite
+ *
+ * \brief Queues more data of the packet being sent.
+ *
+ * If the TX FIFO is below the threshold (the ring buffer ran empty before),
+ * the refill is started at once.
+ *
+ * \param pData is the data.
+ * \param n is the number of bytes.
+ *
+ * \return Number of bytes taken (limited by the free space in the ring buffer and the packet length).
+ */
+uint16_t cc11xx_StreamWrite(const uint8_t *pData, uint16_t n);
+
+/**
+ * \fn cc11xx_StreamRefill
+ *
+ * \brief Queues the write of the next bytes of the ring buffer in the TX FIFO.
+ *
+ * Called on the falling edge of GPIO0 (interrupt context). Nothing is done
+ * if no stream is running or a refill is already queued.
+ *
+ * \return None
+ */
+void cc11xx_StreamRefill();
+
+/**
+ * \fn cc11xx_StreamEnd
+ *
+ * \brief Ends the stream, at the end of packet (falling edge of GPIO2), and restores the registers.
+ *
+ * \return Status. It can be:
+ *      - \b STATUS_SUCCESS
+ *      - \b STATUS_FAIL if no stream was running or the packet was not complete (TX FIFO underflow).
+ *      .
+ */
+uint8_t cc11xx_StreamEnd();
+
+/**
+ * \fn cc11xx_StreamActive
+ *
+ * \brief Checks if a stream is running.
+ *
+ * \return true or false.
+ */
+bool cc11xx_StreamActive();
+
+#endif // CC11XX_STREAM_H_
+
+//! \} End of cc11xx_stream group
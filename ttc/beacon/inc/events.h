@@ -0,0 +1,133 @@
+/*
+ * events.h
+ *
+ * Copyright (C) 2016, Universidade Federal de Santa Catarina
+ *
+ * This file is part of FloripaSat-TTC.
+ *
+ * FloripaSat-TTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FloripaSat-TTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FloripaSat-TTC.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file events.h
+ *
+ * \brief Wake-up events of the main loop: RTC tick, CC1175 end of packet and TX FIFO threshold.
+ *
+ * The main loop sleeps in LPM3 (only ACLK/XT1 running) in events_Wait() and
+ * is woken by:
+ *      - the RTC_B read ready interrupt, once per second (XT1, 32768 Hz);
+ *      - the falling edge of the CC1175 GPIO2 (IOCFG2 = PKT_SYNC_RXTX, de-asserted at the end of the packet);
+ *      - the falling edge of the CC1175 GPIO0 during a stream (IOCFG0 = TXFIFO_THR, See cc11xx_stream.h),
+ *        only to sleep in LPM0 while the refill runs (no event for the main loop).
+ *      .
+ *
+ * Short waits inside a task (the PA settling of beacon_Transmit()) are
+ * timed by a one-shot compare of Timer_A1 on ACLK (events_TimerStart(),
+ * events_TimerWait()), so the CPU sleeps through them in LPM3 too.
+ *
+ * The interrupt routines only set an event flag and leave the low-power
+ * mode, all the work is done by the main loop (but the TX FIFO refill of a
+ * stream, queued on the SPI engine by the port interrupt). While a SPI
+ * transfer to the CC1175 runs, the CPU sleeps in LPM0 instead (See
+ * cc11xx_spi.h). The EPS UART keeps receiving in LPM3: the USCI turns SMCLK
+ * on by itself at the start edge of each byte.
+ *
+ * \version 1.0-dev
+ *
+ * \date 17/10/2026
+ *
+ * \defgroup events Events
+ * \ingroup beacon
+ * \{
+ */
+
+#ifndef EVENTS_H_
+#define EVENTS_H_
+
+#include <stdint.h>
+
+#include "cc11xx.h"
+
+#define EVENTS_RTC_TICK             0x01                /**< One second elapsed */
+#define EVENTS_TX_END               0x02                /**< End of the packet being transmitted (or TX FIFO underflow) */
+
+#define EVENTS_GDO_PORT             CC11XX_GPIO2_PORT   /**< End of packet: CC1175 GPIO2 (P1.5) */
+#define EVENTS_GDO_PIN              CC11XX_GPIO2_PIN
+#define EVENTS_FIFO_PORT            CC11XX_GPIO0_PORT   /**< TX FIFO threshold: CC1175 GPIO0 (P1.6) */
+#define EVENTS_FIFO_PIN             CC11XX_GPIO0_PIN
+
+#define EVENTS_XT1_TIMEOUT          50000           /**< Fault flag clearing attempts while XT1 starts */
+
+#define EVENTS_TIMER_BASE           TIMER_A1_BASE   /**< One-shot delays (up mode, CCR0 compare) */
+#define EVENTS_TIMER_HZ             32768           /**< ACLK (XT1), runs in LPM3 */
+
+/**
+ * \fn events_Init
+ *
+ * \brief Initialization of the event sources.
+ *
+ * Starts XT1, the RTC_B (calendar mode, read ready interrupt every second)
+ * and the interrupts on the falling edges of the CC1175 GPIO2 and GPIO0.
+ *
+ * \return Status. It can be:
+ *      - \b STATUS_SUCCESS
+ *      - \b STATUS_FAIL if XT1 did not start.
+ *      .
+ */
+uint8_t events_Init();
+
+/**
+ * \fn events_Wait
+ *
+ * \brief Sleeps until at least one event is pending.
+ *
+ * The flags are checked with the interrupts disabled, and the CPU enters
+ * the low-power mode and enables them in the same instruction, so an event
+ * that comes just before the sleep is not lost.
+ *
+ * \return The pending events (EVENTS_RTC_TICK, EVENTS_TX_END), cleared.
+ */
+uint8_t events_Wait();
+
+/**
+ * \fn events_TimerStart
+ *
+ * \brief Starts a one-shot delay of ticks ACLK periods (Timer_A1, CCR0 compare).
+ *
+ * The caller goes on (SPI transfers, for example) and waits for the end of
+ * the delay with events_TimerWait().
+ *
+ * \param ticks is the delay in periods of EVENTS_TIMER_HZ (1 to 65535).
+ *
+ * \return None
+ */
+void events_TimerStart(uint16_t ticks);
+
+/**
+ * \fn events_TimerWait
+ *
+ * \brief Sleeps until the delay started by events_TimerStart() ends.
+ *
+ * LPM3, or LPM0 while a SPI transfer runs. Returns at once if the delay is
+ * already over. The events that come meanwhile stay pending for
+ * events_Wait(). The interrupt state of the caller is kept.
+ *
+ * \return None
+ */
+void events_TimerWait();
+
+#endif // EVENTS_H_
+
+//! \} End of events group
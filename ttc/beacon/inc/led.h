@@ -72,6 +72,15 @@ void led_Enable();
  */
 void led_Disable();
 
+/**
+ * \fn led_Toggle
+ * 
+ * \brief Toggles the status led.
+ * 
+ * \return None
+ */
+void led_Toggle();
+
 /**
  * \fn led_Blink
  * 
@@ -46,16 +46,63 @@
 #define EPS_UART_RX_PIN     GPIO_PIN5
 
 /**
- * \fn eps_UART_Init
+ * \defgroup eps_frame EPS frame
+ * \ingroup eps_uart
+ * 
+ * \brief Battery frame sent by the EPS to the beacon (eps/eps_timer_test.c, make_frame()).
+ * 
+ * Structure: "{{{" + Vbat1 (MSB, LSB) + Vbat2 (MSB, LSB) + "}" + "\n\r"
+ * 
+ * \{
+ */
+#define EPS_FRAME_SOF       '{'     /**< Start of frame (3 times) */
+#define EPS_FRAME_SOF_LEN   3       /**< Bytes of the start of frame */
+#define EPS_FRAME_DATA_LEN  4       /**< Data bytes */
+#define EPS_FRAME_EOF       '}'     /**< End of frame (followed by "\n\r") */
+//! \} End of eps_frame
+
+/**
+ * \struct EPSBatteryData
+ * 
+ * \brief Last battery state received from the EPS.
+ * 
+ * The voltages are raw ADC values (4,886 mV/LSB).
+ * 
+ */
+typedef struct
+{
+    uint16_t bat1_voltage;          /**< Battery 1 voltage (raw) */
+    uint16_t bat2_voltage;          /**< Battery 2 voltage (raw) */
+    uint16_t frames;                /**< Frames received since UART_EPS_Init() (wraps from 0xFFFF to 1) */
+} EPSBatteryData;
+
+/**
+ * \fn UART_EPS_Init
  * 
  * \brief Initialization of the EPS UART (USCI_A0)
  * 
+ * The frames from the EPS are received by the USCI_A0 RX interrupt.
+ * 
  * \return Initialization status. It can be:
  *      - \b STATUS_SUCCESS
  *      - \b STATUS_FAIL
  *      .
  */
-uint8_t eps_UART_Init();
+uint8_t UART_EPS_Init();
+
+/**
+ * \fn UART_EPS_GetBattery
+ * 
+ * \brief Gets the last battery state received from the EPS.
+ * 
+ * \param data is where the battery state is copied.
+ * 
+ * \return Status. It can be:
+ *      - \b STATUS_SUCCESS
+ *      - \b STATUS_FAIL if no frame was received yet.
+ *      .
+ */
+uint8_t UART_EPS_GetBattery(EPSBatteryData *data);
 
 #endif // UART_EPS_H_
 
@@ -55,10 +55,10 @@
 #include "inc/cc11xx.h"
 #include "inc/rf-switch.h"
 #include "inc/rf6886.h"
-//#include "inc/uart-eps.h"
+#include "inc/uart-eps.h"
 #include "inc/delay.h"
-
-#define TX_MESSAGE "FloripaSat"     /**< Message to transmit. */
+#include "inc/beacon.h"
+#include "inc/events.h"
 
 /**
  * \fn main
@@ -66,7 +66,8 @@
  * \brief The main function.
  * 
  * After the initializations of the periphericals,
- * the program stays running in infinite loop.
+ * the program stays running in infinite loop, sleeping
+ * in LPM3 between events (See events.h).
  * 
  * \return None
  */
@@ -91,14 +92,16 @@ void main()
     led_Enable();
 #endif // DEBUG_MODE
     
-/*    
     // UART for EPS data
     while(UART_EPS_Init() != STATUS_SUCCESS)
     {
         // Blinking system LED if something is wrong
         led_Blink(4000);
     }
-*/    
+
+    // The SPI transfers to the CC1175 are interrupt/DMA driven (See cc11xx_spi.h)
+    __enable_interrupt();
+
     cc11xx_Init();
 
     // Calibrate radio (See "CC112X, CC1175 Silicon Errata")
@@ -111,35 +114,41 @@ void main()
         led_Blink(3000);
     }
 
-    rf6886_Enable();
-
-    rf6886_SetVreg(3.1);   // DAC output = 3,1V
-
     rf_switch_Init();
-    
-    rf_switch_Enable();
 
-    // Data to send
-    uint8_t tx_buffer[] = TX_MESSAGE;
+    // PA and RF switch off, powered by the scheduler around each packet
+    beacon_Init();
+
+    // RTC tick and end of packet interrupts
+    while(events_Init() != STATUS_SUCCESS)
+    {
+        // Blinking system LED if something is wrong
+        led_Blink(5000);
+    }
 
     // Infinite loop
     while(1)
     {
+        // LPM3 until the next event
+        uint8_t events = events_Wait();
+
 #if DEBUG_MODE == false
         WDT_A_resetTimer(WDT_A_BASE);
 #endif // DEBUG_MODE
 
-        // Flush the TX FIFO
-        cc11xx_CmdStrobe(CC11XX_SFTX);
-
-        // Write packet to TX FIFO
-        cc11xx_WriteTXFIFO(tx_buffer, sizeof(tx_buffer));
+        if (events & EVENTS_TX_END)
+        {
+            beacon_TxEnd();
+        }
 
-        // Enable TX (Command strobe)
-        cc11xx_CmdStrobe(CC11XX_STX);
+        if (events & EVENTS_RTC_TICK)
+        {
+            // Packet every BEACON_PERIOD_S seconds (payload rotation in beacon.h)
+            beacon_Tick();
 
-        // Heartbeat
-        led_Blink(100);
+            // Heartbeat
+            led_Toggle();
+        }
     }
 }
 
@@ -0,0 +1,344 @@
+/*
+ * beacon.c
+ *
+ * Copyright (C) 2016, Universidade Federal de Santa Catarina
+ *
+ * This file is part of FloripaSat-TTC.
+ *
+ * FloripaSat-TTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FloripaSat-TTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FloripaSat-TTC.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file beacon.c
+ *
+ * \brief Beacon scheduler (implementation)
+ *
+ * \version 1.0-dev
+ *
+ * \date 17/10/2026
+ *
+ * \addtogroup beacon_sched
+ * \{
+ */
+
+#include <string.h>
+
+#include "../inc/beacon.h"
+#include "../inc/cc11xx.h"
+#include "../inc/cc11xx_stream.h"
+#include "../inc/rf6886.h"
+#include "../inc/rf-switch.h"
+#include "../inc/uart-eps.h"
+#include "../inc/events.h"
+
+#if DEBUG_MODE == true
+#include "../inc/debug.h"
+#endif // DEBUG_MODE
+
+#pragma NOINIT(beacon_resets)
+static BeaconResets beacon_resets;                  // Kept across resets
+
+static const uint8_t beacon_rotation[] = BEACON_ROTATION;
+
+static uint32_t beacon_uptime = 0;                  // Seconds since the last reset
+static uint16_t beacon_next_tx = 0;                 // Seconds to the next packet
+static uint8_t beacon_rotation_pos = 0;             // Next entry of beacon_rotation
+static uint8_t beacon_packet_counter = 0;
+static uint8_t beacon_tx_timeout = 0;               // Ticks left to the end of the running transmission (0 = none)
+
+static uint16_t beacon_eps_frames = 0;              // EPS frames seen
+static uint8_t beacon_eps_age = BEACON_EPS_AGE_MAX; // Seconds since the last EPS frame
+
+void beacon_Init()
+{
+#if DEBUG_MODE == true
+    debug_PrintMsg("beacon_Init()");
+#endif // DEBUG_MODE
+
+    uint16_t cause = SYSRSTIV;      // Highest priority reset cause
+
+    while(SYSRSTIV != SYSRSTIV_NONE);   // Clears the other pending ones
+
+    if (beacon_resets.magic != BEACON_RESETS_MAGIC)
+    {
+        beacon_resets.magic     = BEACON_RESETS_MAGIC;
+        beacon_resets.power_on  = 0;
+        beacon_resets.watchdog  = 0;
+        beacon_resets.other     = 0;
+    }
+
+    switch(cause)
+    {
+        case SYSRSTIV_BOR:
+        case SYSRSTIV_SVSL:
+        case SYSRSTIV_SVSH:
+            beacon_resets.power_on++;
+            break;
+        case SYSRSTIV_WDTTO:
+        case SYSRSTIV_WDTKEY:
+            beacon_resets.watchdog++;
+            break;
+        default:
+            beacon_resets.other++;
+            break;
+    }
+
+    beacon_uptime = 0;
+    beacon_next_tx = 0;             // First packet at the first tick
+    beacon_rotation_pos = 0;
+    beacon_tx_timeout = 0;
+
+    rf6886_Disable();
+    rf_switch_Disable();
+
+#if DEBUG_MODE == true
+    debug_PrintByte("\tReset cause: ", (uint8_t)cause);
+    debug_PrintMsg("End of beacon_Init()\n");
+#endif // DEBUG_MODE
+}
+
+/**
+ * \fn beacon_PAOn
+ *
+ * \brief Start of a transmission: RF switch to the beacon, Vreg1/2 up (the RF drive comes with STX).
+ *
+ * The settling time of the PA runs on Timer_A1: STX must wait for events_TimerWait().
+ *
+ * \param timeout is the number of ticks before the transmission is aborted (See beacon_Tick()).
+ *
+ * \return None
+ */
+static void beacon_PAOn(uint8_t timeout)
+{
+    rf_switch_Enable();
+    rf6886_Enable();
+    rf6886_SetVreg(BEACON_PA_VREG);
+    events_TimerStart(BEACON_PA_SETTLING_TICKS);
+
+    // The PA is turned off on the end of packet event (beacon_TxEnd()) or the timeout (beacon_Tick())
+    beacon_tx_timeout = timeout;
+}
+
+/**
+ * \fn beacon_PAOff
+ *
+ * \brief End of a transmission: RF drive removed (IDLE), Vreg1/2 down, RF switch off.
+ *
+ * \return None
+ */
+static void beacon_PAOff()
+{
+    rf6886_Disable();
+    rf_switch_Disable();
+
+    beacon_tx_timeout = 0;
+}
+
+void beacon_Tick()
+{
+    EPSBatteryData eps;
+
+    beacon_uptime++;
+
+    // Age of the EPS data
+    if ((UART_EPS_GetBattery(&eps) == STATUS_SUCCESS) && (eps.frames != beacon_eps_frames))
+    {
+        beacon_eps_frames = eps.frames;
+        beacon_eps_age = 0;
+    }
+    else if (beacon_eps_age < BEACON_EPS_AGE_MAX)
+    {
+        beacon_eps_age++;
+    }
+
+    // No end of packet event: the radio is forced back to IDLE
+    if ((beacon_tx_timeout > 0) && (--beacon_tx_timeout == 0))
+    {
+#if DEBUG_MODE == true
+        debug_PrintMsg("beacon_Tick(): TX timeout");
+#endif // DEBUG_MODE
+
+        cc11xx_CmdStrobe(CC11XX_SIDLE);
+        cc11xx_CmdStrobe(CC11XX_SFTX);
+        if (cc11xx_StreamActive())
+        {
+            cc11xx_StreamEnd();
+        }
+        beacon_PAOff();
+    }
+
+    if (beacon_next_tx > 0)
+    {
+        beacon_next_tx--;
+        return;
+    }
+
+    beacon_next_tx = BEACON_PERIOD_S - 1;
+    beacon_Transmit();
+}
+
+uint8_t beacon_BuildPacket(uint8_t *packet)
+{
+    EPSBatteryData eps;
+    uint8_t *p = packet + 1;        // After the length byte
+
+    memcpy(p, BEACON_ID, BEACON_ID_LEN);
+    p += BEACON_ID_LEN;
+
+    *p++ = beacon_rotation[beacon_rotation_pos];
+    *p++ = beacon_packet_counter++;
+
+    switch(beacon_rotation[beacon_rotation_pos])
+    {
+        case BEACON_PAYLOAD_EPS:
+            if (UART_EPS_GetBattery(&eps) == STATUS_FAIL)
+            {
+                eps.bat1_voltage = 0;
+                eps.bat2_voltage = 0;
+            }
+            *p++ = (uint8_t)(eps.bat1_voltage >> 8);
+            *p++ = (uint8_t)(eps.bat1_voltage & 0xFF);
+            *p++ = (uint8_t)(eps.bat2_voltage >> 8);
+            *p++ = (uint8_t)(eps.bat2_voltage & 0xFF);
+            *p++ = beacon_eps_age;
+            break;
+        case BEACON_PAYLOAD_UPTIME:
+            *p++ = (uint8_t)(beacon_uptime >> 24);
+            *p++ = (uint8_t)(beacon_uptime >> 16);
+            *p++ = (uint8_t)(beacon_uptime >> 8);
+            *p++ = (uint8_t)(beacon_uptime & 0xFF);
+            break;
+        case BEACON_PAYLOAD_RESETS:
+            *p++ = (uint8_t)(beacon_resets.power_on >> 8);
+            *p++ = (uint8_t)(beacon_resets.power_on & 0xFF);
+            *p++ = (uint8_t)(beacon_resets.watchdog >> 8);
+            *p++ = (uint8_t)(beacon_resets.watchdog & 0xFF);
+            *p++ = (uint8_t)(beacon_resets.other >> 8);
+            *p++ = (uint8_t)(beacon_resets.other & 0xFF);
+            break;
+    }
+
+    beacon_rotation_pos = (beacon_rotation_pos + 1) % sizeof(beacon_rotation);
+
+    // Variable packet length mode (PKT_CFG0): the first byte is the length of the rest
+    packet[0] = (uint8_t)(p - packet - 1);
+
+    return (uint8_t)(p - packet);
+}
+
+uint8_t beacon_Transmit()
+{
+#if DEBUG_MODE == true
+    debug_PrintMsg("beacon_Transmit()");
+#endif // DEBUG_MODE
+
+    uint8_t packet[BEACON_MAX_PACKET_LEN + 1];
+    uint8_t len;
+
+    if (beacon_tx_timeout > 0)
+    {
+#if DEBUG_MODE == true
+        debug_PrintMsg("\tFAIL! (TX running)");
+#endif // DEBUG_MODE
+
+        return STATUS_FAIL;
+    }
+
+    len = beacon_BuildPacket(packet);
+
+    beacon_PAOn(BEACON_TX_TIMEOUT_S);
+
+    // The FIFO is written while the PA settles
+    cc11xx_CmdStrobe(CC11XX_SFTX);
+    cc11xx_WriteTXFIFO(packet, len);
+    events_TimerWait();
+    cc11xx_CmdStrobe(CC11XX_STX);
+
+#if DEBUG_MODE == true
+    debug_PrintByte("\tPacket length: ", len);
+    debug_PrintMsg("End of beacon_Transmit()\n");
+#endif // DEBUG_MODE
+
+    return STATUS_SUCCESS;
+}
+
+uint16_t beacon_Stream(uint16_t len, const uint8_t *pData, uint16_t n)
+{
+#if DEBUG_MODE == true
+    debug_PrintMsg("beacon_Stream()");
+#endif // DEBUG_MODE
+
+    if ((beacon_tx_timeout > 0) || (len == 0) || (len > CC11XX_STREAM_MAX_LEN))
+    {
+#if DEBUG_MODE == true
+        debug_PrintMsg("\tFAIL!");
+#endif // DEBUG_MODE
+
+        return 0;
+    }
+
+    // Air time (length header, preamble, sync word and CRC included) plus the timeout of a packet
+    beacon_PAOn(BEACON_TX_TIMEOUT_S + (uint8_t)((uint32_t)(len + BEACON_STREAM_OVERHEAD)*8/BEACON_BPS));
+    events_TimerWait();
+
+    n = cc11xx_StreamStart(len, pData, n);
+    if (n == 0)
+    {
+        beacon_PAOff();
+    }
+
+#if DEBUG_MODE == true
+    debug_PrintMsg("End of beacon_Stream()\n");
+#endif // DEBUG_MODE
+
+    return n;
+}
+
+uint8_t beacon_TxEnd()
+{
+    uint8_t status = STATUS_SUCCESS;
+
+    // Edge with no transmission running (SIDLE after a timeout, for example)
+    if (beacon_tx_timeout == 0)
+    {
+        return STATUS_FAIL;
+    }
+
+#if DEBUG_MODE == true
+    debug_PrintMsg("beacon_TxEnd()");
+#endif // DEBUG_MODE
+
+    if (cc11xx_StreamActive())
+    {
+        status = cc11xx_StreamEnd();
+    }
+    // GPIO2 also de-asserts on a TX FIFO underflow
+    else if ((cc11xx_CmdStrobe(CC11XX_SNOP) & 0x70) == CC11XX_STATE_TX_FIFO_ERROR)
+    {
+        cc11xx_CmdStrobe(CC11XX_SFTX);
+        status = STATUS_FAIL;
+    }
+
+    beacon_PAOff();
+
+#if DEBUG_MODE == true
+    debug_PrintMsg((status == STATUS_SUCCESS) ? "\tSUCCESS!" : "\tFAIL!");
+    debug_PrintMsg("End of beacon_TxEnd()\n");
+#endif // DEBUG_MODE
+
+    return status;
+}
+
+//! \} End of beacon_sched group
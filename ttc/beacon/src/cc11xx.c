@@ -36,6 +36,8 @@
  */
 
 #include "../inc/cc11xx.h"
+#include "../inc/cc11xx_spi.h"
+#include "../inc/cc11xx_config.h"
 #include "../inc/cc11xx_floripasat_reg_config.h"
 #include "../inc/led.h"
 
@@ -82,25 +84,24 @@ void cc11xx_Init()
 #endif // DEBUG_MODE
 }
 
-void cc11xx_RegConfig()
+uint16_t cc11xx_RegConfig()
 {
 #if DEBUG_MODE == true
     debug_PrintMsg("cc11xx_RegConfig()");
 #endif // DEBUG_MODE
 
-    uint16_t i;
-    uint8_t write_byte;
-
     // Write registers settings to radio (Values in "cc11xx_floripasat_reg_config.h")
-    for(i=0; i<(sizeof(reg_values)/sizeof(RegistersSettings)); i++)
-    {
-        write_byte = reg_values[i].data;
-        cc11xx_WriteReg(reg_values[i].addr, &write_byte, sizeof(reg_values[i].data));
-    }
+    uint16_t digest = cc11xx_LoadConfig(reg_values, sizeof(reg_values)/sizeof(RegistersSettings));
 
 #if DEBUG_MODE == true
+    if (digest != cc11xx_ConfigDigest(reg_values, sizeof(reg_values)/sizeof(RegistersSettings)))
+    {
+        debug_PrintMsg("> Registers readback FAIL!");
+    }
     debug_PrintMsg("End of cc11xx_RegConfig()\n");
 #endif // DEBUG_MODE
+
+    return digest;
 }
 
 uint8_t cc11xx_WriteReg(uint16_t addr, uint8_t *pData, uint8_t len)
@@ -192,31 +193,7 @@ uint8_t cc11xx_CmdStrobe(uint8_t cmd)
     debug_PrintByte("\tcmd = ", cmd);
 #endif // DEBUG_MODE
 
-    uint8_t chip_status;
-
-    GPIO_setOutputLowOnPin(GPIO_PORT_P2, GPIO_PIN0);   // P2.0 = CSn = 0
-
-    while(GPIO_getInputPinValue(GPIO_PORT_P2, GPIO_PIN2) == GPIO_INPUT_PIN_HIGH)
-    {
-        
-    }
-
-    USCI_B_SPI_clearInterrupt(USCI_B0_BASE, USCI_B_SPI_RECEIVE_INTERRUPT);
-    USCI_B_SPI_transmitData(USCI_B0_BASE, cmd);
-
-#if DEBUG_MODE == true
-    debug_PrintByte("Transmited command: ", cmd);
-#endif // DEBUG_MODE
-
-    // Wait until new data was written into RX buffer
-    while(!USCI_B_SPI_getInterruptStatus(USCI_B0_BASE, USCI_B_SPI_RECEIVE_INTERRUPT))
-    {
-        
-    }
-
-    chip_status = USCI_B_SPI_receiveData(USCI_B0_BASE);
-
-    GPIO_setOutputHighOnPin(GPIO_PORT_P2, GPIO_PIN0);   // P2.0 = CSn = 1
+    uint8_t chip_status = cc11xx_SPI_Transfer(0x00, cmd, NULL, 0);
 
 #if DEBUG_MODE == true
     debug_PrintByte("Chip status: ", chip_status);
@@ -236,43 +213,7 @@ uint8_t cc11xx_8BitRegAccess(uint8_t access_type, uint8_t addr_byte, uint8_t *pD
     debug_PrintByte("\tlen = ", len);
 #endif // DEBUG_MODE
 
-	uint8_t read_value = 0;
-    uint8_t header_byte = access_type | addr_byte;
-
-	// Pull CSn low
-	GPIO_setOutputLowOnPin(CC11XX_CSN_PORT, CC11XX_CSN_PIN);
-    
-    // Wait for MISO (or SO) to go low before communication starts
-    while(GPIO_getInputPinValue(CC11XX_MISO_PORT, CC11XX_MISO_PIN) == GPIO_INPUT_PIN_HIGH)
-    {
-        
-    }
-
-    // Send register address byte
-    USCI_B_SPI_clearInterrupt(USCI_B0_BASE, USCI_B_SPI_RECEIVE_INTERRUPT);
-    USCI_B_SPI_transmitData(USCI_B0_BASE, header_byte);
-
-#if DEBUG_MODE == true
-    debug_PrintByte("Transmited header byte: ", header_byte);
-#endif // DEBUG_MOD
-
-    // Wait until new data was written into RX buffer
-    while(!USCI_B_SPI_getInterruptStatus(USCI_B0_BASE, USCI_B_SPI_RECEIVE_INTERRUPT))
-    {
-        
-    }
-
-    // Storing chip status
-	read_value = USCI_B_SPI_receiveData(USCI_B0_BASE);
-
-#if DEBUG_MODE == true
-    debug_PrintByte("Chip status: ", read_value);
-#endif // DEBUG_MODE
-    
-	cc11xx_ReadWriteBurstSingle(header_byte, pData, len);
-	
-    // CSn = high after transfers
-    GPIO_setOutputHighOnPin(CC11XX_CSN_PORT, CC11XX_CSN_PIN);
+    uint8_t read_value = cc11xx_SPI_Transfer(access_type, addr_byte, pData, len);
 
 #if DEBUG_MODE == true
     debug_PrintByte("Chip status: ", read_value);
@@ -280,121 +221,7 @@ uint8_t cc11xx_8BitRegAccess(uint8_t access_type, uint8_t addr_byte, uint8_t *pD
 #endif // DEBUG_MODE
 
     // Return the status byte value
-	return read_value;
-}
-
-void cc11xx_ReadWriteBurstSingle(uint8_t header, uint8_t *pData, uint16_t len)
-{
-#if DEBUG_MODE == true
-    debug_PrintMsg("cc11xx_ReadWriteBurstSingle()");
-    debug_PrintByte("\theader = ", header);
-    debug_PrintByte("\tpData = ", *pData);
-    debug_PrintByte("\tlen = ", len);
-#endif // DEBUG_MODE
-
-    uint16_t i;
-    
-    // Communicate len number of bytes: if RX - the procedure sends 0x00 to push bytes from slave
-    if (header & CC11XX_READ_ACCESS)
-    {
-        if (header & CC11XX_BURST_ACCESS)
-        {
-            for(i=0; i<len; i++)
-            {
-                // ????????????????????????????????????????????????????????????????????????????????????
-                // Possible to combining read and write as one access type ????????????????????????????
-                // ????????????????????????????????????????????????????????????????????????????????????
-
-                // Wait until new data was written into RX buffer
-                while(!USCI_B_SPI_getInterruptStatus(USCI_B0_BASE, USCI_B_SPI_RECEIVE_INTERRUPT))
-                {
-                    
-                }
-                USCI_B_SPI_transmitData(USCI_B0_BASE, 0);   // ????????????????????????????????????????
-
-#if DEBUG_MODE == true
-                debug_PrintByte("Transmited data (Read cmd.): ", 0x00);
-#endif // DEBUG_MODE
-                
-                // Wait until new data was written into RX buffer
-                while(!USCI_B_SPI_getInterruptStatus(USCI_B0_BASE, USCI_B_SPI_RECEIVE_INTERRUPT))
-                {
-                    
-                }
-
-                *pData = USCI_B_SPI_receiveData(USCI_B0_BASE);  // Store pData from last pData RX
-
-#if DEBUG_MODE == true
-                debug_PrintByte("Received data (Reg. value): ", *pData);
-#endif // DEBUG_MODE
-
-                pData++;
-            }
-        }
-        else    // CC11XX_SINGLE_ACCESS
-        {
-            USCI_B_SPI_clearInterrupt(USCI_B0_BASE, USCI_B_SPI_RECEIVE_INTERRUPT);
-            USCI_B_SPI_transmitData(USCI_B0_BASE, 0);
-
-#if DEBUG_MODE == true
-            debug_PrintByte("Transmited data (Read cmd.): ", 0x00);
-#endif // DEBUG_MODE
-
-            // Wait until new data was written into RX buffer
-            while(!USCI_B_SPI_getInterruptStatus(USCI_B0_BASE, USCI_B_SPI_RECEIVE_INTERRUPT))
-            {
-                
-            }
-            
-            *pData = USCI_B_SPI_receiveData(USCI_B0_BASE);
-            
-#if DEBUG_MODE == true
-            debug_PrintByte("Received data (Reg. value): ", *pData);
-#endif // DEBUG_MODE
-        }
-    }
-    else    // CC11XX_WRITE_ACCESS
-    {
-        if (header & CC11XX_BURST_ACCESS)
-        {
-            // Communicate len number of bytes: if TX - the procedure doesn't overwrite pData
-            for(i=0; i<len; i++)
-            {
-                USCI_B_SPI_clearInterrupt(USCI_B0_BASE, USCI_B_SPI_RECEIVE_INTERRUPT);
-                USCI_B_SPI_transmitData(USCI_B0_BASE, *pData);                
-
-#if DEBUG_MODE == true
-                debug_PrintByte("Transmited data (Reg. value): ", *pData);
-#endif // DEBUG_MODE
-                
-                // Wait until new data was written into RX buffer
-                while(!USCI_B_SPI_getInterruptStatus(USCI_B0_BASE, USCI_B_SPI_RECEIVE_INTERRUPT))
-                {
-                    
-                }
-                pData++;
-            }
-        }
-        else    // CC11XX_SINGLE_ACCESS
-        {
-            USCI_B_SPI_clearInterrupt(USCI_B0_BASE, USCI_B_SPI_RECEIVE_INTERRUPT);
-            USCI_B_SPI_transmitData(USCI_B0_BASE, *pData);
-
-#if DEBUG_MODE == true
-            debug_PrintByte("Transmited data (Reg. value): ", *pData);
-#endif // DEBUG_MODE
-
-            // Wait until new data was written into RX buffer
-            while(!USCI_B_SPI_getInterruptStatus(USCI_B0_BASE, USCI_B_SPI_RECEIVE_INTERRUPT))
-            {
-                
-            }
-        }
-    }
-
-#if DEBUG_MODE == true
-    debug_PrintMsg("End of cc11xx_ReadWriteBurstSingle()\n");
-#endif // DEBUG_MODE
+    return read_value;
 }
 
 uint8_t cc11xx_16BitRegAccess(uint8_t access_type, uint8_t ext_addr, uint8_t reg_addr, uint8_t *pData, uint8_t len)
@@ -408,57 +235,7 @@ uint8_t cc11xx_16BitRegAccess(uint8_t access_type, uint8_t ext_addr, uint8_t reg
     debug_PrintByte("\tlen = ", len);
 #endif // DEBUG_MODE
 
-    uint8_t read_value = 0;
-    uint8_t header_byte = access_type | ext_addr;
-
-    // Pull CSn low to start transfer
-    GPIO_setOutputLowOnPin(CC11XX_CSN_PORT, CC11XX_CSN_PIN);
-    
-    // Wait for MISO (or SO) to go low before communication starts
-    while(GPIO_getInputPinValue(CC11XX_MISO_PORT, CC11XX_MISO_PIN) == GPIO_INPUT_PIN_HIGH)
-    {
-        
-    }
-    
-    // Send extended address byte with access type bits set
-    USCI_B_SPI_clearInterrupt(USCI_B0_BASE, USCI_B_SPI_RECEIVE_INTERRUPT);
-    USCI_B_SPI_transmitData(USCI_B0_BASE, header_byte);
-
-#if DEBUG_MODE == true
-    debug_PrintByte("Transmited data (Header byte): ", header_byte);
-#endif // DEBUG_MODE
-
-    // Wait until new data was written into RX buffer
-    while(!USCI_B_SPI_getInterruptStatus(USCI_B0_BASE, USCI_B_SPI_RECEIVE_INTERRUPT))
-    {
-        
-    }
-    
-    // Storing chip status
-    read_value = USCI_B_SPI_receiveData(USCI_B0_BASE);
-
-#if DEBUG_MODE == true
-    debug_PrintByte("Chip status: ", read_value);
-#endif // DEBUG_MODE
-    
-    USCI_B_SPI_clearInterrupt(USCI_B0_BASE, USCI_B_SPI_RECEIVE_INTERRUPT);
-    USCI_B_SPI_transmitData(USCI_B0_BASE, reg_addr);
-
-#if DEBUG_MODE == true
-    debug_PrintByte("Reg. address: ", reg_addr);
-#endif // DEBUG_MODE
-
-    // Wait until new data was written into RX buffer
-    while(!USCI_B_SPI_getInterruptStatus(USCI_B0_BASE, USCI_B_SPI_RECEIVE_INTERRUPT))
-    {
-        
-    }
-    
-    // Communicate len number of bytes
-    cc11xx_ReadWriteBurstSingle(header_byte, pData, len);
-    
-    // Pull CSn high after transfer
-    GPIO_setOutputHighOnPin(CC11XX_CSN_PORT, CC11XX_CSN_PIN);
+    uint8_t read_value = cc11xx_SPI_Transfer(access_type, ((uint16_t)ext_addr << 8) | reg_addr, pData, len);
 
 #if DEBUG_MODE == true
     debug_PrintByte("Chip status: ", read_value);
@@ -593,49 +370,4 @@ uint8_t cc11xx_WriteTXFIFO(uint8_t *pData, uint8_t len)
     return chip_status;
 }
 
-uint8_t cc11xx_SPI_Init()
-{
-#if DEBUG_MODE == true
-    debug_PrintMsg("SPI_Init()");
-#endif // DEBUG_MODE
-
-    // MISO, MOSI and SCLK init.
-    GPIO_setAsPeripheralModuleFunctionInputPin(CC11XX_SPI_PORT,
-                                               CC11XX_MISO_PIN + CC11XX_MOSI_PIN + CC11XX_SCLK_PIN);
-    
-    // CSn init.
-    GPIO_setAsOutputPin(CC11XX_CSN_PORT, CC11XX_CSN_PIN);
-	GPIO_setOutputHighOnPin(CC11XX_CSN_PORT, CC11XX_CSN_PIN);   // CSn must be kept low during SPI transfers
-    
-    // Config. SPI as Master
-    USCI_B_SPI_initMasterParam spi_params = {0};
-    spi_params.selectClockSource     = USCI_B_SPI_CLOCKSOURCE_SMCLK;
-    spi_params.clockSourceFrequency  = UCS_getSMCLK();
-    spi_params.desiredSpiClock       = SPICLK;
-    spi_params.msbFirst              = USCI_B_SPI_MSB_FIRST;
-    spi_params.clockPhase            = USCI_B_SPI_PHASE_DATA_CHANGED_ONFIRST_CAPTURED_ON_NEXT;
-    spi_params.clockPolarity         = USCI_B_SPI_CLOCKPOLARITY_INACTIVITY_HIGH;
-
-    // SPI initialization
-    if (USCI_B_SPI_initMaster(USCI_B0_BASE, &spi_params) == STATUS_FAIL)
-    {
-#if DEBUG_MODE == true
-        debug_PrintMsg("\tFAIL!");
-#endif // DEBUG_MODE
-
-        return STATUS_FAIL;
-    }
-    else
-    {
-        // Enable SPI module
-        USCI_B_SPI_enable(USCI_B0_BASE);
-        
-#if DEBUG_MODE == true
-        debug_PrintMsg("\tSUCCESS!");
-#endif // DEBUG_MODE
-
-        return STATUS_SUCCESS;
-    }
-}
-
 //! \} End of CC1175 implementation group
@@ -0,0 +1,295 @@
+/*
+ * cc11xx_config.c
+ *
+ * Copyright (C) 2016, Universidade Federal de Santa Catarina
+ *
+ * This file is part of FloripaSat-TTC.
+ *
+ * FloripaSat-TTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FloripaSat-TTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FloripaSat-TTC.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file cc11xx_config.c
+ *
+ * \brief Burst loading of register settings tables into the cc11xx (implementation)
+ *
+ * \version 1.0-dev
+ *
+ * \date 17/10/2026
+ *
+ * \addtogroup cc11xx_config
+ * \{
+ */
+
+#include "../inc/cc11xx_config.h"
+#include "../inc/cc11xx_spi.h"
+
+#if DEBUG_MODE == true
+#include "../inc/debug.h"
+#endif // DEBUG_MODE
+
+/**
+ * \fn cc11xx_IsConfigReg
+ *
+ * \brief Checks if an address is a configuration register (with a known reset value).
+ *
+ * \param addr is the register address (0x2Fxx in the extended space).
+ *
+ * \return true or false.
+ */
+static bool cc11xx_IsConfigReg(uint16_t addr)
+{
+    if ((addr >> 8) == CC11XX_EXT_ADDR)
+    {
+        return (addr & 0x00FF) < CC11XX_CONFIG_EXT_REGS;
+    }
+
+    return addr < CC11XX_CONFIG_REGS;
+}
+
+/**
+ * \fn cc11xx_IsResetValue
+ *
+ * \brief Checks if a setting is the reset value of a configuration register.
+ *
+ * \param s is the setting.
+ *
+ * \return true or false.
+ */
+static bool cc11xx_IsResetValue(const RegistersSettings *s)
+{
+    if (!cc11xx_IsConfigReg(s->addr))
+    {
+        return false;
+    }
+
+    if ((s->addr >> 8) == CC11XX_EXT_ADDR)
+    {
+        return cc11xx_ext_reset_values[s->addr & 0x00FF] == s->data;
+    }
+
+    return cc11xx_reset_values[s->addr] == s->data;
+}
+
+/**
+ * \fn cc11xx_RunLength
+ *
+ * \brief Number of entries, from the first one, with consecutive addresses in the same register space.
+ *
+ * \param settings is the first entry.
+ * \param n is the number of entries left in the table.
+ * \param config_only stops the run at the first entry that is not a configuration register.
+ *
+ * \return The run length (1 to CC11XX_CONFIG_MAX_BURST).
+ */
+static uint16_t cc11xx_RunLength(const RegistersSettings *settings, uint16_t n, bool config_only)
+{
+    uint16_t len = 1;
+
+    while((len < n) && (len < CC11XX_CONFIG_MAX_BURST))
+    {
+        if ((settings[len].addr != settings[len-1].addr + 1) || ((settings[len].addr >> 8) != (settings[0].addr >> 8)))
+        {
+            break;
+        }
+        if (config_only && !cc11xx_IsConfigReg(settings[len].addr))
+        {
+            break;
+        }
+        len++;
+    }
+
+    return len;
+}
+
+/**
+ * \fn cc11xx_CRC16
+ *
+ * \brief One byte of CRC-16-CCITT (0x1021).
+ *
+ * \param crc is the current CRC value.
+ * \param byte is the new byte.
+ *
+ * \return The updated CRC value.
+ */
+static uint16_t cc11xx_CRC16(uint16_t crc, uint8_t byte)
+{
+    uint8_t i;
+
+    crc ^= (uint16_t)byte << 8;
+    for(i=0; i<8; i++)
+    {
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+
+    return crc;
+}
+
+/**
+ * \fn cc11xx_WriteConfig
+ *
+ * \brief Writes a settings table with burst accesses.
+ *
+ * \param settings is the table.
+ * \param n is the number of entries.
+ * \param skip_reset skips the entries equal to the reset value (See cc11xx_LoadConfig()).
+ *
+ * \return Number of burst accesses.
+ */
+static uint16_t cc11xx_WriteConfig(const RegistersSettings *settings, uint16_t n, bool skip_reset)
+{
+    uint8_t buffer[CC11XX_CONFIG_MAX_BURST];
+    uint16_t i, j, k, run, first, last;
+    uint16_t accesses = 0;
+
+    for(i=0; i<n; i+=run)
+    {
+        run = cc11xx_RunLength(&settings[i], n - i, false);
+
+        j = i;
+        while(j < i + run)
+        {
+            if (skip_reset && cc11xx_IsResetValue(&settings[j]))
+            {
+                j++;
+                continue;
+            }
+
+            // Extends the burst to the last entry to write that is no more than CC11XX_CONFIG_MAX_GAP after the previous one
+            first = j;
+            last = j;
+            for(k=j+1; k<i+run; k++)
+            {
+                if (skip_reset && cc11xx_IsResetValue(&settings[k]))
+                {
+                    continue;
+                }
+                if (k - last - 1 > CC11XX_CONFIG_MAX_GAP)
+                {
+                    break;
+                }
+                last = k;
+            }
+
+            for(k=first; k<=last; k++)
+            {
+                buffer[k - first] = settings[k].data;
+            }
+            cc11xx_SPI_Transfer(CC11XX_BURST_ACCESS | CC11XX_WRITE_ACCESS, settings[first].addr, buffer, last - first + 1);
+            accesses++;
+
+            j = last + 1;
+        }
+    }
+
+    return accesses;
+}
+
+/**
+ * \fn cc11xx_ReadBackConfig
+ *
+ * \brief Reads back the configuration registers of a settings table with burst accesses.
+ *
+ * \param settings is the table.
+ * \param n is the number of entries.
+ * \param match is set to false if a register differs from the table.
+ *
+ * \return Digest of the values read (See cc11xx_ConfigDigest()).
+ */
+static uint16_t cc11xx_ReadBackConfig(const RegistersSettings *settings, uint16_t n, bool *match)
+{
+    uint8_t buffer[CC11XX_CONFIG_MAX_BURST];
+    uint16_t i, k, run;
+    uint16_t crc = 0xFFFF;
+
+    *match = true;
+
+    for(i=0; i<n; i+=run)
+    {
+        if (!cc11xx_IsConfigReg(settings[i].addr))
+        {
+            run = 1;
+            continue;
+        }
+
+        run = cc11xx_RunLength(&settings[i], n - i, true);
+        cc11xx_SPI_Transfer(CC11XX_BURST_ACCESS | CC11XX_READ_ACCESS, settings[i].addr, buffer, run);
+
+        for(k=0; k<run; k++)
+        {
+            crc = cc11xx_CRC16(crc, (uint8_t)(settings[i+k].addr >> 8));
+            crc = cc11xx_CRC16(crc, (uint8_t)(settings[i+k].addr & 0x00FF));
+            crc = cc11xx_CRC16(crc, buffer[k]);
+
+            if (buffer[k] != settings[i+k].data)
+            {
+                *match = false;
+            }
+        }
+    }
+
+    return crc;
+}
+
+uint16_t cc11xx_LoadConfig(const RegistersSettings *settings, uint16_t n)
+{
+#if DEBUG_MODE == true
+    debug_PrintMsg("cc11xx_LoadConfig()");
+#endif // DEBUG_MODE
+
+    uint16_t digest;
+    bool match;
+
+    cc11xx_WriteConfig(settings, n, true);
+    digest = cc11xx_ReadBackConfig(settings, n, &match);
+
+    if (!match)
+    {
+#if DEBUG_MODE == true
+        debug_PrintMsg("> Readback mismatch, writing all the registers");
+#endif // DEBUG_MODE
+
+        cc11xx_WriteConfig(settings, n, false);
+        digest = cc11xx_ReadBackConfig(settings, n, &match);
+    }
+
+#if DEBUG_MODE == true
+    debug_PrintByte("Digest (MSB): ", (uint8_t)(digest >> 8));
+    debug_PrintByte("Digest (LSB): ", (uint8_t)(digest & 0x00FF));
+    debug_PrintMsg("End of cc11xx_LoadConfig()\n");
+#endif // DEBUG_MODE
+
+    return digest;
+}
+
+uint16_t cc11xx_ConfigDigest(const RegistersSettings *settings, uint16_t n)
+{
+    uint16_t i;
+    uint16_t crc = 0xFFFF;
+
+    for(i=0; i<n; i++)
+    {
+        if (cc11xx_IsConfigReg(settings[i].addr))
+        {
+            crc = cc11xx_CRC16(crc, (uint8_t)(settings[i].addr >> 8));
+            crc = cc11xx_CRC16(crc, (uint8_t)(settings[i].addr & 0x00FF));
+            crc = cc11xx_CRC16(crc, settings[i].data);
+        }
+    }
+
+    return crc;
+}
+
+//! \} End of cc11xx_config group
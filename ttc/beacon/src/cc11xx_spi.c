@@ -0,0 +1,465 @@
+/*
+ * cc11xx_spi.c
+ *
+ * Copyright (C) 2016, Universidade Federal de Santa Catarina
+ *
+ * This file is part of FloripaSat-TTC.
+ *
+ * FloripaSat-TTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FloripaSat-TTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FloripaSat-TTC.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file cc11xx_spi.c
+ *
+ * \brief Interrupt/DMA driven SPI transfers to the cc11xx (implementation)
+ *
+ * \version 1.0-dev
+ *
+ * \date 17/10/2026
+ *
+ * \addtogroup cc11xx_spi
+ * \{
+ */
+
+#include "../inc/cc11xx_spi.h"
+
+#if DEBUG_MODE == true
+#include "../inc/debug.h"
+#endif // DEBUG_MODE
+
+#define CC11XX_SPI_QUEUE_MASK   (CC11XX_SPI_QUEUE_SIZE - 1)
+
+/**
+ * \enum SPIPhase
+ *
+ * \brief Step of the running transfer.
+ */
+typedef enum
+{
+    SPI_PHASE_IDLE = 0,         /**< Nothing on the bus (CSn high) */
+    SPI_PHASE_HEADER,           /**< Header byte sent, chip status coming */
+    SPI_PHASE_EXT_ADDR,         /**< Extended address sent */
+    SPI_PHASE_BYTES,            /**< Data phase, one byte per RX interrupt */
+    SPI_PHASE_DMA               /**< Data phase, DMA */
+} SPIPhase;
+
+static SPITransfer *spi_queue[CC11XX_SPI_QUEUE_SIZE];
+static volatile uint8_t spi_head = 0;          // Running transfer (advanced by the ISRs)
+static volatile uint8_t spi_tail = 0;          // Next free slot (advanced by cc11xx_SPI_Submit)
+static volatile SPIPhase spi_phase = SPI_PHASE_IDLE;
+static uint16_t spi_pos;                        // Data bytes exchanged (SPI_PHASE_BYTES)
+static uint16_t spi_len;                        // Data bytes of the running transfer
+static uint8_t spi_header;                      // Header byte of the running transfer
+static bool spi_starting = false;               // cc11xx_SPI_Next() running
+
+static uint8_t spi_dummy_rx;                    // RX DMA destination of the writes
+static const uint8_t spi_dummy_tx = 0x00;       // TX DMA source of the reads
+
+/**
+ * \fn cc11xx_SPI_Start
+ *
+ * \brief Pulls CSn low and sends the header byte of a transfer.
+ *
+ * \param t is the transfer.
+ *
+ * \return false if CHIP_RDYn did not go low within CC11XX_SPI_READY_POLLS (CSn is back high).
+ */
+static bool cc11xx_SPI_Start(SPITransfer *t)
+{
+    uint16_t polls = CC11XX_SPI_READY_POLLS;
+
+    spi_header = t->access | (uint8_t)(t->addr & 0x00FF);
+
+    if (t->addr >> 8)
+    {
+        spi_header = t->access | CC11XX_EXT_ADDR;
+    }
+
+    GPIO_setOutputLowOnPin(CC11XX_CSN_PORT, CC11XX_CSN_PIN);
+
+    // Wait for MISO (or SO) to go low (CHIP_RDYn) before communication starts
+    while(GPIO_getInputPinValue(CC11XX_MISO_PORT, CC11XX_MISO_PIN) == GPIO_INPUT_PIN_HIGH)
+    {
+        if (--polls == 0)
+        {
+            GPIO_setOutputHighOnPin(CC11XX_CSN_PORT, CC11XX_CSN_PIN);
+
+            return false;
+        }
+    }
+
+    spi_phase = SPI_PHASE_HEADER;
+
+    USCI_B_SPI_clearInterrupt(USCI_B0_BASE, USCI_B_SPI_RECEIVE_INTERRUPT);
+    USCI_B_SPI_enableInterrupt(USCI_B0_BASE, USCI_B_SPI_RECEIVE_INTERRUPT);
+    USCI_B_SPI_transmitData(USCI_B0_BASE, spi_header);
+
+    return true;
+}
+
+/**
+ * \fn cc11xx_SPI_Done
+ *
+ * \brief Marks the transfer at the head of the queue as done and calls its callback.
+ *
+ * \return None
+ */
+static void cc11xx_SPI_Done()
+{
+    SPITransfer *t = spi_queue[spi_head & CC11XX_SPI_QUEUE_MASK];
+
+    spi_phase = SPI_PHASE_IDLE;
+    spi_head++;
+
+    t->done = true;
+    if (t->callback)
+    {
+        t->callback(t);     // May submit the next transfer
+    }
+}
+
+/**
+ * \fn cc11xx_SPI_Next
+ *
+ * \brief Starts the oldest queued transfer if the bus is free.
+ *
+ * A transfer whose CHIP_RDYn wait times out is done at once, with
+ * CC11XX_STATUS_CHIP_RDYn_H as status and no data phase, and the next one is
+ * tried. The transfers submitted by the callbacks meanwhile are started by
+ * this loop, not by a nested call.
+ *
+ * \return None
+ */
+static void cc11xx_SPI_Next()
+{
+    if (spi_starting)
+    {
+        return;
+    }
+
+    spi_starting = true;
+    while((spi_phase == SPI_PHASE_IDLE) && (spi_head != spi_tail))
+    {
+        if (cc11xx_SPI_Start(spi_queue[spi_head & CC11XX_SPI_QUEUE_MASK]))
+        {
+            break;
+        }
+
+        spi_queue[spi_head & CC11XX_SPI_QUEUE_MASK]->status = CC11XX_STATUS_CHIP_RDYn_H;
+        cc11xx_SPI_Done();
+    }
+    spi_starting = false;
+}
+
+/**
+ * \fn cc11xx_SPI_Data
+ *
+ * \brief Starts the data phase of the running transfer.
+ *
+ * \param t is the transfer.
+ *
+ * \return true if there is no data phase (the transfer is done).
+ */
+static bool cc11xx_SPI_Data(SPITransfer *t)
+{
+    bool read = (spi_header & CC11XX_READ_ACCESS) != 0;
+
+    spi_len = t->len;
+    if (spi_len == 0)
+    {
+        return true;
+    }
+
+    // Single access: one data byte
+    if (!(spi_header & CC11XX_BURST_ACCESS))
+    {
+        spi_len = 1;
+    }
+
+    if (spi_len < CC11XX_SPI_DMA_MIN)
+    {
+        spi_phase = SPI_PHASE_BYTES;
+        spi_pos = 0;
+        USCI_B_SPI_transmitData(USCI_B0_BASE, read ? 0x00 : t->pData[0]);
+
+        return false;
+    }
+
+    spi_phase = SPI_PHASE_DMA;
+    USCI_B_SPI_disableInterrupt(USCI_B0_BASE, USCI_B_SPI_RECEIVE_INTERRUPT);
+
+    // RX channel: every byte received, into the data (read) or nowhere (write). Its end is the end of the transfer.
+    DMA_setSrcAddress(CC11XX_SPI_DMA_RX_CHANNEL, USCI_B_SPI_getReceiveBufferAddressForDMA(USCI_B0_BASE),
+                      DMA_DIRECTION_UNCHANGED);
+    if (read)
+    {
+        DMA_setDstAddress(CC11XX_SPI_DMA_RX_CHANNEL, (uintptr_t)t->pData, DMA_DIRECTION_INCREMENT);
+    }
+    else
+    {
+        DMA_setDstAddress(CC11XX_SPI_DMA_RX_CHANNEL, (uintptr_t)&spi_dummy_rx, DMA_DIRECTION_UNCHANGED);
+    }
+    DMA_setTransferSize(CC11XX_SPI_DMA_RX_CHANNEL, spi_len);
+    DMA_clearInterrupt(CC11XX_SPI_DMA_RX_CHANNEL);
+    DMA_enableInterrupt(CC11XX_SPI_DMA_RX_CHANNEL);
+    DMA_enableTransfers(CC11XX_SPI_DMA_RX_CHANNEL);
+
+    // TX channel: bytes 1..len-1, each time TXBUF moves to the shift register. Byte 0 is written below.
+    if (read)
+    {
+        DMA_setSrcAddress(CC11XX_SPI_DMA_TX_CHANNEL, (uintptr_t)&spi_dummy_tx, DMA_DIRECTION_UNCHANGED);
+    }
+    else
+    {
+        DMA_setSrcAddress(CC11XX_SPI_DMA_TX_CHANNEL, (uintptr_t)(t->pData + 1), DMA_DIRECTION_INCREMENT);
+    }
+    DMA_setDstAddress(CC11XX_SPI_DMA_TX_CHANNEL, USCI_B_SPI_getTransmitBufferAddressForDMA(USCI_B0_BASE),
+                      DMA_DIRECTION_UNCHANGED);
+    DMA_setTransferSize(CC11XX_SPI_DMA_TX_CHANNEL, spi_len - 1);
+    DMA_enableTransfers(CC11XX_SPI_DMA_TX_CHANNEL);
+
+    USCI_B_SPI_transmitData(USCI_B0_BASE, read ? 0x00 : t->pData[0]);
+
+    return false;
+}
+
+/**
+ * \fn cc11xx_SPI_Finish
+ *
+ * \brief Ends the running transfer and starts the next one.
+ *
+ * \return None
+ */
+static void cc11xx_SPI_Finish()
+{
+    USCI_B_SPI_disableInterrupt(USCI_B0_BASE, USCI_B_SPI_RECEIVE_INTERRUPT);
+    GPIO_setOutputHighOnPin(CC11XX_CSN_PORT, CC11XX_CSN_PIN);
+
+    cc11xx_SPI_Done();
+    cc11xx_SPI_Next();
+}
+
+uint8_t cc11xx_SPI_Init()
+{
+#if DEBUG_MODE == true
+    debug_PrintMsg("SPI_Init()");
+#endif // DEBUG_MODE
+
+    // MISO, MOSI and SCLK init.
+    GPIO_setAsPeripheralModuleFunctionInputPin(CC11XX_SPI_PORT,
+                                               CC11XX_MISO_PIN + CC11XX_MOSI_PIN + CC11XX_SCLK_PIN);
+
+    // CSn init.
+    GPIO_setAsOutputPin(CC11XX_CSN_PORT, CC11XX_CSN_PIN);
+    GPIO_setOutputHighOnPin(CC11XX_CSN_PORT, CC11XX_CSN_PIN);   // CSn must be kept low during SPI transfers
+
+    // Config. SPI as Master
+    USCI_B_SPI_initMasterParam spi_params = {0};
+    spi_params.selectClockSource     = USCI_B_SPI_CLOCKSOURCE_SMCLK;
+    spi_params.clockSourceFrequency  = UCS_getSMCLK();
+    spi_params.desiredSpiClock       = SPICLK;
+    spi_params.msbFirst              = USCI_B_SPI_MSB_FIRST;
+    spi_params.clockPhase            = USCI_B_SPI_PHASE_DATA_CHANGED_ONFIRST_CAPTURED_ON_NEXT;
+    spi_params.clockPolarity         = USCI_B_SPI_CLOCKPOLARITY_INACTIVITY_HIGH;
+
+    // SPI initialization
+    if (USCI_B_SPI_initMaster(USCI_B0_BASE, &spi_params) == STATUS_FAIL)
+    {
+#if DEBUG_MODE == true
+        debug_PrintMsg("\tFAIL!");
+#endif // DEBUG_MODE
+
+        return STATUS_FAIL;
+    }
+
+    // DMA channels: single byte transfers on the USCI_B0 flags
+    DMA_initParam dma_params = {0};
+    dma_params.transferModeSelect    = DMA_TRANSFER_SINGLE;
+    dma_params.transferSize          = 1;
+    dma_params.transferUnitSelect    = DMA_SIZE_SRCBYTE_DSTBYTE;
+    dma_params.triggerTypeSelect     = DMA_TRIGGER_RISINGEDGE;
+
+    dma_params.channelSelect         = CC11XX_SPI_DMA_RX_CHANNEL;
+    dma_params.triggerSourceSelect   = CC11XX_SPI_DMA_RX_TRIGGER;
+    DMA_init(&dma_params);
+
+    dma_params.channelSelect         = CC11XX_SPI_DMA_TX_CHANNEL;
+    dma_params.triggerSourceSelect   = CC11XX_SPI_DMA_TX_TRIGGER;
+    DMA_init(&dma_params);
+
+    spi_head = 0;
+    spi_tail = 0;
+    spi_phase = SPI_PHASE_IDLE;
+    spi_starting = false;
+
+    // Enable SPI module
+    USCI_B_SPI_enable(USCI_B0_BASE);
+
+#if DEBUG_MODE == true
+    debug_PrintMsg("\tSUCCESS!");
+#endif // DEBUG_MODE
+
+    return STATUS_SUCCESS;
+}
+
+uint8_t cc11xx_SPI_Submit(SPITransfer *t)
+{
+    uint16_t int_state = __get_interrupt_state();
+
+    __disable_interrupt();
+
+    if ((uint8_t)(spi_tail - spi_head) == CC11XX_SPI_QUEUE_SIZE)
+    {
+        __set_interrupt_state(int_state);
+
+        return STATUS_FAIL;
+    }
+
+    t->done = false;
+    spi_queue[spi_tail & CC11XX_SPI_QUEUE_MASK] = t;
+    spi_tail++;
+
+    // Bus free: start the oldest (t, unless called from a callback with transfers still queued)
+    cc11xx_SPI_Next();
+
+    __set_interrupt_state(int_state);
+
+    return STATUS_SUCCESS;
+}
+
+void cc11xx_SPI_Wait(SPITransfer *t)
+{
+    uint16_t int_state = __get_interrupt_state();
+
+    // The check and the sleep must be atomic: the end of the transfer could come in between
+    __disable_interrupt();
+    while(!t->done)
+    {
+        __bis_SR_register(LPM0_bits + GIE);
+        __disable_interrupt();
+    }
+    __set_interrupt_state(int_state);
+}
+
+uint8_t cc11xx_SPI_Transfer(uint8_t access, uint16_t addr, uint8_t *pData, uint16_t len)
+{
+    SPITransfer t = {0};
+    uint16_t int_state = __get_interrupt_state();
+
+    t.access = access;
+    t.addr   = addr;
+    t.pData  = pData;
+    t.len    = len;
+
+    // Queue full: sleep until a transfer ends (atomically, as in cc11xx_SPI_Wait())
+    __disable_interrupt();
+    while(cc11xx_SPI_Submit(&t) != STATUS_SUCCESS)
+    {
+        __bis_SR_register(LPM0_bits + GIE);
+        __disable_interrupt();
+    }
+
+    cc11xx_SPI_Wait(&t);
+    __set_interrupt_state(int_state);
+
+    return t.status;
+}
+
+bool cc11xx_SPI_Busy()
+{
+    return spi_head != spi_tail;
+}
+
+/**
+ * \fn cc11xx_SPI_USCI_ISR
+ *
+ * \brief USCI_B0 RX interrupt: header bytes and short data phases.
+ *
+ * \return None
+ */
+#pragma vector=USCI_B0_VECTOR
+__interrupt void cc11xx_SPI_USCI_ISR()
+{
+    SPITransfer *t = spi_queue[spi_head & CC11XX_SPI_QUEUE_MASK];
+    uint8_t rx = USCI_B_SPI_receiveData(USCI_B0_BASE);     // Clears UCRXIFG
+    bool done = false;
+
+    switch(spi_phase)
+    {
+        case SPI_PHASE_HEADER:
+            t->status = rx;
+            if (t->addr >> 8)
+            {
+                spi_phase = SPI_PHASE_EXT_ADDR;
+                USCI_B_SPI_transmitData(USCI_B0_BASE, (uint8_t)(t->addr & 0x00FF));
+            }
+            else
+            {
+                done = cc11xx_SPI_Data(t);
+            }
+            break;
+        case SPI_PHASE_EXT_ADDR:
+            done = cc11xx_SPI_Data(t);
+            break;
+        case SPI_PHASE_BYTES:
+            if (spi_header & CC11XX_READ_ACCESS)
+            {
+                t->pData[spi_pos] = rx;
+            }
+            spi_pos++;
+            if (spi_pos < spi_len)
+            {
+                USCI_B_SPI_transmitData(USCI_B0_BASE, (spi_header & CC11XX_READ_ACCESS) ? 0x00 : t->pData[spi_pos]);
+            }
+            else
+            {
+                done = true;
+            }
+            break;
+        default:
+            break;
+    }
+
+    if (done)
+    {
+        cc11xx_SPI_Finish();
+        __bic_SR_register_on_exit(LPM0_bits);
+    }
+}
+
+/**
+ * \fn cc11xx_SPI_DMA_ISR
+ *
+ * \brief DMA interrupt: end of a DMA data phase.
+ *
+ * \return None
+ */
+#pragma vector=DMA_VECTOR
+__interrupt void cc11xx_SPI_DMA_ISR()
+{
+    if (DMA_getInterruptStatus(CC11XX_SPI_DMA_RX_CHANNEL) == DMA_INT_ACTIVE)
+    {
+        DMA_clearInterrupt(CC11XX_SPI_DMA_RX_CHANNEL);
+        DMA_disableInterrupt(CC11XX_SPI_DMA_RX_CHANNEL);
+
+        if (spi_phase == SPI_PHASE_DMA)
+        {
+            cc11xx_SPI_Finish();
+            __bic_SR_register_on_exit(LPM0_bits);
+        }
+    }
+}
+
+//! \} End of cc11xx_spi implementation group
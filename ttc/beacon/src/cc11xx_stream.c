@@ -0,0 +1,321 @@
+/*
+ * cc11xx_stream.c
+ *
+ * Copyright (C) 2016, Universidade Federal de Santa Catarina
+ *
+ * This file is part of FloripaSat-TTC.
+ *
+ * FloripaSat-TTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FloripaSat-TTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FloripaSat-TTC.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file cc11xx_stream.c
+ *
+ * \brief Transmission of packets longer than the cc11xx TX FIFO (implementation)
+ *
+ * \version 1.0-dev
+ *
+ * \date 17/10/2026
+ *
+ * \addtogroup cc11xx_stream
+ * \{
+ */
+
+#include "../inc/cc11xx_stream.h"
+#include "../inc/cc11xx_spi.h"
+
+#if DEBUG_MODE == true
+#include "../inc/debug.h"
+#endif // DEBUG_MODE
+
+#define CC11XX_STREAM_RING_MASK     (CC11XX_STREAM_RING_SIZE - 1)
+#define CC11XX_STREAM_SAVED_REGS    4
+
+static const uint16_t stream_regs[CC11XX_STREAM_SAVED_REGS] = {CC11XX_IOCFG0, CC11XX_FIFO_CFG, CC11XX_PKT_CFG0, CC11XX_PKT_LEN};
+static uint8_t stream_saved[CC11XX_STREAM_SAVED_REGS];      // Values before cc11xx_StreamStart()
+
+static uint8_t stream_ring[CC11XX_STREAM_RING_SIZE];
+static volatile uint16_t stream_head = 0;                   // Packet bytes given to the ring buffer
+static volatile uint16_t stream_tail = 0;                   // Packet bytes written to the TX FIFO
+static uint16_t stream_total = 0;                           // Packet bytes (length header included)
+
+static volatile bool stream_active = false;
+static volatile bool stream_busy = false;                   // Refill queued on the SPI engine
+static bool stream_fixed = false;                           // Fixed packet length mode set
+
+static SPITransfer stream_refill;
+static SPITransfer stream_mode;
+static uint8_t stream_pkt_cfg0 = CC11XX_PKT_CFG0_FIXED;
+
+/**
+ * \fn cc11xx_StreamWriteReg
+ *
+ * \brief Writes one register (and waits for it).
+ *
+ * \param addr is the register address.
+ * \param value is the new value.
+ *
+ * \return None
+ */
+static void cc11xx_StreamWriteReg(uint16_t addr, uint8_t value)
+{
+    cc11xx_SPI_Transfer(CC11XX_SINGLE_ACCESS | CC11XX_WRITE_ACCESS, addr, &value, 1);
+}
+
+/**
+ * \fn cc11xx_StreamPush
+ *
+ * \brief Copies data to the ring buffer.
+ *
+ * \param pData is the data.
+ * \param n is the number of bytes.
+ *
+ * \return Number of bytes copied (limited by the free space and the packet length).
+ */
+static uint16_t cc11xx_StreamPush(const uint8_t *pData, uint16_t n)
+{
+    uint16_t room = CC11XX_STREAM_RING_SIZE - (uint16_t)(stream_head - stream_tail);
+    uint16_t i;
+
+    if (n > room)
+    {
+        n = room;
+    }
+    if (n > stream_total - stream_head)
+    {
+        n = stream_total - stream_head;
+    }
+
+    for(i=0; i<n; i++)
+    {
+        stream_ring[(stream_head + i) & CC11XX_STREAM_RING_MASK] = pData[i];
+    }
+
+    // The refill only sees the bytes once they are in place
+    stream_head += n;
+
+    return n;
+}
+
+/**
+ * \fn cc11xx_StreamRefilled
+ *
+ * \brief End of a TX FIFO write (callback of the SPI engine, interrupt context).
+ *
+ * \param t is the transfer.
+ *
+ * \return None
+ */
+static void cc11xx_StreamRefilled(SPITransfer *t)
+{
+    stream_busy = false;
+
+    // Chip not ready: nothing written, the stream ends short (See cc11xx_StreamEnd())
+    if (t->status & CC11XX_STATUS_CHIP_RDYn_H)
+    {
+        return;
+    }
+
+    stream_tail += t->len;
+
+    // Still below the threshold (short ring buffer or end of the ring): GPIO0 will not fall again
+    if (GPIO_getInputPinValue(CC11XX_GPIO0_PORT, CC11XX_GPIO0_PIN) == GPIO_INPUT_PIN_LOW)
+    {
+        cc11xx_StreamRefill();
+    }
+}
+
+/**
+ * \fn cc11xx_StreamKick
+ *
+ * \brief Starts a refill if the TX FIFO is below the threshold (no falling edge to wait for).
+ *
+ * \return None
+ */
+static void cc11xx_StreamKick()
+{
+    uint16_t int_state = __get_interrupt_state();
+
+    __disable_interrupt();
+    if (GPIO_getInputPinValue(CC11XX_GPIO0_PORT, CC11XX_GPIO0_PIN) == GPIO_INPUT_PIN_LOW)
+    {
+        cc11xx_StreamRefill();
+    }
+    __set_interrupt_state(int_state);
+}
+
+uint16_t cc11xx_StreamStart(uint16_t len, const uint8_t *pData, uint16_t n)
+{
+#if DEBUG_MODE == true
+    debug_PrintMsg("cc11xx_StreamStart()");
+#endif // DEBUG_MODE
+
+    uint8_t header[CC11XX_STREAM_HEADER];
+    uint8_t i;
+
+    if (stream_active || (len == 0) || (len > CC11XX_STREAM_MAX_LEN))
+    {
+#if DEBUG_MODE == true
+        debug_PrintMsg("\tFAIL!");
+#endif // DEBUG_MODE
+
+        return 0;
+    }
+
+    for(i=0; i<CC11XX_STREAM_SAVED_REGS; i++)
+    {
+        cc11xx_SPI_Transfer(CC11XX_SINGLE_ACCESS | CC11XX_READ_ACCESS, stream_regs[i], &stream_saved[i], 1);
+    }
+
+    stream_total = len + CC11XX_STREAM_HEADER;
+    stream_head = 0;
+    stream_tail = 0;
+    stream_busy = false;
+    stream_fixed = stream_total < 256;
+
+    header[0] = CC11XX_STREAM_FLAG | (uint8_t)(len >> 8);
+    header[1] = (uint8_t)(len & 0xFF);
+    cc11xx_StreamPush(header, CC11XX_STREAM_HEADER);
+    n = cc11xx_StreamPush(pData, n);
+
+    // The packet ends when the byte counter (modulo 256) reaches PKT_LEN in the fixed length mode
+    cc11xx_StreamWriteReg(CC11XX_PKT_LEN, (uint8_t)(stream_total & 0xFF));
+    cc11xx_StreamWriteReg(CC11XX_PKT_CFG0, stream_fixed ? CC11XX_PKT_CFG0_FIXED : CC11XX_PKT_CFG0_INFINITE);
+    cc11xx_StreamWriteReg(CC11XX_FIFO_CFG, CC11XX_STREAM_FIFO_THR);
+    cc11xx_SPI_Transfer(0x00, CC11XX_SFTX, NULL, 0);
+    cc11xx_StreamWriteReg(CC11XX_IOCFG0, CC11XX_IOCFG_TXFIFO_THR);
+
+    // Edges of the previous GPIO0 function are not refills
+    GPIO_clearInterrupt(CC11XX_GPIO0_PORT, CC11XX_GPIO0_PIN);
+    GPIO_enableInterrupt(CC11XX_GPIO0_PORT, CC11XX_GPIO0_PIN);
+
+    // First fill, then STX (queued behind it)
+    stream_active = true;
+    cc11xx_StreamKick();
+    cc11xx_SPI_Transfer(0x00, CC11XX_STX, NULL, 0);
+
+#if DEBUG_MODE == true
+    debug_PrintByte("\tLength (MSB): ", (uint8_t)(stream_total >> 8));
+    debug_PrintByte("\tLength (LSB): ", (uint8_t)(stream_total & 0xFF));
+    debug_PrintMsg("End of cc11xx_StreamStart()\n");
+#endif // DEBUG_MODE
+
+    return n;
+}
+
+uint16_t cc11xx_StreamWrite(const uint8_t *pData, uint16_t n)
+{
+    if (!stream_active)
+    {
+        return 0;
+    }
+
+    n = cc11xx_StreamPush(pData, n);
+    cc11xx_StreamKick();
+
+    return n;
+}
+
+void cc11xx_StreamRefill()
+{
+    uint16_t n = stream_head - stream_tail;
+    uint16_t contiguous = CC11XX_STREAM_RING_SIZE - (stream_tail & CC11XX_STREAM_RING_MASK);
+
+    if (!stream_active || stream_busy || (n == 0))
+    {
+        return;
+    }
+
+    // Fixed length for the end: fewer than 256 bytes left to send (the ones not written and up to a full TX FIFO)
+    if (!stream_fixed && (stream_total - stream_tail < CC11XX_FIFO_SIZE))
+    {
+        stream_mode.access   = CC11XX_SINGLE_ACCESS | CC11XX_WRITE_ACCESS;
+        stream_mode.addr     = CC11XX_PKT_CFG0;
+        stream_mode.pData    = &stream_pkt_cfg0;
+        stream_mode.len      = 1;
+        stream_mode.callback = NULL;
+        if (cc11xx_SPI_Submit(&stream_mode) == STATUS_SUCCESS)
+        {
+            stream_fixed = true;
+        }
+    }
+
+    // One burst per refill: the end of the ring buffer is written by the next one (See cc11xx_StreamRefilled())
+    if (n > contiguous)
+    {
+        n = contiguous;
+    }
+    if (n > CC11XX_STREAM_REFILL)
+    {
+        n = CC11XX_STREAM_REFILL;
+    }
+
+    stream_refill.access   = CC11XX_WRITE_ACCESS;
+    stream_refill.addr     = CC11XX_BURST_TXFIFO;
+    stream_refill.pData    = &stream_ring[stream_tail & CC11XX_STREAM_RING_MASK];
+    stream_refill.len      = n;
+    stream_refill.callback = cc11xx_StreamRefilled;
+
+    stream_busy = cc11xx_SPI_Submit(&stream_refill) == STATUS_SUCCESS;
+}
+
+uint8_t cc11xx_StreamEnd()
+{
+    uint8_t status = STATUS_SUCCESS;
+    uint8_t i;
+
+    if (!stream_active)
+    {
+        return STATUS_FAIL;
+    }
+
+#if DEBUG_MODE == true
+    debug_PrintMsg("cc11xx_StreamEnd()");
+#endif // DEBUG_MODE
+
+    stream_active = false;
+
+    // Before IOCFG0 gets its value back
+    GPIO_disableInterrupt(CC11XX_GPIO0_PORT, CC11XX_GPIO0_PIN);
+    GPIO_clearInterrupt(CC11XX_GPIO0_PORT, CC11XX_GPIO0_PIN);
+
+    // GPIO2 also de-asserts on a TX FIFO underflow
+    if (((cc11xx_SPI_Transfer(0x00, CC11XX_SNOP, NULL, 0) & 0x70) == CC11XX_STATE_TX_FIFO_ERROR) ||
+        (stream_tail != stream_total))
+    {
+        cc11xx_SPI_Transfer(0x00, CC11XX_SIDLE, NULL, 0);
+        cc11xx_SPI_Transfer(0x00, CC11XX_SFTX, NULL, 0);
+        status = STATUS_FAIL;
+    }
+
+    for(i=0; i<CC11XX_STREAM_SAVED_REGS; i++)
+    {
+        cc11xx_StreamWriteReg(stream_regs[i], stream_saved[i]);
+    }
+
+#if DEBUG_MODE == true
+    debug_PrintMsg((status == STATUS_SUCCESS) ? "\tSUCCESS!" : "\tFAIL!");
+    debug_PrintMsg("End of cc11xx_StreamEnd()\n");
+#endif // DEBUG_MODE
+
+    return status;
+}
+
+bool cc11xx_StreamActive()
+{
+    return stream_active;
+}
+
+//! \} End of cc11xx_stream group
@@ -0,0 +1,218 @@
+/*
+ * events.c
+ *
+ * Copyright (C) 2016, Universidade Federal de Santa Catarina
+ *
+ * This file is part of FloripaSat-TTC.
+ *
+ * FloripaSat-TTC is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * FloripaSat-TTC is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with FloripaSat-TTC.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * \file events.c
+ *
+ * \brief Wake-up events of the main loop (implementation)
+ *
+ * \version 1.0-dev
+ *
+ * \date 17/10/2026
+ *
+ * \addtogroup events
+ * \{
+ */
+
+#include "../inc/events.h"
+#include "../inc/cc11xx_spi.h"
+#include "../inc/cc11xx_stream.h"
+
+#if DEBUG_MODE == true
+#include "../inc/debug.h"
+#endif // DEBUG_MODE
+
+static volatile uint8_t events_pending = 0;         // Set by the interrupt routines, cleared by events_Wait()
+static volatile bool events_timer_running = false;  // Set by events_TimerStart(), cleared by the Timer_A1 compare
+
+uint8_t events_Init()
+{
+#if DEBUG_MODE == true
+    debug_PrintMsg("events_Init()");
+#endif // DEBUG_MODE
+
+    Calendar time = {0};
+
+    // XT1 and the RTC_B are in the backup subsystem
+    while(BattBak_unlockBackupSubSystem(BAK_BATT_BASE) != BATTBAK_UNLOCKSUCCESS);
+
+    if (UCS_turnOnLFXT1WithTimeout(UCS_XT1_DRIVE_0, UCS_XCAP_3, EVENTS_XT1_TIMEOUT) == STATUS_FAIL)
+    {
+#if DEBUG_MODE == true
+        debug_PrintMsg("\tFAIL!");
+#endif // DEBUG_MODE
+
+        return STATUS_FAIL;
+    }
+
+    // RTC tick: read ready interrupt, once per second
+    time.DayOfMonth = 1;
+    RTC_B_initCalendar(RTC_B_BASE, &time, RTC_B_FORMAT_BINARY);
+    RTC_B_clearInterrupt(RTC_B_BASE, RTC_B_CLOCK_READ_READY_INTERRUPT);
+    RTC_B_enableInterrupt(RTC_B_BASE, RTC_B_CLOCK_READ_READY_INTERRUPT);
+    RTC_B_startClock(RTC_B_BASE);
+
+    // End of packet: falling edge of GPIO2 (PKT_SYNC_RXTX)
+    GPIO_setAsInputPin(EVENTS_GDO_PORT, EVENTS_GDO_PIN);
+    GPIO_selectInterruptEdge(EVENTS_GDO_PORT, EVENTS_GDO_PIN, GPIO_HIGH_TO_LOW_TRANSITION);
+    GPIO_clearInterrupt(EVENTS_GDO_PORT, EVENTS_GDO_PIN);
+    GPIO_enableInterrupt(EVENTS_GDO_PORT, EVENTS_GDO_PIN);
+
+    // Stream TX FIFO refill: falling edge of GPIO0 (TXFIFO_THR), enabled during a stream only (See cc11xx_StreamStart())
+    GPIO_setAsInputPin(EVENTS_FIFO_PORT, EVENTS_FIFO_PIN);
+    GPIO_selectInterruptEdge(EVENTS_FIFO_PORT, EVENTS_FIFO_PIN, GPIO_HIGH_TO_LOW_TRANSITION);
+    GPIO_disableInterrupt(EVENTS_FIFO_PORT, EVENTS_FIFO_PIN);
+
+    events_pending = 0;
+
+#if DEBUG_MODE == true
+    debug_PrintMsg("\tSUCCESS!");
+#endif // DEBUG_MODE
+
+    return STATUS_SUCCESS;
+}
+
+uint8_t events_Wait()
+{
+    uint8_t events;
+
+    // The check and the sleep must be atomic (See cc11xx_SPI_Wait())
+    __disable_interrupt();
+    while(events_pending == 0)
+    {
+        // LPM3 stops SMCLK, which clocks the SPI
+        if (cc11xx_SPI_Busy())
+        {
+            __bis_SR_register(LPM0_bits + GIE);
+        }
+        else
+        {
+            __bis_SR_register(LPM3_bits + GIE);
+        }
+        __disable_interrupt();
+    }
+    events = events_pending;
+    events_pending = 0;
+    __enable_interrupt();
+
+    return events;
+}
+
+void events_TimerStart(uint16_t ticks)
+{
+    Timer_A_initUpModeParam param = {0};
+
+    param.clockSource                               = TIMER_A_CLOCKSOURCE_ACLK;
+    param.clockSourceDivider                        = TIMER_A_CLOCKSOURCE_DIVIDER_1;
+    param.timerPeriod                               = ticks;
+    param.timerInterruptEnable_TAIE                 = TIMER_A_TAIE_INTERRUPT_DISABLE;
+    param.captureCompareInterruptEnable_CCR0_CCIE   = TIMER_A_CCIE_CCR0_INTERRUPT_ENABLE;
+    param.timerClear                                = TIMER_A_DO_CLEAR;
+    param.startTimer                                = true;
+
+    events_timer_running = true;
+    Timer_A_initUpMode(EVENTS_TIMER_BASE, &param);
+}
+
+void events_TimerWait()
+{
+    uint16_t state = __get_interrupt_state();
+
+    // Same atomic check and sleep as events_Wait()
+    __disable_interrupt();
+    while(events_timer_running)
+    {
+        if (cc11xx_SPI_Busy())
+        {
+            __bis_SR_register(LPM0_bits + GIE);
+        }
+        else
+        {
+            __bis_SR_register(LPM3_bits + GIE);
+        }
+        __disable_interrupt();
+    }
+    __set_interrupt_state(state);
+}
+
+/**
+ * \fn events_Timer_ISR
+ *
+ * \brief Timer_A1 CCR0 interrupt: end of the delay of events_TimerStart().
+ *
+ * \return None
+ */
+#pragma vector=TIMER1_A0_VECTOR
+__interrupt void events_Timer_ISR()
+{
+    // One-shot: CCIFG is cleared by the interrupt itself
+    Timer_A_stop(EVENTS_TIMER_BASE);
+    events_timer_running = false;
+    __bic_SR_register_on_exit(LPM3_bits);
+}
+
+/**
+ * \fn events_RTC_ISR
+ *
+ * \brief RTC_B interrupt: one second tick.
+ *
+ * \return None
+ */
+#pragma vector=RTC_VECTOR
+__interrupt void events_RTC_ISR()
+{
+    if (RTC_B_getInterruptStatus(RTC_B_BASE, RTC_B_CLOCK_READ_READY_INTERRUPT))
+    {
+        RTC_B_clearInterrupt(RTC_B_BASE, RTC_B_CLOCK_READ_READY_INTERRUPT);
+        events_pending |= EVENTS_RTC_TICK;
+        __bic_SR_register_on_exit(LPM3_bits);
+    }
+}
+
+/**
+ * \fn events_GDO_ISR
+ *
+ * \brief Port 1 interrupt: end of the packet (falling edge of the CC1175 GPIO2) and TX FIFO threshold (GPIO0).
+ *
+ * \return None
+ */
+#pragma vector=PORT1_VECTOR
+__interrupt void events_GDO_ISR()
+{
+    if (GPIO_getInterruptStatus(EVENTS_FIFO_PORT, EVENTS_FIFO_PIN))
+    {
+        GPIO_clearInterrupt(EVENTS_FIFO_PORT, EVENTS_FIFO_PIN);
+        cc11xx_StreamRefill();
+
+        // No event: events_Wait() only has to sleep in LPM0 while the refill runs
+        __bic_SR_register_on_exit(LPM3_bits);
+    }
+
+    if (GPIO_getInterruptStatus(EVENTS_GDO_PORT, EVENTS_GDO_PIN))
+    {
+        GPIO_clearInterrupt(EVENTS_GDO_PORT, EVENTS_GDO_PIN);
+        events_pending |= EVENTS_TX_END;
+        __bic_SR_register_on_exit(LPM3_bits);
+    }
+}
+
+//! \} End of events group
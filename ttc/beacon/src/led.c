@@ -53,6 +53,11 @@ void led_Disable()
     GPIO_setOutputLowOnPin(BEACON_STATUS_LED_PORT, BEACON_STATUS_LED_PIN);
 }
 
+void led_Toggle()
+{
+    GPIO_toggleOutputOnPin(BEACON_STATUS_LED_PORT, BEACON_STATUS_LED_PIN);
+}
+
 void led_Blink(uint16_t period)
 {
     GPIO_toggleOutputOnPin(BEACON_STATUS_LED_PORT, BEACON_STATUS_LED_PIN);
@@ -42,6 +42,10 @@
 #include "../inc/debug.h"
 #endif // DEBUG_MODE
 
+static volatile EPSBatteryData eps_battery = {0};   // Last frame (written by the RX interrupt)
+static uint8_t eps_frame[EPS_FRAME_DATA_LEN];       // Data bytes of the frame being received
+static uint8_t eps_frame_pos = 0;                   // Bytes of the frame received (SOF included)
+
 uint8_t UART_EPS_Init()
 {
 #if DEBUG_MODE == true
@@ -77,6 +81,12 @@ uint8_t UART_EPS_Init()
         // Enable UART module
         USCI_A_UART_enable(USCI_A0_BASE);
 
+        // Frames received by interrupt
+        eps_frame_pos = 0;
+        eps_battery.frames = 0;
+        USCI_A_UART_clearInterrupt(USCI_A0_BASE, USCI_A_UART_RECEIVE_INTERRUPT);
+        USCI_A_UART_enableInterrupt(USCI_A0_BASE, USCI_A_UART_RECEIVE_INTERRUPT);
+
 #if DEBUG_MODE == true
         debug_PrintMsg("\tSUCCESS!");
 #endif // DEBUG_MODE
@@ -85,4 +95,61 @@ uint8_t UART_EPS_Init()
     }
 }
 
+uint8_t UART_EPS_GetBattery(EPSBatteryData *data)
+{
+    uint16_t gie = __get_interrupt_state();
+
+    __disable_interrupt();
+    data->bat1_voltage  = eps_battery.bat1_voltage;
+    data->bat2_voltage  = eps_battery.bat2_voltage;
+    data->frames        = eps_battery.frames;
+    __set_interrupt_state(gie);
+
+    return (data->frames > 0) ? STATUS_SUCCESS : STATUS_FAIL;
+}
+
+/**
+ * \fn UART_EPS_ISR
+ * 
+ * \brief USCI_A0 interrupt: one byte of an EPS frame.
+ * 
+ * \return None
+ */
+#pragma vector=USCI_A0_VECTOR
+__interrupt void UART_EPS_ISR()
+{
+    uint8_t byte;
+
+    if (!USCI_A_UART_getInterruptStatus(USCI_A0_BASE, USCI_A_UART_RECEIVE_INTERRUPT_FLAG))
+    {
+        return;
+    }
+
+    byte = USCI_A_UART_receiveData(USCI_A0_BASE);
+
+    if (eps_frame_pos < EPS_FRAME_SOF_LEN)
+    {
+        // Start of frame: restarts on anything else
+        eps_frame_pos = (byte == EPS_FRAME_SOF) ? eps_frame_pos + 1 : 0;
+    }
+    else if (eps_frame_pos < EPS_FRAME_SOF_LEN + EPS_FRAME_DATA_LEN)
+    {
+        eps_frame[eps_frame_pos - EPS_FRAME_SOF_LEN] = byte;
+        eps_frame_pos++;
+    }
+    else
+    {
+        if (byte == EPS_FRAME_EOF)
+        {
+            eps_battery.bat1_voltage = ((uint16_t)eps_frame[0] << 8) | eps_frame[1];
+            eps_battery.bat2_voltage = ((uint16_t)eps_frame[2] << 8) | eps_frame[3];
+            if (++eps_battery.frames == 0)
+            {
+                eps_battery.frames = 1;     // 0 = no frame yet
+            }
+        }
+        eps_frame_pos = 0;
+    }
+}
+
 //! \} End of eps_uart implementation group